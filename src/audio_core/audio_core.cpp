@@ -11,6 +11,7 @@
 #include "audio_core/null_sink.h"
 #include "audio_core/sink.h"
 #include "audio_core/sink_details.h"
+#include "common/chunk_file.h"
 #include "common/common_types.h"
 #include "core/core_timing.h"
 #include "core/hle/service/dsp_dsp.h"
@@ -58,4 +59,12 @@ void Shutdown() {
     DSP::HLE::Shutdown();
 }
 
+void DoState(PointerWrap& p) {
+    auto section = p.Section("AudioCore", 1);
+    if (!section) {
+        return;
+    }
+    DSP::HLE::DoState(p);
+}
+
 } // namespace AudioCore
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <cstring>
@@ -11,6 +12,10 @@
 #include "common/common_types.h"
 #include "common/math_util.h"
 
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
+
 namespace Codec {
 
 StereoBuffer16 DecodeADPCM(const u8* const data, const size_t sample_count,
@@ -21,8 +26,6 @@ StereoBuffer16 DecodeADPCM(const u8* const data, const size_t sample_count,
 
     constexpr size_t FRAME_LEN = 8;
     constexpr size_t SAMPLES_PER_FRAME = 14;
-    constexpr std::array<int, 16> SIGNED_NIBBLES = {
-        {0, 1, 2, 3, 4, 5, 6, 7, -8, -7, -6, -5, -4, -3, -2, -1}};
 
     const size_t ret_size =
         sample_count % 2 == 0 ? sample_count : sample_count + 1; // Ensure multiple of two.
@@ -33,7 +36,8 @@ StereoBuffer16 DecodeADPCM(const u8* const data, const size_t sample_count,
     const size_t NUM_FRAMES =
         (sample_count + (SAMPLES_PER_FRAME - 1)) / SAMPLES_PER_FRAME; // Round up.
     for (size_t framei = 0; framei < NUM_FRAMES; framei++) {
-        const int frame_header = data[framei * FRAME_LEN];
+        const u8* const frame = data + framei * FRAME_LEN;
+        const int frame_header = frame[0];
         const int scale = 1 << (frame_header & 0xF);
         const int idx = (frame_header >> 4) & 0x7;
 
@@ -48,27 +52,30 @@ StereoBuffer16 DecodeADPCM(const u8* const data, const size_t sample_count,
             // digital filter, then transform back.
             // 0x400 == 0.5 in 11 bit fixed point.
             // Filter: y[n] = x[n] + 0.5 + c1 * y[n-1] + c2 * y[n-2]
-            int val = ((xn << 11) + 0x400 + coef1 * yn1 + coef2 * yn2) >> 11;
-            // Clamp to output range.
-            val = MathUtil::Clamp(val, -32768, 32767);
+            // Everything but the c1 * y[n-1] term is known one sample ahead, which keeps it off
+            // the dependency chain between samples.
+            const int partial = (xn << 11) + 0x400 + coef2 * yn2;
+            int val = (partial + coef1 * yn1) >> 11;
+            // Clamp to output range. Audio rarely clips, so this branch predicts well and is
+            // cheaper than an unconditional clamp on the dependency chain.
+            if (val != static_cast<s16>(val))
+                val = MathUtil::Clamp(val, -32768, 32767);
             // Advance output feedback.
             yn2 = yn1;
             yn1 = val;
             return (s16)val;
         };
 
-        size_t outputi = framei * SAMPLES_PER_FRAME;
-        size_t datai = framei * FRAME_LEN + 1;
-        for (size_t i = 0; i < SAMPLES_PER_FRAME && outputi < sample_count; i += 2) {
-            const s16 sample1 = decode_sample(SIGNED_NIBBLES[data[datai] >> 4]);
-            ret[outputi].fill(sample1);
-            outputi++;
-
-            const s16 sample2 = decode_sample(SIGNED_NIBBLES[data[datai] & 0xF]);
-            ret[outputi].fill(sample2);
-            outputi++;
-
-            datai++;
+        // Only the last frame can be partial. Samples are decoded in pairs, which is why ret_size
+        // is rounded up.
+        const size_t frame_samples =
+            std::min(SAMPLES_PER_FRAME, sample_count - framei * SAMPLES_PER_FRAME);
+        std::array<s16, 2>* const output = &ret[framei * SAMPLES_PER_FRAME];
+        for (size_t i = 0; i < frame_samples; i += 2) {
+            // The high nibble comes first. Both are sign-extended with arithmetic shifts.
+            const s8 byte = static_cast<s8>(frame[1 + i / 2]);
+            output[i].fill(decode_sample(byte >> 4));
+            output[i + 1].fill(decode_sample(static_cast<s8>(byte << 4) >> 4));
         }
     }
 
@@ -84,18 +91,46 @@ static s16 SignExtendS8(u8 x) {
     return static_cast<s16>(static_cast<s8>(x));
 }
 
+// The SSE2 paths convert 16 bytes of input at a time. PCM8 is sign extended by moving each byte to
+// the upper half of a 16-bit lane and shifting it back down, mono samples are duplicated to both
+// channels by interleaving them with themselves.
+
 StereoBuffer16 DecodePCM8(const unsigned num_channels, const u8* const data,
                           const size_t sample_count) {
     ASSERT(num_channels == 1 || num_channels == 2);
 
     StereoBuffer16 ret(sample_count);
+    size_t i = 0;
 
+#ifdef ARCHITECTURE_x86_64
+    __m128i* output = reinterpret_cast<__m128i*>(ret.data());
     if (num_channels == 1) {
-        for (size_t i = 0; i < sample_count; i++) {
+        for (; i + 16 <= sample_count; i += 16) {
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            const __m128i low = _mm_srai_epi16(_mm_unpacklo_epi8(bytes, bytes), 8);
+            const __m128i high = _mm_srai_epi16(_mm_unpackhi_epi8(bytes, bytes), 8);
+            _mm_storeu_si128(output++, _mm_unpacklo_epi16(low, low));
+            _mm_storeu_si128(output++, _mm_unpackhi_epi16(low, low));
+            _mm_storeu_si128(output++, _mm_unpacklo_epi16(high, high));
+            _mm_storeu_si128(output++, _mm_unpackhi_epi16(high, high));
+        }
+    } else {
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 8 <= sample_count; i += 8) {
+            const __m128i bytes =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 2));
+            _mm_storeu_si128(output++, _mm_srai_epi16(_mm_unpacklo_epi8(zero, bytes), 8));
+            _mm_storeu_si128(output++, _mm_srai_epi16(_mm_unpackhi_epi8(zero, bytes), 8));
+        }
+    }
+#endif
+
+    if (num_channels == 1) {
+        for (; i < sample_count; i++) {
             ret[i].fill(SignExtendS8(data[i]));
         }
     } else {
-        for (size_t i = 0; i < sample_count; i++) {
+        for (; i < sample_count; i++) {
             ret[i][0] = SignExtendS8(data[i * 2 + 0]);
             ret[i][1] = SignExtendS8(data[i * 2 + 1]);
         }
@@ -111,7 +146,17 @@ StereoBuffer16 DecodePCM16(const unsigned num_channels, const u8* const data,
     StereoBuffer16 ret(sample_count);
 
     if (num_channels == 1) {
-        for (size_t i = 0; i < sample_count; i++) {
+        size_t i = 0;
+#ifdef ARCHITECTURE_x86_64
+        __m128i* output = reinterpret_cast<__m128i*>(ret.data());
+        for (; i + 8 <= sample_count; i += 8) {
+            const __m128i samples =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * sizeof(s16)));
+            _mm_storeu_si128(output++, _mm_unpacklo_epi16(samples, samples));
+            _mm_storeu_si128(output++, _mm_unpackhi_epi16(samples, samples));
+        }
+#endif
+        for (; i < sample_count; i++) {
             s16 sample;
             std::memcpy(&sample, data + i * sizeof(s16), sizeof(s16));
             ret[i].fill(sample);
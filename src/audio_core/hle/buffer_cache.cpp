@@ -0,0 +1,161 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <list>
+#include <mutex>
+#include "audio_core/hle/buffer_cache.h"
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "core/memory.h"
+
+namespace DSP {
+namespace HLE {
+
+MICROPROFILE_DEFINE(DSP_BufferDecode, "DSP", "Buffer Decode", MP_RGB(100, 200, 100));
+
+Codec::StereoBuffer16 DecodeBuffer(const u8* memory, u32 length, BufferFormat format,
+                                   unsigned num_channels, const std::array<s16, 16>& adpcm_coeffs,
+                                   Codec::ADPCMState& adpcm_state) {
+    MICROPROFILE_SCOPE(DSP_BufferDecode);
+
+    switch (format) {
+    case BufferFormat::PCM8:
+        return Codec::DecodePCM8(num_channels, memory, length);
+    case BufferFormat::PCM16:
+        return Codec::DecodePCM16(num_channels, memory, length);
+    case BufferFormat::ADPCM:
+        DEBUG_ASSERT(num_channels == 1);
+        return Codec::DecodeADPCM(memory, length, adpcm_coeffs, adpcm_state);
+    default:
+        UNIMPLEMENTED();
+        return {};
+    }
+}
+
+/// Size of the encoded samples of a buffer in bytes
+static u32 EncodedSize(u32 length, BufferFormat format, unsigned num_channels) {
+    switch (format) {
+    case BufferFormat::PCM8:
+        return length * num_channels;
+    case BufferFormat::PCM16:
+        return length * num_channels * 2;
+    case BufferFormat::ADPCM:
+        // Frames of 8 bytes hold 14 samples
+        return (length + 13) / 14 * 8;
+    default:
+        return 0;
+    }
+}
+
+namespace {
+
+struct CachedBuffer {
+    PAddr physical_address;
+    u32 size;
+    u32 length;
+    BufferFormat format;
+    unsigned num_channels;
+    /// Decoder input and output, only meaningful for ADPCM
+    std::array<s16, 16> adpcm_coeffs;
+    Codec::ADPCMState initial_adpcm_state;
+    Codec::ADPCMState final_adpcm_state;
+
+    std::shared_ptr<const Codec::StereoBuffer16> samples;
+
+    bool Matches(PAddr address, u32 length_, BufferFormat format_, unsigned num_channels_,
+                 const std::array<s16, 16>& coeffs, const Codec::ADPCMState& state) const {
+        if (physical_address != address || length != length_ || format != format_ ||
+            num_channels != num_channels_)
+            return false;
+        return format != BufferFormat::ADPCM ||
+               (adpcm_coeffs == coeffs && initial_adpcm_state.yn1 == state.yn1 &&
+                initial_adpcm_state.yn2 == state.yn2);
+    }
+};
+
+} // anonymous namespace
+
+/// About 16 MiB of decoded samples
+constexpr size_t MAX_CACHED_SAMPLES = 4 * 1024 * 1024;
+
+// Sources may be ticked in parallel, so the cache is guarded by a mutex. Marking memory as cached
+// is safe from the worker threads as the emulation thread waits for them while sources are ticked.
+static std::mutex buffer_cache_mutex;
+/// Most recently used buffers first
+static std::list<CachedBuffer> buffer_cache;
+static size_t cached_samples = 0;
+
+static void ReleaseBuffer(const CachedBuffer& buffer) {
+    Memory::RasterizerMarkRegionCached(buffer.physical_address, buffer.size, -1);
+    cached_samples -= buffer.samples->size();
+}
+
+std::shared_ptr<const Codec::StereoBuffer16> GetDecodedBuffer(
+    PAddr physical_address, u32 length, BufferFormat format, unsigned num_channels,
+    const std::array<s16, 16>& adpcm_coeffs, Codec::ADPCMState& adpcm_state) {
+
+    {
+        std::lock_guard<std::mutex> lock(buffer_cache_mutex);
+        for (auto it = buffer_cache.begin(); it != buffer_cache.end(); ++it) {
+            if (it->Matches(physical_address, length, format, num_channels, adpcm_coeffs,
+                            adpcm_state)) {
+                buffer_cache.splice(buffer_cache.begin(), buffer_cache, it);
+                adpcm_state = it->final_adpcm_state;
+                return it->samples;
+            }
+        }
+    }
+
+    const u8* const memory = Memory::GetPhysicalPointer(physical_address);
+    if (memory == nullptr)
+        return nullptr;
+
+    CachedBuffer buffer;
+    buffer.physical_address = physical_address;
+    buffer.size = EncodedSize(length, format, num_channels);
+    buffer.length = length;
+    buffer.format = format;
+    buffer.num_channels = num_channels;
+    buffer.adpcm_coeffs = adpcm_coeffs;
+    buffer.initial_adpcm_state = adpcm_state;
+    buffer.samples = std::make_shared<const Codec::StereoBuffer16>(
+        DecodeBuffer(memory, length, format, num_channels, adpcm_coeffs, adpcm_state));
+    buffer.final_adpcm_state = adpcm_state;
+
+    if (buffer.size == 0 || buffer.samples->size() > MAX_CACHED_SAMPLES)
+        return buffer.samples;
+
+    std::lock_guard<std::mutex> lock(buffer_cache_mutex);
+    cached_samples += buffer.samples->size();
+    while (cached_samples > MAX_CACHED_SAMPLES) {
+        ReleaseBuffer(buffer_cache.back());
+        buffer_cache.pop_back();
+    }
+    Memory::RasterizerMarkRegionCached(physical_address, buffer.size, 1);
+    buffer_cache.push_front(buffer);
+    return buffer.samples;
+}
+
+void InvalidateDecodedBuffers(PAddr address, u32 size) {
+    std::lock_guard<std::mutex> lock(buffer_cache_mutex);
+    for (auto it = buffer_cache.begin(); it != buffer_cache.end();) {
+        if (it->physical_address < address + size && address < it->physical_address + it->size) {
+            ReleaseBuffer(*it);
+            it = buffer_cache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ClearDecodedBuffers() {
+    std::lock_guard<std::mutex> lock(buffer_cache_mutex);
+    for (const CachedBuffer& buffer : buffer_cache)
+        ReleaseBuffer(buffer);
+    buffer_cache.clear();
+}
+
+} // namespace HLE
+} // namespace DSP
@@ -0,0 +1,49 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include "audio_core/codec.h"
+#include "audio_core/hle/dsp.h"
+#include "common/common_types.h"
+
+namespace DSP {
+namespace HLE {
+
+using BufferFormat = SourceConfiguration::Configuration::Format;
+
+/**
+ * Decodes a buffer of samples.
+ * @param memory Pointer to the encoded samples
+ * @param length Length of the buffer in samples
+ * @param format Format of the samples
+ * @param num_channels Number of channels, must be 1 for ADPCM
+ * @param adpcm_coeffs ADPCM coefficients, only used for ADPCM buffers
+ * @param adpcm_state ADPCM state, updated as by Codec::DecodeADPCM
+ */
+Codec::StereoBuffer16 DecodeBuffer(const u8* memory, u32 length, BufferFormat format,
+                                   unsigned num_channels, const std::array<s16, 16>& adpcm_coeffs,
+                                   Codec::ADPCMState& adpcm_state);
+
+/**
+ * Like DecodeBuffer, but for buffers at a physical address which are likely to be played again,
+ * such as looping buffers. The decoded samples are kept until the emulated memory they were
+ * decoded from is written to, so that repeating the buffer with the same decoder state doesn't
+ * decode it again.
+ * @return The decoded samples, or null if the address is invalid
+ */
+std::shared_ptr<const Codec::StereoBuffer16> GetDecodedBuffer(
+    PAddr physical_address, u32 length, BufferFormat format, unsigned num_channels,
+    const std::array<s16, 16>& adpcm_coeffs, Codec::ADPCMState& adpcm_state);
+
+/// Drops the decoded buffers overlapping the given region of physical memory
+void InvalidateDecodedBuffers(PAddr address, u32 size);
+
+/// Drops all decoded buffers
+void ClearDecodedBuffers();
+
+} // namespace HLE
+} // namespace DSP
@@ -2,21 +2,30 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
 #include <memory>
+#include <new>
+#include <thread>
+#include "audio_core/hle/buffer_cache.h"
 #include "audio_core/hle/dsp.h"
 #include "audio_core/hle/mixers.h"
 #include "audio_core/hle/pipe.h"
 #include "audio_core/hle/source.h"
 #include "audio_core/sink.h"
 #include "audio_core/time_stretch.h"
+#include "common/chunk_file.h"
+#include "common/thread_pool.h"
+#include "core/memory.h"
+#include "core/settings.h"
 
 namespace DSP {
 namespace HLE {
 
 // Region management
 
-DspMemory g_dsp_memory;
+// Applications access DSP RAM directly, so it is backing memory like FCRAM
+DspMemory& g_dsp_memory = *new (Memory::AllocateBackingMemory(sizeof(DspMemory))) DspMemory();
 
 static size_t CurrentRegionIndex() {
     // The region with the higher frame counter is chosen unless there is wraparound.
@@ -54,16 +63,32 @@ static std::array<Source, num_sources> sources = {
 };
 static Mixers mixers;
 
+/// With more threads, each of them would only get a couple of sources per frame
+constexpr size_t MAX_SOURCE_THREADS = 4;
+/// Used to tick sources in parallel, null if sources are ticked on the calling thread
+static std::unique_ptr<Common::ThreadPool> source_thread_pool;
+
 static StereoFrame16 GenerateCurrentFrame() {
     SharedMemory& read = ReadRegion();
     SharedMemory& write = WriteRegion();
 
-    std::array<QuadFrame32, 3> intermediate_mixes = {};
-
-    // Generate intermediate mixes
-    for (size_t i = 0; i < num_sources; i++) {
+    // Sources only access their own configuration and status, so they can be ticked concurrently
+    const auto tick_source = [&read, &write](size_t i) {
         write.source_statuses.status[i] =
             sources[i].Tick(read.source_configurations.config[i], read.adpcm_coefficients.coeff[i]);
+    };
+    if (source_thread_pool) {
+        source_thread_pool->ParallelFor(num_sources, tick_source);
+    } else {
+        for (size_t i = 0; i < num_sources; i++) {
+            tick_source(i);
+        }
+    }
+
+    // Generate intermediate mixes. This always happens in source order on this thread, so the
+    // output doesn't depend on how the sources were ticked.
+    std::array<QuadFrame32, 3> intermediate_mixes = {};
+    for (size_t i = 0; i < num_sources; i++) {
         for (size_t mix = 0; mix < 3; mix++) {
             sources[i].MixInto(intermediate_mixes[mix], mix);
         }
@@ -102,7 +127,9 @@ static void FlushResidualStretcherAudio() {
 }
 
 static void OutputCurrentFrame(const StereoFrame16& frame) {
-    if (perform_time_stretching) {
+    if (sink->IsSampleExact()) {
+        sink->EnqueueSamples(&frame[0][0], frame.size());
+    } else if (perform_time_stretching) {
         time_stretcher.AddSamples(&frame[0][0], frame.size());
         std::vector<s16> stretched_samples = time_stretcher.Process(sink->SamplesInQueue());
         sink->EnqueueSamples(stretched_samples.data(), stretched_samples.size() / 2);
@@ -138,6 +165,17 @@ void Init() {
     }
 
     mixers.Reset();
+    ClearDecodedBuffers();
+
+    size_t num_threads = Settings::values.dsp_threads;
+    if (num_threads == 0)
+        num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    num_threads = std::min<size_t>(num_threads, MAX_SOURCE_THREADS);
+    if (num_threads > 1) {
+        source_thread_pool = std::make_unique<Common::ThreadPool>(num_threads - 1, "DSP");
+    } else {
+        source_thread_pool.reset();
+    }
 
     time_stretcher.Reset();
     if (sink) {
@@ -149,6 +187,8 @@ void Shutdown() {
     if (perform_time_stretching) {
         FlushResidualStretcherAudio();
     }
+    source_thread_pool.reset();
+    ClearDecodedBuffers();
 }
 
 bool Tick() {
@@ -163,6 +203,15 @@ bool Tick() {
     return true;
 }
 
+void DoState(PointerWrap& p) {
+    p.DoArray(g_dsp_memory.raw_memory.data(), static_cast<int>(g_dsp_memory.raw_memory.size()));
+    PipesDoState(p);
+    for (auto& source : sources) {
+        source.DoState(p);
+    }
+    mixers.DoState(p);
+}
+
 void SetSink(std::unique_ptr<AudioCore::Sink> sink_) {
     sink = std::move(sink_);
     time_stretcher.SetOutputSampleRate(sink->GetNativeSampleRate());
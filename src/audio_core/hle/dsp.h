@@ -18,6 +18,8 @@ namespace AudioCore {
 class Sink;
 }
 
+class PointerWrap;
+
 namespace DSP {
 namespace HLE {
 
@@ -527,7 +529,7 @@ static_assert(offsetof(DspMemory, region_0) == region0_offset,
 static_assert(offsetof(DspMemory, region_1) == region1_offset,
               "DSP region 1 is at the wrong offset");
 
-extern DspMemory g_dsp_memory;
+extern DspMemory& g_dsp_memory;
 
 // Structures must have an offset that is a multiple of two.
 static_assert(offsetof(SharedMemory, frame_counter) % 2 == 0,
@@ -591,5 +593,8 @@ void SetSink(std::unique_ptr<AudioCore::Sink> sink);
  */
 void EnableStretching(bool enable);
 
+/// Serializes the DSP memory and the state of the HLE DSP for save states
+void DoState(PointerWrap& p);
+
 } // namespace HLE
 } // namespace DSP
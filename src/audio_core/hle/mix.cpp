@@ -0,0 +1,130 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstddef>
+#include "audio_core/hle/mix.h"
+#include "common/math_util.h"
+
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
+
+namespace DSP {
+namespace HLE {
+
+// The SSE2 versions produce exactly the same results as the scalar ones: float conversions round
+// to nearest, float to integer conversions truncate, and the saturating packs and adds clamp like
+// ClampToS16 does.
+
+#ifdef ARCHITECTURE_x86_64
+
+void MixStereoIntoQuad(QuadFrame32& dest, const StereoFrame16& source,
+                       const std::array<float, 4>& gains) {
+    const __m128 gain = _mm_loadu_ps(gains.data());
+    for (size_t samplei = 0; samplei < samples_per_frame; samplei += 2) {
+        // Sign-extend the two stereo samples to [l0, r0, l1, r1]
+        const __m128i pair = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&source[samplei]));
+        const __m128i pair32 = _mm_srai_epi32(_mm_unpacklo_epi16(pair, pair), 16);
+
+        const __m128i quad0 = _mm_shuffle_epi32(pair32, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m128i quad1 = _mm_shuffle_epi32(pair32, _MM_SHUFFLE(3, 2, 3, 2));
+        const __m128i scaled0 = _mm_cvttps_epi32(_mm_mul_ps(gain, _mm_cvtepi32_ps(quad0)));
+        const __m128i scaled1 = _mm_cvttps_epi32(_mm_mul_ps(gain, _mm_cvtepi32_ps(quad1)));
+
+        __m128i* out = reinterpret_cast<__m128i*>(&dest[samplei]);
+        _mm_storeu_si128(out, _mm_add_epi32(_mm_loadu_si128(out), scaled0));
+        _mm_storeu_si128(out + 1, _mm_add_epi32(_mm_loadu_si128(out + 1), scaled1));
+    }
+}
+
+static __m128 LoadScaled(const QuadFrame32& source, size_t samplei, __m128 gain) {
+    const __m128i sample = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&source[samplei]));
+    return _mm_mul_ps(gain, _mm_cvtepi32_ps(sample));
+}
+
+static void AddToFrame(StereoFrame16& dest, size_t samplei, __m128i mix) {
+    __m128i* out = reinterpret_cast<__m128i*>(&dest[samplei]);
+    _mm_storeu_si128(out, _mm_adds_epi16(_mm_loadu_si128(out), mix));
+}
+
+void DownmixStereoAndMix(StereoFrame16& dest, const QuadFrame32& source, float gain) {
+    const __m128 gains = _mm_set1_ps(gain);
+    for (size_t samplei = 0; samplei < samples_per_frame; samplei += 4) {
+        // Adding the upper half of each scaled sample to its lower half gives [left, right]
+        __m128 scaled[4];
+        for (size_t i = 0; i < 4; ++i) {
+            const __m128 value = LoadScaled(source, samplei + i, gains);
+            scaled[i] = _mm_add_ps(value, _mm_movehl_ps(value, value));
+        }
+        const __m128 stereo01 = _mm_movelh_ps(scaled[0], scaled[1]);
+        const __m128 stereo23 = _mm_movelh_ps(scaled[2], scaled[3]);
+        const __m128i mix = _mm_packs_epi32(_mm_cvttps_epi32(stereo01),
+                                            _mm_cvttps_epi32(stereo23));
+        AddToFrame(dest, samplei, mix);
+    }
+}
+
+void DownmixMonoAndMix(StereoFrame16& dest, const QuadFrame32& source, float gain) {
+    const __m128 gains = _mm_set1_ps(gain);
+    const __m128 half = _mm_set1_ps(0.5f);
+    for (size_t samplei = 0; samplei < samples_per_frame; samplei += 4) {
+        __m128 channel0 = LoadScaled(source, samplei, gains);
+        __m128 channel1 = LoadScaled(source, samplei + 1, gains);
+        __m128 channel2 = LoadScaled(source, samplei + 2, gains);
+        __m128 channel3 = LoadScaled(source, samplei + 3, gains);
+        _MM_TRANSPOSE4_PS(channel0, channel1, channel2, channel3);
+
+        // Summed in the same order as the scalar version, halving is exact either way
+        const __m128 sum =
+            _mm_add_ps(_mm_add_ps(_mm_add_ps(channel0, channel1), channel2), channel3);
+        const __m128i mono = _mm_cvttps_epi32(_mm_mul_ps(sum, half));
+        const __m128i mono_pairs = _mm_packs_epi32(_mm_unpacklo_epi32(mono, mono),
+                                                   _mm_unpackhi_epi32(mono, mono));
+        AddToFrame(dest, samplei, mono_pairs);
+    }
+}
+
+#else
+
+static s16 ClampToS16(s32 value) {
+    return static_cast<s16>(MathUtil::Clamp(value, -32768, 32767));
+}
+
+static void AddAndClampToS16(std::array<s16, 2>& accumulator, s16 left, s16 right) {
+    accumulator[0] = ClampToS16(static_cast<s32>(accumulator[0]) + left);
+    accumulator[1] = ClampToS16(static_cast<s32>(accumulator[1]) + right);
+}
+
+void MixStereoIntoQuad(QuadFrame32& dest, const StereoFrame16& source,
+                       const std::array<float, 4>& gains) {
+    for (size_t samplei = 0; samplei < samples_per_frame; samplei++) {
+        dest[samplei][0] += static_cast<s32>(gains[0] * source[samplei][0]);
+        dest[samplei][1] += static_cast<s32>(gains[1] * source[samplei][1]);
+        dest[samplei][2] += static_cast<s32>(gains[2] * source[samplei][0]);
+        dest[samplei][3] += static_cast<s32>(gains[3] * source[samplei][1]);
+    }
+}
+
+void DownmixStereoAndMix(StereoFrame16& dest, const QuadFrame32& source, float gain) {
+    for (size_t samplei = 0; samplei < samples_per_frame; samplei++) {
+        const auto& sample = source[samplei];
+        const s16 left = ClampToS16(static_cast<s32>(gain * sample[0] + gain * sample[2]));
+        const s16 right = ClampToS16(static_cast<s32>(gain * sample[1] + gain * sample[3]));
+        AddAndClampToS16(dest[samplei], left, right);
+    }
+}
+
+void DownmixMonoAndMix(StereoFrame16& dest, const QuadFrame32& source, float gain) {
+    for (size_t samplei = 0; samplei < samples_per_frame; samplei++) {
+        const auto& sample = source[samplei];
+        const s16 mono = ClampToS16(static_cast<s32>(
+            (gain * sample[0] + gain * sample[1] + gain * sample[2] + gain * sample[3]) / 2));
+        AddAndClampToS16(dest[samplei], mono, mono);
+    }
+}
+
+#endif
+
+} // namespace HLE
+} // namespace DSP
@@ -0,0 +1,34 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include "audio_core/hle/common.h"
+
+namespace DSP {
+namespace HLE {
+
+/**
+ * Converts a stereo frame to quadraphonic and accumulates it into dest. Each output channel is
+ * gains[channel] times the left (channels 0 and 2) or right (channels 1 and 3) input channel,
+ * truncated towards zero.
+ */
+void MixStereoIntoQuad(QuadFrame32& dest, const StereoFrame16& source,
+                       const std::array<float, 4>& gains);
+
+/**
+ * Scales a quadraphonic frame by gain, downmixes it to stereo (channels 0 and 2 to the left,
+ * 1 and 3 to the right) and adds it to dest, saturating to 16 bits.
+ */
+void DownmixStereoAndMix(StereoFrame16& dest, const QuadFrame32& source, float gain);
+
+/**
+ * Scales a quadraphonic frame by gain, downmixes it to mono (half the sum of all channels) and
+ * adds it to both channels of dest, saturating to 16 bits.
+ */
+void DownmixMonoAndMix(StereoFrame16& dest, const QuadFrame32& source, float gain);
+
+} // namespace HLE
+} // namespace DSP
@@ -8,6 +8,8 @@
 #include "audio_core/hle/common.h"
 #include "audio_core/hle/dsp.h"
 
+class PointerWrap;
+
 namespace DSP {
 namespace HLE {
 
@@ -26,6 +28,8 @@ public:
         return current_frame;
     }
 
+    void DoState(PointerWrap& p);
+
 private:
     StereoFrame16 current_frame = {};
 
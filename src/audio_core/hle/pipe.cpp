@@ -7,6 +7,7 @@
 #include "audio_core/hle/dsp.h"
 #include "audio_core/hle/pipe.h"
 #include "common/assert.h"
+#include "common/chunk_file.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
 #include "core/hle/service/dsp_dsp.h"
@@ -173,5 +174,12 @@ DspState GetDspState() {
     return dsp_state;
 }
 
+void PipesDoState(PointerWrap& p) {
+    p.Do(dsp_state);
+    for (auto& data : pipe_data) {
+        p.Do(data);
+    }
+}
+
 } // namespace HLE
 } // namespace DSP
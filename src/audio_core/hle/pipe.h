@@ -8,6 +8,8 @@
 #include <vector>
 #include "common/common_types.h"
 
+class PointerWrap;
+
 namespace DSP {
 namespace HLE {
 
@@ -59,5 +61,8 @@ enum class DspState {
 /// Get the state of the DSP
 DspState GetDspState();
 
+/// Serializes the DSP state and the contents of the pipes for save states
+void PipesDoState(PointerWrap& p);
+
 } // namespace HLE
 } // namespace DSP
@@ -5,10 +5,13 @@
 #include <algorithm>
 #include <array>
 #include "audio_core/codec.h"
+#include "audio_core/hle/buffer_cache.h"
 #include "audio_core/hle/common.h"
+#include "audio_core/hle/mix.h"
 #include "audio_core/hle/source.h"
 #include "audio_core/interpolate.h"
 #include "common/assert.h"
+#include "common/chunk_file.h"
 #include "common/logging/log.h"
 #include "core/memory.h"
 
@@ -30,14 +33,8 @@ void Source::MixInto(QuadFrame32& dest, size_t intermediate_mix_id) const {
     if (!state.enabled)
         return;
 
-    const std::array<float, 4>& gains = state.gain.at(intermediate_mix_id);
-    for (size_t samplei = 0; samplei < samples_per_frame; samplei++) {
-        // Conversion from stereo (current_frame) to quadraphonic (dest) occurs here.
-        dest[samplei][0] += static_cast<s32>(gains[0] * current_frame[samplei][0]);
-        dest[samplei][1] += static_cast<s32>(gains[1] * current_frame[samplei][1]);
-        dest[samplei][2] += static_cast<s32>(gains[2] * current_frame[samplei][0]);
-        dest[samplei][3] += static_cast<s32>(gains[3] * current_frame[samplei][1]);
-    }
+    // Conversion from stereo (current_frame) to quadraphonic (dest) occurs here.
+    MixStereoIntoQuad(dest, current_frame, state.gain.at(intermediate_mix_id));
 }
 
 void Source::Reset() {
@@ -45,6 +42,65 @@ void Source::Reset() {
     state = {};
 }
 
+void Source::DoState(PointerWrap& p) {
+    p.DoVoid(current_frame.data(), sizeof(current_frame));
+
+    p.Do(state.enabled);
+    p.Do(state.sync);
+    p.DoVoid(state.gain.data(), sizeof(state.gain));
+
+    // The queue can only be accessed through its top element, so it's stored as a sorted list
+    std::vector<Buffer> queued_buffers;
+    if (p.GetMode() != PointerWrap::MODE_READ) {
+        auto queue = state.input_queue;
+        while (!queue.empty()) {
+            queued_buffers.push_back(queue.top());
+            queue.pop();
+        }
+    }
+    u32 queued_count = static_cast<u32>(queued_buffers.size());
+    p.Do(queued_count);
+    if (queued_count > 0xFFFF) {
+        p.SetError(PointerWrap::ERROR_FAILURE);
+        return;
+    }
+    queued_buffers.resize(queued_count);
+    p.DoVoid(queued_buffers.data(), static_cast<int>(queued_count * sizeof(Buffer)));
+    if (p.GetMode() == PointerWrap::MODE_READ) {
+        state.input_queue = {};
+        for (const Buffer& buffer : queued_buffers) {
+            state.input_queue.push(buffer);
+        }
+    }
+
+    p.Do(state.mono_or_stereo);
+    p.Do(state.format);
+
+    p.Do(state.current_sample_number);
+    p.Do(state.next_sample_number);
+    u32 buffer_size = static_cast<u32>(state.current_buffer.size());
+    p.Do(buffer_size);
+    if (buffer_size > Memory::FCRAM_SIZE) {
+        p.SetError(PointerWrap::ERROR_FAILURE);
+        return;
+    }
+    state.current_buffer.resize(buffer_size);
+    p.DoVoid(state.current_buffer.data(),
+             static_cast<int>(buffer_size * sizeof(state.current_buffer[0])));
+
+    p.Do(state.buffer_update);
+    p.Do(state.current_buffer_id);
+
+    p.DoVoid(state.adpcm_coeffs.data(), sizeof(state.adpcm_coeffs));
+    p.DoVoid(&state.adpcm_state, sizeof(state.adpcm_state));
+
+    p.Do(state.rate_multiplier);
+    p.Do(state.interpolation_mode);
+    p.DoVoid(&state.interp_state, sizeof(state.interp_state));
+
+    p.DoVoid(&state.filters, sizeof(state.filters));
+}
+
 void Source::ParseConfig(SourceConfiguration::Configuration& config,
                          const s16_le (&adpcm_coeffs)[16]) {
     if (!config.dirty_raw) {
@@ -278,26 +334,25 @@ bool Source::DequeueBuffer() {
         state.adpcm_state.yn2 = buf.adpcm_yn[1];
     }
 
-    const u8* const memory = Memory::GetPhysicalPointer(buf.physical_address);
-    if (memory) {
-        const unsigned num_channels = buf.mono_or_stereo == MonoOrStereo::Stereo ? 2 : 1;
-        switch (buf.format) {
-        case Format::PCM8:
-            state.current_buffer = Codec::DecodePCM8(num_channels, memory, buf.length);
-            break;
-        case Format::PCM16:
-            state.current_buffer = Codec::DecodePCM16(num_channels, memory, buf.length);
-            break;
-        case Format::ADPCM:
-            DEBUG_ASSERT(num_channels == 1);
-            state.current_buffer =
-                Codec::DecodeADPCM(memory, buf.length, state.adpcm_coeffs, state.adpcm_state);
-            break;
-        default:
-            UNIMPLEMENTED();
-            break;
-        }
+    const unsigned num_channels = buf.mono_or_stereo == MonoOrStereo::Stereo ? 2 : 1;
+    bool valid_address;
+    if (buf.is_looping) {
+        // Looping buffers are played over and over, so keep them decoded
+        const auto samples = GetDecodedBuffer(buf.physical_address, buf.length, buf.format,
+                                              num_channels, state.adpcm_coeffs, state.adpcm_state);
+        valid_address = samples != nullptr;
+        if (samples)
+            state.current_buffer = *samples;
     } else {
+        const u8* const memory = Memory::GetPhysicalPointer(buf.physical_address);
+        valid_address = memory != nullptr;
+        if (memory) {
+            state.current_buffer = DecodeBuffer(memory, buf.length, buf.format, num_channels,
+                                                state.adpcm_coeffs, state.adpcm_state);
+        }
+    }
+
+    if (!valid_address) {
         LOG_WARNING(Audio_DSP,
                     "source_id=%zu buffer_id=%hu length=%u: Invalid physical address 0x%08X",
                     source_id, buf.buffer_id, buf.length, buf.physical_address);
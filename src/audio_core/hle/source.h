@@ -14,6 +14,8 @@
 #include "audio_core/interpolate.h"
 #include "common/common_types.h"
 
+class PointerWrap;
+
 namespace DSP {
 namespace HLE {
 
@@ -54,6 +56,8 @@ public:
      */
     void MixInto(QuadFrame32& dest, size_t intermediate_mix_id) const;
 
+    void DoState(PointerWrap& p);
+
 private:
     const size_t source_id;
     StereoFrame16 current_frame;
@@ -32,6 +32,14 @@ public:
     /// Samples enqueued that have not been played yet.
     virtual std::size_t SamplesInQueue() const = 0;
 
+    /**
+     * Whether this sink wants exactly the samples generated by the emulated DSP, one frame per
+     * audio tick. Such sinks bypass time stretching and never have samples dropped.
+     */
+    virtual bool IsSampleExact() const {
+        return false;
+    }
+
     /**
      * Sets the desired output device.
      * @param device_id ID of the desired device.
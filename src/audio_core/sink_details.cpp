@@ -7,6 +7,7 @@
 #include <vector>
 #include "audio_core/null_sink.h"
 #include "audio_core/sink_details.h"
+#include "audio_core/wav_sink.h"
 #ifdef HAVE_SDL2
 #include "audio_core/sdl2_sink.h"
 #endif
@@ -20,6 +21,7 @@ const std::vector<SinkDetails> g_sink_details = {
     {"sdl2", []() { return std::make_unique<SDL2Sink>(); }},
 #endif
     {"null", []() { return std::make_unique<NullSink>(); }},
+    {"wav", []() { return std::make_unique<WavSink>(); }},
 };
 
 const SinkDetails& GetSinkDetails(std::string sink_id) {
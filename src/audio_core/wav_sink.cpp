@@ -0,0 +1,153 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "audio_core/audio_core.h"
+#include "audio_core/wav_sink.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/swap.h"
+#include "common/thread.h"
+#include "core/settings.h"
+
+namespace AudioCore {
+
+/// Header of a WAV file holding 16-bit stereo PCM
+struct WavHeader {
+    u32_le riff_id = 0x46464952; // "RIFF"
+    u32_le riff_size = 0;
+    u32_le wave_id = 0x45564157; // "WAVE"
+
+    u32_le fmt_id = 0x20746D66; // "fmt "
+    u32_le fmt_size = 16;
+    u16_le audio_format = 1; // PCM
+    u16_le num_channels = 2;
+    u32_le sample_rate = native_sample_rate;
+    u32_le byte_rate = native_sample_rate * 2 * sizeof(s16);
+    u16_le block_align = 2 * sizeof(s16);
+    u16_le bits_per_sample = 16;
+
+    u32_le data_id = 0x61746164; // "data"
+    u32_le data_size = 0;
+};
+static_assert(sizeof(WavHeader) == 44, "WavHeader has incorrect size");
+
+/// Number of buffered samples after which the writer thread is woken up (about 125 ms)
+constexpr size_t WRITE_THRESHOLD = 4096;
+
+struct WavSink::Impl {
+    FileUtil::IOFile file;
+    WavHeader header;
+    bool sample_exact = true;
+
+    std::thread writer_thread;
+    std::mutex mutex;
+    std::condition_variable samples_available;
+    /// Interleaved stereo samples which have not been written yet
+    std::vector<s16> pending;
+    bool quit = false;
+
+    void WriterLoop();
+    void WriteSamples(const std::vector<s16>& samples);
+};
+
+void WavSink::Impl::WriterLoop() {
+    Common::SetCurrentThreadName("WavSink");
+
+    std::vector<s16> samples;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            samples_available.wait(
+                lock, [this] { return quit || pending.size() >= WRITE_THRESHOLD * 2; });
+            samples.swap(pending);
+            if (samples.empty() && quit)
+                return;
+        }
+        WriteSamples(samples);
+        samples.clear();
+    }
+}
+
+void WavSink::Impl::WriteSamples(const std::vector<s16>& samples) {
+    const size_t size = samples.size() * sizeof(s16);
+    if (file.WriteBytes(samples.data(), size) != size) {
+        LOG_ERROR(Audio_Sink, "Failed to write audio samples");
+        return;
+    }
+
+    // Keep the sizes in the header up to date, so the file is valid even if it isn't closed
+    header.data_size = header.data_size + static_cast<u32>(size);
+    header.riff_size = static_cast<u32>(sizeof(WavHeader) - 8 + header.data_size);
+    file.Seek(0, SEEK_SET);
+    file.WriteObject(header);
+    file.Seek(0, SEEK_END);
+}
+
+WavSink::WavSink() : impl(std::make_unique<Impl>()) {
+    std::string path = Settings::values.audio_file_path;
+    if (path.empty())
+        path = FileUtil::GetUserPath(D_USER_IDX) + "audio.wav";
+    impl->sample_exact = Settings::values.audio_file_sample_exact;
+
+    if (!impl->file.Open(path, "wb") || impl->file.WriteObject(impl->header) != 1) {
+        LOG_CRITICAL(Audio_Sink, "Failed to open %s for writing", path.c_str());
+        impl->file.Close();
+        return;
+    }
+    LOG_INFO(Audio_Sink, "Writing audio to %s", path.c_str());
+
+    impl->writer_thread = std::thread(&Impl::WriterLoop, impl.get());
+}
+
+WavSink::~WavSink() {
+    if (!impl->writer_thread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        impl->quit = true;
+    }
+    impl->samples_available.notify_one();
+    impl->writer_thread.join();
+}
+
+unsigned int WavSink::GetNativeSampleRate() const {
+    return native_sample_rate;
+}
+
+void WavSink::EnqueueSamples(const s16* samples, size_t sample_count) {
+    if (!impl->writer_thread.joinable())
+        return;
+
+    bool notify;
+    {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        impl->pending.insert(impl->pending.end(), samples, samples + sample_count * 2);
+        notify = impl->pending.size() >= WRITE_THRESHOLD * 2;
+    }
+    if (notify)
+        impl->samples_available.notify_one();
+}
+
+size_t WavSink::SamplesInQueue() const {
+    // Samples are consumed as soon as they are enqueued
+    return 0;
+}
+
+bool WavSink::IsSampleExact() const {
+    return impl->sample_exact;
+}
+
+std::vector<std::string> WavSink::GetDeviceList() const {
+    return {};
+}
+
+void WavSink::SetDevice(int device_id) {}
+
+} // namespace AudioCore
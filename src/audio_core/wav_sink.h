@@ -0,0 +1,39 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include "audio_core/sink.h"
+
+namespace AudioCore {
+
+/**
+ * Writes the audio output to a WAV file (Settings::values.audio_file_path). Samples are handed to
+ * a background thread which writes them in large chunks, so the emulation thread doesn't wait on
+ * disk I/O. Useful for capturing audio and for benchmarking without an audio device.
+ */
+class WavSink final : public Sink {
+public:
+    WavSink();
+    ~WavSink() override;
+
+    unsigned int GetNativeSampleRate() const override;
+
+    void EnqueueSamples(const s16* samples, size_t sample_count) override;
+
+    size_t SamplesInQueue() const override;
+
+    bool IsSampleExact() const override;
+
+    std::vector<std::string> GetDeviceList() const override;
+    void SetDevice(int device_id) override;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+} // namespace AudioCore
@@ -2,6 +2,9 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -25,6 +28,7 @@
 #endif
 
 #include "citra/config.h"
+#include "citra/emu_window/emu_window_headless.h"
 #include "citra/emu_window/emu_window_sdl2.h"
 #include "common/logging/backend.h"
 #include "common/logging/filter.h"
@@ -36,12 +40,25 @@
 #include "core/gdbstub/gdbstub.h"
 #include "core/loader/loader.h"
 #include "core/settings.h"
+#include "core/tracer/player.h"
 
 static void PrintHelp(const char* argv0) {
     std::cout << "Usage: " << argv0
               << " [options] <filename>\n"
                  "-g, --gdbport=NUMBER  Enable gdb stub on port NUMBER\n"
                  "-h, --help            Display this help and exit\n"
+                 "-l, --log-file=FILE   Also write the log to FILE, rotated to FILE.1 when large\n"
+                 "-s, --load-state=FILE Load the save state FILE after booting\n"
+                 "-H, --headless        Run without a window, using the software rasterizer,\n"
+                 "                      no audio output and no frame limiting\n"
+                 "-d, --dump-dir=DIR    In headless mode, dump the screens and performance\n"
+                 "                      statistics to DIR\n"
+                 "-i, --dump-interval=N Dump every N frames (default: 60). Unless frame_skip is\n"
+                 "                      set, the frames in between are skipped\n"
+                 "-f, --frames=N        In headless mode, exit after N frames\n"
+                 "-t, --trace           Replay the CiTrace <filename> in headless mode and print\n"
+                 "                      the time and screen hashes of each frame. With --frames,\n"
+                 "                      the trace is looped until N frames were replayed\n"
                  "-v, --version         Output version information and exit\n";
 }
 
@@ -49,6 +66,58 @@ static void PrintVersion() {
     std::cout << "Citra " << Common::g_scm_branch << " " << Common::g_scm_desc << std::endl;
 }
 
+/**
+ * Replays a CiTrace on the software rasterizer, printing the time taken by each frame and hashes
+ * of the screens at its end.
+ * @param frame_limit Number of frames to replay, looping the trace, or 0 to replay it once
+ */
+static int ReplayTrace(const std::string& filepath, EmuWindow* emu_window, u32 frame_limit) {
+    CiTrace::Player player;
+    if (!player.Load(filepath)) {
+        LOG_CRITICAL(Frontend, "Failed to load CiTrace %s!", filepath.c_str());
+        return -1;
+    }
+    if (player.GetFrameCount() == 0) {
+        LOG_CRITICAL(Frontend, "CiTrace %s contains no frames!", filepath.c_str());
+        return -1;
+    }
+
+    if (Core::System::GetInstance().InitHardware(emu_window) !=
+        Core::System::ResultStatus::Success) {
+        LOG_CRITICAL(Frontend, "Failed to initialize the emulated hardware!");
+        return -1;
+    }
+    player.Start();
+
+    const u32 num_frames = frame_limit != 0 ? frame_limit : player.GetFrameCount();
+    double total_ms = 0.0;
+    double min_ms = 0.0;
+    double max_ms = 0.0;
+    for (u32 frame = 0; frame < num_frames; ++frame) {
+        const auto start = std::chrono::steady_clock::now();
+        if (!player.ReplayFrame()) {
+            player.Rewind();
+            player.ReplayFrame();
+        }
+        const double frame_ms =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+                .count();
+
+        total_ms += frame_ms;
+        min_ms = frame == 0 ? frame_ms : std::min(min_ms, frame_ms);
+        max_ms = std::max(max_ms, frame_ms);
+        std::cout << Common::StringFromFormat("frame %u: %.3f ms, top %016" PRIX64
+                                              ", bottom %016" PRIX64 "\n",
+                                              frame, frame_ms, CiTrace::Player::HashScreen(0),
+                                              CiTrace::Player::HashScreen(1));
+    }
+
+    std::cout << Common::StringFromFormat(
+        "%u frames, %.3f ms per frame on average, %.3f ms min, %.3f ms max\n", num_frames,
+        total_ms / num_frames, min_ms, max_ms);
+    return 0;
+}
+
 /// Application entry point
 int main(int argc, char** argv) {
     Config config;
@@ -66,16 +135,30 @@ int main(int argc, char** argv) {
     }
 #endif
     std::string filepath;
+    std::string state_path;
+    std::string log_path;
+    bool headless = false;
+    std::string dump_dir;
+    u32 dump_interval = 60;
+    u32 frame_limit = 0;
+    bool replay_trace = false;
 
     static struct option long_options[] = {
         {"gdbport", required_argument, 0, 'g'},
         {"help", no_argument, 0, 'h'},
+        {"log-file", required_argument, 0, 'l'},
+        {"load-state", required_argument, 0, 's'},
+        {"headless", no_argument, 0, 'H'},
+        {"dump-dir", required_argument, 0, 'd'},
+        {"dump-interval", required_argument, 0, 'i'},
+        {"frames", required_argument, 0, 'f'},
+        {"trace", no_argument, 0, 't'},
         {"version", no_argument, 0, 'v'},
         {0, 0, 0, 0},
     };
 
     while (optind < argc) {
-        char arg = getopt_long(argc, argv, "g:hv", long_options, &option_index);
+        char arg = getopt_long(argc, argv, "g:hl:s:Hd:i:f:tv", long_options, &option_index);
         if (arg != -1) {
             switch (arg) {
             case 'g':
@@ -92,6 +175,38 @@ int main(int argc, char** argv) {
             case 'h':
                 PrintHelp(argv[0]);
                 return 0;
+            case 'l':
+                log_path = optarg;
+                break;
+            case 's':
+                state_path = optarg;
+                break;
+            case 'H':
+                headless = true;
+                break;
+            case 'd':
+                dump_dir = optarg;
+                break;
+            case 'i':
+            case 'f': {
+                errno = 0;
+                const u32 value = strtoul(optarg, &endarg, 0);
+                if (endarg == optarg)
+                    errno = EINVAL;
+                if (errno != 0) {
+                    perror(arg == 'i' ? "--dump-interval" : "--frames");
+                    exit(1);
+                }
+                if (arg == 'i')
+                    dump_interval = value;
+                else
+                    frame_limit = value;
+                break;
+            }
+            case 't':
+                replay_trace = true;
+                headless = true;
+                break;
             case 'v':
                 PrintVersion();
                 return 0;
@@ -112,6 +227,9 @@ int main(int argc, char** argv) {
 
     Log::Filter log_filter(Log::Level::Debug);
     Log::SetFilter(&log_filter);
+    if (!log_path.empty()) {
+        Log::SetLogFile(log_path);
+    }
 
     MicroProfileOnThreadCreate("EmuThread");
     SCOPE_EXIT({ MicroProfileShutdown(); });
@@ -126,15 +244,45 @@ int main(int argc, char** argv) {
     // Apply the command line arguments
     Settings::values.gdbstub_port = gdb_port;
     Settings::values.use_gdbstub = use_gdbstub;
+    if (headless) {
+        Settings::values.use_headless_renderer = true;
+        Settings::values.use_hw_renderer = false;
+        Settings::values.sink_id = "null";
+        Settings::values.toggle_framelimit = false;
+
+        // Only the dumped frames have to be rendered to the screens, so the others are skipped
+        // unless frame skipping was configured. Dumps happen on the first frame of each period,
+        // which is the rendered one. Replayed traces hash the screens of every frame.
+        if (!dump_dir.empty() && dump_interval > 1 && !replay_trace &&
+            Settings::values.frame_skip == 0) {
+            const u16 period = static_cast<u16>(std::min<u32>(dump_interval, 0xFFFF));
+            Settings::values.frame_skip_period = period;
+            Settings::values.frame_skip = period - 1;
+        }
+    }
     Settings::Apply();
 
-    std::unique_ptr<EmuWindow_SDL2> emu_window{std::make_unique<EmuWindow_SDL2>()};
+    std::unique_ptr<EmuWindow_SDL2> sdl_window;
+    std::unique_ptr<EmuWindow_Headless> headless_window;
+    EmuWindow* emu_window;
+    if (headless) {
+        headless_window =
+            std::make_unique<EmuWindow_Headless>(dump_dir, dump_interval, frame_limit);
+        emu_window = headless_window.get();
+    } else {
+        sdl_window = std::make_unique<EmuWindow_SDL2>();
+        emu_window = sdl_window.get();
+    }
 
     Core::System& system{Core::System::GetInstance()};
 
     SCOPE_EXIT({ system.Shutdown(); });
 
-    const Core::System::ResultStatus load_result{system.Load(emu_window.get(), filepath)};
+    if (replay_trace) {
+        return ReplayTrace(filepath, emu_window, frame_limit);
+    }
+
+    const Core::System::ResultStatus load_result{system.Load(emu_window, filepath)};
 
     switch (load_result) {
     case Core::System::ResultStatus::ErrorGetLoader:
@@ -165,7 +313,12 @@ int main(int argc, char** argv) {
         break; // Expected case
     }
 
-    while (emu_window->IsOpen()) {
+    if (!state_path.empty() && !system.LoadState(state_path)) {
+        LOG_CRITICAL(Frontend, "Failed to load save state %s!", state_path.c_str());
+        return -1;
+    }
+
+    while (headless ? headless_window->IsOpen() : sdl_window->IsOpen()) {
         system.RunLoop();
     }
 
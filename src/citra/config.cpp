@@ -82,11 +82,21 @@ void Config::ReadValues() {
     // Renderer
     Settings::values.use_hw_renderer = sdl2_config->GetBoolean("Renderer", "use_hw_renderer", true);
     Settings::values.use_shader_jit = sdl2_config->GetBoolean("Renderer", "use_shader_jit", true);
+    Settings::values.use_disk_shader_cache =
+        sdl2_config->GetBoolean("Renderer", "use_disk_shader_cache", true);
+    Settings::values.sw_rasterizer_threads =
+        static_cast<u32>(sdl2_config->GetInteger("Renderer", "sw_rasterizer_threads", 0));
     Settings::values.resolution_factor =
         (float)sdl2_config->GetReal("Renderer", "resolution_factor", 1.0);
     Settings::values.use_vsync = sdl2_config->GetBoolean("Renderer", "use_vsync", false);
     Settings::values.toggle_framelimit =
         sdl2_config->GetBoolean("Renderer", "toggle_framelimit", true);
+    Settings::values.frame_limit =
+        static_cast<u16>(sdl2_config->GetInteger("Renderer", "frame_limit", 100));
+    Settings::values.frame_skip =
+        static_cast<u16>(sdl2_config->GetInteger("Renderer", "frame_skip", 0));
+    Settings::values.frame_skip_period =
+        static_cast<u16>(sdl2_config->GetInteger("Renderer", "frame_skip_period", 1));
 
     Settings::values.bg_red = (float)sdl2_config->GetReal("Renderer", "bg_red", 0.0);
     Settings::values.bg_green = (float)sdl2_config->GetReal("Renderer", "bg_green", 0.0);
@@ -119,6 +129,11 @@ void Config::ReadValues() {
     Settings::values.enable_audio_stretching =
         sdl2_config->GetBoolean("Audio", "enable_audio_stretching", true);
     Settings::values.audio_device_id = sdl2_config->Get("Audio", "output_device", "auto");
+    Settings::values.audio_file_path = sdl2_config->Get("Audio", "output_file", "");
+    Settings::values.audio_file_sample_exact =
+        sdl2_config->GetBoolean("Audio", "output_file_sample_exact", true);
+    Settings::values.dsp_threads =
+        static_cast<u32>(sdl2_config->GetInteger("Audio", "dsp_threads", 1));
 
     // Data Storage
     Settings::values.use_virtual_sd =
@@ -70,6 +70,14 @@ use_hw_renderer =
 # 0: Interpreter (slow), 1 (default): JIT (fast)
 use_shader_jit =
 
+# Whether to keep the shaders used by a game on disk and compile them at startup
+# 0: Off, 1 (default): On
+use_disk_shader_cache =
+
+# Number of host threads used by the software renderer
+# 0 (default): One per host CPU core, 1: Rasterize on the emulation thread only
+sw_rasterizer_threads =
+
 # Resolution scale factor
 # 0: Auto (scales resolution to window size), 1: Native 3DS screen resolution, Otherwise a scale
 # factor for the 3DS resolution
@@ -109,6 +117,18 @@ custom_bottom_bottom =
 # 0: Off , 1  (default): On
 toggle_framelimit =
 
+# Emulation speed targeted by the frame limiter, in percent of real time. 100 (default)
+frame_limit =
+
+# Number of frames skipped in each frame skip period. Skipped frames are not presented, and their
+# draws to the buffers shown on the screens are dropped. Draws to other buffers (e.g. textures),
+# memory fills and display transfers are still performed. 0 (default): Don't skip frames
+frame_skip =
+
+# Length in frames of the frame skip period, of which the first one is always rendered.
+# Must be greater than frame_skip. 1 (default)
+frame_skip_period =
+
 # Swaps the prominent screen with the other screen.
 # For example, if Single Screen is chosen, setting this to 1 will display the bottom screen instead of the top screen.
 # 0 (default): Top Screen is prominent, 1: Bottom Screen is prominent
@@ -116,7 +136,8 @@ swap_screen =
 
 [Audio]
 # Which audio output engine to use.
-# auto (default): Auto-select, null: No audio output, sdl2: SDL2 (if available)
+# auto (default): Auto-select, null: No audio output, sdl2: SDL2 (if available),
+# wav: Write to a WAV file
 output_engine =
 
 # Whether or not to enable the audio-stretching post-processing effect.
@@ -129,6 +150,17 @@ enable_audio_stretching =
 # auto (default): Auto-select
 output_device =
 
+# File written by the wav output engine. Defaults to audio.wav in the user directory.
+output_file =
+
+# Whether the wav output engine writes exactly the samples generated by the emulated DSP, bypassing
+# audio stretching. 0: No, 1 (default): Yes
+output_file_sample_exact =
+
+# Number of host threads used to process the audio sources of the DSP (at most 4)
+# 0: One per host CPU core, 1 (default): Process sources on the emulation thread only
+dsp_threads =
+
 [Data Storage]
 # Whether to create a virtual SD card.
 # 1 (default): Yes, 0: No
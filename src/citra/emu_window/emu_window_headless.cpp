@@ -0,0 +1,143 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <utility>
+#include <vector>
+#include "citra/emu_window/emu_window_headless.h"
+#include "common/color.h"
+#include "common/logging/log.h"
+#include "common/string_util.h"
+#include "core/3ds.h"
+#include "core/core.h"
+#include "core/hw/gpu.h"
+#include "core/hw/lcd.h"
+#include "core/memory.h"
+#include "input_common/main.h"
+
+EmuWindow_Headless::EmuWindow_Headless(std::string dump_dir_, u32 dump_interval_,
+                                       u32 frame_limit_)
+    : dump_dir(std::move(dump_dir_)), dump_interval(dump_interval_), frame_limit(frame_limit_) {
+    InputCommon::Init();
+
+    // There is no window to lay the screens out in, use the size of the 3DS screens
+    UpdateCurrentFramebufferLayout(Core::kScreenTopWidth,
+                                   Core::kScreenTopHeight + Core::kScreenBottomHeight);
+
+    if (!dump_dir.empty()) {
+        if (dump_dir.back() != '/') {
+            dump_dir += '/';
+        }
+        FileUtil::CreateFullPath(dump_dir);
+
+        if (perf_stats_file.Open(dump_dir + "perf_stats.csv", "w")) {
+            const std::string header = "frame,system_fps,game_fps,frametime_ms,emulation_speed\n";
+            perf_stats_file.WriteBytes(header.data(), header.size());
+        } else {
+            LOG_ERROR(Frontend, "Failed to create %sperf_stats.csv", dump_dir.c_str());
+        }
+    }
+}
+
+EmuWindow_Headless::~EmuWindow_Headless() {
+    InputCommon::Shutdown();
+}
+
+void EmuWindow_Headless::SwapBuffers() {
+    if (dump_dir.empty() || dump_interval == 0 || frame_count - last_dump_frame < dump_interval) {
+        return;
+    }
+    last_dump_frame = frame_count;
+
+    DumpScreen(0, Common::StringFromFormat("%sframe_%08u_top.ppm", dump_dir.c_str(), frame_count));
+    DumpScreen(1, Common::StringFromFormat("%sframe_%08u_bottom.ppm", dump_dir.c_str(),
+                                           frame_count));
+    DumpPerfStats();
+}
+
+void EmuWindow_Headless::PollEvents() {
+    frame_count++;
+}
+
+bool EmuWindow_Headless::IsOpen() const {
+    return frame_limit == 0 || frame_count < frame_limit;
+}
+
+void EmuWindow_Headless::DumpScreen(int screen_index, const std::string& path) const {
+    const auto& framebuffer = GPU::g_regs.framebuffer_config[screen_index];
+    const LCD::Regs::ColorFill color_fill =
+        screen_index == 0 ? LCD::g_regs.color_fill_top : LCD::g_regs.color_fill_bottom;
+
+    // The LCDs are rotated: each framebuffer row is a screen column, starting from the bottom
+    const u32 screen_width = framebuffer.height;
+    const u32 screen_height = framebuffer.width;
+    const PAddr framebuffer_addr =
+        framebuffer.active_fb == 0 ? framebuffer.address_left1 : framebuffer.address_left2;
+    const u32 bpp = GPU::Regs::BytesPerPixel(framebuffer.color_format);
+
+    const u32 framebuffer_size = framebuffer.stride * framebuffer.height;
+
+    Memory::RasterizerFlushRegion(framebuffer_addr, framebuffer_size);
+    const u8* framebuffer_data = Memory::GetPhysicalPointer(framebuffer_addr);
+    const bool valid = framebuffer_data != nullptr && framebuffer_size != 0 &&
+                       Memory::GetPhysicalPointer(framebuffer_addr + framebuffer_size - 1) ==
+                           framebuffer_data + framebuffer_size - 1;
+    if (!valid && !color_fill.is_enabled) {
+        LOG_ERROR(Frontend, "Screen %d points to invalid memory 0x%08X", screen_index,
+                  framebuffer_addr);
+        return;
+    }
+
+    std::vector<u8> pixels(screen_width * screen_height * 3);
+    for (u32 y = 0; y < screen_height; ++y) {
+        for (u32 x = 0; x < screen_width; ++x) {
+            Math::Vec4<u8> color;
+            if (color_fill.is_enabled) {
+                color = {static_cast<u8>(color_fill.color_r), static_cast<u8>(color_fill.color_g),
+                         static_cast<u8>(color_fill.color_b), 255};
+            } else {
+                const u8* pixel =
+                    framebuffer_data + x * framebuffer.stride + (screen_height - 1 - y) * bpp;
+                switch (framebuffer.color_format) {
+                case GPU::Regs::PixelFormat::RGBA8:
+                    color = Color::DecodeRGBA8(pixel);
+                    break;
+                case GPU::Regs::PixelFormat::RGB8:
+                    color = Color::DecodeRGB8(pixel);
+                    break;
+                case GPU::Regs::PixelFormat::RGB565:
+                    color = Color::DecodeRGB565(pixel);
+                    break;
+                case GPU::Regs::PixelFormat::RGB5A1:
+                    color = Color::DecodeRGB5A1(pixel);
+                    break;
+                case GPU::Regs::PixelFormat::RGBA4:
+                    color = Color::DecodeRGBA4(pixel);
+                    break;
+                }
+            }
+
+            u8* out = &pixels[(y * screen_width + x) * 3];
+            out[0] = color.r();
+            out[1] = color.g();
+            out[2] = color.b();
+        }
+    }
+
+    FileUtil::IOFile file(path, "wb");
+    const std::string header =
+        Common::StringFromFormat("P6\n%u %u\n255\n", screen_width, screen_height);
+    if (file.WriteBytes(header.data(), header.size()) != header.size() ||
+        file.WriteBytes(pixels.data(), pixels.size()) != pixels.size()) {
+        LOG_ERROR(Frontend, "Failed to write %s", path.c_str());
+    }
+}
+
+void EmuWindow_Headless::DumpPerfStats() {
+    const auto results = Core::System::GetInstance().GetAndResetPerfStats();
+    const std::string line = Common::StringFromFormat(
+        "%u,%.2f,%.2f,%.3f,%.4f\n", frame_count, results.system_fps, results.game_fps,
+        results.frametime * 1000.0, results.emulation_speed);
+    perf_stats_file.WriteBytes(line.data(), line.size());
+    perf_stats_file.Flush();
+}
@@ -0,0 +1,57 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "core/frontend/emu_window.h"
+
+/**
+ * Window used to run without a display or graphics context. Instead of presenting frames, it
+ * periodically dumps the screens and the performance statistics to a directory.
+ */
+class EmuWindow_Headless : public EmuWindow {
+public:
+    /**
+     * @param dump_dir Directory the screens and statistics are written to, empty to disable dumps
+     * @param dump_interval Number of frames between two dumps
+     * @param frame_limit Number of frames after which the window closes itself, 0 for no limit
+     */
+    EmuWindow_Headless(std::string dump_dir, u32 dump_interval, u32 frame_limit);
+    ~EmuWindow_Headless();
+
+    /// Called for every frame which isn't skipped, dumps the screens when one is due
+    void SwapBuffers() override;
+
+    /// Called for every frame, counts the frames
+    void PollEvents() override;
+
+    /// There is no graphics context, so these do nothing
+    void MakeCurrent() override {}
+    void DoneCurrent() override {}
+
+    /// Whether the frame limit hasn't been reached yet
+    bool IsOpen() const;
+
+private:
+    /// Writes one screen as a binary PPM image
+    void DumpScreen(int screen_index, const std::string& path) const;
+
+    /// Appends the performance statistics since the last dump to the statistics file
+    void DumpPerfStats();
+
+    std::string dump_dir;
+    u32 dump_interval;
+    u32 frame_limit;
+
+    /// Number of frames emulated so far, including skipped ones
+    u32 frame_count = 0;
+    /// Frame number of the last dump
+    u32 last_dump_frame = 0;
+
+    /// CSV file receiving the performance statistics
+    FileUtil::IOFile perf_stats_file;
+};
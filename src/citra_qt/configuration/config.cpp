@@ -66,9 +66,16 @@ void Config::ReadValues() {
     qt_config->beginGroup("Renderer");
     Settings::values.use_hw_renderer = qt_config->value("use_hw_renderer", true).toBool();
     Settings::values.use_shader_jit = qt_config->value("use_shader_jit", true).toBool();
+    Settings::values.use_disk_shader_cache =
+        qt_config->value("use_disk_shader_cache", true).toBool();
+    Settings::values.sw_rasterizer_threads =
+        qt_config->value("sw_rasterizer_threads", 0).toUInt();
     Settings::values.resolution_factor = qt_config->value("resolution_factor", 1.0).toFloat();
     Settings::values.use_vsync = qt_config->value("use_vsync", false).toBool();
     Settings::values.toggle_framelimit = qt_config->value("toggle_framelimit", true).toBool();
+    Settings::values.frame_limit = qt_config->value("frame_limit", 100).toInt();
+    Settings::values.frame_skip = qt_config->value("frame_skip", 0).toInt();
+    Settings::values.frame_skip_period = qt_config->value("frame_skip_period", 1).toInt();
 
     Settings::values.bg_red = qt_config->value("bg_red", 0.0).toFloat();
     Settings::values.bg_green = qt_config->value("bg_green", 0.0).toFloat();
@@ -96,6 +103,11 @@ void Config::ReadValues() {
         qt_config->value("enable_audio_stretching", true).toBool();
     Settings::values.audio_device_id =
         qt_config->value("output_device", "auto").toString().toStdString();
+    Settings::values.audio_file_path =
+        qt_config->value("output_file", "").toString().toStdString();
+    Settings::values.audio_file_sample_exact =
+        qt_config->value("output_file_sample_exact", true).toBool();
+    Settings::values.dsp_threads = qt_config->value("dsp_threads", 1).toUInt();
     qt_config->endGroup();
 
     using namespace Service::CAM;
@@ -204,9 +216,14 @@ void Config::SaveValues() {
     qt_config->beginGroup("Renderer");
     qt_config->setValue("use_hw_renderer", Settings::values.use_hw_renderer);
     qt_config->setValue("use_shader_jit", Settings::values.use_shader_jit);
+    qt_config->setValue("use_disk_shader_cache", Settings::values.use_disk_shader_cache);
+    qt_config->setValue("sw_rasterizer_threads", Settings::values.sw_rasterizer_threads);
     qt_config->setValue("resolution_factor", (double)Settings::values.resolution_factor);
     qt_config->setValue("use_vsync", Settings::values.use_vsync);
     qt_config->setValue("toggle_framelimit", Settings::values.toggle_framelimit);
+    qt_config->setValue("frame_limit", Settings::values.frame_limit);
+    qt_config->setValue("frame_skip", Settings::values.frame_skip);
+    qt_config->setValue("frame_skip_period", Settings::values.frame_skip_period);
 
     // Cast to double because Qt's written float values are not human-readable
     qt_config->setValue("bg_red", (double)Settings::values.bg_red);
@@ -232,6 +249,9 @@ void Config::SaveValues() {
     qt_config->setValue("output_engine", QString::fromStdString(Settings::values.sink_id));
     qt_config->setValue("enable_audio_stretching", Settings::values.enable_audio_stretching);
     qt_config->setValue("output_device", QString::fromStdString(Settings::values.audio_device_id));
+    qt_config->setValue("output_file", QString::fromStdString(Settings::values.audio_file_path));
+    qt_config->setValue("output_file_sample_exact", Settings::values.audio_file_sample_exact);
+    qt_config->setValue("dsp_threads", Settings::values.dsp_threads);
     qt_config->endGroup();
 
     using namespace Service::CAM;
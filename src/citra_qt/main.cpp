@@ -267,6 +267,8 @@ void GMainWindow::ConnectMenuEvents() {
     connect(ui.action_Start, &QAction::triggered, this, &GMainWindow::OnStartGame);
     connect(ui.action_Pause, &QAction::triggered, this, &GMainWindow::OnPauseGame);
     connect(ui.action_Stop, &QAction::triggered, this, &GMainWindow::OnStopGame);
+    connect(ui.action_Save_State, &QAction::triggered, this, &GMainWindow::OnSaveState);
+    connect(ui.action_Load_State, &QAction::triggered, this, &GMainWindow::OnLoadState);
     connect(ui.action_Configure, &QAction::triggered, this, &GMainWindow::OnConfigure);
 
     // View
@@ -439,6 +441,8 @@ void GMainWindow::ShutdownGame() {
     ui.action_Start->setText(tr("Start"));
     ui.action_Pause->setEnabled(false);
     ui.action_Stop->setEnabled(false);
+    ui.action_Save_State->setEnabled(false);
+    ui.action_Load_State->setEnabled(false);
     render_window->hide();
     game_list->show();
     game_list->setFilterFocus();
@@ -562,6 +566,8 @@ void GMainWindow::OnStartGame() {
 
     ui.action_Pause->setEnabled(true);
     ui.action_Stop->setEnabled(true);
+    ui.action_Save_State->setEnabled(true);
+    ui.action_Load_State->setEnabled(true);
 }
 
 void GMainWindow::OnPauseGame() {
@@ -576,6 +582,25 @@ void GMainWindow::OnStopGame() {
     ShutdownGame();
 }
 
+void GMainWindow::OnSaveState() {
+    QString filename = QFileDialog::getSaveFileName(
+        this, tr("Save State"), QString::fromStdString(FileUtil::GetUserPath(D_USER_IDX)),
+        tr("Save State (*.cst)"));
+    if (!filename.isEmpty()) {
+        // Handled by the emulation thread before it runs the next slice, or once it is resumed
+        Core::System::GetInstance().RequestSaveState(filename.toStdString());
+    }
+}
+
+void GMainWindow::OnLoadState() {
+    QString filename = QFileDialog::getOpenFileName(
+        this, tr("Load State"), QString::fromStdString(FileUtil::GetUserPath(D_USER_IDX)),
+        tr("Save State (*.cst)"));
+    if (!filename.isEmpty()) {
+        Core::System::GetInstance().RequestLoadState(filename.toStdString());
+    }
+}
+
 void GMainWindow::ToggleWindowMode() {
     if (ui.action_Single_Window_Mode->isChecked()) {
         // Render in the main window...
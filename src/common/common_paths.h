@@ -37,6 +37,9 @@
 #define NAND_DIR "nand"
 #define SYSDATA_DIR "sysdata"
 
+// Subdirs in the cache dir returned by GetUserPath(D_CACHE_IDX)
+#define SHADER_DIR "shaders"
+
 // Filenames
 // Files in the directory returned by GetUserPath(D_CONFIG_IDX)
 #define EMU_CONFIG "emu.ini"
@@ -4,18 +4,18 @@
 
 #pragma once
 
+#include <cstring>
 #include <fstream>
 #include "common/common_types.h"
-
-// defined in Version.cpp
-extern const char* scm_rev_git_str;
+#include "common/file_util.h"
+#include "common/scm_rev.h"
 
 // On disk format:
 // header{
 // u32 'DCAC';
-// u32 version;  // svn_rev
 // u16 sizeof(key_type);
 // u16 sizeof(value_type);
+// char version[40];  // git revision
 //}
 
 // key_value_pair{
@@ -73,8 +73,9 @@ public:
             std::fstream::pos_type last_pos = m_file.tellg();
 
             while (Read(&value_size)) {
-                std::streamoff next_extent =
-                    (last_pos - start_pos) + sizeof(value_size) + value_size;
+                std::streamoff next_extent = (last_pos - start_pos) + sizeof(value_size) +
+                                             sizeof(K) + value_size * sizeof(V) +
+                                             sizeof(entry_number);
                 if (next_extent > file_size)
                     break;
 
@@ -102,7 +103,7 @@ public:
         // failed to open file for reading or bad header
         // close and recreate file
         Close();
-        m_file.open(filename, ios_base::out | ios_base::trunc | ios_base::binary);
+        OpenFStream(m_file, filename, ios_base::out | ios_base::trunc | ios_base::binary);
         WriteHeader();
         return 0;
     }
@@ -138,7 +139,7 @@ private:
         char file_header[sizeof(Header)];
 
         return (Read(file_header, sizeof(Header)) &&
-                !memcmp((const char*)&m_header, file_header, sizeof(Header)));
+                !std::memcmp((const char*)&m_header, file_header, sizeof(Header)));
     }
 
     template <typename D>
@@ -153,7 +154,8 @@ private:
 
     struct Header {
         Header() : id(*(u32*)"DCAC"), key_t_size(sizeof(K)), value_t_size(sizeof(V)) {
-            memcpy(ver, scm_rev_git_str, 40);
+            std::memset(ver, 0, sizeof(ver));
+            std::strncpy(ver, Common::g_scm_rev, sizeof(ver));
         }
 
         const u32 id;
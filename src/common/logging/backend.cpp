@@ -4,9 +4,18 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <condition_variable>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include "common/assert.h"
 #include "common/common_funcs.h" // snprintf compatibility define
+#include "common/file_util.h"
 #include "common/logging/backend.h"
 #include "common/logging/filter.h"
 #include "common/logging/log.h"
@@ -108,23 +117,32 @@ const char* GetLevelName(Level log_level) {
 #undef LVL
 }
 
-Entry CreateEntry(Class log_class, Level log_level, const char* filename, unsigned int line_nr,
-                  const char* function, const char* format, va_list args) {
+/// Returns the time elapsed since the first message was logged
+static std::chrono::microseconds GetTimestamp() {
     using std::chrono::steady_clock;
     using std::chrono::duration_cast;
 
     static steady_clock::time_point time_origin = steady_clock::now();
+    return duration_cast<std::chrono::microseconds>(steady_clock::now() - time_origin);
+}
+
+static std::string FormatLocation(const char* filename, unsigned int line_nr,
+                                  const char* function) {
+    std::array<char, 4 * 1024> formatting_buffer;
+    snprintf(formatting_buffer.data(), formatting_buffer.size(), "%s:%s:%u", filename, function,
+             line_nr);
+    return formatting_buffer.data();
+}
 
+Entry CreateEntry(Class log_class, Level log_level, const char* filename, unsigned int line_nr,
+                  const char* function, const char* format, va_list args) {
     std::array<char, 4 * 1024> formatting_buffer;
 
     Entry entry;
-    entry.timestamp = duration_cast<std::chrono::microseconds>(steady_clock::now() - time_origin);
+    entry.timestamp = GetTimestamp();
     entry.log_class = log_class;
     entry.log_level = log_level;
-
-    snprintf(formatting_buffer.data(), formatting_buffer.size(), "%s:%s:%u", filename, function,
-             line_nr);
-    entry.location = std::string(formatting_buffer.data());
+    entry.location = FormatLocation(filename, line_nr, function);
 
     vsnprintf(formatting_buffer.data(), formatting_buffer.size(), format, args);
     entry.message = std::string(formatting_buffer.data());
@@ -132,22 +150,334 @@ Entry CreateEntry(Class log_class, Level log_level, const char* filename, unsign
     return entry;
 }
 
-static Filter* filter = nullptr;
+namespace {
+
+/**
+ * A message waiting to be written. The location is only kept as pointers to the string literals
+ * of the logging macros, and the message is formatted in place unless it is too long, so that
+ * queueing a message doesn't allocate.
+ */
+struct QueuedEntry {
+    std::chrono::microseconds timestamp;
+    Class log_class;
+    Level log_level;
+    unsigned int line_nr;
+    const char* filename;
+    const char* function;
+    /// Holds the message instead of short_message when it doesn't fit there
+    std::unique_ptr<char[]> long_message;
+    std::array<char, 256> short_message;
+};
+
+/**
+ * Queue of the messages logged by one thread, emptied by the logging thread. As there is a single
+ * producer and a single consumer, each side only writes one of the indices and no lock is needed.
+ */
+class MessageRing {
+public:
+    static constexpr u64 SIZE = 512;
+
+    /// Returns the slot to fill with the next message, or null if the ring is full
+    QueuedEntry* BeginPush() {
+        const u64 current_head = head.load(std::memory_order_relaxed);
+        if (current_head - tail.load(std::memory_order_acquire) == SIZE)
+            return nullptr;
+        return &slots[current_head % SIZE];
+    }
+
+    /// Publishes the slot returned by BeginPush
+    void EndPush() {
+        head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /// Returns the oldest message, or null if the ring is empty
+    QueuedEntry* Front() {
+        const u64 current_tail = tail.load(std::memory_order_relaxed);
+        if (current_tail == head.load(std::memory_order_acquire))
+            return nullptr;
+        return &slots[current_tail % SIZE];
+    }
+
+    /// Releases the slot returned by Front
+    void Pop() {
+        tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool IsEmpty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+    /// Set when the thread owning the ring exits, the ring is dropped once emptied
+    std::atomic<bool> closed{false};
+
+private:
+    // The slots keep the indices written by different threads on separate cache lines
+    std::atomic<u64> head{0};
+    std::array<QueuedEntry, SIZE> slots;
+    std::atomic<u64> tail{0};
+};
+
+/**
+ * Writes the messages queued by the other threads to stderr and to the log file, on a thread of
+ * its own so that logging doesn't wait for the console or the disk.
+ */
+class Logger {
+public:
+    Logger() {
+        std::thread(&Logger::WriterLoop, this).detach();
+    }
+
+    /// Queues a message logged by the calling thread
+    void Push(Class log_class, Level log_level, const char* filename, unsigned int line_nr,
+              const char* function, const char* format, va_list args);
+
+    void SetLogFile(const std::string& path, size_t max_size);
+    void Flush();
+
+    std::atomic<bool> console_output{true};
+
+private:
+    /// Owns the ring of a thread, and closes it when the thread exits
+    struct ThreadRing {
+        std::shared_ptr<MessageRing> ring;
+
+        ~ThreadRing() {
+            if (ring != nullptr)
+                ring->closed = true;
+        }
+    };
+
+    MessageRing& GetThreadRing();
+
+    void WriterLoop();
+
+    /// Writes the queued messages of the given rings, by order of timestamp
+    void WriteQueued(const std::vector<std::shared_ptr<MessageRing>>& current_rings);
+
+    /// Writes a message to the log file, rotating it if it became too large
+    void WriteToFile(const Entry& entry);
+
+    static thread_local ThreadRing thread_ring;
+    static thread_local bool is_writer_thread;
+
+    std::mutex mutex;
+    /// Notified to make the logging thread write the queued messages early
+    std::condition_variable wake_cv;
+    /// Notified when the logging thread finished writing
+    std::condition_variable written_cv;
+
+    // Protected by mutex
+    std::vector<std::shared_ptr<MessageRing>> rings;
+    u64 passes_started = 0;
+    u64 passes_finished = 0;
+    bool flush_requested = false;
+    bool log_file_changed = false;
+    std::string log_file_path;
+    size_t log_file_max_size = 0;
+
+    // Only accessed by the logging thread
+    FileUtil::IOFile log_file;
+    std::string current_log_file_path;
+    size_t current_log_file_max_size = 0;
+};
+
+thread_local Logger::ThreadRing Logger::thread_ring;
+thread_local bool Logger::is_writer_thread = false;
+
+void Logger::Push(Class log_class, Level log_level, const char* filename, unsigned int line_nr,
+                  const char* function, const char* format, va_list args) {
+    if (is_writer_thread) {
+        // Messages of the file functions used while writing, which can't wait for a free slot
+        PrintColoredMessage(
+            CreateEntry(log_class, log_level, filename, line_nr, function, format, args));
+        return;
+    }
+
+    MessageRing& ring = GetThreadRing();
+    const bool was_empty = ring.IsEmpty();
+    QueuedEntry* entry;
+    while ((entry = ring.BeginPush()) == nullptr) {
+        wake_cv.notify_one();
+        std::this_thread::yield();
+    }
+
+    entry->timestamp = GetTimestamp();
+    entry->log_class = log_class;
+    entry->log_level = log_level;
+    entry->line_nr = line_nr;
+    entry->filename = filename;
+    entry->function = function;
+
+    va_list args_copy;
+    va_copy(args_copy, args);
+    const int length =
+        vsnprintf(entry->short_message.data(), entry->short_message.size(), format, args);
+    if (length >= static_cast<int>(entry->short_message.size())) {
+        entry->long_message.reset(new char[length + 1]);
+        vsnprintf(entry->long_message.get(), length + 1, format, args_copy);
+    } else if (length < 0) {
+        entry->short_message[0] = '\0';
+    }
+    va_end(args_copy);
+
+    ring.EndPush();
+
+    if (log_level >= Level::Critical) {
+        // Critical messages usually precede a crash, make sure they are written before
+        Flush();
+    } else if (was_empty) {
+        wake_cv.notify_one();
+    }
+}
+
+MessageRing& Logger::GetThreadRing() {
+    if (thread_ring.ring == nullptr) {
+        thread_ring.ring = std::make_shared<MessageRing>();
+        std::lock_guard<std::mutex> lock(mutex);
+        rings.push_back(thread_ring.ring);
+    }
+    return *thread_ring.ring;
+}
+
+void Logger::SetLogFile(const std::string& path, size_t max_size) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        log_file_path = path;
+        log_file_max_size = max_size;
+        log_file_changed = true;
+    }
+    Flush();
+}
+
+void Logger::Flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    // Any pass started from now on sees the messages queued so far
+    const u64 pass = passes_started + 1;
+    flush_requested = true;
+    wake_cv.notify_one();
+    written_cv.wait(lock, [&] { return passes_finished >= pass; });
+}
+
+void Logger::WriterLoop() {
+    is_writer_thread = true;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        // Messages are mostly written when a thread starts queueing after the previous pass, the
+        // timeout only catches wake ups missed while writing
+        if (!flush_requested)
+            wake_cv.wait_for(lock, std::chrono::milliseconds(10));
+        flush_requested = false;
+
+        const u64 pass = ++passes_started;
+        if (log_file_changed) {
+            log_file_changed = false;
+            current_log_file_path = log_file_path;
+            current_log_file_max_size = log_file_max_size;
+            log_file.Close();
+            if (!current_log_file_path.empty())
+                log_file.Open(current_log_file_path, "w");
+        }
+        const std::vector<std::shared_ptr<MessageRing>> current_rings = rings;
+
+        lock.unlock();
+        WriteQueued(current_rings);
+        lock.lock();
+
+        const auto is_finished = [](const auto& ring) { return ring->closed && ring->IsEmpty(); };
+        rings.erase(std::remove_if(rings.begin(), rings.end(), is_finished), rings.end());
+        passes_finished = pass;
+        written_cv.notify_all();
+    }
+}
+
+void Logger::WriteQueued(const std::vector<std::shared_ptr<MessageRing>>& current_rings) {
+    std::vector<Entry> entries;
+    for (const auto& ring : current_rings) {
+        while (QueuedEntry* queued = ring->Front()) {
+            Entry entry;
+            entry.timestamp = queued->timestamp;
+            entry.log_class = queued->log_class;
+            entry.log_level = queued->log_level;
+            entry.location = FormatLocation(queued->filename, queued->line_nr, queued->function);
+            if (queued->long_message != nullptr) {
+                entry.message = queued->long_message.get();
+                queued->long_message = nullptr;
+            } else {
+                entry.message = queued->short_message.data();
+            }
+            entries.push_back(std::move(entry));
+            ring->Pop();
+        }
+    }
+
+    // Each ring is in order, interleave the messages of the different threads
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const Entry& a, const Entry& b) { return a.timestamp < b.timestamp; });
+
+    const bool print = console_output;
+    for (const Entry& entry : entries) {
+        if (print)
+            PrintColoredMessage(entry);
+        WriteToFile(entry);
+    }
+    if (log_file.IsOpen())
+        log_file.Flush();
+}
+
+void Logger::WriteToFile(const Entry& entry) {
+    if (!log_file.IsOpen())
+        return;
+
+    std::array<char, 4 * 1024> format_buffer;
+    FormatLogMessage(entry, format_buffer.data(), format_buffer.size());
+    log_file.WriteBytes(format_buffer.data(), std::strlen(format_buffer.data()));
+    log_file.WriteBytes("\n", 1);
+
+    if (log_file.Tell() >= current_log_file_max_size) {
+        log_file.Close();
+        const std::string old_path = current_log_file_path + ".1";
+        if (FileUtil::Exists(old_path))
+            FileUtil::Delete(old_path);
+        FileUtil::Rename(current_log_file_path, old_path);
+        log_file.Open(current_log_file_path, "w");
+    }
+}
+
+/// The logger is never destroyed, as messages can be logged until the very end of the program
+Logger& GetLogger() {
+    static Logger* logger = [] {
+        std::atexit(Flush);
+        return new Logger;
+    }();
+    return *logger;
+}
+
+} // anonymous namespace
+
+const Level* Detail::class_levels = nullptr;
 
 void SetFilter(Filter* new_filter) {
-    filter = new_filter;
+    Detail::class_levels = new_filter != nullptr ? new_filter->GetClassLevels() : nullptr;
+}
+
+void SetLogFile(const std::string& path, size_t max_size) {
+    GetLogger().SetLogFile(path, max_size);
+}
+
+void SetConsoleOutput(bool enabled) {
+    GetLogger().console_output = enabled;
+}
+
+void Flush() {
+    GetLogger().Flush();
 }
 
 void LogMessage(Class log_class, Level log_level, const char* filename, unsigned int line_nr,
                 const char* function, const char* format, ...) {
-    if (filter != nullptr && !filter->CheckMessage(log_class, log_level))
-        return;
-
     va_list args;
     va_start(args, format);
-    Entry entry = CreateEntry(log_class, log_level, filename, line_nr, function, format, args);
+    GetLogger().Push(log_class, log_level, filename, line_nr, function, format, args);
     va_end(args);
-
-    PrintColoredMessage(entry);
 }
 }
@@ -6,6 +6,7 @@
 
 #include <chrono>
 #include <cstdarg>
+#include <cstddef>
 #include <string>
 #include <utility>
 #include "common/logging/log.h"
@@ -46,5 +47,23 @@ const char* GetLevelName(Level log_level);
 Entry CreateEntry(Class log_class, Level log_level, const char* filename, unsigned int line_nr,
                   const char* function, const char* format, va_list args);
 
+/**
+ * Sets the filter deciding which messages are logged. The filter is referenced, so changes made
+ * to it later apply too.
+ */
 void SetFilter(Filter* filter);
+
+/**
+ * Also writes the log to a file, in addition to stderr. Once the file grows larger than max_size
+ * bytes, it is renamed with a ".1" suffix, replacing the previous one, and a new file is started.
+ * @param path Path of the log file, empty to stop writing to a file
+ * @param max_size Size of the file at which it is rotated
+ */
+void SetLogFile(const std::string& path, size_t max_size = 16 * 1024 * 1024);
+
+/// Sets whether the log is written to stderr, which it is by default.
+void SetConsoleOutput(bool enabled);
+
+/// Blocks until all messages logged before the call have been written.
+void Flush();
 }
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include "common/common_types.h"
 
 namespace Log {
@@ -93,7 +94,21 @@ enum class Class : ClassType {
     Count              ///< Total number of logging classes
 };
 
-/// Logs a message to the global logger.
+namespace Detail {
+/// Minimum level of each class, owned by the filter passed to SetFilter, or null without filter
+extern const Level* class_levels;
+} // namespace Detail
+
+/**
+ * Returns whether messages of a class and level pass the current filter. It is inlined in the
+ * logging macros, so that filtered out messages only cost a comparison.
+ */
+inline bool IsLogged(Class log_class, Level log_level) {
+    return Detail::class_levels == nullptr ||
+           log_level >= Detail::class_levels[static_cast<size_t>(log_class)];
+}
+
+/// Logs a message to the global logger, regardless of the filter.
 void LogMessage(Class log_class, Level log_level, const char* filename, unsigned int line_nr,
                 const char* function,
 #ifdef _MSC_VER
@@ -109,7 +124,9 @@ void LogMessage(Class log_class, Level log_level, const char* filename, unsigned
 } // namespace Log
 
 #define LOG_GENERIC(log_class, log_level, ...)                                                     \
-    ::Log::LogMessage(log_class, log_level, __FILE__, __LINE__, __func__, __VA_ARGS__)
+    (::Log::IsLogged(log_class, log_level)                                                         \
+         ? ::Log::LogMessage(log_class, log_level, __FILE__, __LINE__, __func__, __VA_ARGS__)      \
+         : void(0))
 
 #ifdef _DEBUG
 #define LOG_TRACE(log_class, ...)                                                                  \
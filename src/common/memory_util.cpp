@@ -12,8 +12,15 @@
 #include "common/common_funcs.h"
 #include "common/string_util.h"
 #else
+#include <csignal>
+#include <cstdio>
 #include <cstdlib>
+#include <fcntl.h>
 #include <sys/mman.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
 #endif
 
 #if !defined(_WIN32) && defined(ARCHITECTURE_X64) && !defined(MAP_32BIT)
@@ -175,3 +182,167 @@ std::string MemUsage() {
     return "";
 #endif
 }
+
+#ifdef _WIN32
+
+MemoryArena::~MemoryArena() = default;
+
+bool MemoryArena::Create(size_t) {
+    return false;
+}
+
+bool MemoryArena::MapView(size_t, size_t, void*) const {
+    return false;
+}
+
+void MemoryArena::Discard(size_t, size_t) const {}
+
+void* ReserveAddressSpace(size_t) {
+    return nullptr;
+}
+
+void ReleaseAddressSpace(void*, size_t) {}
+
+void ResetAddressSpace(void*, size_t) {}
+
+void ProtectMemoryPages(void*, size_t, bool) {}
+
+void InstallMemoryFaultHandler(bool (*)(uintptr_t)) {}
+
+void UninstallMemoryFaultHandler() {}
+
+#else
+
+static int CreateSharedMemoryFile() {
+#ifdef __linux__
+#ifdef SYS_memfd_create
+    return static_cast<int>(syscall(SYS_memfd_create, "citra_memory_arena", 0));
+#else
+    return -1;
+#endif
+#else
+    // The name is unlinked right away, the object goes away with the last mapping of it
+    char name[64];
+    std::snprintf(name, sizeof(name), "/citra_memory_arena_%d", static_cast<int>(getpid()));
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd >= 0)
+        shm_unlink(name);
+    return fd;
+#endif
+}
+
+MemoryArena::~MemoryArena() {
+    if (base != nullptr)
+        munmap(base, size);
+    if (fd >= 0)
+        close(fd);
+}
+
+bool MemoryArena::Create(size_t size_) {
+    fd = CreateSharedMemoryFile();
+    if (fd < 0)
+        return false;
+
+    if (ftruncate(fd, static_cast<off_t>(size_)) != 0) {
+        close(fd);
+        fd = -1;
+        return false;
+    }
+
+    void* ptr = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (ptr == MAP_FAILED) {
+        close(fd);
+        fd = -1;
+        return false;
+    }
+
+    base = static_cast<u8*>(ptr);
+    size = size_;
+    return true;
+}
+
+bool MemoryArena::MapView(size_t offset, size_t view_size, void* address) const {
+    void* ptr = mmap(address, view_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd,
+                     static_cast<off_t>(offset));
+    if (ptr == MAP_FAILED) {
+        LOG_ERROR(Common_Memory, "Failed to map a view of the memory arena");
+        return false;
+    }
+    return true;
+}
+
+void MemoryArena::Discard(size_t offset, size_t discard_size) const {
+#ifdef MADV_REMOVE
+    madvise(base + offset, discard_size, MADV_REMOVE);
+#endif
+}
+
+void* ReserveAddressSpace(size_t size) {
+    void* ptr = mmap(nullptr, size, PROT_NONE, MAP_ANON | MAP_PRIVATE | MAP_NORESERVE, -1, 0);
+    if (ptr == MAP_FAILED) {
+        LOG_ERROR(Common_Memory, "Failed to reserve address space");
+        return nullptr;
+    }
+    return ptr;
+}
+
+void ReleaseAddressSpace(void* ptr, size_t size) {
+    if (ptr)
+        munmap(ptr, size);
+}
+
+void ResetAddressSpace(void* ptr, size_t size) {
+    mmap(ptr, size, PROT_NONE, MAP_ANON | MAP_PRIVATE | MAP_NORESERVE | MAP_FIXED, -1, 0);
+}
+
+void ProtectMemoryPages(void* ptr, size_t size, bool accessible) {
+    mprotect(ptr, size, accessible ? PROT_READ | PROT_WRITE : PROT_NONE);
+}
+
+static bool (*memory_fault_handler)(uintptr_t address) = nullptr;
+static struct sigaction previous_segv_action;
+static struct sigaction previous_bus_action;
+
+static void HandleMemoryFault(int sig, siginfo_t* info, void* context) {
+    if (memory_fault_handler != nullptr &&
+        memory_fault_handler(reinterpret_cast<uintptr_t>(info->si_addr))) {
+        return;
+    }
+
+    const struct sigaction& previous = sig == SIGSEGV ? previous_segv_action : previous_bus_action;
+    if (previous.sa_flags & SA_SIGINFO) {
+        previous.sa_sigaction(sig, info, context);
+    } else if (previous.sa_handler == SIG_DFL || previous.sa_handler == SIG_IGN) {
+        // The access faults again once this returns, with the default action
+        std::signal(sig, SIG_DFL);
+    } else {
+        previous.sa_handler(sig);
+    }
+}
+
+void InstallMemoryFaultHandler(bool (*handler)(uintptr_t address)) {
+    if (memory_fault_handler != nullptr) {
+        memory_fault_handler = handler;
+        return;
+    }
+    memory_fault_handler = handler;
+
+    struct sigaction action = {};
+    action.sa_sigaction = HandleMemoryFault;
+    action.sa_flags = SA_SIGINFO;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGSEGV, &action, &previous_segv_action);
+    // Some hosts report accesses to inaccessible pages as bus errors
+    sigaction(SIGBUS, &action, &previous_bus_action);
+}
+
+void UninstallMemoryFaultHandler() {
+    if (memory_fault_handler == nullptr)
+        return;
+    memory_fault_handler = nullptr;
+
+    sigaction(SIGSEGV, &previous_segv_action, nullptr);
+    sigaction(SIGBUS, &previous_bus_action, nullptr);
+}
+
+#endif
@@ -5,7 +5,9 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <string>
+#include "common/common_types.h"
 
 void* AllocateExecutableMemory(size_t size, bool low = true);
 void* AllocateMemoryPages(size_t size);
@@ -16,6 +18,70 @@ void WriteProtectMemory(void* ptr, size_t size, bool executable = false);
 void UnWriteProtectMemory(void* ptr, size_t size, bool allowExecute = false);
 std::string MemUsage();
 
+/**
+ * Shared memory object whose pages can be mapped at several host addresses at the same time. Only
+ * supported on POSIX hosts: views on Windows have a 64KB granularity, while the emulated memory is
+ * mapped with 4KB pages.
+ */
+class MemoryArena final {
+public:
+    MemoryArena() = default;
+    ~MemoryArena();
+
+    MemoryArena(const MemoryArena&) = delete;
+    MemoryArena& operator=(const MemoryArena&) = delete;
+
+    /**
+     * Creates the shared memory object and maps all of it. Its pages are only backed by host
+     * memory once they are touched.
+     * @returns Whether the host supports it and it could be created
+     */
+    bool Create(size_t size);
+
+    /// Returns the base of the mapping of the whole arena, null if it wasn't created
+    u8* GetBase() const {
+        return base;
+    }
+
+    /// Returns whether a host pointer lies in the mapping of the whole arena
+    bool Contains(const void* ptr) const {
+        return ptr >= base && ptr < base + size;
+    }
+
+    /**
+     * Maps a range of the arena at a fixed host address, replacing what was mapped there
+     * @param offset Offset of the range in the arena, a multiple of the page size
+     * @param size Size of the range, a multiple of the page size
+     * @param address Page-aligned host address to map the range at
+     * @returns Whether the range could be mapped
+     */
+    bool MapView(size_t offset, size_t size, void* address) const;
+
+    /// Releases the host memory backing a range of the arena, whose contents become undefined
+    void Discard(size_t offset, size_t size) const;
+
+private:
+    int fd = -1;
+    u8* base = nullptr;
+    size_t size = 0;
+};
+
+/// Reserves a range of host address space, which is inaccessible until something is mapped in it
+void* ReserveAddressSpace(size_t size);
+void ReleaseAddressSpace(void* ptr, size_t size);
+/// Makes a range of reserved address space inaccessible again, unmapping what was mapped in it
+void ResetAddressSpace(void* ptr, size_t size);
+/// Makes memory pages either readable and writable, or inaccessible
+void ProtectMemoryPages(void* ptr, size_t size, bool accessible);
+
+/**
+ * Installs a handler for the accesses to inaccessible memory, on hosts supporting MemoryArena. It
+ * is given the faulting host address and returns whether it resolved the fault, in which case the
+ * access is retried. The other faults are passed on to the previous handler.
+ */
+void InstallMemoryFaultHandler(bool (*handler)(uintptr_t address));
+void UninstallMemoryFaultHandler();
+
 inline int GetPageSize() {
     return 4096;
 }
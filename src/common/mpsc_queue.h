@@ -0,0 +1,65 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <utility>
+#include "common/common_types.h"
+
+namespace Common {
+
+/**
+ * An unbounded lock-free queue which any number of threads may push to, while only a single
+ * thread pops from it. Based on Dmitry Vyukov's intrusive MPSC node-based queue.
+ *
+ * A push becomes visible to the consumer once it has completed, a push which has started
+ * linking in its element may briefly hide elements pushed after it.
+ */
+template <typename T>
+class MPSCQueue : NonCopyable {
+public:
+    MPSCQueue() : head(new Node), tail(head.load(std::memory_order_relaxed)) {}
+
+    ~MPSCQueue() {
+        T value;
+        while (Pop(value)) {
+        }
+        delete tail;
+    }
+
+    /// Appends a value to the queue, can be called from any thread.
+    void Push(T value) {
+        Node* node = new Node;
+        node->value = std::move(value);
+        Node* previous = head.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    /// Removes the oldest value from the queue, can only be called from the consumer thread.
+    bool Pop(T& value) {
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (next == nullptr)
+            return false;
+
+        // The popped node becomes the new stub node
+        value = std::move(next->value);
+        delete tail;
+        tail = next;
+        return true;
+    }
+
+private:
+    struct Node {
+        T value{};
+        std::atomic<Node*> next{nullptr};
+    };
+
+    /// Most recently pushed node, shared by the producers
+    std::atomic<Node*> head;
+    /// Stub node preceding the oldest value, only accessed by the consumer
+    Node* tail;
+};
+
+} // namespace Common
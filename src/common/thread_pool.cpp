@@ -0,0 +1,89 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <utility>
+#include "common/thread.h"
+#include "common/thread_pool.h"
+
+namespace Common {
+
+ThreadPool::ThreadPool(size_t num_workers, std::string name_) : name(std::move(name_)) {
+    workers.reserve(num_workers);
+    for (size_t i = 0; i < num_workers; ++i) {
+        workers.emplace_back([this] { WorkerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    work_available.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)>& func) {
+    if (count == 0)
+        return;
+
+    if (workers.empty() || count == 1) {
+        for (size_t i = 0; i < count; ++i) {
+            func(i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        current_job = &func;
+        current_job_count = count;
+        next_index = 0;
+        busy_workers = workers.size();
+        ++generation;
+    }
+    work_available.notify_all();
+
+    RunJobs(func, count);
+
+    // Every worker has to check in before returning, otherwise a slow worker could still be
+    // reading the job of this batch when the next one is set up.
+    std::unique_lock<std::mutex> lock(mutex);
+    work_done.wait(lock, [this] { return busy_workers == 0; });
+    current_job = nullptr;
+}
+
+void ThreadPool::RunJobs(const std::function<void(size_t)>& func, size_t count) {
+    for (size_t i = next_index++; i < count; i = next_index++) {
+        func(i);
+    }
+}
+
+void ThreadPool::WorkerLoop() {
+    SetCurrentThreadName(name.c_str());
+
+    u64 last_generation = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        work_available.wait(lock, [&] { return quit || generation != last_generation; });
+        if (quit)
+            return;
+
+        last_generation = generation;
+        const auto& func = *current_job;
+        const size_t count = current_job_count;
+
+        lock.unlock();
+        RunJobs(func, count);
+        lock.lock();
+
+        if (--busy_workers == 0)
+            work_done.notify_one();
+    }
+}
+
+} // namespace Common
@@ -0,0 +1,67 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Common {
+
+/**
+ * A fixed set of worker threads used to split a batch of independent jobs across host cores.
+ * The thread calling ParallelFor takes part in the work as well, so a pool created with zero
+ * worker threads simply runs every job inline.
+ */
+class ThreadPool : NonCopyable {
+public:
+    /**
+     * @param num_workers Number of worker threads to spawn in addition to the calling thread.
+     * @param name Debugger-visible name given to the worker threads.
+     */
+    ThreadPool(size_t num_workers, std::string name);
+    ~ThreadPool();
+
+    /// Returns the number of threads taking part in ParallelFor, including the caller.
+    size_t GetThreadCount() const {
+        return workers.size() + 1;
+    }
+
+    /**
+     * Invokes func(i) for every i in [0, count), distributed over the worker threads and the
+     * calling thread. Returns once all invocations have completed. Invocations may run in any
+     * order and concurrently, so func must not depend on the ordering between indices.
+     * Only one thread may call ParallelFor on a given pool at a time.
+     */
+    void ParallelFor(size_t count, const std::function<void(size_t)>& func);
+
+private:
+    void WorkerLoop();
+    void RunJobs(const std::function<void(size_t)>& func, size_t count);
+
+    std::vector<std::thread> workers;
+    std::string name;
+
+    std::mutex mutex;
+    std::condition_variable work_available;
+    std::condition_variable work_done;
+
+    const std::function<void(size_t)>* current_job = nullptr;
+    size_t current_job_count = 0;
+    std::atomic<size_t> next_index{0};
+    /// Incremented for each ParallelFor call, used by workers to detect a new batch
+    u64 generation = 0;
+    /// Number of workers which have not yet finished the current batch
+    size_t busy_workers = 0;
+    bool quit = false;
+};
+
+} // namespace Common
@@ -5,157 +5,171 @@
 #pragma once
 
 #include <array>
-#include <deque>
-#include <boost/range/algorithm_ext/erase.hpp>
+#include <vector>
+#include "common/assert.h"
+#include "common/bit_set.h"
+#include "common/common_types.h"
 
 namespace Common {
 
-template <class T, unsigned int N>
+/// Links embedded in the elements of a ThreadQueueList. An element can be in one list at a time.
+template <class T>
+struct ThreadQueueListLink {
+    T* prev = nullptr;
+    T* next = nullptr;
+    /// Priority level the element is queued at, only meaningful while queued
+    unsigned int priority = 0;
+    bool queued = false;
+};
+
+/**
+ * A queue of threads for each priority level, lower levels being the better ones. The queues are
+ * intrusive doubly linked lists running through the Link member of the elements, and a bitmap
+ * tracks which levels are non-empty, so that every operation except clear() takes constant time.
+ */
+template <class T, unsigned int N, ThreadQueueListLink<T> T::*Link>
 struct ThreadQueueList {
-    // TODO(yuriks): If performance proves to be a problem, the std::deques can be replaced with
-    //               (dynamically resizable) circular buffers to remove their overhead when
-    //               inserting and popping.
+    static_assert(N <= 64, "The bitmap of non-empty levels holds up to 64 priority levels");
 
     typedef unsigned int Priority;
 
     // Number of priority levels. (Valid levels are [0..NUM_QUEUES).)
     static const Priority NUM_QUEUES = N;
 
-    ThreadQueueList() {
-        first = nullptr;
-    }
-
     // Only for debugging, returns priority level.
-    Priority contains(const T& uid) {
-        for (Priority i = 0; i < NUM_QUEUES; ++i) {
-            Queue& cur = queues[i];
-            if (std::find(cur.data.cbegin(), cur.data.cend(), uid) != cur.data.cend()) {
-                return i;
-            }
-        }
-
-        return -1;
+    Priority contains(const T* thread) const {
+        const ThreadQueueListLink<T>& link = thread->*Link;
+        return link.queued ? link.priority : -1;
     }
 
-    T get_first() {
-        Queue* cur = first;
-        while (cur != nullptr) {
-            if (!cur->data.empty()) {
-                return cur->data.front();
-            }
-            cur = cur->next_nonempty;
-        }
-
-        return T();
+    T* get_first() const {
+        if (nonempty == 0)
+            return nullptr;
+        return queues[LeastSignificantSetBit(nonempty)].head;
     }
 
-    T pop_first() {
-        Queue* cur = first;
-        while (cur != nullptr) {
-            if (!cur->data.empty()) {
-                auto tmp = std::move(cur->data.front());
-                cur->data.pop_front();
-                return tmp;
-            }
-            cur = cur->next_nonempty;
-        }
-
-        return T();
+    T* pop_first() {
+        if (nonempty == 0)
+            return nullptr;
+        return pop_front(LeastSignificantSetBit(nonempty));
     }
 
-    T pop_first_better(Priority priority) {
-        Queue* cur = first;
-        Queue* stop = &queues[priority];
-        while (cur < stop) {
-            if (!cur->data.empty()) {
-                auto tmp = std::move(cur->data.front());
-                cur->data.pop_front();
-                return tmp;
-            }
-            cur = cur->next_nonempty;
-        }
-
-        return T();
+    /// Pops the first thread of a better level than the given one, if any
+    T* pop_first_better(Priority priority) {
+        const u64 better = priority < 64 ? nonempty & ((u64(1) << priority) - 1) : nonempty;
+        if (better == 0)
+            return nullptr;
+        return pop_front(LeastSignificantSetBit(better));
     }
 
-    void push_front(Priority priority, const T& thread_id) {
-        Queue* cur = &queues[priority];
-        cur->data.push_front(thread_id);
+    void push_front(Priority priority, T* thread) {
+        ThreadQueueListLink<T>& link = Prepare(priority, thread);
+        Queue& queue = queues[priority];
+        link.next = queue.head;
+        if (queue.head != nullptr)
+            (queue.head->*Link).prev = thread;
+        else
+            queue.tail = thread;
+        queue.head = thread;
     }
 
-    void push_back(Priority priority, const T& thread_id) {
-        Queue* cur = &queues[priority];
-        cur->data.push_back(thread_id);
+    void push_back(Priority priority, T* thread) {
+        ThreadQueueListLink<T>& link = Prepare(priority, thread);
+        Queue& queue = queues[priority];
+        link.prev = queue.tail;
+        if (queue.tail != nullptr)
+            (queue.tail->*Link).next = thread;
+        else
+            queue.head = thread;
+        queue.tail = thread;
     }
 
-    void move(const T& thread_id, Priority old_priority, Priority new_priority) {
-        remove(old_priority, thread_id);
-        prepare(new_priority);
-        push_back(new_priority, thread_id);
+    void move(T* thread, Priority old_priority, Priority new_priority) {
+        remove(old_priority, thread);
+        push_back(new_priority, thread);
     }
 
-    void remove(Priority priority, const T& thread_id) {
-        Queue* cur = &queues[priority];
-        boost::remove_erase(cur->data, thread_id);
+    /// Removes a thread from the given level, does nothing if it isn't queued
+    void remove(Priority priority, T* thread) {
+        ThreadQueueListLink<T>& link = thread->*Link;
+        if (!link.queued)
+            return;
+        DEBUG_ASSERT_MSG(link.priority == priority, "Thread is queued at another priority");
+
+        Queue& queue = queues[link.priority];
+        if (link.prev != nullptr)
+            (link.prev->*Link).next = link.next;
+        else
+            queue.head = link.next;
+        if (link.next != nullptr)
+            (link.next->*Link).prev = link.prev;
+        else
+            queue.tail = link.prev;
+
+        if (queue.head == nullptr)
+            nonempty &= ~(u64(1) << link.priority);
+        link = {};
     }
 
+    /// Moves the first thread of a level to its back
     void rotate(Priority priority) {
-        Queue* cur = &queues[priority];
-
-        if (cur->data.size() > 1) {
-            cur->data.push_back(std::move(cur->data.front()));
-            cur->data.pop_front();
+        T* first = queues[priority].head;
+        if (first != nullptr && first != queues[priority].tail) {
+            remove(priority, first);
+            push_back(priority, first);
         }
     }
 
+    /// Empties all levels. The threads still queued must not have been destroyed.
     void clear() {
-        queues.fill(Queue());
-        first = nullptr;
+        for (Queue& queue : queues) {
+            for (T* thread = queue.head; thread != nullptr;) {
+                T* next = (thread->*Link).next;
+                thread->*Link = {};
+                thread = next;
+            }
+            queue = {};
+        }
+        nonempty = 0;
     }
 
     bool empty(Priority priority) const {
-        const Queue* cur = &queues[priority];
-        return cur->data.empty();
+        return queues[priority].head == nullptr;
     }
 
-    void prepare(Priority priority) {
-        Queue* cur = &queues[priority];
-        if (cur->next_nonempty == UnlinkedTag())
-            link(priority);
+    /// Returns the threads queued at a level, in order
+    std::vector<T*> get_queue(Priority priority) const {
+        std::vector<T*> threads;
+        for (T* thread = queues[priority].head; thread != nullptr; thread = (thread->*Link).next)
+            threads.push_back(thread);
+        return threads;
     }
 
 private:
     struct Queue {
-        // Points to the next active priority, skipping over ones that have never been used.
-        Queue* next_nonempty = UnlinkedTag();
-        // Double-ended queue of threads in this priority level
-        std::deque<T> data;
+        T* head = nullptr;
+        T* tail = nullptr;
     };
 
-    /// Special tag used to mark priority levels that have never been used.
-    static Queue* UnlinkedTag() {
-        return reinterpret_cast<Queue*>(1);
+    ThreadQueueListLink<T>& Prepare(Priority priority, T* thread) {
+        ThreadQueueListLink<T>& link = thread->*Link;
+        DEBUG_ASSERT_MSG(!link.queued, "Thread is already queued");
+        link = {};
+        link.priority = priority;
+        link.queued = true;
+        nonempty |= u64(1) << priority;
+        return link;
     }
 
-    void link(Priority priority) {
-        Queue* cur = &queues[priority];
-
-        for (int i = priority - 1; i >= 0; --i) {
-            if (queues[i].next_nonempty != UnlinkedTag()) {
-                cur->next_nonempty = queues[i].next_nonempty;
-                queues[i].next_nonempty = cur;
-                return;
-            }
-        }
-
-        cur->next_nonempty = first;
-        first = cur;
+    T* pop_front(Priority priority) {
+        T* thread = queues[priority].head;
+        remove(priority, thread);
+        return thread;
     }
 
-    // The first queue that's ever been used.
-    Queue* first;
-    // The priority level queues of thread ids.
+    /// Bit i is set if level i is non-empty
+    u64 nonempty = 0;
     std::array<Queue, NUM_QUEUES> queues;
 };
 
-} // namespace
+} // namespace Common
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include "common/common_types.h"
 #include "core/arm/skyeye_common/arm_regformat.h"
 #include "core/arm/skyeye_common/vfp/asm_vfp.h"
@@ -41,6 +42,14 @@ public:
     /// Clear all instruction cache
     virtual void ClearInstructionCache() = 0;
 
+    /**
+     * Clear the instruction cache of a range of memory, which must be done when code in it is
+     * modified
+     * @param start_address Address of the start of the range
+     * @param length Length of the range in bytes
+     */
+    virtual void InvalidateCacheRange(u32 start_address, size_t length) = 0;
+
     /**
      * Set the Program Counter to an address
      * @param addr Address to set PC to
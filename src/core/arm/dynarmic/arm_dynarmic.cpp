@@ -175,4 +175,10 @@ void ARM_Dynarmic::PrepareReschedule() {
 
 void ARM_Dynarmic::ClearInstructionCache() {
     jit->ClearCache();
+    interpreter_state->instruction_cache.Clear();
+}
+
+void ARM_Dynarmic::InvalidateCacheRange(u32 start_address, size_t length) {
+    jit->InvalidateCacheRange(start_address, length);
+    interpreter_state->instruction_cache.InvalidateRange(start_address, static_cast<u32>(length));
 }
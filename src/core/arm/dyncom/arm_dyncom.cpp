@@ -21,8 +21,13 @@ ARM_DynCom::ARM_DynCom(PrivilegeMode initial_mode) {
 ARM_DynCom::~ARM_DynCom() {}
 
 void ARM_DynCom::ClearInstructionCache() {
-    state->instruction_cache.clear();
-    trans_cache_buf_top = 0;
+    state->instruction_cache.Clear();
+    ClearTranslationBuffer();
+    state->instruction_cache_generation = trans_cache_generation;
+}
+
+void ARM_DynCom::InvalidateCacheRange(u32 start_address, size_t length) {
+    state->instruction_cache.InvalidateRange(start_address, static_cast<u32>(length));
 }
 
 void ARM_DynCom::SetPC(u32 pc) {
@@ -0,0 +1,43 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "core/arm/dyncom/arm_dyncom_block_cache.h"
+
+void BlockCache::Insert(u32 addr, int offset) {
+    std::unique_ptr<Page>& page = pages[addr >> PAGE_BITS];
+    if (page == nullptr) {
+        page = std::make_unique<Page>();
+        page->fill(-1);
+    }
+    (*page)[(addr & PAGE_MASK) >> 1] = offset;
+}
+
+void BlockCache::InvalidateRange(u32 addr, u32 size) {
+    if (size == 0)
+        return;
+
+    const u32 first_page = addr >> PAGE_BITS;
+    const u32 last_addr = size - 1 > 0xFFFFFFFF - addr ? 0xFFFFFFFF : addr + (size - 1);
+    const u32 last_page = last_addr >> PAGE_BITS;
+    if (last_page - first_page >= pages.size()) {
+        for (auto it = pages.begin(); it != pages.end();) {
+            if (it->first >= first_page && it->first <= last_page)
+                it = pages.erase(it);
+            else
+                ++it;
+        }
+    } else {
+        for (u32 page = first_page; page != last_page + 1; ++page)
+            pages.erase(page);
+    }
+
+    last_page_index = 0xFFFFFFFF;
+    ++epoch;
+}
+
+void BlockCache::Clear() {
+    pages.clear();
+    last_page_index = 0xFFFFFFFF;
+    ++epoch;
+}
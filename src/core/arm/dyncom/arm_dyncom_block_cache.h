@@ -0,0 +1,68 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <unordered_map>
+#include "common/common_types.h"
+
+/**
+ * Locations of the translated blocks of the interpreter in the translation buffer, indexed by the
+ * page of their first instruction. Blocks never cross a page, so dropping the pages overlapping a
+ * range of memory drops every block translated from it.
+ */
+class BlockCache {
+public:
+    /// Returns the offset of the block starting at the given address, or -1 if there is none
+    int Find(u32 addr) const {
+        const Page* page = GetPage(addr >> PAGE_BITS);
+        return page != nullptr ? (*page)[(addr & PAGE_MASK) >> 1] : -1;
+    }
+
+    /// Records the offset of the block starting at the given address
+    void Insert(u32 addr, int offset);
+
+    /// Drops the blocks starting in pages overlapping the given range
+    void InvalidateRange(u32 addr, u32 size);
+
+    /// Drops all blocks
+    void Clear();
+
+    /**
+     * Returns a counter incremented whenever blocks are dropped. Anything remembered about the
+     * blocks at an older epoch, such as links between them, may be stale.
+     */
+    u32 GetEpoch() const {
+        return epoch;
+    }
+
+private:
+    static constexpr u32 PAGE_BITS = 12;
+    static constexpr u32 PAGE_MASK = (1 << PAGE_BITS) - 1;
+
+    /// Block offsets of a page, by halfword as Thumb instructions are halfword aligned
+    using Page = std::array<int, (PAGE_MASK + 1) / 2>;
+
+    const Page* GetPage(u32 page_index) const {
+        if (page_index != last_page_index) {
+            auto it = pages.find(page_index);
+            if (it == pages.end())
+                return nullptr;
+            last_page_index = page_index;
+            last_page = it->second.get();
+        }
+        return last_page;
+    }
+
+    std::unordered_map<u32, std::unique_ptr<Page>> pages;
+
+    // Consecutive lookups mostly hit the same page
+    mutable u32 last_page_index = 0xFFFFFFFF;
+    mutable const Page* last_page = nullptr;
+
+    // Starts at 1 so that zero-initialized links are never current
+    u32 epoch = 1;
+};
@@ -7,6 +7,7 @@
 #include <algorithm>
 #include <cinttypes>
 #include <cstdio>
+#include <new>
 #include "common/common_types.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
@@ -838,6 +839,31 @@ static unsigned int InterpreterTranslateInstruction(const ARMul_State* cpu, cons
     return inst_size;
 }
 
+// Largest size of a block in the translation buffer: a page of Thumb instructions, with room to
+// spare for the largest instruction cream
+constexpr size_t MAX_BLOCK_SIZE = sizeof(BlockHeader) + 2048 * 256;
+
+/**
+ * Drops the blocks of a state if the translation buffer was emptied since they were translated,
+ * and empties it if a new block may not fit, then allocates the header of a new block.
+ * @return Offset of the new block in the translation buffer
+ */
+static int AllocateBlock(ARMul_State* cpu) {
+    if (trans_cache_buf_top + MAX_BLOCK_SIZE > TRANS_CACHE_SIZE) {
+        LOG_DEBUG(Core_ARM11, "Translation buffer is full, clearing it");
+        ClearTranslationBuffer();
+    }
+    if (cpu->instruction_cache_generation != trans_cache_generation) {
+        cpu->instruction_cache.Clear();
+        cpu->instruction_cache_generation = trans_cache_generation;
+    }
+
+    const int bb_start = static_cast<int>(trans_cache_buf_top);
+    new (&trans_cache_buf[trans_cache_buf_top]) BlockHeader{};
+    trans_cache_buf_top += sizeof(BlockHeader);
+    return bb_start;
+}
+
 static int InterpreterTranslateBlock(ARMul_State* cpu, int& bb_start, u32 addr) {
     MICROPROFILE_SCOPE(DynCom_Decode);
 
@@ -848,7 +874,7 @@ static int InterpreterTranslateBlock(ARMul_State* cpu, int& bb_start, u32 addr)
     ARM_INST_PTR inst_base = nullptr;
     TransExtData ret = TransExtData::NON_BRANCH;
     int size = 0; // instruction size of basic block
-    bb_start = trans_cache_buf_top;
+    bb_start = AllocateBlock(cpu);
 
     u32 phys_addr = addr;
     u32 pc_start = cpu->Reg[15];
@@ -866,7 +892,7 @@ static int InterpreterTranslateBlock(ARMul_State* cpu, int& bb_start, u32 addr)
         ret = inst_base->br;
     };
 
-    cpu->instruction_cache[pc_start] = bb_start;
+    cpu->instruction_cache.Insert(pc_start, bb_start);
 
     return KEEP_GOING;
 }
@@ -875,7 +901,7 @@ static int InterpreterTranslateSingle(ARMul_State* cpu, int& bb_start, u32 addr)
     MICROPROFILE_SCOPE(DynCom_Decode);
 
     ARM_INST_PTR inst_base = nullptr;
-    bb_start = trans_cache_buf_top;
+    bb_start = AllocateBlock(cpu);
 
     u32 phys_addr = addr;
     u32 pc_start = cpu->Reg[15];
@@ -886,7 +912,7 @@ static int InterpreterTranslateSingle(ARMul_State* cpu, int& bb_start, u32 addr)
         inst_base->br = TransExtData::SINGLE_STEP;
     }
 
-    cpu->instruction_cache[pc_start] = bb_start;
+    cpu->instruction_cache.Insert(pc_start, bb_start);
 
     return KEEP_GOING;
 }
@@ -1622,6 +1648,10 @@ unsigned InterpreterMainLoop(ARMul_State* cpu) {
 
     int ptr;
 
+    // Header of the block being executed, used to link it to the next one
+    BlockHeader* block = nullptr;
+    u32 block_epoch = 0;
+
     LOAD_NZCVT;
 DISPATCH : {
     if (!cpu->NirqSig) {
@@ -1635,17 +1665,36 @@ DISPATCH : {
     else
         cpu->Reg[15] &= 0xfffffffc;
 
-    // Find the cached instruction cream, otherwise translate it...
-    auto itr = cpu->instruction_cache.find(cpu->Reg[15]);
-    if (itr != cpu->instruction_cache.end()) {
-        ptr = itr->second;
-    } else if (cpu->NumInstrsToExecute != 1) {
-        if (InterpreterTranslateBlock(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
-            goto END;
+    // Blocks may have been dropped while the previous one was executing
+    const u32 epoch = cpu->instruction_cache.GetEpoch();
+    if (block_epoch != epoch)
+        block = nullptr;
+
+    // Follow the link of the previous block, otherwise find the cached instruction cream, and
+    // otherwise translate it...
+    const BlockLink* link = block != nullptr ? block->FindLink(cpu->Reg[15], epoch) : nullptr;
+    if (link != nullptr) {
+        ptr = link->ptr;
     } else {
-        if (InterpreterTranslateSingle(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
-            goto END;
+        ptr = -1;
+        if (cpu->instruction_cache_generation == trans_cache_generation)
+            ptr = cpu->instruction_cache.Find(cpu->Reg[15]);
+
+        if (ptr == -1 && cpu->NumInstrsToExecute != 1) {
+            if (InterpreterTranslateBlock(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
+                goto END;
+        } else if (ptr == -1) {
+            if (InterpreterTranslateSingle(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
+                goto END;
+        }
+
+        // Translating may have emptied the translation buffer along with the previous block
+        if (block != nullptr && cpu->instruction_cache.GetEpoch() == epoch)
+            block->AddLink(cpu->Reg[15], ptr, epoch);
     }
+    block = reinterpret_cast<BlockHeader*>(&trans_cache_buf[ptr]);
+    block_epoch = cpu->instruction_cache.GetEpoch();
+    ptr += sizeof(BlockHeader);
 
     // Find breakpoint if one exists within the block
     if (GDBStub::IsConnected()) {
@@ -9,6 +9,12 @@
 
 char trans_cache_buf[TRANS_CACHE_SIZE];
 size_t trans_cache_buf_top = 0;
+u32 trans_cache_generation = 0;
+
+void ClearTranslationBuffer() {
+    trans_cache_buf_top = 0;
+    ++trans_cache_generation;
+}
 
 static void* AllocBuffer(size_t size) {
     size_t start = trans_cache_buf_top;
@@ -25,6 +25,34 @@ struct arm_inst {
     char component[0];
 };
 
+/// A block executed after another one, remembered to skip looking it up in the block cache
+struct BlockLink {
+    u32 pc;
+    /// Offset of the linked block in the translation buffer
+    int ptr;
+    /// Epoch of the block cache the link was made at, it is stale at any other epoch
+    u32 epoch;
+};
+
+/// Precedes the instructions of each block in the translation buffer
+struct BlockHeader {
+    // Two links cover both outcomes of a conditional branch at the end of the block
+    BlockLink links[2];
+
+    const BlockLink* FindLink(u32 pc, u32 epoch) const {
+        for (const BlockLink& link : links) {
+            if (link.pc == pc && link.epoch == epoch)
+                return &link;
+        }
+        return nullptr;
+    }
+
+    void AddLink(u32 pc, int ptr, u32 epoch) {
+        links[1] = links[0];
+        links[0] = {pc, ptr, epoch};
+    }
+};
+
 struct generic_arm_inst {
     u32 Ra;
     u32 Rm;
@@ -492,3 +520,8 @@ extern const size_t arm_instruction_trans_len;
 #define TRANS_CACHE_SIZE (64 * 1024 * 2000)
 extern char trans_cache_buf[TRANS_CACHE_SIZE];
 extern size_t trans_cache_buf_top;
+/// Incremented whenever the translation buffer is emptied
+extern u32 trans_cache_generation;
+
+/// Empties the translation buffer, which drops the blocks translated for every ARMul_State
+void ClearTranslationBuffer();
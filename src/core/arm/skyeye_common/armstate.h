@@ -18,8 +18,8 @@
 #pragma once
 
 #include <array>
-#include <unordered_map>
 #include "common/common_types.h"
+#include "core/arm/dyncom/arm_dyncom_block_cache.h"
 #include "core/arm/skyeye_common/arm_regformat.h"
 
 // Signal levels
@@ -230,7 +230,9 @@ public:
 
     // TODO(bunnei): Move this cache to a better place - it should be per codeset (likely per
     // process for our purposes), not per ARMul_State (which tracks CPU core state).
-    std::unordered_map<u32, int> instruction_cache;
+    BlockCache instruction_cache;
+    /// Value of trans_cache_generation when the blocks in instruction_cache were translated
+    u32 instruction_cache_generation = 0;
 
 private:
     void ResetMPCoreCP15Registers();
@@ -18,6 +18,7 @@
 #include "core/hw/hw.h"
 #include "core/loader/loader.h"
 #include "core/memory_setup.h"
+#include "core/savestate.h"
 #include "core/settings.h"
 #include "video_core/video_core.h"
 
@@ -31,6 +32,11 @@ System::ResultStatus System::RunLoop(int tight_loop) {
         return ResultStatus::ErrorNotInitialized;
     }
 
+    HandleStateRequests();
+    if (status != ResultStatus::Success) {
+        return status;
+    }
+
     if (GDBStub::IsServerEnabled()) {
         GDBStub::HandlePacket();
 
@@ -113,10 +119,76 @@ System::ResultStatus System::Load(EmuWindow* emu_window, const std::string& file
             return ResultStatus::ErrorLoader;
         }
     }
+
+    u64 program_id = 0;
+    app_loader->ReadProgramId(program_id);
+    VideoCore::LoadShaderCache(program_id);
+
     status = ResultStatus::Success;
     return status;
 }
 
+System::ResultStatus System::InitHardware(EmuWindow* emu_window) {
+    // The system mode only decides the layout of FCRAM, use the one of most applications
+    ResultStatus init_result{Init(emu_window, 0)};
+    if (init_result != ResultStatus::Success) {
+        LOG_CRITICAL(Core, "Failed to initialize system (Error %i)!", init_result);
+        System::Shutdown();
+        return init_result;
+    }
+
+    status = ResultStatus::Success;
+    return status;
+}
+
+bool System::SaveState(const std::string& path) {
+    if (!cpu_core || !app_loader) {
+        return false;
+    }
+
+    u64 program_id = 0;
+    app_loader->ReadProgramId(program_id);
+    return ::SaveState::Save(path, program_id);
+}
+
+bool System::LoadState(const std::string& path) {
+    if (!cpu_core || !app_loader) {
+        return false;
+    }
+
+    u64 program_id = 0;
+    app_loader->ReadProgramId(program_id);
+    return ::SaveState::Load(path, program_id);
+}
+
+void System::RequestSaveState(const std::string& path) {
+    std::lock_guard<std::mutex> lock(state_request_mutex);
+    save_state_request = path;
+}
+
+void System::RequestLoadState(const std::string& path) {
+    std::lock_guard<std::mutex> lock(state_request_mutex);
+    load_state_request = path;
+}
+
+void System::HandleStateRequests() {
+    std::string save_path, load_path;
+    {
+        std::lock_guard<std::mutex> lock(state_request_mutex);
+        save_path = std::move(save_state_request);
+        load_path = std::move(load_state_request);
+        save_state_request.clear();
+        load_state_request.clear();
+    }
+
+    if (!save_path.empty()) {
+        SaveState(save_path);
+    }
+    if (!load_path.empty()) {
+        LoadState(load_path);
+    }
+}
+
 void System::PrepareReschedule() {
     cpu_core->PrepareReschedule();
     reschedule_pending = true;
@@ -143,11 +215,14 @@ System::ResultStatus System::Init(EmuWindow* emu_window, u32 system_mode) {
         cpu_core = std::make_unique<ARM_Dynarmic>(USER32MODE);
     } else {
         cpu_core = std::make_unique<ARM_DynCom>(USER32MODE);
+        // Dyncom accesses memory through the fastmem region where the host supports it, falling
+        // back to the page table otherwise. Dynarmic doesn't use it yet.
+        Memory::EnableFastmem();
     }
 
     telemetry_session = std::make_unique<Core::TelemetrySession>();
 
-    CoreTiming::Init();
+    CoreTiming::Init(cpu_core->down_count);
     HW::Init();
     Kernel::Init(system_mode);
     Service::Init();
@@ -176,9 +251,16 @@ void System::Shutdown() {
     HW::Shutdown();
     CoreTiming::Shutdown();
     cpu_core = nullptr;
+    Memory::DisableFastmem();
     app_loader = nullptr;
     telemetry_session = nullptr;
 
+    {
+        std::lock_guard<std::mutex> lock(state_request_mutex);
+        save_state_request.clear();
+        load_state_request.clear();
+    }
+
     LOG_DEBUG(Core, "Shutdown OK");
 }
 
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include "common/common_types.h"
 #include "core/memory.h"
@@ -75,6 +76,44 @@ public:
      */
     ResultStatus Load(EmuWindow* emu_window, const std::string& filepath);
 
+    /**
+     * Initializes the emulated hardware without loading an application, for tools that drive the
+     * hardware directly such as the CiTrace player. No thread is created, so RunLoop only advances
+     * the timing.
+     * @param emu_window Pointer to the host-system window used for video output.
+     * @returns ResultStatus code, indicating if the operation succeeded.
+     */
+    ResultStatus InitHardware(EmuWindow* emu_window);
+
+    /**
+     * Saves the state of the emulated system to a file. Must be called from the thread running
+     * the emulation, between two calls to RunLoop.
+     * @param path Path of the save state file
+     * @returns True if the state was saved successfully
+     */
+    bool SaveState(const std::string& path);
+
+    /**
+     * Restores the state of the emulated system from a file. Must be called from the thread
+     * running the emulation, between two calls to RunLoop. If loading fails after the state has
+     * started to be restored, the status is set to an error as the system can't keep running.
+     * @param path Path of the save state file
+     * @returns True if the state was loaded successfully
+     */
+    bool LoadState(const std::string& path);
+
+    /**
+     * Requests the state to be saved by the next call to RunLoop. Can be called from any thread.
+     * @param path Path of the save state file
+     */
+    void RequestSaveState(const std::string& path);
+
+    /**
+     * Requests the state to be loaded by the next call to RunLoop. Can be called from any thread.
+     * @param path Path of the save state file
+     */
+    void RequestLoadState(const std::string& path);
+
     /**
      * Indicates if the emulated system is powered on (all subsystems initialized and able to run an
      * application).
@@ -131,6 +170,9 @@ private:
     /// Reschedule the core emulation
     void Reschedule();
 
+    /// Handles the save state requests made since the last call to RunLoop
+    void HandleStateRequests();
+
     /// AppLoader used to load the current executing application
     std::unique_ptr<Loader::AppLoader> app_loader;
 
@@ -147,6 +189,11 @@ private:
 
     ResultStatus status = ResultStatus::Success;
     std::string status_details = "";
+
+    /// Save state requests, set by other threads and handled by RunLoop
+    std::mutex state_request_mutex;
+    std::string save_state_request;
+    std::string load_state_request;
 };
 
 inline ARM_Interface& CPU() {
@@ -2,15 +2,17 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <atomic>
 #include <cinttypes>
-#include <mutex>
+#include <string>
+#include <tuple>
+#include <unordered_map>
 #include <vector>
 #include "common/chunk_file.h"
 #include "common/logging/log.h"
+#include "common/mpsc_queue.h"
 #include "common/string_util.h"
-#include "core/arm/arm_interface.h"
-#include "core/core.h"
 #include "core/core_timing.h"
 
 int g_clock_rate_arm11 = BASE_CLOCK_RATE_ARM11;
@@ -31,34 +33,60 @@ struct EventType {
 
 static std::vector<EventType> event_types;
 
-struct BaseEvent {
+/// A scheduled event. Events are kept in slots, which are reused once the event fires or is
+/// unscheduled, and are referred to by EventHandles combining the slot with its generation.
+struct Event {
     s64 time;
+    /// Orders events scheduled for the same time by when they were scheduled
+    u64 fifo_order;
     u64 userdata;
     int type;
+    /// Incremented whenever the slot is released, invalidating handles to the previous event
+    u32 generation = 1;
 };
 
-typedef LinkedListItem<BaseEvent> Event;
+/// Entry of the event queue. Entries of unscheduled events stay in the queue until they reach
+/// its top, they are recognized by their generation not matching the one of their slot anymore.
+struct QueueEntry {
+    s64 time;
+    u64 fifo_order;
+    u32 slot;
+    u32 generation;
 
-static Event* first;
-static Event* ts_first;
-static Event* ts_last;
+    /// Ordering for std::push_heap and friends, which put the greatest element on top
+    bool operator<(const QueueEntry& other) const {
+        return std::tie(time, fifo_order) > std::tie(other.time, other.fifo_order);
+    }
+};
 
-// event pools
-static Event* event_pool = nullptr;
-static Event* event_ts_pool = nullptr;
-static int allocated_ts_events = 0;
+struct ThreadsafeEvent {
+    s64 time;
+    u64 userdata;
+    int type;
+};
+
+static std::vector<Event> events;
+static std::vector<u32> free_slots;
+/// Binary heap of pending events, the first element is always the next event to fire
+static std::vector<QueueEntry> event_queue;
+/// Number of entries in event_queue which belong to unscheduled events
+static size_t cancelled_entries;
+static u64 event_fifo_id;
+
+/// Events scheduled from other threads, moved into event_queue by the CPU thread
+static Common::MPSCQueue<ThreadsafeEvent> ts_queue;
 // Optimization to skip MoveEvents when possible.
 static std::atomic<bool> has_ts_events(false);
 
 int g_slice_length;
+/// Cycles left in the current slice, decremented by the CPU as it executes
+static s64* downcount;
 
 static s64 global_timer;
 static s64 idled_cycles;
 static s64 last_global_time_ticks;
 static s64 last_global_time_us;
 
-static std::recursive_mutex external_event_section;
-
 // Warning: not included in save state.
 using AdvanceCallback = void(int cycles_executed);
 static AdvanceCallback* advance_callback = nullptr;
@@ -92,35 +120,77 @@ u64 GetGlobalTimeUs() {
     return last_global_time_us + us_since_last;
 }
 
-static Event* GetNewEvent() {
-    if (!event_pool)
-        return new Event;
+static bool IsPending(const QueueEntry& entry) {
+    return events[entry.slot].generation == entry.generation;
+}
 
-    Event* event = event_pool;
-    event_pool = event->next;
-    return event;
+static EventHandle MakeHandle(u32 slot) {
+    return (static_cast<u64>(events[slot].generation) << 32) | slot;
 }
 
-static Event* GetNewTsEvent() {
-    allocated_ts_events++;
+/// Returns the slot of the event the handle refers to, or -1 if the event is not pending
+static s64 GetSlot(EventHandle handle) {
+    const u32 slot = static_cast<u32>(handle);
+    const u32 generation = static_cast<u32>(handle >> 32);
+    if (slot >= events.size() || events[slot].generation != generation)
+        return -1;
+    return slot;
+}
 
-    if (!event_ts_pool)
-        return new Event;
+static u32 AllocateSlot() {
+    if (free_slots.empty()) {
+        events.emplace_back();
+        return static_cast<u32>(events.size() - 1);
+    }
+    const u32 slot = free_slots.back();
+    free_slots.pop_back();
+    return slot;
+}
+
+static void ReleaseSlot(u32 slot) {
+    // Generation 0 is skipped, so that no handle is 0
+    if (++events[slot].generation == 0)
+        events[slot].generation = 1;
+    free_slots.push_back(slot);
+}
 
-    Event* event = event_ts_pool;
-    event_ts_pool = event->next;
-    return event;
+static void PushEvent(u32 slot) {
+    const Event& event = events[slot];
+    event_queue.push_back({event.time, event.fifo_order, slot, event.generation});
+    std::push_heap(event_queue.begin(), event_queue.end());
 }
 
-static void FreeEvent(Event* event) {
-    event->next = event_pool;
-    event_pool = event;
+static void PopEvent() {
+    std::pop_heap(event_queue.begin(), event_queue.end());
+    event_queue.pop_back();
+}
+
+/**
+ * Drops the entries of unscheduled events from the top of the queue, so that the first entry is
+ * always pending. The queue is compacted once most of its entries belong to unscheduled events.
+ */
+static void DiscardCancelledEvents() {
+    while (!event_queue.empty() && !IsPending(event_queue.front())) {
+        PopEvent();
+        --cancelled_entries;
+    }
+
+    if (cancelled_entries > 64 && cancelled_entries > event_queue.size() / 2) {
+        event_queue.erase(std::remove_if(event_queue.begin(), event_queue.end(),
+                                         [](const QueueEntry& entry) { return !IsPending(entry); }),
+                          event_queue.end());
+        std::make_heap(event_queue.begin(), event_queue.end());
+        cancelled_entries = 0;
+    }
 }
 
-static void FreeTsEvent(Event* event) {
-    event->next = event_ts_pool;
-    event_ts_pool = event;
-    allocated_ts_events--;
+/// Unschedules a pending event, returning the remaining ticks until it would have fired
+static s64 CancelEvent(u32 slot) {
+    const s64 remaining = events[slot].time - GetTicks();
+    ReleaseSlot(slot);
+    ++cancelled_entries;
+    DiscardCancelledEvents();
+    return remaining;
 }
 
 int RegisterEvent(const char* name, TimedCallback callback) {
@@ -140,13 +210,14 @@ void RestoreRegisterEvent(int event_type, const char* name, TimedCallback callba
 }
 
 void UnregisterAllEvents() {
-    if (first)
+    if (!event_queue.empty())
         LOG_ERROR(Core_Timing, "Cannot unregister events with events pending");
     event_types.clear();
 }
 
-void Init() {
-    Core::CPU().down_count = INITIAL_SLICE_LENGTH;
+void Init(s64& cpu_downcount) {
+    downcount = &cpu_downcount;
+    *downcount = INITIAL_SLICE_LENGTH;
     g_slice_length = INITIAL_SLICE_LENGTH;
     global_timer = 0;
     idled_cycles = 0;
@@ -155,13 +226,11 @@ void Init() {
     has_ts_events = 0;
     mhz_change_callbacks.clear();
 
-    first = nullptr;
-    ts_first = nullptr;
-    ts_last = nullptr;
-
-    event_pool = nullptr;
-    event_ts_pool = nullptr;
-    allocated_ts_events = 0;
+    events.clear();
+    free_slots.clear();
+    event_queue.clear();
+    cancelled_entries = 0;
+    event_fifo_id = 0;
 
     advance_callback = nullptr;
 }
@@ -171,22 +240,15 @@ void Shutdown() {
     ClearPendingEvents();
     UnregisterAllEvents();
 
-    while (event_pool) {
-        Event* event = event_pool;
-        event_pool = event->next;
-        delete event;
-    }
-
-    std::lock_guard<std::recursive_mutex> lock(external_event_section);
-    while (event_ts_pool) {
-        Event* event = event_ts_pool;
-        event_ts_pool = event->next;
-        delete event;
-    }
+    events.clear();
+    events.shrink_to_fit();
+    free_slots.clear();
+    free_slots.shrink_to_fit();
+    event_queue.shrink_to_fit();
 }
 
 u64 GetTicks() {
-    return (u64)global_timer + g_slice_length - Core::CPU().down_count;
+    return (u64)global_timer + g_slice_length - *downcount;
 }
 
 u64 GetIdleTicks() {
@@ -196,19 +258,8 @@ u64 GetIdleTicks() {
 // This is to be called when outside threads, such as the graphics thread, wants to
 // schedule things to be executed on the main thread.
 void ScheduleEvent_Threadsafe(s64 cycles_into_future, int event_type, u64 userdata) {
-    std::lock_guard<std::recursive_mutex> lock(external_event_section);
-    Event* new_event = GetNewTsEvent();
-    new_event->time = GetTicks() + cycles_into_future;
-    new_event->type = event_type;
-    new_event->next = nullptr;
-    new_event->userdata = userdata;
-    if (!ts_first)
-        ts_first = new_event;
-    if (ts_last)
-        ts_last->next = new_event;
-    ts_last = new_event;
-
-    has_ts_events = true;
+    ts_queue.Push({static_cast<s64>(GetTicks()) + cycles_into_future, userdata, event_type});
+    has_ts_events.store(true, std::memory_order_release);
 }
 
 // Same as ScheduleEvent_Threadsafe(0, ...) EXCEPT if we are already on the CPU thread
@@ -216,121 +267,68 @@ void ScheduleEvent_Threadsafe(s64 cycles_into_future, int event_type, u64 userda
 void ScheduleEvent_Threadsafe_Immediate(int event_type, u64 userdata) {
     if (false) // Core::IsCPUThread())
     {
-        std::lock_guard<std::recursive_mutex> lock(external_event_section);
         event_types[event_type].callback(userdata, 0);
     } else
         ScheduleEvent_Threadsafe(0, event_type, userdata);
 }
 
 void ClearPendingEvents() {
-    while (first) {
-        Event* event = first->next;
-        FreeEvent(first);
-        first = event;
+    for (const QueueEntry& entry : event_queue) {
+        if (IsPending(entry))
+            ReleaseSlot(entry.slot);
     }
+    event_queue.clear();
+    cancelled_entries = 0;
 }
 
-static void AddEventToQueue(Event* new_event) {
-    Event* prev_event = nullptr;
-    Event** next_event = &first;
-    for (;;) {
-        Event*& next = *next_event;
-        if (!next || new_event->time < next->time) {
-            new_event->next = next;
-            next = new_event;
-            break;
-        }
-        prev_event = next;
-        next_event = &prev_event->next;
-    }
+static EventHandle AddEvent(s64 time, int event_type, u64 userdata) {
+    const u32 slot = AllocateSlot();
+    Event& event = events[slot];
+    event.time = time;
+    event.fifo_order = event_fifo_id++;
+    event.userdata = userdata;
+    event.type = event_type;
+    PushEvent(slot);
+    return MakeHandle(slot);
 }
 
-void ScheduleEvent(s64 cycles_into_future, int event_type, u64 userdata) {
-    Event* new_event = GetNewEvent();
-    new_event->userdata = userdata;
-    new_event->type = event_type;
-    new_event->time = GetTicks() + cycles_into_future;
-    AddEventToQueue(new_event);
+EventHandle ScheduleEvent(s64 cycles_into_future, int event_type, u64 userdata) {
+    return AddEvent(GetTicks() + cycles_into_future, event_type, userdata);
 }
 
-s64 UnscheduleEvent(int event_type, u64 userdata) {
-    s64 result = 0;
-    if (!first)
-        return result;
-    while (first) {
-        if (first->type == event_type && first->userdata == userdata) {
-            result = first->time - GetTicks();
-
-            Event* next = first->next;
-            FreeEvent(first);
-            first = next;
-        } else {
-            break;
-        }
-    }
-    if (!first)
-        return result;
-
-    Event* prev_event = first;
-    Event* ptr = prev_event->next;
-
-    while (ptr) {
-        if (ptr->type == event_type && ptr->userdata == userdata) {
-            result = ptr->time - GetTicks();
-
-            prev_event->next = ptr->next;
-            FreeEvent(ptr);
-            ptr = prev_event->next;
-        } else {
-            prev_event = ptr;
-            ptr = ptr->next;
-        }
-    }
-
-    return result;
+s64 UnscheduleEvent(EventHandle handle) {
+    const s64 slot = GetSlot(handle);
+    if (slot == -1)
+        return 0;
+    return CancelEvent(static_cast<u32>(slot));
 }
 
-s64 UnscheduleThreadsafeEvent(int event_type, u64 userdata) {
+/// Unschedules all pending events matching the predicate, returning the remaining ticks of one
+/// of them
+template <typename Predicate>
+static s64 UnscheduleMatchingEvents(Predicate predicate) {
     s64 result = 0;
-    std::lock_guard<std::recursive_mutex> lock(external_event_section);
-    if (!ts_first)
-        return result;
-
-    while (ts_first) {
-        if (ts_first->type == event_type && ts_first->userdata == userdata) {
-            result = ts_first->time - GetTicks();
-
-            Event* next = ts_first->next;
-            FreeTsEvent(ts_first);
-            ts_first = next;
-        } else {
-            break;
+    for (const QueueEntry& entry : event_queue) {
+        if (IsPending(entry) && predicate(events[entry.slot])) {
+            result = events[entry.slot].time - GetTicks();
+            ReleaseSlot(entry.slot);
+            ++cancelled_entries;
         }
     }
+    DiscardCancelledEvents();
+    return result;
+}
 
-    if (!ts_first) {
-        ts_last = nullptr;
-        return result;
-    }
-
-    Event* prev_event = ts_first;
-    Event* next = prev_event->next;
-    while (next) {
-        if (next->type == event_type && next->userdata == userdata) {
-            result = next->time - GetTicks();
-
-            prev_event->next = next->next;
-            if (next == ts_last)
-                ts_last = prev_event;
-            FreeTsEvent(next);
-            next = prev_event->next;
-        } else {
-            prev_event = next;
-            next = next->next;
-        }
-    }
+s64 UnscheduleEvent(int event_type, u64 userdata) {
+    return UnscheduleMatchingEvents([event_type, userdata](const Event& event) {
+        return event.type == event_type && event.userdata == userdata;
+    });
+}
 
-    return result;
+s64 UnscheduleThreadsafeEvent(int event_type, u64 userdata) {
+    // Threadsafe events can only be removed once they have been moved into the main queue
+    MoveEvents();
+    return UnscheduleEvent(event_type, userdata);
 }
 
 // Warning: not included in save state.
@@ -343,176 +341,115 @@ void RegisterMHzChangeCallback(MHzChangeCallback callback) {
 }
 
 bool IsScheduled(int event_type) {
-    if (!first)
-        return false;
-    Event* event = first;
-    while (event) {
-        if (event->type == event_type)
-            return true;
-        event = event->next;
-    }
-    return false;
+    return std::any_of(event_queue.begin(), event_queue.end(), [event_type](const QueueEntry& e) {
+        return IsPending(e) && events[e.slot].type == event_type;
+    });
 }
 
 void RemoveEvent(int event_type) {
-    if (!first)
-        return;
-    while (first) {
-        if (first->type == event_type) {
-            Event* next = first->next;
-            FreeEvent(first);
-            first = next;
-        } else {
-            break;
-        }
-    }
-    if (!first)
-        return;
-    Event* prev = first;
-    Event* next = prev->next;
-    while (next) {
-        if (next->type == event_type) {
-            prev->next = next->next;
-            FreeEvent(next);
-            next = prev->next;
-        } else {
-            prev = next;
-            next = next->next;
-        }
-    }
+    UnscheduleMatchingEvents([event_type](const Event& event) { return event.type == event_type; });
 }
 
 void RemoveThreadsafeEvent(int event_type) {
-    std::lock_guard<std::recursive_mutex> lock(external_event_section);
-    if (!ts_first)
-        return;
-
-    while (ts_first) {
-        if (ts_first->type == event_type) {
-            Event* next = ts_first->next;
-            FreeTsEvent(ts_first);
-            ts_first = next;
-        } else {
-            break;
-        }
-    }
-
-    if (!ts_first) {
-        ts_last = nullptr;
-        return;
-    }
-
-    Event* prev = ts_first;
-    Event* next = prev->next;
-    while (next) {
-        if (next->type == event_type) {
-            prev->next = next->next;
-            if (next == ts_last)
-                ts_last = prev;
-            FreeTsEvent(next);
-            next = prev->next;
-        } else {
-            prev = next;
-            next = next->next;
-        }
-    }
+    // Threadsafe events can only be removed once they have been moved into the main queue
+    MoveEvents();
+    RemoveEvent(event_type);
 }
 
 void RemoveAllEvents(int event_type) {
     RemoveThreadsafeEvent(event_type);
-    RemoveEvent(event_type);
 }
 
 // This raise only the events required while the fifo is processing data
 void ProcessFifoWaitEvents() {
-    while (first) {
-        if (first->time <= (s64)GetTicks()) {
-            Event* evt = first;
-            first = first->next;
-            event_types[evt->type].callback(evt->userdata, (int)(GetTicks() - evt->time));
-            FreeEvent(evt);
-        } else {
-            break;
-        }
+    while (!event_queue.empty() && event_queue.front().time <= (s64)GetTicks()) {
+        const u32 slot = event_queue.front().slot;
+        const Event event = events[slot];
+        PopEvent();
+        ReleaseSlot(slot);
+        DiscardCancelledEvents();
+
+        event_types[event.type].callback(event.userdata, (int)(GetTicks() - event.time));
     }
 }
 
 void MoveEvents() {
-    has_ts_events = false;
+    // Acquires the events pushed before the flag was set, later ones set it again
+    if (!has_ts_events.exchange(false, std::memory_order_acquire))
+        return;
 
-    std::lock_guard<std::recursive_mutex> lock(external_event_section);
     // Move events from async queue into main queue
-    while (ts_first) {
-        Event* next = ts_first->next;
-        AddEventToQueue(ts_first);
-        ts_first = next;
-    }
-    ts_last = nullptr;
-
-    // Move free events to threadsafe pool
-    while (allocated_ts_events > 0 && event_pool) {
-        Event* event = event_pool;
-        event_pool = event->next;
-        event->next = event_ts_pool;
-        event_ts_pool = event;
-        allocated_ts_events--;
+    ThreadsafeEvent event;
+    while (ts_queue.Pop(event)) {
+        AddEvent(event.time, event.type, event.userdata);
     }
 }
 
 void ForceCheck() {
-    s64 cycles_executed = g_slice_length - Core::CPU().down_count;
+    s64 cycles_executed = g_slice_length - *downcount;
     global_timer += cycles_executed;
     // This will cause us to check for new events immediately.
-    Core::CPU().down_count = 0;
+    *downcount = 0;
     // But let's not eat a bunch more time in Advance() because of this.
     g_slice_length = 0;
 }
 
 void Advance() {
-    s64 cycles_executed = g_slice_length - Core::CPU().down_count;
+    s64 cycles_executed = g_slice_length - *downcount;
     global_timer += cycles_executed;
-    Core::CPU().down_count = g_slice_length;
+    *downcount = g_slice_length;
 
-    if (has_ts_events)
+    if (has_ts_events.load(std::memory_order_relaxed))
         MoveEvents();
     ProcessFifoWaitEvents();
 
-    if (!first) {
+    if (event_queue.empty()) {
         if (g_slice_length < 10000) {
             g_slice_length += 10000;
-            Core::CPU().down_count += g_slice_length;
+            *downcount += g_slice_length;
         }
     } else {
         // Note that events can eat cycles as well.
-        int target = (int)(first->time - global_timer);
+        int target = (int)(event_queue.front().time - global_timer);
         if (target > MAX_SLICE_LENGTH)
             target = MAX_SLICE_LENGTH;
 
         const int diff = target - g_slice_length;
         g_slice_length += diff;
-        Core::CPU().down_count += diff;
+        *downcount += diff;
     }
     if (advance_callback)
         advance_callback(static_cast<int>(cycles_executed));
 }
 
+/// Returns the pending events in the order in which they fire
+static std::vector<Event> GetPendingEvents() {
+    std::vector<Event> pending;
+    for (const QueueEntry& entry : event_queue) {
+        if (IsPending(entry))
+            pending.push_back(events[entry.slot]);
+    }
+    std::sort(pending.begin(), pending.end(), [](const Event& a, const Event& b) {
+        return std::tie(a.time, a.fifo_order) < std::tie(b.time, b.fifo_order);
+    });
+    return pending;
+}
+
 void LogPendingEvents() {
-    Event* event = first;
-    while (event) {
-        // LOG_TRACE(Core_Timing, "PENDING: Now: %lld Pending: %lld Type: %d", globalTimer,
-        // next->time, next->type);
-        event = event->next;
+    for (const Event& event : GetPendingEvents()) {
+        LOG_TRACE(Core_Timing, "PENDING: Now: %" PRId64 " Pending: %" PRId64 " Type: %d",
+                  global_timer, event.time, event.type);
     }
 }
 
 void Idle(int max_idle) {
-    s64 cycles_down = Core::CPU().down_count;
+    s64 cycles_down = *downcount;
     if (max_idle != 0 && cycles_down > max_idle)
         cycles_down = max_idle;
 
-    if (first && cycles_down > 0) {
-        s64 cycles_executed = g_slice_length - Core::CPU().down_count;
-        s64 cycles_next_event = first->time - global_timer;
+    if (!event_queue.empty() && cycles_down > 0) {
+        s64 cycles_executed = g_slice_length - *downcount;
+        s64 cycles_next_event = event_queue.front().time - global_timer;
 
         if (cycles_next_event < cycles_executed + cycles_down) {
             cycles_down = cycles_next_event - cycles_executed;
@@ -526,27 +463,130 @@ void Idle(int max_idle) {
               cycles_down / (float)(g_clock_rate_arm11 * 0.001f));
 
     idled_cycles += cycles_down;
-    Core::CPU().down_count -= cycles_down;
-    if (Core::CPU().down_count == 0)
-        Core::CPU().down_count = -1;
+    *downcount -= cycles_down;
+    if (*downcount == 0)
+        *downcount = -1;
 }
 
 std::string GetScheduledEventsSummary() {
-    Event* event = first;
     std::string text = "Scheduled events\n";
     text.reserve(1000);
-    while (event) {
-        unsigned int t = event->type;
+    for (const Event& event : GetPendingEvents()) {
+        unsigned int t = event.type;
         if (t >= event_types.size())
             LOG_ERROR(Core_Timing, "Invalid event type"); // %i", t);
-        const char* name = event_types[event->type].name;
+        const char* name = event_types[event.type].name;
         if (!name)
             name = "[unknown]";
-        text += Common::StringFromFormat("%s : %i %08x%08x\n", name, (int)event->time,
-                                         (u32)(event->userdata >> 32), (u32)(event->userdata));
-        event = event->next;
+        text += Common::StringFromFormat("%s : %i %08x%08x\n", name, (int)event.time,
+                                         (u32)(event.userdata >> 32), (u32)(event.userdata));
     }
     return text;
 }
 
+void DoState(PointerWrap& p) {
+    // Threadsafe events are only moved into the main queue when it is processed
+    MoveEvents();
+
+    auto section = p.Section("CoreTiming", 2);
+    if (!section) {
+        return;
+    }
+
+    u32 type_count = static_cast<u32>(event_types.size());
+    p.Do(type_count);
+    // Maps the event types of the state to the registered ones, some names are registered more
+    // than once (by services which have several instances), the latest registration is used then.
+    std::vector<int> type_remap(type_count, -1);
+    std::unordered_map<std::string, int> types_by_name;
+    for (size_t i = 0; i < event_types.size(); ++i) {
+        types_by_name[event_types[i].name] = static_cast<int>(i);
+    }
+    for (u32 i = 0; i < type_count; ++i) {
+        std::string name = i < event_types.size() ? event_types[i].name : "";
+        p.Do(name);
+        if (p.GetMode() == PointerWrap::MODE_READ) {
+            auto it = types_by_name.find(name);
+            if (it != types_by_name.end()) {
+                type_remap[i] = it->second;
+            }
+        }
+    }
+
+    p.Do(g_clock_rate_arm11);
+    p.Do(g_slice_length);
+    p.Do(global_timer);
+    p.Do(idled_cycles);
+    p.Do(last_global_time_ticks);
+    p.Do(last_global_time_us);
+    p.Do(*downcount);
+    p.Do(event_fifo_id);
+
+    // The slots and their generations are stored as well, so that handles to events held by the
+    // rest of the emulated system stay valid
+    u32 slot_count = static_cast<u32>(events.size());
+    p.Do(slot_count);
+    if (p.GetMode() == PointerWrap::MODE_READ) {
+        ClearPendingEvents();
+        events.resize(slot_count);
+    }
+    for (Event& event : events) {
+        p.Do(event.generation);
+    }
+
+    u32 event_count = static_cast<u32>(event_queue.size() - cancelled_entries);
+    p.Do(event_count);
+
+    if (p.GetMode() != PointerWrap::MODE_READ) {
+        for (const QueueEntry& entry : event_queue) {
+            if (!IsPending(entry))
+                continue;
+            Event& event = events[entry.slot];
+            u32 slot = entry.slot;
+            p.Do(slot);
+            p.Do(event.time);
+            p.Do(event.fifo_order);
+            p.Do(event.userdata);
+            p.Do(event.type);
+        }
+        return;
+    }
+
+    std::vector<bool> slot_used(slot_count, false);
+    for (u32 i = 0; i < event_count && p.GetMode() == PointerWrap::MODE_READ; ++i) {
+        u32 slot;
+        Event loaded;
+        p.Do(slot);
+        p.Do(loaded.time);
+        p.Do(loaded.fifo_order);
+        p.Do(loaded.userdata);
+        p.Do(loaded.type);
+        if (slot >= slot_count || slot_used[slot]) {
+            LOG_ERROR(Core_Timing, "Save state contains an invalid event slot");
+            p.SetError(PointerWrap::ERROR_FAILURE);
+            return;
+        }
+        if (loaded.type < 0 || static_cast<u32>(loaded.type) >= type_count ||
+            type_remap[loaded.type] == -1) {
+            LOG_ERROR(Core_Timing, "Save state contains an event of an unknown type");
+            p.SetError(PointerWrap::ERROR_FAILURE);
+            return;
+        }
+
+        Event& event = events[slot];
+        event.time = loaded.time;
+        event.fifo_order = loaded.fifo_order;
+        event.userdata = loaded.userdata;
+        event.type = type_remap[loaded.type];
+        slot_used[slot] = true;
+        PushEvent(slot);
+    }
+
+    free_slots.clear();
+    for (u32 slot = slot_count; slot-- > 0;) {
+        if (!slot_used[slot])
+            free_slots.push_back(slot);
+    }
+}
+
 } // namespace
@@ -60,8 +60,15 @@ inline u64 cyclesToMs(s64 cycles) {
     return cycles / (g_clock_rate_arm11 / 1000);
 }
 
+class PointerWrap;
+
 namespace CoreTiming {
-void Init();
+/**
+ * Initializes the timing state
+ * @param cpu_downcount Counter of the cycles left in the current slice, which the CPU decrements
+ *                      as it executes and which is kept alive until Shutdown
+ */
+void Init(s64& cpu_downcount);
 void Shutdown();
 
 typedef void (*MHzChangeCallback)();
@@ -82,6 +89,13 @@ int RegisterEvent(const char* name, TimedCallback callback);
 void RestoreRegisterEvent(int event_type, const char* name, TimedCallback callback);
 void UnregisterAllEvents();
 
+/**
+ * Identifies a scheduled event, allowing to unschedule it in constant time. Handles stay valid
+ * across save states and never compare equal to 0, handles of events which have already fired
+ * or were unscheduled are ignored.
+ */
+using EventHandle = u64;
+
 /// userdata MAY NOT CONTAIN POINTERS. userdata might get written and reloaded from disk,
 /// when we implement state saves.
 /**
@@ -91,8 +105,9 @@ void UnregisterAllEvents();
  * @param cycles_into_future The number of cycles after which this event will be fired
  * @param event_type The event type to fire, as returned from RegisterEvent
  * @param userdata Optional parameter to pass to the callback when fired
+ * @returns A handle which can be passed to UnscheduleEvent
  */
-void ScheduleEvent(s64 cycles_into_future, int event_type, u64 userdata = 0);
+EventHandle ScheduleEvent(s64 cycles_into_future, int event_type, u64 userdata = 0);
 
 void ScheduleEvent_Threadsafe(s64 cycles_into_future, int event_type, u64 userdata = 0);
 void ScheduleEvent_Threadsafe_Immediate(int event_type, u64 userdata = 0);
@@ -105,6 +120,13 @@ void ScheduleEvent_Threadsafe_Immediate(int event_type, u64 userdata = 0);
  */
 s64 UnscheduleEvent(int event_type, u64 userdata);
 
+/**
+ * Unschedules the event with the specified handle, if it is still pending
+ * @param handle The handle of the event, as returned from ScheduleEvent
+ * @returns The remaining ticks until the event would have fired, or 0 if it isn't pending
+ */
+s64 UnscheduleEvent(EventHandle handle);
+
 s64 UnscheduleThreadsafeEvent(int event_type, u64 userdata);
 
 void RemoveEvent(int event_type);
@@ -135,4 +157,10 @@ void SetClockFrequencyMHz(int cpu_mhz);
 int GetClockFrequencyMHz();
 extern int g_slice_length;
 
+/**
+ * Serializes the timing state and all pending events. Event types are stored by name, so they
+ * can be matched with the ones registered by the running emulator when loading.
+ */
+void DoState(PointerWrap& p);
+
 } // namespace
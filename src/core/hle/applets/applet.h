@@ -5,6 +5,7 @@
 #pragma once
 
 #include <memory>
+#include "core/hle/kernel/vm_manager.h"
 #include "core/hle/result.h"
 #include "core/hle/service/apt/apt.h"
 
@@ -64,8 +65,8 @@ protected:
      */
     virtual ResultCode StartImpl(const Service::APT::AppletStartupParameter& parameter) = 0;
 
-    Service::APT::AppletId id;                    ///< Id of this Applet
-    std::shared_ptr<std::vector<u8>> heap_memory; ///< Heap memory for this Applet
+    Service::APT::AppletId id;                        ///< Id of this Applet
+    std::shared_ptr<Kernel::MemoryBlock> heap_memory; ///< Heap memory for this Applet
 
     /// Whether this applet is currently running instead of the host application or not.
     bool is_running = false;
@@ -3,13 +3,17 @@
 // Refer to the license.txt file included.
 
 #include <cstring>
+#include <new>
 #include "core/hle/config_mem.h"
+#include "core/memory.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 namespace ConfigMem {
 
-ConfigMemDef config_mem;
+// Mapped read-only into every process by Kernel::MapSharedPages
+ConfigMemDef& config_mem =
+    *new (Memory::AllocateBackingMemory(sizeof(ConfigMemDef))) ConfigMemDef();
 
 void Init() {
     std::memset(&config_mem, 0, sizeof(config_mem));
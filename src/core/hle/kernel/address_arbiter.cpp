@@ -6,6 +6,7 @@
 #include "common/logging/log.h"
 #include "core/hle/kernel/address_arbiter.h"
 #include "core/hle/kernel/errors.h"
+#include "core/hle/kernel/savestate.h"
 #include "core/hle/kernel/thread.h"
 #include "core/memory.h"
 
@@ -88,4 +89,8 @@ ResultCode AddressArbiter::ArbitrateAddress(ArbitrationType type, VAddr address,
     return RESULT_SUCCESS;
 }
 
+void AddressArbiter::DoState(PointerWrap& p) {
+    p.Do(name);
+}
+
 } // namespace Kernel
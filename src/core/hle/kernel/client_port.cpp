@@ -8,6 +8,7 @@
 #include "core/hle/kernel/errors.h"
 #include "core/hle/kernel/hle_ipc.h"
 #include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/savestate.h"
 #include "core/hle/kernel/server_port.h"
 #include "core/hle/kernel/server_session.h"
 
@@ -39,4 +40,11 @@ ResultVal<SharedPtr<ClientSession>> ClientPort::Connect() {
     return MakeResult(std::get<SharedPtr<ClientSession>>(sessions));
 }
 
+void ClientPort::DoState(PointerWrap& p) {
+    DoObjectRef(p, server_port);
+    p.Do(max_sessions);
+    p.Do(active_sessions);
+    p.Do(name);
+}
+
 } // namespace
@@ -29,6 +29,8 @@ public:
         return HANDLE_TYPE;
     }
 
+    void DoState(PointerWrap& p) override;
+
     /**
      * Creates a new Session pair, adds the created ServerSession to the associated ServerPort's
      * list of pending sessions, and signals the ServerPort, causing any threads
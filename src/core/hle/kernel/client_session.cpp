@@ -7,6 +7,7 @@
 #include "core/hle/kernel/client_session.h"
 #include "core/hle/kernel/errors.h"
 #include "core/hle/kernel/hle_ipc.h"
+#include "core/hle/kernel/savestate.h"
 #include "core/hle/kernel/server_session.h"
 #include "core/hle/kernel/session.h"
 #include "core/hle/kernel/thread.h"
@@ -48,4 +49,9 @@ ResultCode ClientSession::SendSyncRequest(SharedPtr<Thread> thread) {
     return server->HandleSyncRequest(std::move(thread));
 }
 
+void ClientSession::DoState(PointerWrap& p) {
+    // The endpoints of the session are matched up by Kernel::DoState
+    p.Do(name);
+}
+
 } // namespace
@@ -33,6 +33,8 @@ public:
         return HANDLE_TYPE;
     }
 
+    void DoState(PointerWrap& p) override;
+
     /**
      * Sends an SyncRequest from the current emulated thread.
      * @param thread Thread that initiated the request.
@@ -31,6 +31,8 @@ public:
         return HANDLE_TYPE;
     }
 
+    void DoState(PointerWrap& p) override;
+
     ResetType reset_type; ///< Current ResetType
 
     bool signaled;    ///< Whether the event has already been signaled
@@ -9,6 +9,7 @@
 #include "core/hle/kernel/handle_table.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/process.h"
+#include "core/hle/kernel/savestate.h"
 #include "core/hle/kernel/thread.h"
 
 namespace Kernel {
@@ -94,4 +95,13 @@ void HandleTable::Clear() {
     next_free_slot = 0;
 }
 
+void HandleTable::DoState(PointerWrap& p) {
+    for (auto& object : objects) {
+        DoObjectRef(p, object);
+    }
+    p.DoArray(generations.data(), static_cast<int>(generations.size()));
+    p.Do(next_generation);
+    p.Do(next_free_slot);
+}
+
 } // namespace
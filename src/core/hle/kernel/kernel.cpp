@@ -15,9 +15,33 @@
 namespace Kernel {
 
 unsigned int Object::next_object_id;
+Object* Object::first_object;
+
+Object::Object() {
+    next_object = first_object;
+    if (first_object != nullptr) {
+        first_object->prev_object = this;
+    }
+    first_object = this;
+}
+
+Object::~Object() {
+    if (prev_object != nullptr) {
+        prev_object->next_object = next_object;
+    } else {
+        first_object = next_object;
+    }
+    if (next_object != nullptr) {
+        next_object->prev_object = prev_object;
+    }
+}
 
 /// Initialize the kernel
 void Init(u32 system_mode) {
+    // Object ids are assigned from 0 on every boot, so that objects created while booting the same
+    // title get the same ids. Save states rely on this to find these objects again.
+    Object::next_object_id = 0;
+
     ConfigMem::Init();
     SharedPage::Init();
 
@@ -27,7 +51,6 @@ void Init(u32 system_mode) {
     Kernel::ThreadingInit();
     Kernel::TimersInit();
 
-    Object::next_object_id = 0;
     // TODO(Subv): Start the process ids from 10 for now, as lower PIDs are
     // reserved for low-level services
     Process::next_process_id = 10;
@@ -10,6 +10,8 @@
 #include <boost/smart_ptr/intrusive_ptr.hpp>
 #include "common/common_types.h"
 
+class PointerWrap;
+
 namespace Kernel {
 
 using Handle = u32;
@@ -44,7 +46,8 @@ enum class ResetType {
 
 class Object : NonCopyable {
 public:
-    virtual ~Object() {}
+    Object();
+    virtual ~Object();
 
     /// Returns a unique identifier for the object. For debugging purposes only.
     unsigned int GetObjectId() const {
@@ -59,6 +62,13 @@ public:
     }
     virtual Kernel::HandleType GetHandleType() const = 0;
 
+    /**
+     * Serializes the state of the object for save states. When loading, the object has either
+     * existed before or has just been created for the save state, see Kernel::DoState.
+     * References to other kernel objects are serialized with Kernel::DoObjectRef.
+     */
+    virtual void DoState(PointerWrap& p) = 0;
+
     /**
      * Check if a thread can wait on the object
      * @return True if a thread can wait on the object, otherwise false
@@ -89,10 +99,25 @@ public:
 public:
     static unsigned int next_object_id;
 
+    /// Returns the first object of the list of all existing kernel objects
+    static Object* GetFirstObject() {
+        return first_object;
+    }
+
+    /// Returns the next object of the list of all existing kernel objects
+    Object* GetNextObject() const {
+        return next_object;
+    }
+
 private:
     friend void intrusive_ptr_add_ref(Object*);
     friend void intrusive_ptr_release(Object*);
 
+    /// Intrusive list of all existing objects, used to find them by their id in save states
+    static Object* first_object;
+    Object* prev_object = nullptr;
+    Object* next_object = nullptr;
+
     unsigned int ref_count = 0;
     unsigned int object_id = next_object_id++;
 };
@@ -10,6 +10,7 @@
 #include <vector>
 #include "audio_core/audio_core.h"
 #include "common/assert.h"
+#include "common/chunk_file.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
 #include "core/hle/config_mem.h"
@@ -54,7 +55,7 @@ void MemoryInit(u32 mem_type) {
         memory_regions[i].base = base;
         memory_regions[i].size = memory_region_sizes[mem_type][i];
         memory_regions[i].used = 0;
-        memory_regions[i].linear_heap_memory = std::make_shared<std::vector<u8>>();
+        memory_regions[i].linear_heap_memory = std::make_shared<MemoryBlock>();
         // Reserve enough space for this region of FCRAM.
         // We do not want this block of memory to be relocated when allocating from it.
         memory_regions[i].linear_heap_memory->reserve(memory_regions[i].size);
@@ -96,8 +97,44 @@ MemoryRegionInfo* GetMemoryRegion(MemoryRegion region) {
     }
 }
 
-std::array<u8, Memory::VRAM_SIZE> vram;
-std::array<u8, Memory::N3DS_EXTRA_RAM_SIZE> n3ds_extra_ram;
+// Backing memory is page-aligned and zeroed, like the rest of emulated memory
+u8* const vram = Memory::AllocateBackingMemory(Memory::VRAM_SIZE);
+u8* const n3ds_extra_ram = Memory::AllocateBackingMemory(Memory::N3DS_EXTRA_RAM_SIZE);
+
+void MemoryDoState(PointerWrap& p) {
+    for (auto& region : memory_regions) {
+        u32 base = region.base;
+        u32 size = region.size;
+        p.Do(base);
+        p.Do(size);
+        if (base != region.base || size != region.size) {
+            LOG_ERROR(Kernel, "Save state uses a different memory layout");
+            p.SetError(PointerWrap::ERROR_FAILURE);
+            return;
+        }
+        p.Do(region.used);
+
+        // The linear heap is resized in place, its storage was reserved to the size of the region
+        // and must not move as it is mapped into the address space.
+        auto& heap = *region.linear_heap_memory;
+        u32 heap_size = static_cast<u32>(heap.size());
+        p.Do(heap_size);
+        if (heap_size > region.size) {
+            LOG_ERROR(Kernel, "Linear heap in save state is larger than its region");
+            p.SetError(PointerWrap::ERROR_FAILURE);
+            return;
+        }
+        if (p.GetMode() == PointerWrap::MODE_READ) {
+            heap.resize(heap_size);
+        }
+        p.DoArray(heap.data(), heap_size);
+    }
+
+    p.DoArray(vram, static_cast<int>(Memory::VRAM_SIZE));
+    p.DoArray(n3ds_extra_ram, static_cast<int>(Memory::N3DS_EXTRA_RAM_SIZE));
+    p.DoVoid(&ConfigMem::config_mem, sizeof(ConfigMem::config_mem));
+    p.DoVoid(&SharedPage::shared_page, sizeof(SharedPage::shared_page));
+}
 
 void HandleSpecialMapping(VMManager& address_space, const AddressMapping& mapping) {
     using namespace Memory;
@@ -148,13 +185,13 @@ void HandleSpecialMapping(VMManager& address_space, const AddressMapping& mappin
     u8* target_pointer = nullptr;
     switch (area->paddr_base) {
     case VRAM_PADDR:
-        target_pointer = vram.data();
+        target_pointer = vram;
         break;
     case DSP_RAM_PADDR:
         target_pointer = AudioCore::GetDspMemory().data();
         break;
     case N3DS_EXTRA_RAM_PADDR:
-        target_pointer = n3ds_extra_ram.data();
+        target_pointer = n3ds_extra_ram;
         break;
     default:
         UNREACHABLE();
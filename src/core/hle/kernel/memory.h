@@ -8,6 +8,8 @@
 #include "common/common_types.h"
 #include "core/hle/kernel/process.h"
 
+class PointerWrap;
+
 namespace Kernel {
 
 class VMManager;
@@ -17,13 +19,19 @@ struct MemoryRegionInfo {
     u32 size;
     u32 used;
 
-    std::shared_ptr<std::vector<u8>> linear_heap_memory;
+    std::shared_ptr<MemoryBlock> linear_heap_memory;
 };
 
 void MemoryInit(u32 mem_type);
 void MemoryShutdown();
 MemoryRegionInfo* GetMemoryRegion(MemoryRegion region);
 
+/**
+ * Serializes the contents of the linear heap of each memory region, VRAM, the N3DS extra RAM, the
+ * config memory and the shared page. The memory layout has to match the one of the state.
+ */
+void MemoryDoState(PointerWrap& p);
+
 void HandleSpecialMapping(VMManager& address_space, const AddressMapping& mapping);
 void MapSharedPages(VMManager& address_space);
 } // namespace Kernel
@@ -9,6 +9,7 @@
 #include "core/core.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/mutex.h"
+#include "core/hle/kernel/savestate.h"
 #include "core/hle/kernel/thread.h"
 
 namespace Kernel {
@@ -102,4 +103,12 @@ void Mutex::UpdatePriority() {
     }
 }
 
+void Mutex::DoState(PointerWrap& p) {
+    WaitObject::DoState(p);
+    p.Do(lock_count);
+    p.Do(priority);
+    p.Do(name);
+    DoObjectRef(p, holding_thread);
+}
+
 } // namespace
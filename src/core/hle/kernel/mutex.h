@@ -35,6 +35,8 @@ public:
         return HANDLE_TYPE;
     }
 
+    void DoState(PointerWrap& p) override;
+
     int lock_count;                   ///< Number of times the mutex has been acquired
     u32 priority;                     ///< The priority of the mutex, used for priority inheritance.
     std::string name;                 ///< Name of mutex (optional)
@@ -10,6 +10,7 @@
 #include "core/hle/kernel/memory.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/resource_limit.h"
+#include "core/hle/kernel/savestate.h"
 #include "core/hle/kernel/thread.h"
 #include "core/hle/kernel/vm_manager.h"
 #include "core/memory.h"
@@ -28,6 +29,24 @@ SharedPtr<CodeSet> CodeSet::Create(std::string name, u64 program_id) {
 CodeSet::CodeSet() {}
 CodeSet::~CodeSet() {}
 
+static void DoSegment(PointerWrap& p, CodeSet::Segment& segment) {
+    u32 offset = static_cast<u32>(segment.offset);
+    p.Do(offset);
+    segment.offset = offset;
+    p.Do(segment.addr);
+    p.Do(segment.size);
+}
+
+void CodeSet::DoState(PointerWrap& p) {
+    p.Do(name);
+    p.Do(program_id);
+    DoMemoryBlock(p, memory);
+    DoSegment(p, code);
+    DoSegment(p, rodata);
+    DoSegment(p, data);
+    p.Do(entrypoint);
+}
+
 u32 Process::next_process_id;
 
 SharedPtr<Process> Process::Create(SharedPtr<CodeSet> code_set) {
@@ -134,7 +153,7 @@ void Process::Run(s32 main_thread_priority, u32 stack_size) {
     // Allocate and map stack
     vm_manager
         .MapMemoryBlock(Memory::HEAP_VADDR_END - stack_size,
-                        std::make_shared<std::vector<u8>>(stack_size, 0), 0, stack_size,
+                        std::make_shared<MemoryBlock>(stack_size, 0), 0, stack_size,
                         MemoryState::Locked)
         .Unwrap();
     misc_memory_used += stack_size;
@@ -172,7 +191,7 @@ ResultVal<VAddr> Process::HeapAllocate(VAddr target, u32 size, VMAPermission per
 
     if (heap_memory == nullptr) {
         // Initialize heap
-        heap_memory = std::make_shared<std::vector<u8>>();
+        heap_memory = std::make_shared<MemoryBlock>();
         heap_start = heap_end = target;
     }
 
@@ -296,6 +315,87 @@ ResultCode Process::LinearFree(VAddr target, u32 size) {
     return RESULT_SUCCESS;
 }
 
+void Process::DoState(PointerWrap& p) {
+    DoObjectRef(p, codeset);
+    DoObjectRef(p, resource_limit);
+
+    std::string svc_access = svc_access_mask.to_string();
+    p.Do(svc_access);
+    if (p.GetMode() == PointerWrap::MODE_READ) {
+        if (svc_access.size() != svc_access_mask.size() ||
+            svc_access.find_first_not_of("01") != std::string::npos) {
+            LOG_ERROR(Kernel, "Invalid SVC access mask in save state");
+            p.SetError(PointerWrap::ERROR_FAILURE);
+            return;
+        }
+        svc_access_mask = decltype(svc_access_mask)(svc_access);
+    }
+
+    p.Do(handle_table_size);
+
+    u32 mapping_count = static_cast<u32>(address_mappings.size());
+    p.Do(mapping_count);
+    if (mapping_count > address_mappings.capacity()) {
+        LOG_ERROR(Kernel, "Too many address mappings in save state");
+        p.SetError(PointerWrap::ERROR_FAILURE);
+        return;
+    }
+    if (p.GetMode() == PointerWrap::MODE_READ) {
+        address_mappings.resize(mapping_count);
+    }
+    for (auto& mapping : address_mappings) {
+        p.DoPOD(mapping);
+    }
+
+    p.Do(flags.raw);
+    p.Do(kernel_version);
+    p.Do(ideal_processor);
+    p.Do(process_id);
+
+    DoMemoryBlock(p, heap_memory);
+    p.Do(heap_start);
+    p.Do(heap_end);
+    p.Do(heap_used);
+    p.Do(linear_heap_used);
+    p.Do(misc_memory_used);
+
+    // The region is stored as its MemoryRegion value, or 0 if there is none
+    u16 region = 0;
+    for (u16 i = static_cast<u16>(MemoryRegion::APPLICATION);
+         i <= static_cast<u16>(MemoryRegion::BASE); ++i) {
+        if (memory_region == GetMemoryRegion(static_cast<MemoryRegion>(i))) {
+            region = i;
+        }
+    }
+    p.Do(region);
+    if (p.GetMode() == PointerWrap::MODE_READ) {
+        if (region > static_cast<u16>(MemoryRegion::BASE)) {
+            LOG_ERROR(Kernel, "Invalid memory region in save state");
+            p.SetError(PointerWrap::ERROR_FAILURE);
+            return;
+        }
+        memory_region = region == 0 ? nullptr : GetMemoryRegion(static_cast<MemoryRegion>(region));
+    }
+
+    u32 tls_page_count = static_cast<u32>(tls_slots.size());
+    p.Do(tls_page_count);
+    if (tls_page_count > Memory::FCRAM_SIZE / Memory::PAGE_SIZE) {
+        LOG_ERROR(Kernel, "Too many TLS pages in save state");
+        p.SetError(PointerWrap::ERROR_FAILURE);
+        return;
+    }
+    if (p.GetMode() == PointerWrap::MODE_READ) {
+        tls_slots.resize(tls_page_count);
+    }
+    for (auto& slots : tls_slots) {
+        u8 bits = static_cast<u8>(slots.to_ulong());
+        p.Do(bits);
+        slots = bits;
+    }
+
+    vm_manager.DoState(p);
+}
+
 Kernel::Process::Process() {}
 Kernel::Process::~Process() {}
 
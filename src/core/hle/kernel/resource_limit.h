@@ -55,6 +55,8 @@ public:
         return HANDLE_TYPE;
     }
 
+    void DoState(PointerWrap& p) override;
+
     /**
      * Gets the current value for the specified resource.
      * @param resource Requested resource type
@@ -0,0 +1,363 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "core/hle/kernel/address_arbiter.h"
+#include "core/hle/kernel/client_port.h"
+#include "core/hle/kernel/client_session.h"
+#include "core/hle/kernel/event.h"
+#include "core/hle/kernel/handle_table.h"
+#include "core/hle/kernel/hle_ipc.h"
+#include "core/hle/kernel/memory.h"
+#include "core/hle/kernel/mutex.h"
+#include "core/hle/kernel/process.h"
+#include "core/hle/kernel/resource_limit.h"
+#include "core/hle/kernel/savestate.h"
+#include "core/hle/kernel/semaphore.h"
+#include "core/hle/kernel/server_port.h"
+#include "core/hle/kernel/server_session.h"
+#include "core/hle/kernel/session.h"
+#include "core/hle/kernel/shared_memory.h"
+#include "core/hle/kernel/thread.h"
+#include "core/hle/kernel/timer.h"
+#include "core/memory.h"
+
+namespace Kernel {
+
+/// Id or index used to serialize null references
+static const u32 NULL_REFERENCE = 0xFFFFFFFF;
+
+/// Objects of the state being saved or loaded, by their id in the state
+static std::unordered_map<u32, SharedPtr<Object>> state_objects;
+
+/// Memory blocks of the state being saved or loaded, by their index in the state
+static std::vector<std::shared_ptr<MemoryBlock>> memory_blocks;
+static std::unordered_map<const MemoryBlock*, u32> memory_block_indices;
+
+/// Entry of the object table, which lists the objects of a state before their contents
+struct ObjectEntry {
+    u32 id;
+    HandleType type;
+    std::string name;
+    /// For sessions, the id of the ClientPort the session was created from
+    u32 port_id = NULL_REFERENCE;
+    /// For sessions, the id of the other endpoint, which is null if it has been closed
+    u32 peer_id = NULL_REFERENCE;
+};
+
+static u32 GetId(const Object* object) {
+    return object == nullptr ? NULL_REFERENCE : object->GetObjectId();
+}
+
+static void GetSessionPeers(const Object* object, u32& port_id, u32& peer_id) {
+    std::shared_ptr<Session> parent;
+    if (object->GetHandleType() == HandleType::ClientSession) {
+        parent = static_cast<const ClientSession*>(object)->parent;
+        peer_id = GetId(parent->server);
+    } else if (object->GetHandleType() == HandleType::ServerSession) {
+        parent = static_cast<const ServerSession*>(object)->parent;
+        peer_id = GetId(parent->client);
+    } else {
+        return;
+    }
+    port_id = GetId(parent->port.get());
+}
+
+/// Returns all existing objects by id. Objects left over from a previous boot can share their id
+/// with a newer object, the newest one is used then.
+static std::map<u32, SharedPtr<Object>> GetExistingObjects() {
+    std::map<u32, SharedPtr<Object>> objects;
+    for (Object* object = Object::GetFirstObject(); object != nullptr;
+         object = object->GetNextObject()) {
+        // The list starts with the newest object
+        objects.emplace(object->GetObjectId(), object);
+    }
+    return objects;
+}
+
+static bool DoObjectTable(PointerWrap& p, std::vector<ObjectEntry>& entries) {
+    u32 count = static_cast<u32>(entries.size());
+    p.Do(count);
+    if (p.GetMode() == PointerWrap::MODE_READ) {
+        entries.clear();
+    }
+    for (u32 i = 0; i < count && p.error != PointerWrap::ERROR_FAILURE; ++i) {
+        if (p.GetMode() == PointerWrap::MODE_READ) {
+            entries.emplace_back();
+        }
+        ObjectEntry& entry = entries[i];
+        p.Do(entry.id);
+        p.Do(entry.type);
+        p.Do(entry.name);
+        p.Do(entry.port_id);
+        p.Do(entry.peer_id);
+    }
+    return p.error != PointerWrap::ERROR_FAILURE;
+}
+
+/// Creates an object for an entry of the state which doesn't exist anymore, or null on failure
+static SharedPtr<Object> CreateObject(const ObjectEntry& entry) {
+    switch (entry.type) {
+    case HandleType::Event:
+        return Event::Create(ResetType::OneShot, entry.name);
+    case HandleType::Mutex:
+        return Mutex::Create(false, entry.name);
+    case HandleType::Semaphore:
+        return Semaphore::Create(0, 1, entry.name).Unwrap();
+    case HandleType::Timer:
+        return Timer::Create(ResetType::OneShot, entry.name);
+    case HandleType::AddressArbiter:
+        return AddressArbiter::Create(entry.name);
+    case HandleType::ResourceLimit:
+        return ResourceLimit::Create(entry.name);
+    case HandleType::SharedMemory:
+        return SharedMemory::CreateForSaveState();
+    case HandleType::Thread:
+        return Thread::CreateForSaveState();
+    case HandleType::ServerPort:
+        return std::get<0>(ServerPort::CreatePortPair(0, entry.name));
+    case HandleType::ClientPort:
+        return std::get<1>(ServerPort::CreatePortPair(0, entry.name));
+    default:
+        LOG_ERROR(Kernel, "Object %u (%s) of type %u can't be recreated", entry.id,
+                  entry.name.c_str(), static_cast<u32>(entry.type));
+        return nullptr;
+    }
+}
+
+/**
+ * Recreates a session which doesn't exist anymore. Both endpoints are recreated together, which is
+ * only possible for sessions to HLE services, by connecting to the port of the service again.
+ */
+static bool CreateSession(const ObjectEntry& entry,
+                          const std::unordered_map<u32, const ObjectEntry*>& entries) {
+    auto peer = entries.find(entry.peer_id);
+    auto port = state_objects.find(entry.port_id);
+    if (peer == entries.end() || peer->second->type == entry.type ||
+        peer->second->peer_id != entry.id || state_objects.count(entry.peer_id) != 0 ||
+        port == state_objects.end() || port->second->GetHandleType() != HandleType::ClientPort) {
+        LOG_ERROR(Kernel, "Session %u (%s) can't be recreated", entry.id, entry.name.c_str());
+        return false;
+    }
+
+    auto client_port = boost::static_pointer_cast<ClientPort>(port->second);
+    auto hle_handler = client_port->server_port->hle_handler;
+    if (hle_handler == nullptr) {
+        LOG_ERROR(Kernel, "Session %u (%s) doesn't belong to an HLE service", entry.id,
+                  entry.name.c_str());
+        return false;
+    }
+
+    SharedPtr<ServerSession> server;
+    SharedPtr<ClientSession> client;
+    std::tie(server, client) =
+        ServerSession::CreateSessionPair(client_port->server_port->GetName(), client_port);
+    hle_handler->ClientConnected(server);
+
+    bool is_client = entry.type == HandleType::ClientSession;
+    state_objects.emplace(entry.id, is_client ? SharedPtr<Object>(client) : server);
+    state_objects.emplace(entry.peer_id, is_client ? SharedPtr<Object>(server) : client);
+    return true;
+}
+
+/// Finds or creates the objects for all entries of a loaded object table
+static bool ResolveObjects(const std::vector<ObjectEntry>& entries,
+                           std::vector<SharedPtr<Object>>& orphans) {
+    std::map<u32, SharedPtr<Object>> existing = GetExistingObjects();
+
+    // Objects with the same id and type are restored in place
+    for (const ObjectEntry& entry : entries) {
+        auto object = existing.find(entry.id);
+        if (object == existing.end() || object->second->GetHandleType() != entry.type) {
+            continue;
+        }
+        u32 port_id = NULL_REFERENCE;
+        u32 peer_id = NULL_REFERENCE;
+        GetSessionPeers(object->second.get(), port_id, peer_id);
+        if (port_id != entry.port_id || peer_id != entry.peer_id) {
+            LOG_ERROR(Kernel, "Session %u (%s) is connected differently in the save state",
+                      entry.id, entry.name.c_str());
+            return false;
+        }
+        state_objects.emplace(entry.id, std::move(object->second));
+        existing.erase(object);
+    }
+
+    // Everything else doesn't exist anymore and has to be recreated
+    std::unordered_map<u32, const ObjectEntry*> entries_by_id;
+    for (const ObjectEntry& entry : entries) {
+        entries_by_id.emplace(entry.id, &entry);
+    }
+    for (const ObjectEntry& entry : entries) {
+        if (state_objects.count(entry.id) != 0) {
+            continue;
+        }
+        if (entry.type == HandleType::ClientSession || entry.type == HandleType::ServerSession) {
+            if (!CreateSession(entry, entries_by_id)) {
+                return false;
+            }
+            continue;
+        }
+        SharedPtr<Object> object = CreateObject(entry);
+        if (object == nullptr) {
+            return false;
+        }
+        state_objects.emplace(entry.id, std::move(object));
+    }
+
+    // Objects which aren't part of the state are released once loading is done. Sessions are
+    // detached from their ports first, as the session counts of the ports have been restored.
+    for (auto& pair : existing) {
+        SharedPtr<Object>& object = pair.second;
+        if (object->GetHandleType() == HandleType::ClientSession) {
+            static_cast<ClientSession*>(object.get())->parent->port = nullptr;
+        } else if (object->GetHandleType() == HandleType::ServerSession) {
+            static_cast<ServerSession*>(object.get())->parent->port = nullptr;
+        }
+        orphans.push_back(std::move(object));
+    }
+    return true;
+}
+
+void DoState(PointerWrap& p) {
+    auto section = p.Section("Kernel", 2);
+    if (!section) {
+        return;
+    }
+
+    MemoryDoState(p);
+
+    // The linear heaps are always the first memory blocks, their contents have just been restored
+    for (MemoryRegion region : {MemoryRegion::APPLICATION, MemoryRegion::SYSTEM,
+                                MemoryRegion::BASE}) {
+        auto& block = GetMemoryRegion(region)->linear_heap_memory;
+        memory_block_indices.emplace(block.get(), static_cast<u32>(memory_blocks.size()));
+        memory_blocks.push_back(block);
+    }
+
+    std::vector<ObjectEntry> entries;
+    std::vector<SharedPtr<Object>> orphans;
+    if (p.GetMode() != PointerWrap::MODE_READ) {
+        for (auto& pair : GetExistingObjects()) {
+            ObjectEntry entry;
+            entry.id = pair.first;
+            entry.type = pair.second->GetHandleType();
+            entry.name = pair.second->GetName();
+            GetSessionPeers(pair.second.get(), entry.port_id, entry.peer_id);
+            entries.push_back(std::move(entry));
+            state_objects.emplace(pair.first, std::move(pair.second));
+        }
+    }
+
+    if (DoObjectTable(p, entries) &&
+        (p.GetMode() != PointerWrap::MODE_READ || ResolveObjects(entries, orphans))) {
+        for (const ObjectEntry& entry : entries) {
+            state_objects[entry.id]->DoState(p);
+        }
+
+        g_handle_table.DoState(p);
+        ThreadingDoState(p);
+        TimersDoState(p);
+        DoObjectRef(p, g_current_process);
+        p.Do(Process::next_process_id);
+    } else {
+        p.SetError(PointerWrap::ERROR_FAILURE);
+    }
+
+    state_objects.clear();
+    memory_blocks.clear();
+    memory_block_indices.clear();
+}
+
+void DoObjectRef(PointerWrap& p, SharedPtr<Object>& object) {
+    u32 id = GetId(object.get());
+    p.Do(id);
+
+    if (p.GetMode() == PointerWrap::MODE_READ) {
+        if (id == NULL_REFERENCE) {
+            object = nullptr;
+            return;
+        }
+        auto it = state_objects.find(id);
+        if (it == state_objects.end()) {
+            LOG_ERROR(Kernel, "Save state references unknown object %u", id);
+            p.SetError(PointerWrap::ERROR_FAILURE);
+            return;
+        }
+        object = it->second;
+    } else if (object != nullptr) {
+        auto it = state_objects.find(id);
+        if (it == state_objects.end() || it->second != object) {
+            LOG_ERROR(Kernel, "Object %u (%s) is not part of the save state", id,
+                      object->GetName().c_str());
+            p.SetError(PointerWrap::ERROR_FAILURE);
+        }
+    }
+}
+
+void DoMemoryBlock(PointerWrap& p, std::shared_ptr<MemoryBlock>& block) {
+    if (p.GetMode() != PointerWrap::MODE_READ) {
+        u32 index = NULL_REFERENCE;
+        bool is_new = false;
+        if (block != nullptr) {
+            auto it = memory_block_indices.find(block.get());
+            is_new = it == memory_block_indices.end();
+            if (is_new) {
+                index = static_cast<u32>(memory_blocks.size());
+                memory_block_indices.emplace(block.get(), index);
+                memory_blocks.push_back(block);
+            } else {
+                index = it->second;
+            }
+        }
+        p.Do(index);
+        if (is_new) {
+            u32 size = static_cast<u32>(block->size());
+            p.Do(size);
+            p.DoArray(block->data(), size);
+        }
+        return;
+    }
+
+    u32 index = NULL_REFERENCE;
+    p.Do(index);
+    if (index == NULL_REFERENCE) {
+        block = nullptr;
+        return;
+    }
+    if (index < memory_blocks.size()) {
+        block = memory_blocks[index];
+        return;
+    }
+    if (index != memory_blocks.size()) {
+        LOG_ERROR(Kernel, "Invalid memory block %u in save state", index);
+        p.SetError(PointerWrap::ERROR_FAILURE);
+        return;
+    }
+
+    u32 size = 0;
+    p.Do(size);
+    if (size > Memory::FCRAM_SIZE) {
+        LOG_ERROR(Kernel, "Memory block %u in save state is too large", index);
+        p.SetError(PointerWrap::ERROR_FAILURE);
+        return;
+    }
+
+    // The current block is reused if it isn't part of the state yet, as it may also be referenced
+    // from outside of the kernel (e.g. by HLE applets)
+    if (block == nullptr || memory_block_indices.count(block.get()) != 0) {
+        block = std::make_shared<MemoryBlock>();
+    }
+    block->resize(size);
+    p.DoArray(block->data(), size);
+
+    memory_block_indices.emplace(block.get(), index);
+    memory_blocks.push_back(block);
+}
+
+} // namespace Kernel
@@ -0,0 +1,73 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "common/chunk_file.h"
+#include "common/common_types.h"
+#include "common/logging/log.h"
+#include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/vm_manager.h"
+
+namespace Kernel {
+
+/**
+ * Serializes the kernel state: the FCRAM regions, all kernel objects and the handle tables and
+ * scheduler queues referring to them.
+ *
+ * Objects are identified by their object id. When loading, objects which exist with the same id
+ * and type are restored in place, which keeps the references HLE services hold to them intact.
+ * This always works for objects created while booting the title, as their ids are assigned in the
+ * same order on every boot. Other objects are recreated if their type supports it, otherwise
+ * loading fails.
+ */
+void DoState(PointerWrap& p);
+
+/// Serializes a reference to a kernel object, which has to be part of the state (or null)
+void DoObjectRef(PointerWrap& p, SharedPtr<Object>& object);
+
+template <typename T>
+void DoObjectRef(PointerWrap& p, SharedPtr<T>& object) {
+    SharedPtr<Object> generic = object;
+    DoObjectRef(p, generic);
+    if (p.GetMode() == PointerWrap::MODE_READ) {
+        object = DynamicObjectCast<T>(generic);
+        if (generic != nullptr && object == nullptr) {
+            LOG_ERROR(Kernel, "Save state references object %u with an unexpected type",
+                      generic->GetObjectId());
+            p.SetError(PointerWrap::ERROR_FAILURE);
+        }
+    }
+}
+
+/// Serializes a container (vector or flat_set) of references to kernel objects
+template <typename Container>
+void DoObjectRefs(PointerWrap& p, Container& objects) {
+    using T = typename Container::value_type::element_type;
+
+    u32 count = static_cast<u32>(objects.size());
+    p.Do(count);
+    if (p.GetMode() == PointerWrap::MODE_READ) {
+        objects.clear();
+        for (u32 i = 0; i < count && p.GetMode() == PointerWrap::MODE_READ; ++i) {
+            SharedPtr<T> object;
+            DoObjectRef(p, object);
+            objects.insert(objects.end(), std::move(object));
+        }
+    } else {
+        for (SharedPtr<T> object : objects) {
+            DoObjectRef(p, object);
+        }
+    }
+}
+
+/**
+ * Serializes a reference to a memory block backing emulated memory. Blocks can be shared by
+ * several VMAs and kernel objects, their contents are only written for the first reference.
+ */
+void DoMemoryBlock(PointerWrap& p, std::shared_ptr<MemoryBlock>& block);
+
+} // namespace Kernel
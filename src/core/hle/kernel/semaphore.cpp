@@ -5,6 +5,7 @@
 #include "common/assert.h"
 #include "core/hle/kernel/errors.h"
 #include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/savestate.h"
 #include "core/hle/kernel/semaphore.h"
 #include "core/hle/kernel/thread.h"
 
@@ -52,4 +53,11 @@ ResultVal<s32> Semaphore::Release(s32 release_count) {
     return MakeResult<s32>(previous_count);
 }
 
+void Semaphore::DoState(PointerWrap& p) {
+    WaitObject::DoState(p);
+    p.Do(max_count);
+    p.Do(available_count);
+    p.Do(name);
+}
+
 } // namespace
@@ -7,6 +7,7 @@
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/errors.h"
 #include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/savestate.h"
 #include "core/hle/kernel/server_port.h"
 #include "core/hle/kernel/server_session.h"
 #include "core/hle/kernel/thread.h"
@@ -50,4 +51,10 @@ std::tuple<SharedPtr<ServerPort>, SharedPtr<ClientPort>> ServerPort::CreatePortP
     return std::make_tuple(std::move(server_port), std::move(client_port));
 }
 
+void ServerPort::DoState(PointerWrap& p) {
+    WaitObject::DoState(p);
+    p.Do(name);
+    DoObjectRefs(p, pending_sessions);
+}
+
 } // namespace
@@ -7,6 +7,7 @@
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/client_session.h"
 #include "core/hle/kernel/hle_ipc.h"
+#include "core/hle/kernel/savestate.h"
 #include "core/hle/kernel/server_session.h"
 #include "core/hle/kernel/session.h"
 #include "core/hle/kernel/thread.h"
@@ -100,4 +101,14 @@ ResultCode TranslateHLERequest(ServerSession* server_session) {
     // TODO(Subv): Implement this function once multiple concurrent processes are supported.
     return RESULT_SUCCESS;
 }
+
+void ServerSession::DoState(PointerWrap& p) {
+    // The endpoints of the session are matched up by Kernel::DoState, the HLE handler is restored
+    // when the session is recreated.
+    WaitObject::DoState(p);
+    p.Do(name);
+    DoObjectRefs(p, pending_requesting_threads);
+    DoObjectRef(p, currently_handling);
+}
+
 } // namespace Kernel
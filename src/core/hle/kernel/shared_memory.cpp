@@ -6,6 +6,7 @@
 #include "common/logging/log.h"
 #include "core/hle/kernel/errors.h"
 #include "core/hle/kernel/memory.h"
+#include "core/hle/kernel/savestate.h"
 #include "core/hle/kernel/shared_memory.h"
 #include "core/memory.h"
 
@@ -60,7 +61,7 @@ SharedPtr<SharedMemory> SharedMemory::Create(SharedPtr<Process> owner_process, u
         // The memory is already available and mapped in the owner process.
         auto vma = vm_manager.FindVMA(address)->second;
         // Copy it over to our own storage
-        shared_memory->backing_block = std::make_shared<std::vector<u8>>(
+        shared_memory->backing_block = std::make_shared<MemoryBlock>(
             vma.backing_block->data() + vma.offset, vma.backing_block->data() + vma.offset + size);
         shared_memory->backing_block_offset = 0;
         // Unmap the existing pages
@@ -76,7 +77,7 @@ SharedPtr<SharedMemory> SharedMemory::Create(SharedPtr<Process> owner_process, u
     return shared_memory;
 }
 
-SharedPtr<SharedMemory> SharedMemory::CreateForApplet(std::shared_ptr<std::vector<u8>> heap_block,
+SharedPtr<SharedMemory> SharedMemory::CreateForApplet(std::shared_ptr<MemoryBlock> heap_block,
                                                       u32 offset, u32 size,
                                                       MemoryPermission permissions,
                                                       MemoryPermission other_permissions,
@@ -95,6 +96,10 @@ SharedPtr<SharedMemory> SharedMemory::CreateForApplet(std::shared_ptr<std::vecto
     return shared_memory;
 }
 
+SharedPtr<SharedMemory> SharedMemory::CreateForSaveState() {
+    return SharedPtr<SharedMemory>(new SharedMemory);
+}
+
 ResultCode SharedMemory::Map(Process* target_process, VAddr address, MemoryPermission permissions,
                              MemoryPermission other_permissions) {
 
@@ -183,4 +188,24 @@ u8* SharedMemory::GetPointer(u32 offset) {
     return backing_block->data() + backing_block_offset + offset;
 }
 
+void SharedMemory::DoState(PointerWrap& p) {
+    DoObjectRef(p, owner_process);
+    p.Do(base_address);
+    p.Do(linear_heap_phys_address);
+    DoMemoryBlock(p, backing_block);
+    p.Do(backing_block_offset);
+    p.Do(size);
+    p.Do(permissions);
+    p.Do(other_permissions);
+    p.Do(name);
+
+    if (p.GetMode() == PointerWrap::MODE_READ &&
+        (backing_block == nullptr || backing_block_offset > backing_block->size() ||
+         size > backing_block->size() - backing_block_offset)) {
+        LOG_ERROR(Kernel, "Shared memory %u is out of the bounds of its backing block",
+                  GetObjectId());
+        p.SetError(PointerWrap::ERROR_FAILURE);
+    }
+}
+
 } // namespace
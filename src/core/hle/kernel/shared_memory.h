@@ -55,12 +55,15 @@ public:
      * block.
      * @param name Optional object name, used for debugging purposes.
      */
-    static SharedPtr<SharedMemory> CreateForApplet(std::shared_ptr<std::vector<u8>> heap_block,
+    static SharedPtr<SharedMemory> CreateForApplet(std::shared_ptr<MemoryBlock> heap_block,
                                                    u32 offset, u32 size,
                                                    MemoryPermission permissions,
                                                    MemoryPermission other_permissions,
                                                    std::string name = "Unknown Applet");
 
+    /// Creates an empty shared memory object, to be filled in by DoState when loading a state.
+    static SharedPtr<SharedMemory> CreateForSaveState();
+
     std::string GetTypeName() const override {
         return "SharedMemory";
     }
@@ -73,6 +76,8 @@ public:
         return HANDLE_TYPE;
     }
 
+    void DoState(PointerWrap& p) override;
+
     /**
      * Converts the specified MemoryPermission into the equivalent VMAPermission.
      * @param permission The MemoryPermission to convert.
@@ -112,7 +117,7 @@ public:
     /// during creation.
     PAddr linear_heap_phys_address;
     /// Backing memory for this shared memory block.
-    std::shared_ptr<std::vector<u8>> backing_block;
+    std::shared_ptr<MemoryBlock> backing_block;
     /// Offset into the backing block for this shared memory.
     u32 backing_block_offset;
     /// Size of the memory block. Page-aligned.
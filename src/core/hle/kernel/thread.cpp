@@ -20,6 +20,7 @@
 #include "core/hle/kernel/memory.h"
 #include "core/hle/kernel/mutex.h"
 #include "core/hle/kernel/process.h"
+#include "core/hle/kernel/savestate.h"
 #include "core/hle/kernel/thread.h"
 #include "core/hle/result.h"
 #include "core/memory.h"
@@ -45,7 +46,8 @@ static Kernel::HandleTable wakeup_callback_handle_table;
 static std::vector<SharedPtr<Thread>> thread_list;
 
 // Lists only ready thread ids.
-static Common::ThreadQueueList<Thread*, THREADPRIO_LOWEST + 1> ready_queue;
+static Common::ThreadQueueList<Thread, THREADPRIO_LOWEST + 1, &Thread::ready_queue_link>
+    ready_queue;
 
 static SharedPtr<Thread> current_thread;
 
@@ -79,7 +81,7 @@ static bool CheckWait_AddressArbiter(const Thread* thread, VAddr wait_address) {
 
 void Thread::Stop() {
     // Cancel any outstanding wakeup events for this thread
-    CoreTiming::UnscheduleEvent(ThreadWakeupEventType, callback_handle);
+    CancelWakeupTimer();
     wakeup_callback_handle_table.Close(callback_handle);
     callback_handle = 0;
 
@@ -169,7 +171,7 @@ static void SwitchContext(Thread* new_thread) {
                    "Thread must be ready to become running.");
 
         // Cancel any outstanding wakeup events for this thread
-        CoreTiming::UnscheduleEvent(ThreadWakeupEventType, new_thread->callback_handle);
+        new_thread->CancelWakeupTimer();
 
         current_thread = new_thread;
 
@@ -254,8 +256,17 @@ void Thread::WakeAfterDelay(s64 nanoseconds) {
     if (nanoseconds == -1)
         return;
 
+    CancelWakeupTimer();
     u64 microseconds = nanoseconds / 1000;
-    CoreTiming::ScheduleEvent(usToCycles(microseconds), ThreadWakeupEventType, callback_handle);
+    wakeup_event =
+        CoreTiming::ScheduleEvent(usToCycles(microseconds), ThreadWakeupEventType, callback_handle);
+}
+
+void Thread::CancelWakeupTimer() {
+    if (wakeup_event != 0) {
+        CoreTiming::UnscheduleEvent(wakeup_event);
+        wakeup_event = 0;
+    }
 }
 
 void Thread::ResumeFromWait() {
@@ -351,6 +362,10 @@ static void ResetThreadContext(ARM_Interface::ThreadContext& context, u32 stack_
     context.cpsr = USER32MODE | ((entry_point & 1) << 5); // Usermode and THUMB mode
 }
 
+SharedPtr<Thread> Thread::CreateForSaveState() {
+    return SharedPtr<Thread>(new Thread);
+}
+
 ResultVal<SharedPtr<Thread>> Thread::Create(std::string name, VAddr entry_point, u32 priority,
                                             u32 arg, s32 processor_id, VAddr stack_top) {
     // Check if priority is in ranged. Lowest priority -> highest priority id.
@@ -376,7 +391,6 @@ ResultVal<SharedPtr<Thread>> Thread::Create(std::string name, VAddr entry_point,
     SharedPtr<Thread> thread(new Thread);
 
     thread_list.push_back(thread);
-    ready_queue.prepare(priority);
 
     thread->thread_id = NewThreadId();
     thread->status = THREADSTATUS_DORMANT;
@@ -390,6 +404,7 @@ ResultVal<SharedPtr<Thread>> Thread::Create(std::string name, VAddr entry_point,
     thread->wait_address = 0;
     thread->name = std::move(name);
     thread->callback_handle = wakeup_callback_handle_table.Create(thread).Unwrap();
+    thread->wakeup_event = 0;
     thread->owner_process = g_current_process;
 
     // Find the next available TLS index, and mark it as used
@@ -453,8 +468,6 @@ void Thread::SetPriority(s32 priority) {
     // If thread was ready, adjust queues
     if (status == THREADSTATUS_READY)
         ready_queue.move(this, current_priority, priority);
-    else
-        ready_queue.prepare(priority);
 
     nominal_priority = current_priority = priority;
 }
@@ -472,8 +485,6 @@ void Thread::BoostPriority(s32 priority) {
     // If thread was ready, adjust queues
     if (status == THREADSTATUS_READY)
         ready_queue.move(this, current_priority, priority);
-    else
-        ready_queue.prepare(priority);
     current_priority = priority;
 }
 
@@ -543,12 +554,80 @@ void ThreadingShutdown() {
     for (auto& t : thread_list) {
         t->Stop();
     }
-    thread_list.clear();
     ready_queue.clear();
+    thread_list.clear();
 }
 
 const std::vector<SharedPtr<Thread>>& GetThreadList() {
     return thread_list;
 }
 
+void Thread::DoState(PointerWrap& p) {
+    WaitObject::DoState(p);
+    p.DoPOD(context);
+    p.Do(thread_id);
+    p.Do(status);
+    p.Do(entry_point);
+    p.Do(stack_top);
+    p.Do(nominal_priority);
+    p.Do(current_priority);
+    p.Do(last_running_ticks);
+    p.Do(processor_id);
+    p.Do(tls_address);
+    DoObjectRefs(p, held_mutexes);
+    DoObjectRefs(p, pending_mutexes);
+    DoObjectRef(p, owner_process);
+    DoObjectRefs(p, wait_objects);
+    p.Do(wait_address);
+    p.Do(wait_set_output);
+    p.Do(name);
+    p.Do(callback_handle);
+    p.Do(wakeup_event);
+
+    if (p.GetMode() == PointerWrap::MODE_READ &&
+        (nominal_priority < 0 || nominal_priority > THREADPRIO_LOWEST || current_priority < 0 ||
+         current_priority > THREADPRIO_LOWEST)) {
+        LOG_ERROR(Kernel, "Thread %u has an invalid priority", GetObjectId());
+        p.SetError(PointerWrap::ERROR_FAILURE);
+    }
+}
+
+void ThreadingDoState(PointerWrap& p) {
+    // The context of the running thread is only stored in the CPU
+    if (p.GetMode() != PointerWrap::MODE_READ && current_thread != nullptr) {
+        Core::CPU().SaveContext(current_thread->context);
+    }
+
+    // The queued threads are unlinked while they are still alive
+    if (p.GetMode() == PointerWrap::MODE_READ) {
+        ready_queue.clear();
+    }
+
+    DoObjectRefs(p, thread_list);
+
+    for (u32 priority = 0; priority <= THREADPRIO_LOWEST; ++priority) {
+        std::vector<SharedPtr<Thread>> queue;
+        if (p.GetMode() != PointerWrap::MODE_READ) {
+            const auto threads = ready_queue.get_queue(priority);
+            queue.assign(threads.begin(), threads.end());
+        }
+        DoObjectRefs(p, queue);
+
+        if (p.GetMode() == PointerWrap::MODE_READ) {
+            for (const auto& thread : queue) {
+                ready_queue.push_back(priority, thread.get());
+            }
+        }
+    }
+
+    DoObjectRef(p, current_thread);
+    p.Do(next_thread_id);
+    wakeup_callback_handle_table.DoState(p);
+
+    if (p.GetMode() == PointerWrap::MODE_READ && current_thread != nullptr) {
+        Core::CPU().LoadContext(current_thread->context);
+        Core::CPU().SetCP15Register(CP15_THREAD_URO, current_thread->GetTLSAddress());
+    }
+}
+
 } // namespace
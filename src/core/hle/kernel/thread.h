@@ -10,7 +10,9 @@
 #include <boost/container/flat_map.hpp>
 #include <boost/container/flat_set.hpp>
 #include "common/common_types.h"
+#include "common/thread_queue_list.h"
 #include "core/arm/arm_interface.h"
+#include "core/core_timing.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/wait_object.h"
 #include "core/hle/result.h"
@@ -61,6 +63,9 @@ public:
     static ResultVal<SharedPtr<Thread>> Create(std::string name, VAddr entry_point, u32 priority,
                                                u32 arg, s32 processor_id, VAddr stack_top);
 
+    /// Creates an empty thread, to be filled in by DoState when loading a state.
+    static SharedPtr<Thread> CreateForSaveState();
+
     std::string GetName() const override {
         return name;
     }
@@ -73,6 +78,8 @@ public:
         return HANDLE_TYPE;
     }
 
+    void DoState(PointerWrap& p) override;
+
     bool ShouldWait(Thread* thread) const override;
     void Acquire(Thread* thread) override;
 
@@ -121,6 +128,9 @@ public:
     */
     void WakeAfterDelay(s64 nanoseconds);
 
+    /// Unschedules the wakeup event of the thread, if any
+    void CancelWakeupTimer();
+
     /**
      * Sets the result after the thread awakens (from either WaitSynchronization SVC)
      * @param result Value to set to the returned result
@@ -205,6 +215,12 @@ public:
     /// Handle used as userdata to reference this object when inserting into the CoreTiming queue.
     Handle callback_handle;
 
+    /// The scheduled wakeup event of the thread, if any
+    CoreTiming::EventHandle wakeup_event;
+
+    /// Links of the thread in the ready queue, only used by the scheduler
+    Common::ThreadQueueListLink<Thread> ready_queue_link;
+
 private:
     Thread();
     ~Thread() override;
@@ -276,4 +292,10 @@ void ThreadingShutdown();
  */
 const std::vector<SharedPtr<Thread>>& GetThreadList();
 
+/**
+ * Serializes the thread list, the ready queue and the current thread. When loading, the context
+ * of the current thread is loaded into the CPU.
+ */
+void ThreadingDoState(PointerWrap& p);
+
 } // namespace
@@ -8,6 +8,7 @@
 #include "core/core_timing.h"
 #include "core/hle/kernel/handle_table.h"
 #include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/savestate.h"
 #include "core/hle/kernel/thread.h"
 #include "core/hle/kernel/timer.h"
 
@@ -31,6 +32,7 @@ SharedPtr<Timer> Timer::Create(ResetType reset_type, std::string name) {
     timer->initial_delay = 0;
     timer->interval_delay = 0;
     timer->callback_handle = timer_callback_handle_table.Create(timer).Unwrap();
+    timer->callback_event = 0;
 
     return timer;
 }
@@ -58,13 +60,16 @@ void Timer::Set(s64 initial, s64 interval) {
         Signal(0);
     } else {
         u64 initial_microseconds = initial / 1000;
-        CoreTiming::ScheduleEvent(usToCycles(initial_microseconds), timer_callback_event_type,
-                                  callback_handle);
+        callback_event = CoreTiming::ScheduleEvent(usToCycles(initial_microseconds),
+                                                   timer_callback_event_type, callback_handle);
     }
 }
 
 void Timer::Cancel() {
-    CoreTiming::UnscheduleEvent(timer_callback_event_type, callback_handle);
+    if (callback_event != 0) {
+        CoreTiming::UnscheduleEvent(callback_event);
+        callback_event = 0;
+    }
 }
 
 void Timer::Clear() {
@@ -89,11 +94,22 @@ void Timer::Signal(int cycles_late) {
     if (interval_delay != 0) {
         // Reschedule the timer with the interval delay
         u64 interval_microseconds = interval_delay / 1000;
-        CoreTiming::ScheduleEvent(usToCycles(interval_microseconds) - cycles_late,
-                                  timer_callback_event_type, callback_handle);
+        callback_event = CoreTiming::ScheduleEvent(usToCycles(interval_microseconds) - cycles_late,
+                                                   timer_callback_event_type, callback_handle);
     }
 }
 
+void Timer::DoState(PointerWrap& p) {
+    WaitObject::DoState(p);
+    p.Do(reset_type);
+    p.Do(signaled);
+    p.Do(name);
+    p.Do(initial_delay);
+    p.Do(interval_delay);
+    p.Do(callback_handle);
+    p.Do(callback_event);
+}
+
 /// The timer callback event, called when a timer is fired
 static void TimerCallback(u64 timer_handle, int cycles_late) {
     SharedPtr<Timer> timer =
@@ -114,4 +130,8 @@ void TimersInit() {
 
 void TimersShutdown() {}
 
+void TimersDoState(PointerWrap& p) {
+    timer_callback_handle_table.DoState(p);
+}
+
 } // namespace
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "common/common_types.h"
+#include "core/core_timing.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/wait_object.h"
 
@@ -32,6 +33,8 @@ public:
         return HANDLE_TYPE;
     }
 
+    void DoState(PointerWrap& p) override;
+
     ResetType reset_type; ///< The ResetType of this timer
 
     bool signaled;    ///< Whether the timer has been signaled or not
@@ -69,11 +72,16 @@ private:
 
     /// Handle used as userdata to reference this object when inserting into the CoreTiming queue.
     Handle callback_handle;
+
+    /// The scheduled callback event of the timer, if any
+    CoreTiming::EventHandle callback_event;
 };
 
 /// Initializes the required variables for timers
 void TimersInit();
 /// Tears down the timer variables
 void TimersShutdown();
+/// Serializes the table of timers referenced by scheduled timer events
+void TimersDoState(PointerWrap& p);
 
 } // namespace
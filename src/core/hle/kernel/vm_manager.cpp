@@ -5,6 +5,7 @@
 #include <iterator>
 #include "common/assert.h"
 #include "core/hle/kernel/errors.h"
+#include "core/hle/kernel/savestate.h"
 #include "core/hle/kernel/vm_manager.h"
 #include "core/memory.h"
 #include "core/memory_setup.h"
@@ -68,7 +69,7 @@ VMManager::VMAHandle VMManager::FindVMA(VAddr target) const {
 }
 
 ResultVal<VMManager::VMAHandle> VMManager::MapMemoryBlock(VAddr target,
-                                                          std::shared_ptr<std::vector<u8>> block,
+                                                          std::shared_ptr<MemoryBlock> block,
                                                           size_t offset, u32 size,
                                                           MemoryState state) {
     ASSERT(block != nullptr);
@@ -180,7 +181,7 @@ ResultCode VMManager::ReprotectRange(VAddr target, u32 size, VMAPermission new_p
     return RESULT_SUCCESS;
 }
 
-void VMManager::RefreshMemoryBlockMappings(const std::vector<u8>* block) {
+void VMManager::RefreshMemoryBlockMappings(const MemoryBlock* block) {
     // If this ever proves to have a noticeable performance impact, allow users of the function to
     // specify a specific range of addresses to limit the scan to.
     for (const auto& p : vma_map) {
@@ -203,6 +204,104 @@ void VMManager::LogLayout(Log::Level log_level) const {
     }
 }
 
+void VMManager::DoState(PointerWrap& p) {
+    u32 count = static_cast<u32>(vma_map.size());
+    p.Do(count);
+
+    if (p.GetMode() != PointerWrap::MODE_READ) {
+        for (auto& pair : vma_map) {
+            VirtualMemoryArea& vma = pair.second;
+            p.Do(vma.base);
+            p.Do(vma.size);
+            p.Do(vma.type);
+            p.Do(vma.permissions);
+            p.Do(vma.meminfo_state);
+            if (vma.type == VMAType::AllocatedMemoryBlock) {
+                DoMemoryBlock(p, vma.backing_block);
+                u32 offset = static_cast<u32>(vma.offset);
+                p.Do(offset);
+            }
+        }
+        return;
+    }
+
+    std::map<VAddr, VirtualMemoryArea> new_vma_map;
+    VAddr next_base = 0;
+    for (u32 i = 0; i < count && p.GetMode() == PointerWrap::MODE_READ; ++i) {
+        VirtualMemoryArea vma;
+        p.Do(vma.base);
+        p.Do(vma.size);
+        p.Do(vma.type);
+        p.Do(vma.permissions);
+        p.Do(vma.meminfo_state);
+
+        if (vma.base != next_base || vma.size == 0 || vma.size > MAX_ADDRESS - vma.base) {
+            LOG_ERROR(Kernel, "Invalid memory area %08X - %08X in save state", vma.base,
+                      vma.base + vma.size);
+            p.SetError(PointerWrap::ERROR_FAILURE);
+            return;
+        }
+        next_base = vma.base + vma.size;
+
+        switch (vma.type) {
+        case VMAType::Free:
+            break;
+        case VMAType::AllocatedMemoryBlock: {
+            DoMemoryBlock(p, vma.backing_block);
+            u32 offset = 0;
+            p.Do(offset);
+            vma.offset = offset;
+            if (vma.backing_block == nullptr || offset > vma.backing_block->size() ||
+                vma.size > vma.backing_block->size() - offset) {
+                LOG_ERROR(Kernel, "Memory area %08X is out of the bounds of its block", vma.base);
+                p.SetError(PointerWrap::ERROR_FAILURE);
+                return;
+            }
+            break;
+        }
+        case VMAType::BackingMemory:
+        case VMAType::MMIO: {
+            // These are only created while booting, so the same area must be mapped right now
+            VMAHandle current = FindVMA(vma.base);
+            if (current == vma_map.end() || current->second.type != vma.type ||
+                vma.base + vma.size > current->second.base + current->second.size) {
+                LOG_ERROR(Kernel, "Memory area %08X in save state is not mapped", vma.base);
+                p.SetError(PointerWrap::ERROR_FAILURE);
+                return;
+            }
+            u32 offset_into_vma = vma.base - current->second.base;
+            if (vma.type == VMAType::BackingMemory) {
+                vma.backing_memory = current->second.backing_memory + offset_into_vma;
+            } else {
+                vma.paddr = current->second.paddr + offset_into_vma;
+                vma.mmio_handler = current->second.mmio_handler;
+            }
+            break;
+        }
+        default:
+            LOG_ERROR(Kernel, "Invalid memory area type in save state");
+            p.SetError(PointerWrap::ERROR_FAILURE);
+            return;
+        }
+
+        new_vma_map.emplace(vma.base, std::move(vma));
+    }
+
+    if (p.GetMode() != PointerWrap::MODE_READ) {
+        return;
+    }
+    if (next_base != MAX_ADDRESS) {
+        LOG_ERROR(Kernel, "Save state doesn't cover the whole address space");
+        p.SetError(PointerWrap::ERROR_FAILURE);
+        return;
+    }
+
+    vma_map = std::move(new_vma_map);
+    for (const auto& pair : vma_map) {
+        UpdatePageTableForVMA(pair.second);
+    }
+}
+
 VMManager::VMAIter VMManager::StripIterConstness(const VMAHandle& iter) {
     // This uses a neat C++ trick to convert a const_iterator to a regular iterator, given
     // non-const access to its container.
@@ -9,10 +9,19 @@
 #include <vector>
 #include "common/common_types.h"
 #include "core/hle/result.h"
+#include "core/memory.h"
 #include "core/mmio.h"
 
+class PointerWrap;
+
 namespace Kernel {
 
+/**
+ * Host memory backing emulated memory. It is allocated with Memory::AllocateBackingMemory, so that
+ * the pages mapped from it can be mirrored into the fastmem region.
+ */
+using MemoryBlock = std::vector<u8, Memory::BackingMemoryAllocator<u8>>;
+
 enum class VMAType : u8 {
     /// VMA represents an unmapped region of the address space.
     Free,
@@ -72,7 +81,7 @@ struct VirtualMemoryArea {
 
     // Settings for type = AllocatedMemoryBlock
     /// Memory block backing this VMA.
-    std::shared_ptr<std::vector<u8>> backing_block = nullptr;
+    std::shared_ptr<MemoryBlock> backing_block = nullptr;
     /// Offset into the backing_memory the mapping starts from.
     size_t offset = 0;
 
@@ -141,7 +150,7 @@ public:
      * @param size Size of the mapping.
      * @param state MemoryState tag to attach to the VMA.
      */
-    ResultVal<VMAHandle> MapMemoryBlock(VAddr target, std::shared_ptr<std::vector<u8>> block,
+    ResultVal<VMAHandle> MapMemoryBlock(VAddr target, std::shared_ptr<MemoryBlock> block,
                                         size_t offset, u32 size, MemoryState state);
 
     /**
@@ -179,11 +188,18 @@ public:
      * Scans all VMAs and updates the page table range of any that use the given vector as backing
      * memory. This should be called after any operation that causes reallocation of the vector.
      */
-    void RefreshMemoryBlockMappings(const std::vector<u8>* block);
+    void RefreshMemoryBlockMappings(const MemoryBlock* block);
 
     /// Dumps the address space layout to the log, for debugging
     void LogLayout(Log::Level log_level) const;
 
+    /**
+     * Serializes the address space layout. Raw pointers and MMIO handlers can't be stored, so when
+     * loading, BackingMemory and MMIO areas are looked up in the current layout instead. The page
+     * table is updated to match the loaded layout.
+     */
+    void DoState(PointerWrap& p);
+
 private:
     using VMAIter = decltype(vma_map)::iterator;
 
@@ -11,6 +11,7 @@
 #include "core/hle/kernel/memory.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/resource_limit.h"
+#include "core/hle/kernel/savestate.h"
 #include "core/hle/kernel/thread.h"
 #include "core/hle/kernel/timer.h"
 #include "core/hle/shared_page.h"
@@ -96,4 +97,8 @@ const std::vector<SharedPtr<Thread>>& WaitObject::GetWaitingThreads() const {
     return waiting_threads;
 }
 
+void WaitObject::DoState(PointerWrap& p) {
+    DoObjectRefs(p, waiting_threads);
+}
+
 } // namespace Kernel
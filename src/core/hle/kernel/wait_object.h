@@ -50,6 +50,9 @@ public:
     /// Get a const reference to the waiting threads list for debug use
     const std::vector<SharedPtr<Thread>>& GetWaitingThreads() const;
 
+    /// Serializes the waiting threads list, has to be called by the DoState of derived classes
+    void DoState(PointerWrap& p) override;
+
 private:
     /// Threads waiting for this object to become available
     std::vector<SharedPtr<Thread>> waiting_threads;
@@ -7,11 +7,13 @@
 #include <cinttypes>
 #include "audio_core/hle/pipe.h"
 #include "common/assert.h"
+#include "common/chunk_file.h"
 #include "common/hash.h"
 #include "common/logging/log.h"
 #include "core/hle/ipc.h"
 #include "core/hle/kernel/event.h"
 #include "core/hle/kernel/handle_table.h"
+#include "core/hle/kernel/savestate.h"
 #include "core/hle/result.h"
 #include "core/hle/service/dsp_dsp.h"
 #include "core/memory.h"
@@ -67,6 +69,14 @@ public:
         return number >= max_number_of_interrupt_events;
     }
 
+    void DoState(PointerWrap& p) {
+        Kernel::DoObjectRef(p, zero);
+        Kernel::DoObjectRef(p, one);
+        for (auto& event : pipe) {
+            Kernel::DoObjectRef(p, event);
+        }
+    }
+
 private:
     /// Currently unknown purpose
     Kernel::SharedPtr<Kernel::Event> zero = nullptr;
@@ -602,5 +612,10 @@ Interface::~Interface() {
     interrupt_events = {};
 }
 
+void DoState(PointerWrap& p) {
+    Kernel::DoObjectRef(p, semaphore_event);
+    interrupt_events.DoState(p);
+}
+
 } // namespace DSP_DSP
 } // namespace Service
@@ -7,6 +7,8 @@
 #include <string>
 #include "core/hle/service/service.h"
 
+class PointerWrap;
+
 namespace DSP {
 namespace HLE {
 enum class DspPipe;
@@ -32,5 +34,8 @@ public:
  */
 void SignalPipeInterrupt(DSP::HLE::DspPipe pipe);
 
+/// Serializes the events registered by the application
+void DoState(PointerWrap& p);
+
 } // namespace DSP_DSP
 } // namespace Service
@@ -3,11 +3,13 @@
 // Refer to the license.txt file included.
 
 #include "common/bit_field.h"
+#include "common/chunk_file.h"
 #include "common/microprofile.h"
 #include "core/core.h"
 #include "core/hle/ipc.h"
 #include "core/hle/kernel/event.h"
 #include "core/hle/kernel/handle_table.h"
+#include "core/hle/kernel/savestate.h"
 #include "core/hle/kernel/shared_memory.h"
 #include "core/hle/result.h"
 #include "core/hle/service/gsp_gpu.h"
@@ -800,5 +802,13 @@ GSP_GPU::~GSP_GPU() {
     gpu_right_acquired = false;
 }
 
+void DoState(PointerWrap& p) {
+    Kernel::DoObjectRef(p, g_interrupt_event);
+    Kernel::DoObjectRef(p, g_shared_memory);
+    p.Do(g_thread_id);
+    p.Do(gpu_right_acquired);
+    p.Do(first_initialization);
+}
+
 } // namespace GSP
 } // namespace Service
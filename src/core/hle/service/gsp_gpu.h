@@ -11,6 +11,8 @@
 #include "core/hle/result.h"
 #include "core/hle/service/service.h"
 
+class PointerWrap;
+
 namespace Service {
 namespace GSP {
 
@@ -201,5 +203,8 @@ ResultCode SetBufferSwap(u32 screen_id, const FrameBufferInfo& info);
  */
 FrameBufferUpdate* GetFrameBufferInfo(u32 thread_id, u32 screen_index);
 
+/// Serializes the interrupt event, shared memory and GPU right of the application
+void DoState(PointerWrap& p);
+
 } // namespace GSP
 } // namespace Service
@@ -131,7 +131,7 @@ static void Initialize(Interface* self) {
 
     if (crs_buffer_ptr != crs_address) {
         // TODO(wwylele): should be memory aliasing
-        std::shared_ptr<std::vector<u8>> crs_mem = std::make_shared<std::vector<u8>>(crs_size);
+        auto crs_mem = std::make_shared<Kernel::MemoryBlock>(crs_size);
         Memory::ReadBlock(crs_buffer_ptr, crs_mem->data(), crs_size);
         result = Kernel::g_current_process->vm_manager
                      .MapMemoryBlock(crs_address, crs_mem, 0, crs_size, Kernel::MemoryState::Code)
@@ -338,7 +338,7 @@ static void LoadCRO(Interface* self, bool link_on_load_bug_fix) {
 
     if (cro_buffer_ptr != cro_address) {
         // TODO(wwylele): should be memory aliasing
-        std::shared_ptr<std::vector<u8>> cro_mem = std::make_shared<std::vector<u8>>(cro_size);
+        auto cro_mem = std::make_shared<Kernel::MemoryBlock>(cro_size);
         Memory::ReadBlock(cro_buffer_ptr, cro_mem->data(), cro_size);
         result = Kernel::g_current_process->vm_manager
                      .MapMemoryBlock(cro_address, cro_mem, 0, cro_size, Kernel::MemoryState::Code)
@@ -439,7 +439,9 @@ static void LoadCRO(Interface* self, bool link_on_load_bug_fix) {
         }
     }
 
-    Core::CPU().ClearInstructionCache();
+    // Code patched by relocations was invalidated as it was written, this drops anything left
+    // over from code previously mapped at the same address
+    Core::CPU().InvalidateCacheRange(cro_address, cro_size);
 
     LOG_INFO(Service_LDR, "CRO \"%s\" loaded at 0x%08X, fixed_end=0x%08X", cro.ModuleName().data(),
              cro_address, cro_address + fix_size);
@@ -535,7 +537,7 @@ static void UnloadCRO(Interface* self) {
         memory_synchronizer.RemoveMemoryBlock(cro_address, cro_buffer_ptr);
     }
 
-    Core::CPU().ClearInstructionCache();
+    Core::CPU().InvalidateCacheRange(cro_address, fixed_size);
 
     rb.Push(result);
 }
@@ -588,7 +590,6 @@ static void LinkCRO(Interface* self) {
     }
 
     memory_synchronizer.SynchronizeOriginalMemory();
-    Core::CPU().ClearInstructionCache();
 
     rb.Push(result);
 }
@@ -641,7 +642,6 @@ static void UnlinkCRO(Interface* self) {
     }
 
     memory_synchronizer.SynchronizeOriginalMemory();
-    Core::CPU().ClearInstructionCache();
 
     rb.Push(result);
 }
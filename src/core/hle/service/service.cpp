@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <fmt/format.h>
 #include "common/assert.h"
+#include "common/chunk_file.h"
 #include "common/logging/log.h"
 #include "common/string_util.h"
 #include "core/hle/ipc.h"
@@ -279,4 +280,14 @@ void Shutdown() {
     g_kernel_named_ports.clear();
     LOG_DEBUG(Service, "shutdown OK");
 }
+
+void DoState(PointerWrap& p) {
+    auto section = p.Section("Service", 1);
+    if (!section) {
+        return;
+    }
+
+    GSP::DoState(p);
+    DSP_DSP::DoState(p);
+}
 }
@@ -16,6 +16,8 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Namespace Service
 
+class PointerWrap;
+
 namespace Kernel {
 class ClientPort;
 class ServerPort;
@@ -255,6 +257,9 @@ void Init();
 /// Shutdown ServiceManager
 void Shutdown();
 
+/// Serializes the state HLE services keep about the running application
+void DoState(PointerWrap& p);
+
 /// Map of named ports managed by the kernel, which can be retrieved using the ConnectToPort SVC.
 extern std::unordered_map<std::string, Kernel::SharedPtr<Kernel::ClientPort>> g_kernel_named_ports;
 
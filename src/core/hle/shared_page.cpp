@@ -5,15 +5,19 @@
 #include <chrono>
 #include <cstring>
 #include <ctime>
+#include <new>
 #include "core/core_timing.h"
 #include "core/hle/service/ptm/ptm.h"
 #include "core/hle/shared_page.h"
+#include "core/memory.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 namespace SharedPage {
 
-SharedPageDef shared_page;
+// Backing memory, as the page is mapped into every process next to the config memory
+SharedPageDef& shared_page =
+    *new (Memory::AllocateBackingMemory(sizeof(SharedPageDef))) SharedPageDef();
 
 static int update_time_event;
 
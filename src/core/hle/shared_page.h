@@ -62,7 +62,7 @@ struct SharedPageDef {
 static_assert(sizeof(SharedPageDef) == Memory::SHARED_PAGE_SIZE,
               "Shared page structure size is wrong");
 
-extern SharedPageDef shared_page;
+extern SharedPageDef& shared_page;
 
 void Init();
 
@@ -106,6 +106,8 @@ static ResultCode ControlMemory(u32* out_addr, u32 operation, u32 addr0, u32 add
         } else {
             return ERR_INVALID_ADDRESS;
         }
+        // Code translated from released memory must not be executed again
+        Core::CPU().InvalidateCacheRange(addr0, size);
         *out_addr = addr0;
         break;
     }
@@ -132,6 +134,7 @@ static ResultCode ControlMemory(u32* out_addr, u32 operation, u32 addr0, u32 add
             ResultCode result = process.HeapFree(addr0, size);
             if (result.IsError())
                 return result;
+            Core::CPU().InvalidateCacheRange(addr0, size);
             break;
         }
 
@@ -139,6 +142,7 @@ static ResultCode ControlMemory(u32* out_addr, u32 operation, u32 addr0, u32 add
         ResultCode result = process.vm_manager.ReprotectRange(addr0, size, vma_permissions);
         if (result.IsError())
             return result;
+        Core::CPU().InvalidateCacheRange(addr0, size);
         break;
     }
 
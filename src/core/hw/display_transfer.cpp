@@ -0,0 +1,371 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstring>
+#include <utility>
+#include "common/assert.h"
+#include "common/color.h"
+#include "common/vector_math.h"
+#include "core/hw/display_transfer.h"
+#include "video_core/utils.h"
+
+#ifdef ARCHITECTURE_x86_64
+#include "common/x64/cpu_detect.h"
+#endif
+
+namespace GPU {
+
+using PixelFormat = Regs::PixelFormat;
+using Config = Regs::DisplayTransferConfig;
+
+template <PixelFormat format>
+struct PixelTraits;
+
+template <>
+struct PixelTraits<PixelFormat::RGBA8> {
+    static constexpr size_t bytes_per_pixel = 4;
+    static Math::Vec4<u8> Decode(const u8* bytes) {
+        return Color::DecodeRGBA8(bytes);
+    }
+    static void Encode(const Math::Vec4<u8>& color, u8* bytes) {
+        Color::EncodeRGBA8(color, bytes);
+    }
+};
+
+template <>
+struct PixelTraits<PixelFormat::RGB8> {
+    static constexpr size_t bytes_per_pixel = 3;
+    static Math::Vec4<u8> Decode(const u8* bytes) {
+        return Color::DecodeRGB8(bytes);
+    }
+    static void Encode(const Math::Vec4<u8>& color, u8* bytes) {
+        Color::EncodeRGB8(color, bytes);
+    }
+};
+
+template <>
+struct PixelTraits<PixelFormat::RGB565> {
+    static constexpr size_t bytes_per_pixel = 2;
+    static Math::Vec4<u8> Decode(const u8* bytes) {
+        return Color::DecodeRGB565(bytes);
+    }
+    static void Encode(const Math::Vec4<u8>& color, u8* bytes) {
+        Color::EncodeRGB565(color, bytes);
+    }
+};
+
+template <>
+struct PixelTraits<PixelFormat::RGB5A1> {
+    static constexpr size_t bytes_per_pixel = 2;
+    static Math::Vec4<u8> Decode(const u8* bytes) {
+        return Color::DecodeRGB5A1(bytes);
+    }
+    static void Encode(const Math::Vec4<u8>& color, u8* bytes) {
+        Color::EncodeRGB5A1(color, bytes);
+    }
+};
+
+template <>
+struct PixelTraits<PixelFormat::RGBA4> {
+    static constexpr size_t bytes_per_pixel = 2;
+    static Math::Vec4<u8> Decode(const u8* bytes) {
+        return Color::DecodeRGBA4(bytes);
+    }
+    static void Encode(const Math::Vec4<u8>& color, u8* bytes) {
+        Color::EncodeRGBA4(color, bytes);
+    }
+};
+
+constexpr size_t NUM_PIXEL_FORMATS = 5;
+constexpr size_t TILE_SIZE = 8;
+constexpr size_t PIXELS_PER_TILE = TILE_SIZE * TILE_SIZE;
+
+/// Coordinates within a tile of the first pixel of each horizontal pair, in Morton order
+static const std::array<std::pair<u32, u32>, PIXELS_PER_TILE / 2> tile_pairs = [] {
+    std::array<std::pair<u32, u32>, PIXELS_PER_TILE / 2> pairs;
+    for (u32 y = 0; y < TILE_SIZE; ++y) {
+        for (u32 x = 0; x < TILE_SIZE; x += 2) {
+            pairs[VideoCore::MortonInterleave(x, y) / 2] = {x, y};
+        }
+    }
+    return pairs;
+}();
+
+template <PixelFormat input_format, PixelFormat output_format>
+static void ConvertPixels(const u8* src, u8* dst, size_t count) {
+    using In = PixelTraits<input_format>;
+    using Out = PixelTraits<output_format>;
+
+    // Decoding and encoding a pixel in the same format gives back the same bytes
+    if (input_format == output_format) {
+        std::memcpy(dst, src, count * In::bytes_per_pixel);
+        return;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        Out::Encode(In::Decode(src + i * In::bytes_per_pixel), dst + i * Out::bytes_per_pixel);
+    }
+}
+
+/// Dimensions of a transfer, after scaling
+struct TransferLayout {
+    u32 input_width;
+    u32 output_width;
+    u32 output_height;
+    bool flip;
+
+    u32 OutputRow(u32 y) const {
+        return flip ? output_height - y - 1 : y;
+    }
+};
+
+/// Moves the pixels of a tile stored in Morton order to the rows of a linear image
+template <size_t bytes_per_pixel>
+static void UnswizzleTile(const u8* tile, u8* linear, size_t stride, u32 first_row,
+                          const TransferLayout& layout) {
+    constexpr size_t pair_size = 2 * bytes_per_pixel;
+    for (size_t i = 0; i < tile_pairs.size(); ++i) {
+        const u32 row = layout.OutputRow(first_row + tile_pairs[i].second);
+        std::memcpy(linear + row * stride + tile_pairs[i].first * bytes_per_pixel,
+                    tile + i * pair_size, pair_size);
+    }
+}
+
+/// Gathers the pixels of a tile in Morton order from the rows of a linear image
+template <size_t bytes_per_pixel>
+static void SwizzleTile(const u8* linear, u8* tile, size_t stride, u32 first_row,
+                        const TransferLayout& layout) {
+    constexpr size_t pair_size = 2 * bytes_per_pixel;
+    for (size_t i = 0; i < tile_pairs.size(); ++i) {
+        const u32 row = layout.OutputRow(first_row + tile_pairs[i].second);
+        std::memcpy(tile + i * pair_size,
+                    linear + row * stride + tile_pairs[i].first * bytes_per_pixel, pair_size);
+    }
+}
+
+/// Tiled input and linear output, both made of whole tiles
+template <PixelFormat input_format, PixelFormat output_format>
+static void TiledToLinear(const u8* src, u8* dst, const TransferLayout& layout,
+                          ConvertPixelsFunction convert) {
+    constexpr size_t in_bpp = PixelTraits<input_format>::bytes_per_pixel;
+    constexpr size_t out_bpp = PixelTraits<output_format>::bytes_per_pixel;
+
+    std::array<u8, PIXELS_PER_TILE * out_bpp> tile;
+    for (u32 y = 0; y < layout.output_height; y += TILE_SIZE) {
+        // The flip applies to whole rows, so it's handled when moving pixels out of the tile
+        for (u32 x = 0; x < layout.output_width; x += TILE_SIZE) {
+            convert(src + (x * TILE_SIZE + y * layout.input_width) * in_bpp, tile.data(),
+                    PIXELS_PER_TILE);
+            UnswizzleTile<out_bpp>(tile.data(), dst + x * out_bpp, layout.output_width * out_bpp,
+                                   y, layout);
+        }
+    }
+}
+
+/// Linear input and tiled output, both made of whole tiles
+template <PixelFormat input_format, PixelFormat output_format>
+static void LinearToTiled(const u8* src, u8* dst, const TransferLayout& layout,
+                          ConvertPixelsFunction convert) {
+    constexpr size_t in_bpp = PixelTraits<input_format>::bytes_per_pixel;
+    constexpr size_t out_bpp = PixelTraits<output_format>::bytes_per_pixel;
+
+    std::array<u8, PIXELS_PER_TILE * in_bpp> tile;
+    for (u32 y = 0; y < layout.output_height; y += TILE_SIZE) {
+        for (u32 x = 0; x < layout.output_width; x += TILE_SIZE) {
+            // Output row y is read from input row y, or its mirror when flipping
+            SwizzleTile<in_bpp>(src + x * in_bpp, tile.data(), layout.input_width * in_bpp, y,
+                                layout);
+            convert(tile.data(), dst + (x * TILE_SIZE + y * layout.output_width) * out_bpp,
+                    PIXELS_PER_TILE);
+        }
+    }
+}
+
+/// Linear input and output
+template <PixelFormat input_format, PixelFormat output_format>
+static void LinearToLinear(const u8* src, u8* dst, const TransferLayout& layout,
+                           ConvertPixelsFunction convert) {
+    constexpr size_t in_bpp = PixelTraits<input_format>::bytes_per_pixel;
+    constexpr size_t out_bpp = PixelTraits<output_format>::bytes_per_pixel;
+
+    for (u32 y = 0; y < layout.output_height; ++y) {
+        convert(src + y * layout.input_width * in_bpp,
+                dst + layout.OutputRow(y) * layout.output_width * out_bpp, layout.output_width);
+    }
+}
+
+/// Tiled input and output made of whole tiles, without flipping
+template <PixelFormat input_format, PixelFormat output_format>
+static void TiledToTiled(const u8* src, u8* dst, const TransferLayout& layout,
+                         ConvertPixelsFunction convert) {
+    constexpr size_t in_bpp = PixelTraits<input_format>::bytes_per_pixel;
+    constexpr size_t out_bpp = PixelTraits<output_format>::bytes_per_pixel;
+
+    for (u32 y = 0; y < layout.output_height; y += TILE_SIZE) {
+        for (u32 x = 0; x < layout.output_width; x += TILE_SIZE) {
+            convert(src + (x * TILE_SIZE + y * layout.input_width) * in_bpp,
+                    dst + (x * TILE_SIZE + y * layout.output_width) * out_bpp, PIXELS_PER_TILE);
+        }
+    }
+}
+
+/// Per-pixel transfer, handling every layout and scaling mode
+template <PixelFormat input_format, PixelFormat output_format>
+static void GenericTransfer(const Config& config, const u8* src_pointer, u8* dst_pointer) {
+    using In = PixelTraits<input_format>;
+    using Out = PixelTraits<output_format>;
+    constexpr u32 src_bytes_per_pixel = In::bytes_per_pixel;
+    constexpr u32 dst_bytes_per_pixel = Out::bytes_per_pixel;
+
+    const int horizontal_scale = config.scaling != config.NoScale ? 1 : 0;
+    const int vertical_scale = config.scaling == config.ScaleXY ? 1 : 0;
+
+    const u32 output_width = config.output_width >> horizontal_scale;
+    const u32 output_height = config.output_height >> vertical_scale;
+
+    for (u32 y = 0; y < output_height; ++y) {
+        // Calculate the y position of the input image based on the output position and the scale
+        const u32 input_y = y << vertical_scale;
+        // Flip the y value of the output data after calculating the input position, to account
+        // for the scaling options
+        const u32 output_y = config.flip_vertically ? output_height - y - 1 : y;
+
+        for (u32 x = 0; x < output_width; ++x) {
+            const u32 input_x = x << horizontal_scale;
+            u32 src_offset;
+            u32 dst_offset;
+
+            if (config.input_linear) {
+                src_offset = (input_x + input_y * config.input_width) * src_bytes_per_pixel;
+                if (!config.dont_swizzle) {
+                    // Interpret the input as linear and the output as tiled
+                    const u32 coarse_y = output_y & ~7;
+                    const u32 stride = output_width * dst_bytes_per_pixel;
+                    dst_offset = VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel) +
+                                 coarse_y * stride;
+                } else {
+                    // Both input and output are linear
+                    dst_offset = (x + output_y * output_width) * dst_bytes_per_pixel;
+                }
+            } else {
+                const u32 in_coarse_y = input_y & ~7;
+                const u32 in_stride = config.input_width * src_bytes_per_pixel;
+                src_offset = VideoCore::GetMortonOffset(input_x, input_y, src_bytes_per_pixel) +
+                             in_coarse_y * in_stride;
+                if (!config.dont_swizzle) {
+                    // Interpret the input as tiled and the output as linear
+                    dst_offset = (x + output_y * output_width) * dst_bytes_per_pixel;
+                } else {
+                    // Both input and output are tiled
+                    const u32 out_coarse_y = output_y & ~7;
+                    const u32 out_stride = output_width * dst_bytes_per_pixel;
+                    dst_offset = VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel) +
+                                 out_coarse_y * out_stride;
+                }
+            }
+
+            // Scaling is only supported on tiled input, where the box filtered pixels are next
+            // to each other in Morton order
+            const u8* src_pixel = src_pointer + src_offset;
+            Math::Vec4<u8> src_color = In::Decode(src_pixel);
+            if (config.scaling == config.ScaleX) {
+                const Math::Vec4<u8> pixel = In::Decode(src_pixel + src_bytes_per_pixel);
+                src_color = ((src_color + pixel) / 2).Cast<u8>();
+            } else if (config.scaling == config.ScaleXY) {
+                const Math::Vec4<u8> pixel1 = In::Decode(src_pixel + 1 * src_bytes_per_pixel);
+                const Math::Vec4<u8> pixel2 = In::Decode(src_pixel + 2 * src_bytes_per_pixel);
+                const Math::Vec4<u8> pixel3 = In::Decode(src_pixel + 3 * src_bytes_per_pixel);
+                src_color = (((src_color + pixel1) + (pixel2 + pixel3)) / 4).Cast<u8>();
+            }
+
+            Out::Encode(src_color, dst_pointer + dst_offset);
+        }
+    }
+}
+
+/// Code specialized for one pair of input and output formats
+struct TransferFunctions {
+    ConvertPixelsFunction convert;
+    void (*tiled_to_linear)(const u8*, u8*, const TransferLayout&, ConvertPixelsFunction);
+    void (*linear_to_tiled)(const u8*, u8*, const TransferLayout&, ConvertPixelsFunction);
+    void (*linear_to_linear)(const u8*, u8*, const TransferLayout&, ConvertPixelsFunction);
+    void (*tiled_to_tiled)(const u8*, u8*, const TransferLayout&, ConvertPixelsFunction);
+    void (*generic)(const Config&, const u8*, u8*);
+};
+
+template <PixelFormat input_format, PixelFormat output_format>
+static constexpr TransferFunctions MakeTransferFunctions() {
+    return {ConvertPixels<input_format, output_format>,
+            TiledToLinear<input_format, output_format>,
+            LinearToTiled<input_format, output_format>,
+            LinearToLinear<input_format, output_format>,
+            TiledToTiled<input_format, output_format>,
+            GenericTransfer<input_format, output_format>};
+}
+
+template <PixelFormat input_format>
+static constexpr std::array<TransferFunctions, NUM_PIXEL_FORMATS> MakeTransferFunctionsRow() {
+    return {{MakeTransferFunctions<input_format, PixelFormat::RGBA8>(),
+             MakeTransferFunctions<input_format, PixelFormat::RGB8>(),
+             MakeTransferFunctions<input_format, PixelFormat::RGB565>(),
+             MakeTransferFunctions<input_format, PixelFormat::RGB5A1>(),
+             MakeTransferFunctions<input_format, PixelFormat::RGBA4>()}};
+}
+
+/// Transfer functions indexed by input and output format
+static const std::array<std::array<TransferFunctions, NUM_PIXEL_FORMATS>, NUM_PIXEL_FORMATS>
+    transfer_functions = [] {
+        std::array<std::array<TransferFunctions, NUM_PIXEL_FORMATS>, NUM_PIXEL_FORMATS> table = {{
+            MakeTransferFunctionsRow<PixelFormat::RGBA8>(),
+            MakeTransferFunctionsRow<PixelFormat::RGB8>(),
+            MakeTransferFunctionsRow<PixelFormat::RGB565>(),
+            MakeTransferFunctionsRow<PixelFormat::RGB5A1>(),
+            MakeTransferFunctionsRow<PixelFormat::RGBA4>(),
+        }};
+
+#ifdef ARCHITECTURE_x86_64
+        // Byte shuffles for the conversions between the formats used by framebuffers and screens
+        if (Common::GetCPUCaps().ssse3) {
+            const size_t rgba8 = static_cast<size_t>(PixelFormat::RGBA8);
+            const size_t rgb8 = static_cast<size_t>(PixelFormat::RGB8);
+            table[rgba8][rgb8].convert = ConvertRGBA8ToRGB8_SSSE3;
+            table[rgb8][rgba8].convert = ConvertRGB8ToRGBA8_SSSE3;
+        }
+#endif
+
+        return table;
+    }();
+
+void SoftwareDisplayTransfer(const Config& config, const u8* src, u8* dst) {
+    const size_t input_format = static_cast<size_t>(config.input_format.Value());
+    const size_t output_format = static_cast<size_t>(config.output_format.Value());
+    ASSERT_MSG(input_format < NUM_PIXEL_FORMATS && output_format < NUM_PIXEL_FORMATS,
+               "Invalid display transfer formats %zu, %zu", input_format, output_format);
+    const TransferFunctions& functions = transfer_functions[input_format][output_format];
+
+    const TransferLayout layout = {config.input_width, config.output_width, config.output_height,
+                                   config.flip_vertically != 0};
+    const bool whole_tiles = layout.output_width % TILE_SIZE == 0 &&
+                             layout.output_height % TILE_SIZE == 0 &&
+                             layout.input_width % TILE_SIZE == 0;
+
+    if (config.scaling != config.NoScale) {
+        functions.generic(config, src, dst);
+    } else if (config.input_linear && config.dont_swizzle) {
+        functions.linear_to_linear(src, dst, layout, functions.convert);
+    } else if (!whole_tiles) {
+        functions.generic(config, src, dst);
+    } else if (config.input_linear) {
+        functions.linear_to_tiled(src, dst, layout, functions.convert);
+    } else if (!config.dont_swizzle) {
+        functions.tiled_to_linear(src, dst, layout, functions.convert);
+    } else if (!layout.flip) {
+        functions.tiled_to_tiled(src, dst, layout, functions.convert);
+    } else {
+        functions.generic(config, src, dst);
+    }
+}
+
+} // namespace GPU
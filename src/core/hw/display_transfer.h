@@ -0,0 +1,35 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include "common/common_types.h"
+#include "core/hw/gpu.h"
+
+namespace GPU {
+
+/**
+ * Performs a display transfer on the CPU. The configuration has to be validated beforehand, and
+ * scaling is only supported for tiled input.
+ *
+ * The transfer is done by code specialized for its input and output formats. When the image is
+ * made of whole 8x8 tiles and isn't scaled, each tile is converted at once as a contiguous run of
+ * pixels and only moved between the tiled and linear layouts in pairs of pixels. Other transfers
+ * go through a per-pixel loop, still specialized for their formats.
+ * @param config Display transfer configuration
+ * @param src Pointer to the input image
+ * @param dst Pointer to the output image
+ */
+void SoftwareDisplayTransfer(const Regs::DisplayTransferConfig& config, const u8* src, u8* dst);
+
+/// Converts a contiguous run of pixels from one format to another
+using ConvertPixelsFunction = void (*)(const u8* src, u8* dst, size_t count);
+
+#ifdef ARCHITECTURE_x86_64
+void ConvertRGBA8ToRGB8_SSSE3(const u8* src, u8* dst, size_t count);
+void ConvertRGB8ToRGBA8_SSSE3(const u8* src, u8* dst, size_t count);
+#endif
+
+} // namespace GPU
@@ -0,0 +1,50 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+// This file is compiled with SSSE3 code generation enabled, see core/CMakeLists.txt
+
+#include <tmmintrin.h>
+#include "core/hw/display_transfer.h"
+
+namespace GPU {
+
+void ConvertRGBA8ToRGB8_SSSE3(const u8* src, u8* dst, size_t count) {
+    // RGBA8 is stored as ABGR and RGB8 as BGR, so the conversion drops the first byte of each
+    // pixel. Each store writes 16 bytes of which only 12 are valid, the rest is overwritten by
+    // the next iteration, so this stops while at least 6 pixels are left.
+    const __m128i shuffle = _mm_setr_epi8(1, 2, 3, 5, 6, 7, 9, 10, 11, 13, 14, 15, -1, -1, -1, -1);
+    size_t i = 0;
+    for (; i + 6 <= count; i += 4) {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 3),
+                         _mm_shuffle_epi8(pixels, shuffle));
+    }
+    for (; i < count; ++i) {
+        dst[i * 3 + 0] = src[i * 4 + 1];
+        dst[i * 3 + 1] = src[i * 4 + 2];
+        dst[i * 3 + 2] = src[i * 4 + 3];
+    }
+}
+
+void ConvertRGB8ToRGBA8_SSSE3(const u8* src, u8* dst, size_t count) {
+    // Each load reads 16 bytes of which only 12 are used, so this stops while at least 6 pixels
+    // are left to not read past the end of the input
+    const __m128i shuffle =
+        _mm_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+    const __m128i alpha = _mm_set1_epi32(0xFF);
+    size_t i = 0;
+    for (; i + 6 <= count; i += 4) {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4),
+                         _mm_or_si128(_mm_shuffle_epi8(pixels, shuffle), alpha));
+    }
+    for (; i < count; ++i) {
+        dst[i * 4 + 0] = 0xFF;
+        dst[i * 4 + 1] = src[i * 3 + 0];
+        dst[i * 4 + 2] = src[i * 3 + 1];
+        dst[i * 4 + 3] = src[i * 3 + 2];
+    }
+}
+
+} // namespace GPU
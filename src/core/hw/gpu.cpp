@@ -2,17 +2,19 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
 #include <cstring>
 #include <numeric>
 #include <type_traits>
 #include "common/alignment.h"
-#include "common/color.h"
+#include "common/chunk_file.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
-#include "common/vector_math.h"
 #include "core/core_timing.h"
 #include "core/hle/service/gsp_gpu.h"
+#include "core/hw/display_transfer.h"
 #include "core/hw/gpu.h"
 #include "core/hw/hw.h"
 #include "core/memory.h"
@@ -21,7 +23,6 @@
 #include "video_core/debug_utils/debug_utils.h"
 #include "video_core/rasterizer_interface.h"
 #include "video_core/renderer_base.h"
-#include "video_core/utils.h"
 #include "video_core/video_core.h"
 
 namespace GPU {
@@ -32,6 +33,21 @@ Regs g_regs;
 const u64 frame_ticks = BASE_CLOCK_RATE_ARM11 / SCREEN_REFRESH_RATE;
 /// Event id for CoreTiming
 static int vblank_event;
+/// Number of VBlanks since the GPU was initialized
+static u64 frame_count;
+
+/// Buffer recently transferred to an LCD framebuffer, see IsScreenSource
+struct ScreenSource {
+    PAddr address;
+    /// Frame during which it was last transferred
+    u64 frame;
+};
+
+/// Number of frames during which a buffer remains a screen source after its last transfer
+constexpr u64 SCREEN_SOURCE_FRAMES = 4;
+/// Screen sources, which are few as applications render each screen (and eye) to a single buffer
+/// or alternate between two of them
+static std::array<ScreenSource, 8> screen_sources;
 
 template <typename T>
 inline void Read(T& var, const u32 raw_addr) {
@@ -47,29 +63,6 @@ inline void Read(T& var, const u32 raw_addr) {
     var = g_regs[addr / 4];
 }
 
-static Math::Vec4<u8> DecodePixel(Regs::PixelFormat input_format, const u8* src_pixel) {
-    switch (input_format) {
-    case Regs::PixelFormat::RGBA8:
-        return Color::DecodeRGBA8(src_pixel);
-
-    case Regs::PixelFormat::RGB8:
-        return Color::DecodeRGB8(src_pixel);
-
-    case Regs::PixelFormat::RGB565:
-        return Color::DecodeRGB565(src_pixel);
-
-    case Regs::PixelFormat::RGB5A1:
-        return Color::DecodeRGB5A1(src_pixel);
-
-    case Regs::PixelFormat::RGBA4:
-        return Color::DecodeRGBA4(src_pixel);
-
-    default:
-        LOG_ERROR(HW_GPU, "Unknown source framebuffer format %x", input_format);
-        return {0, 0, 0, 0};
-    }
-}
-
 MICROPROFILE_DEFINE(GPU_DisplayTransfer, "GPU", "DisplayTransfer", MP_RGB(100, 100, 255));
 MICROPROFILE_DEFINE(GPU_CmdlistProcessing, "GPU", "Cmdlist Processing", MP_RGB(100, 255, 100));
 
@@ -134,6 +127,39 @@ static void MemoryFill(const Regs::MemoryFillConfig& config) {
     }
 }
 
+static bool IsLCDFramebuffer(PAddr address) {
+    for (const auto& framebuffer : g_regs.framebuffer_config) {
+        if (address == framebuffer.address_left1 || address == framebuffer.address_left2 ||
+            address == framebuffer.address_right1 || address == framebuffer.address_right2)
+            return true;
+    }
+    return false;
+}
+
+/// Remembers the input of a display transfer whose output is shown on one of the screens
+static void AddScreenSource(PAddr address) {
+    auto it = std::find_if(
+        screen_sources.begin(), screen_sources.end(),
+        [address](const ScreenSource& source) { return source.address == address; });
+    if (it == screen_sources.end()) {
+        // Replace the source which has gone the longest without being transferred
+        it = std::min_element(screen_sources.begin(), screen_sources.end(),
+                              [](const ScreenSource& a, const ScreenSource& b) {
+                                  return a.frame < b.frame;
+                              });
+        it->address = address;
+    }
+    it->frame = frame_count;
+}
+
+bool IsScreenSource(PAddr address) {
+    return std::any_of(screen_sources.begin(), screen_sources.end(),
+                       [address](const ScreenSource& source) {
+                           return source.address == address && source.address != 0 &&
+                                  frame_count - source.frame < SCREEN_SOURCE_FRAMES;
+                       });
+}
+
 static void DisplayTransfer(const Regs::DisplayTransferConfig& config) {
     const PAddr src_addr = config.GetPhysicalInputAddress();
     const PAddr dst_addr = config.GetPhysicalOutputAddress();
@@ -169,6 +195,9 @@ static void DisplayTransfer(const Regs::DisplayTransferConfig& config) {
         return;
     }
 
+    if (IsLCDFramebuffer(dst_addr))
+        AddScreenSource(src_addr);
+
     if (VideoCore::g_renderer->Rasterizer()->AccelerateDisplayTransfer(config))
         return;
 
@@ -188,6 +217,13 @@ static void DisplayTransfer(const Regs::DisplayTransferConfig& config) {
         return;
     }
 
+    if (config.input_format > Regs::PixelFormat::RGBA4 ||
+        config.output_format > Regs::PixelFormat::RGBA4) {
+        LOG_ERROR(HW_GPU, "Unknown display transfer formats %x -> %x",
+                  config.input_format.Value(), config.output_format.Value());
+        return;
+    }
+
     int horizontal_scale = config.scaling != config.NoScale ? 1 : 0;
     int vertical_scale = config.scaling == config.ScaleXY ? 1 : 0;
 
@@ -201,113 +237,7 @@ static void DisplayTransfer(const Regs::DisplayTransferConfig& config) {
     Memory::RasterizerFlushRegion(config.GetPhysicalInputAddress(), input_size);
     Memory::RasterizerFlushAndInvalidateRegion(config.GetPhysicalOutputAddress(), output_size);
 
-    for (u32 y = 0; y < output_height; ++y) {
-        for (u32 x = 0; x < output_width; ++x) {
-            Math::Vec4<u8> src_color;
-
-            // Calculate the [x,y] position of the input image
-            // based on the current output position and the scale
-            u32 input_x = x << horizontal_scale;
-            u32 input_y = y << vertical_scale;
-
-            u32 output_y;
-            if (config.flip_vertically) {
-                // Flip the y value of the output data,
-                // we do this after calculating the [x,y] position of the input image
-                // to account for the scaling options.
-                output_y = output_height - y - 1;
-            } else {
-                output_y = y;
-            }
-
-            u32 dst_bytes_per_pixel = GPU::Regs::BytesPerPixel(config.output_format);
-            u32 src_bytes_per_pixel = GPU::Regs::BytesPerPixel(config.input_format);
-            u32 src_offset;
-            u32 dst_offset;
-
-            if (config.input_linear) {
-                if (!config.dont_swizzle) {
-                    // Interpret the input as linear and the output as tiled
-                    u32 coarse_y = output_y & ~7;
-                    u32 stride = output_width * dst_bytes_per_pixel;
-
-                    src_offset = (input_x + input_y * config.input_width) * src_bytes_per_pixel;
-                    dst_offset = VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel) +
-                                 coarse_y * stride;
-                } else {
-                    // Both input and output are linear
-                    src_offset = (input_x + input_y * config.input_width) * src_bytes_per_pixel;
-                    dst_offset = (x + output_y * output_width) * dst_bytes_per_pixel;
-                }
-            } else {
-                if (!config.dont_swizzle) {
-                    // Interpret the input as tiled and the output as linear
-                    u32 coarse_y = input_y & ~7;
-                    u32 stride = config.input_width * src_bytes_per_pixel;
-
-                    src_offset = VideoCore::GetMortonOffset(input_x, input_y, src_bytes_per_pixel) +
-                                 coarse_y * stride;
-                    dst_offset = (x + output_y * output_width) * dst_bytes_per_pixel;
-                } else {
-                    // Both input and output are tiled
-                    u32 out_coarse_y = output_y & ~7;
-                    u32 out_stride = output_width * dst_bytes_per_pixel;
-
-                    u32 in_coarse_y = input_y & ~7;
-                    u32 in_stride = config.input_width * src_bytes_per_pixel;
-
-                    src_offset = VideoCore::GetMortonOffset(input_x, input_y, src_bytes_per_pixel) +
-                                 in_coarse_y * in_stride;
-                    dst_offset = VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel) +
-                                 out_coarse_y * out_stride;
-                }
-            }
-
-            const u8* src_pixel = src_pointer + src_offset;
-            src_color = DecodePixel(config.input_format, src_pixel);
-            if (config.scaling == config.ScaleX) {
-                Math::Vec4<u8> pixel =
-                    DecodePixel(config.input_format, src_pixel + src_bytes_per_pixel);
-                src_color = ((src_color + pixel) / 2).Cast<u8>();
-            } else if (config.scaling == config.ScaleXY) {
-                Math::Vec4<u8> pixel1 =
-                    DecodePixel(config.input_format, src_pixel + 1 * src_bytes_per_pixel);
-                Math::Vec4<u8> pixel2 =
-                    DecodePixel(config.input_format, src_pixel + 2 * src_bytes_per_pixel);
-                Math::Vec4<u8> pixel3 =
-                    DecodePixel(config.input_format, src_pixel + 3 * src_bytes_per_pixel);
-                src_color = (((src_color + pixel1) + (pixel2 + pixel3)) / 4).Cast<u8>();
-            }
-
-            u8* dst_pixel = dst_pointer + dst_offset;
-            switch (config.output_format) {
-            case Regs::PixelFormat::RGBA8:
-                Color::EncodeRGBA8(src_color, dst_pixel);
-                break;
-
-            case Regs::PixelFormat::RGB8:
-                Color::EncodeRGB8(src_color, dst_pixel);
-                break;
-
-            case Regs::PixelFormat::RGB565:
-                Color::EncodeRGB565(src_color, dst_pixel);
-                break;
-
-            case Regs::PixelFormat::RGB5A1:
-                Color::EncodeRGB5A1(src_color, dst_pixel);
-                break;
-
-            case Regs::PixelFormat::RGBA4:
-                Color::EncodeRGBA4(src_color, dst_pixel);
-                break;
-
-            default:
-                LOG_ERROR(HW_GPU, "Unknown destination framebuffer format %x",
-                          config.output_format.Value());
-                break;
-            }
-        }
-    }
+    SoftwareDisplayTransfer(config, src_pointer, dst_pointer);
 }
 
 static void TextureCopy(const Regs::DisplayTransferConfig& config) {
@@ -515,6 +445,7 @@ template void Write<u8>(u32 addr, const u8 data);
 
 /// Update hardware
 static void VBlankCallback(u64 userdata, int cycles_late) {
+    ++frame_count;
     VideoCore::g_renderer->SwapBuffers();
 
     // Signal to GSP that GPU interrupt has occurred
@@ -532,6 +463,8 @@ static void VBlankCallback(u64 userdata, int cycles_late) {
 /// Initialize hardware
 void Init() {
     memset(&g_regs, 0, sizeof(g_regs));
+    frame_count = 0;
+    screen_sources.fill({});
 
     auto& framebuffer_top = g_regs.framebuffer_config[0];
     auto& framebuffer_sub = g_regs.framebuffer_config[1];
@@ -570,4 +503,8 @@ void Shutdown() {
     LOG_DEBUG(HW_GPU, "shutdown OK");
 }
 
+void DoState(PointerWrap& p) {
+    p.DoVoid(&g_regs, sizeof(g_regs));
+}
+
 } // namespace
@@ -11,6 +11,8 @@
 #include "common/common_funcs.h"
 #include "common/common_types.h"
 
+class PointerWrap;
+
 namespace GPU {
 
 constexpr float SCREEN_REFRESH_RATE = 60;
@@ -325,10 +327,20 @@ void Read(T& var, const u32 addr);
 template <typename T>
 void Write(u32 addr, const T data);
 
+/**
+ * Returns whether a buffer was the source of a display transfer to one of the LCD framebuffers in
+ * the last few frames, meaning that what is rendered to it only shows up on the screens.
+ * @param address Physical address of the buffer
+ */
+bool IsScreenSource(PAddr address);
+
 /// Initialize hardware
 void Init();
 
 /// Shutdown hardware
 void Shutdown();
 
+/// Serializes the register state for save states
+void DoState(PointerWrap& p);
+
 } // namespace
@@ -2,12 +2,14 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include "common/chunk_file.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
 #include "core/hw/aes/key.h"
 #include "core/hw/gpu.h"
 #include "core/hw/hw.h"
 #include "core/hw/lcd.h"
+#include "core/hw/y2r.h"
 
 namespace HW {
 
@@ -89,6 +91,7 @@ void Init() {
     AES::InitKeys();
     GPU::Init();
     LCD::Init();
+    Y2R::Init();
     LOG_DEBUG(HW, "initialized OK");
 }
 
@@ -96,6 +99,16 @@ void Init() {
 void Shutdown() {
     GPU::Shutdown();
     LCD::Shutdown();
+    Y2R::Shutdown();
     LOG_DEBUG(HW, "shutdown OK");
 }
+
+void DoState(PointerWrap& p) {
+    auto section = p.Section("HW", 1);
+    if (!section) {
+        return;
+    }
+    GPU::DoState(p);
+    LCD::DoState(p);
+}
 }
@@ -6,6 +6,8 @@
 
 #include "common/common_types.h"
 
+class PointerWrap;
+
 namespace HW {
 
 /// Beginnings of IO register regions, in the user VA space.
@@ -47,4 +49,7 @@ void Init();
 /// Shutdown hardware
 void Shutdown();
 
+/// Serializes the state of the emulated hardware for save states
+void DoState(PointerWrap& p);
+
 } // namespace
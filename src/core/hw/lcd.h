@@ -12,6 +12,8 @@
 
 #define LCD_REG_INDEX(field_name) (offsetof(LCD::Regs, field_name) / sizeof(u32))
 
+class PointerWrap;
+
 namespace LCD {
 
 struct Regs {
@@ -83,4 +85,7 @@ void Init();
 /// Shutdown hardware
 void Shutdown();
 
+/// Serializes the register state for save states
+void DoState(PointerWrap& p);
+
 } // namespace
@@ -5,16 +5,26 @@
 #include <algorithm>
 #include <array>
 #include <cstddef>
+#include <cstring>
 #include <memory>
+#include <thread>
+#include <vector>
 #include "common/assert.h"
 #include "common/color.h"
+#include "common/common_funcs.h"
 #include "common/common_types.h"
 #include "common/math_util.h"
+#include "common/swap.h"
+#include "common/thread_pool.h"
 #include "common/vector_math.h"
 #include "core/hle/service/y2r_u.h"
 #include "core/hw/y2r.h"
 #include "core/memory.h"
 
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
+
 namespace HW {
 namespace Y2R {
 
@@ -23,10 +33,154 @@ using namespace Service::Y2R;
 static const size_t MAX_TILES = 1024 / 8;
 static const size_t TILE_SIZE = 8 * 8;
 using ImageTile = std::array<u32, TILE_SIZE>;
+static_assert(sizeof(ImageTile) == TILE_SIZE * sizeof(u32), "Tiles must be contiguous");
+
+/// Upper bound on the threads converting strips, beyond which the CDMA copies dominate
+static const size_t MAX_THREADS = 4;
+
+static std::unique_ptr<Common::ThreadPool> thread_pool;
+
+// Buffers used as CDMA sources/targets and tile storage, kept between conversions since games
+// usually convert a video frame at a time.
+static std::vector<u8> input_buffer;
+static std::vector<u32> output_buffer;
+static std::vector<ImageTile> tiles_buffer;
+
+/**
+ * Converts a image strip from the source YUV format into RGB32 pixels. Pixel (x, y) is written to
+ * `output[(x / 8) * tile_stride + y * line_stride + x % 8]`, so the strip can either be split into
+ * individual 8x8 tiles (tile_stride = 64, line_stride = 8) or written as linear lines
+ * (tile_stride = 8, line_stride = width).
+ */
+using ConvertFunction = void (*)(const u8* input_Y, const u8* input_U, const u8* input_V,
+                                 u32* output, size_t tile_stride, size_t line_stride,
+                                 unsigned int width, unsigned int height,
+                                 const CoefficientSet& coefficients);
+
+#ifdef ARCHITECTURE_x86_64
+
+/// Coefficients arranged for _mm_madd_epi16 on interleaved pairs of 16-bit components
+struct CoefficientVectors {
+    explicit CoefficientVectors(const CoefficientSet& c)
+        : y_v_to_r(Pair(c[0], c[1])), y_to_y(Pair(c[0], 0)), v_u_to_g(Pair(c[2], c[3])),
+          y_u_to_b(Pair(c[0], c[4])), r_offset(_mm_set1_epi32(c[5] + ROUNDING_OFFSET)),
+          g_offset(_mm_set1_epi32(c[6] + ROUNDING_OFFSET)),
+          b_offset(_mm_set1_epi32(c[7] + ROUNDING_OFFSET)) {}
+
+    static __m128i Pair(s16 first, s16 second) {
+        const u32 low = static_cast<u16>(first);
+        const u32 high = static_cast<u16>(second);
+        return _mm_set1_epi32(static_cast<int>(low | high << 16));
+    }
+
+    static const s32 ROUNDING_OFFSET = 0x18;
+
+    __m128i y_v_to_r, y_to_y, v_u_to_g, y_u_to_b;
+    __m128i r_offset, g_offset, b_offset;
+};
+
+/// Finishes the fixed point calculation of one channel for 4 pixels, see ConvertYUVToRGB
+static __m128i ScaleChannel(__m128i value, __m128i offset) {
+    return _mm_srai_epi32(_mm_add_epi32(_mm_srai_epi32(value, 3), offset), 5);
+}
+
+/// Converts a quad of pixels given as interleaved 16-bit (Y, V), (V, U) and (Y, U) pairs
+static FORCE_INLINE void ConvertQuad(__m128i y_v, __m128i v_u, __m128i y_u,
+                                     const CoefficientVectors& c, __m128i& r, __m128i& g,
+                                     __m128i& b) {
+    const __m128i cY = _mm_madd_epi16(y_v, c.y_to_y);
+    r = ScaleChannel(_mm_madd_epi16(y_v, c.y_v_to_r), c.r_offset);
+    g = ScaleChannel(_mm_sub_epi32(cY, _mm_madd_epi16(v_u, c.v_u_to_g)), c.g_offset);
+    b = ScaleChannel(_mm_madd_epi16(y_u, c.y_u_to_b), c.b_offset);
+}
+
+/**
+ * Converts 8 pixels given as 16-bit Y, U and V lanes, bit-exact with the scalar calculation. Each
+ * product and sum is done in 32 bits, and the final clamp to [0, 255] is done by the saturating
+ * packs to 16 and then 8 bits.
+ */
+static FORCE_INLINE void ConvertOctet(__m128i y, __m128i u, __m128i v,
+                                      const CoefficientVectors& c, u32* out) {
+    __m128i r_lo, g_lo, b_lo, r_hi, g_hi, b_hi;
+    ConvertQuad(_mm_unpacklo_epi16(y, v), _mm_unpacklo_epi16(v, u), _mm_unpacklo_epi16(y, u), c,
+                r_lo, g_lo, b_lo);
+    ConvertQuad(_mm_unpackhi_epi16(y, v), _mm_unpackhi_epi16(v, u), _mm_unpackhi_epi16(y, u), c,
+                r_hi, g_hi, b_hi);
+
+    const __m128i r16 = _mm_packs_epi32(r_lo, r_hi);
+    const __m128i g16 = _mm_packs_epi32(g_lo, g_hi);
+    const __m128i b16 = _mm_packs_epi32(b_lo, b_hi);
+    const __m128i r8 = _mm_packus_epi16(r16, r16);
+    const __m128i g8 = _mm_packus_epi16(g16, g16);
+    const __m128i b8 = _mm_packus_epi16(b16, b16);
+
+    // Assemble r << 24 | g << 16 | b << 8
+    const __m128i zero_b = _mm_unpacklo_epi8(_mm_setzero_si128(), b8);
+    const __m128i g_r = _mm_unpacklo_epi8(g8, r8);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi16(zero_b, g_r));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4), _mm_unpackhi_epi16(zero_b, g_r));
+}
+
+/// Loads 8 bytes widened to 16-bit lanes
+static __m128i LoadOctet(const u8* data) {
+    return _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(data)),
+                             _mm_setzero_si128());
+}
+
+/// Loads 4 chroma bytes widened to 16-bit lanes, each one repeated for a pair of pixels
+static __m128i LoadChromaOctet(const u8* data) {
+    u32 chroma;
+    std::memcpy(&chroma, data, sizeof(chroma));
+    const __m128i bytes = _mm_cvtsi32_si128(static_cast<int>(chroma));
+    return _mm_unpacklo_epi8(_mm_unpacklo_epi8(bytes, bytes), _mm_setzero_si128());
+}
+
+template <InputFormat input_format>
+static void ConvertYUVToRGB(const u8* input_Y, const u8* input_U, const u8* input_V, u32* output,
+                            size_t tile_stride, size_t line_stride, unsigned int width,
+                            unsigned int height, const CoefficientSet& coefficients) {
+    const CoefficientVectors c(coefficients);
+
+    for (unsigned int y = 0; y < height; ++y) {
+        for (unsigned int x = 0; x < width; x += 8) {
+            __m128i Y, U, V;
+            switch (input_format) {
+            case InputFormat::YUV422_Indiv8:
+            case InputFormat::YUV422_Indiv16:
+                Y = LoadOctet(input_Y + y * width + x);
+                U = LoadChromaOctet(input_U + (y * width + x) / 2);
+                V = LoadChromaOctet(input_V + (y * width + x) / 2);
+                break;
+            case InputFormat::YUV420_Indiv8:
+            case InputFormat::YUV420_Indiv16:
+                Y = LoadOctet(input_Y + y * width + x);
+                U = LoadChromaOctet(input_U + ((y / 2) * width + x) / 2);
+                V = LoadChromaOctet(input_V + ((y / 2) * width + x) / 2);
+                break;
+            case InputFormat::YUYV422_Interleaved: {
+                // Y0 U0 Y1 V0 Y2 U1 Y3 V1 ...
+                const u8* pixels = input_Y + (y * width + x) * 2;
+                const __m128i yuyv = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels));
+                Y = _mm_and_si128(yuyv, _mm_set1_epi16(0xFF));
+                const __m128i chroma = _mm_srli_epi16(yuyv, 8);
+                U = _mm_shufflehi_epi16(_mm_shufflelo_epi16(chroma, _MM_SHUFFLE(2, 2, 0, 0)),
+                                        _MM_SHUFFLE(2, 2, 0, 0));
+                V = _mm_shufflehi_epi16(_mm_shufflelo_epi16(chroma, _MM_SHUFFLE(3, 3, 1, 1)),
+                                        _MM_SHUFFLE(3, 3, 1, 1));
+                break;
+            }
+            }
+
+            ConvertOctet(Y, U, V, c, output + (x / 8) * tile_stride + y * line_stride);
+        }
+    }
+}
+
+#else
 
-/// Converts a image strip from the source YUV format into individual 8x8 RGB32 tiles.
-static void ConvertYUVToRGB(InputFormat input_format, const u8* input_Y, const u8* input_U,
-                            const u8* input_V, ImageTile output[], unsigned int width,
+template <InputFormat input_format>
+static void ConvertYUVToRGB(const u8* input_Y, const u8* input_U, const u8* input_V, u32* output,
+                            size_t tile_stride, size_t line_stride, unsigned int width,
                             unsigned int height, const CoefficientSet& coefficients) {
 
     for (unsigned int y = 0; y < height; ++y) {
@@ -67,9 +221,7 @@ static void ConvertYUVToRGB(InputFormat input_format, const u8* input_Y, const u
             g = (g >> 3) + c[6] + rounding_offset;
             b = (b >> 3) + c[7] + rounding_offset;
 
-            unsigned int tile = x / 8;
-            unsigned int tile_x = x % 8;
-            u32* out = &output[tile][y * 8 + tile_x];
+            u32* out = &output[(x / 8) * tile_stride + y * line_stride + x % 8];
 
             using MathUtil::Clamp;
             *out = ((u32)Clamp(r >> 5, 0, 0xFF) << 24) | ((u32)Clamp(g >> 5, 0, 0xFF) << 16) |
@@ -78,6 +230,22 @@ static void ConvertYUVToRGB(InputFormat input_format, const u8* input_Y, const u
     }
 }
 
+#endif
+
+static ConvertFunction GetConvertFunction(InputFormat input_format) {
+    switch (input_format) {
+    case InputFormat::YUV422_Indiv8:
+    case InputFormat::YUV422_Indiv16:
+        return ConvertYUVToRGB<InputFormat::YUV422_Indiv8>;
+    case InputFormat::YUV420_Indiv8:
+    case InputFormat::YUV420_Indiv16:
+        return ConvertYUVToRGB<InputFormat::YUV420_Indiv8>;
+    case InputFormat::YUYV422_Interleaved:
+        return ConvertYUVToRGB<InputFormat::YUYV422_Interleaved>;
+    }
+    UNREACHABLE();
+}
+
 /// Simulates an incoming CDMA transfer. The N parameter is used to automatically convert 16-bit
 /// formats to 8-bit.
 template <size_t N>
@@ -88,8 +256,12 @@ static void ReceiveData(u8* output, ConversionBuffer& buf, size_t amount_of_data
     ASSERT(amount_of_data % output_unit == 0);
 
     while (amount_of_data > 0) {
-        for (size_t i = 0; i < output_unit; ++i) {
-            output[i] = input[i * N];
+        if (N == 1) {
+            std::memcpy(output, input, output_unit);
+        } else {
+            for (size_t i = 0; i < output_unit; ++i) {
+                output[i] = input[i * N];
+            }
         }
 
         output += output_unit;
@@ -101,37 +273,101 @@ static void ReceiveData(u8* output, ConversionBuffer& buf, size_t amount_of_data
     }
 }
 
+/// Receives the input data of one strip, made of `row_data_size` pixels, into `input_Y`. The U and
+/// V planes are stored after room for 8 lines of Y data.
+static void ReceiveStrip(ConversionConfiguration& cvt, u8* input_Y, size_t row_data_size) {
+    u8* input_U = input_Y + 8 * cvt.input_line_width;
+    u8* input_V = input_U + 8 * cvt.input_line_width / 2;
+
+    switch (cvt.input_format) {
+    case InputFormat::YUV422_Indiv8:
+        ReceiveData<1>(input_Y, cvt.src_Y, row_data_size);
+        ReceiveData<1>(input_U, cvt.src_U, row_data_size / 2);
+        ReceiveData<1>(input_V, cvt.src_V, row_data_size / 2);
+        break;
+    case InputFormat::YUV420_Indiv8:
+        ReceiveData<1>(input_Y, cvt.src_Y, row_data_size);
+        ReceiveData<1>(input_U, cvt.src_U, row_data_size / 4);
+        ReceiveData<1>(input_V, cvt.src_V, row_data_size / 4);
+        break;
+    case InputFormat::YUV422_Indiv16:
+        ReceiveData<2>(input_Y, cvt.src_Y, row_data_size);
+        ReceiveData<2>(input_U, cvt.src_U, row_data_size / 2);
+        ReceiveData<2>(input_V, cvt.src_V, row_data_size / 2);
+        break;
+    case InputFormat::YUV420_Indiv16:
+        ReceiveData<2>(input_Y, cvt.src_Y, row_data_size);
+        ReceiveData<2>(input_U, cvt.src_U, row_data_size / 4);
+        ReceiveData<2>(input_V, cvt.src_V, row_data_size / 4);
+        break;
+    case InputFormat::YUYV422_Interleaved:
+        ReceiveData<1>(input_Y, cvt.src_YUYV, row_data_size * 2);
+        break;
+    }
+}
+
+template <OutputFormat output_format>
+static void EncodePixel(u32 color, u8 alpha, u8* output);
+
+template <>
+void EncodePixel<OutputFormat::RGBA8>(u32 color, u8 alpha, u8* output) {
+    // The intermediate RGB32 format only lacks the alpha component
+    const u32_le rgba = color | alpha;
+    std::memcpy(output, &rgba, sizeof(rgba));
+}
+
+template <>
+void EncodePixel<OutputFormat::RGB8>(u32 color, u8, u8* output) {
+    output[0] = static_cast<u8>(color >> 8);
+    output[1] = static_cast<u8>(color >> 16);
+    output[2] = static_cast<u8>(color >> 24);
+}
+
+template <>
+void EncodePixel<OutputFormat::RGB5A1>(u32 color, u8 alpha, u8* output) {
+    Color::EncodeRGB5A1({(u8)(color >> 24), (u8)(color >> 16), (u8)(color >> 8), alpha}, output);
+}
+
+template <>
+void EncodePixel<OutputFormat::RGB565>(u32 color, u8 alpha, u8* output) {
+    Color::EncodeRGB565({(u8)(color >> 24), (u8)(color >> 16), (u8)(color >> 8), alpha}, output);
+}
+
+template <OutputFormat output_format>
+static constexpr size_t OutputBytesPerPixel() {
+    return output_format == OutputFormat::RGBA8 ? 4 : output_format == OutputFormat::RGB8 ? 3 : 2;
+}
+
 /// Convert intermediate RGB32 format to the final output format while simulating an outgoing CDMA
 /// transfer.
-static void SendData(const u32* input, ConversionBuffer& buf, int amount_of_data,
-                     OutputFormat output_format, u8 alpha) {
+template <OutputFormat output_format>
+static void SendData(const u32* input, ConversionBuffer& buf, int amount_of_data, u8 alpha) {
 
     u8* output = Memory::GetPointer(buf.address);
+    const size_t bytes_per_pixel = OutputBytesPerPixel<output_format>();
+
+    if (buf.transfer_unit % bytes_per_pixel == 0) {
+        // Each unit is made of whole pixels, so they can be encoded in a simple loop
+        const size_t unit_pixels = buf.transfer_unit / bytes_per_pixel;
+        while (amount_of_data > 0) {
+            for (size_t i = 0; i < unit_pixels; ++i) {
+                EncodePixel<output_format>(input[i], alpha, output + i * bytes_per_pixel);
+            }
+            input += unit_pixels;
+            amount_of_data -= static_cast<int>(unit_pixels);
+
+            output += buf.transfer_unit + buf.gap;
+            buf.address += buf.transfer_unit + buf.gap;
+            buf.image_size -= buf.transfer_unit;
+        }
+        return;
+    }
 
     while (amount_of_data > 0) {
         u8* unit_end = output + buf.transfer_unit;
         while (output < unit_end) {
-            u32 color = *input++;
-            Math::Vec4<u8> col_vec{(u8)(color >> 24), (u8)(color >> 16), (u8)(color >> 8), alpha};
-
-            switch (output_format) {
-            case OutputFormat::RGBA8:
-                Color::EncodeRGBA8(col_vec, output);
-                output += 4;
-                break;
-            case OutputFormat::RGB8:
-                Color::EncodeRGB8(col_vec, output);
-                output += 3;
-                break;
-            case OutputFormat::RGB5A1:
-                Color::EncodeRGB5A1(col_vec, output);
-                output += 2;
-                break;
-            case OutputFormat::RGB565:
-                Color::EncodeRGB565(col_vec, output);
-                output += 2;
-                break;
-            }
+            EncodePixel<output_format>(*input++, alpha, output);
+            output += bytes_per_pixel;
 
             amount_of_data -= 1;
         }
@@ -142,6 +378,24 @@ static void SendData(const u32* input, ConversionBuffer& buf, int amount_of_data
     }
 }
 
+static void SendStrip(ConversionConfiguration& cvt, const u32* input, int row_data_size) {
+    const u8 alpha = static_cast<u8>(cvt.alpha);
+    switch (cvt.output_format) {
+    case OutputFormat::RGBA8:
+        SendData<OutputFormat::RGBA8>(input, cvt.dst, row_data_size, alpha);
+        break;
+    case OutputFormat::RGB8:
+        SendData<OutputFormat::RGB8>(input, cvt.dst, row_data_size, alpha);
+        break;
+    case OutputFormat::RGB5A1:
+        SendData<OutputFormat::RGB5A1>(input, cvt.dst, row_data_size, alpha);
+        break;
+    case OutputFormat::RGB565:
+        SendData<OutputFormat::RGB565>(input, cvt.dst, row_data_size, alpha);
+        break;
+    }
+}
+
 static const u8 linear_lut[TILE_SIZE] = {
     // clang-format off
      0,  1,  2,  3,  4,  5,  6,  7,
@@ -203,14 +457,243 @@ static void RotateTile270(const ImageTile& input, ImageTile& output, int height,
     }
 }
 
+#ifdef ARCHITECTURE_x86_64
+
+/// Transposes an 8x8 tile given by its lines, storing the transposed lines to `output_lines`
+static void TransposeTile(const u32* const input_lines[8], u32* const output_lines[8]) {
+    for (int block_y = 0; block_y < 8; block_y += 4) {
+        for (int block_x = 0; block_x < 8; block_x += 4) {
+            __m128i line[4];
+            for (int i = 0; i < 4; ++i) {
+                line[i] = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(input_lines[block_y + i] + block_x));
+            }
+            const __m128i t0 = _mm_unpacklo_epi32(line[0], line[1]);
+            const __m128i t1 = _mm_unpacklo_epi32(line[2], line[3]);
+            const __m128i t2 = _mm_unpackhi_epi32(line[0], line[1]);
+            const __m128i t3 = _mm_unpackhi_epi32(line[2], line[3]);
+            const __m128i columns[4] = {_mm_unpacklo_epi64(t0, t1), _mm_unpackhi_epi64(t0, t1),
+                                        _mm_unpacklo_epi64(t2, t3), _mm_unpackhi_epi64(t2, t3)};
+            for (int i = 0; i < 4; ++i) {
+                _mm_storeu_si128(
+                    reinterpret_cast<__m128i*>(output_lines[block_x + i] + block_y), columns[i]);
+            }
+        }
+    }
+}
+
+/// Rotates a complete 8-line tile, producing the same result as RotateTile* with `linear_lut`
+static void RotateFullTile(Rotation rotation, const ImageTile& input, ImageTile& output) {
+    const u32* input_lines[8];
+    u32* output_lines[8];
+
+    switch (rotation) {
+    case Rotation::None:
+        output = input;
+        break;
+    case Rotation::Clockwise_90:
+        // Transpose of the vertically flipped tile
+        for (int i = 0; i < 8; ++i) {
+            input_lines[i] = &input[(7 - i) * 8];
+            output_lines[i] = &output[i * 8];
+        }
+        TransposeTile(input_lines, output_lines);
+        break;
+    case Rotation::Clockwise_180:
+        for (int y = 0; y < 8; ++y) {
+            // Mirror of the opposite line, reversing the order of each half
+            const __m128i* line = reinterpret_cast<const __m128i*>(&input[(7 - y) * 8]);
+            const __m128i left = _mm_loadu_si128(line);
+            const __m128i right = _mm_loadu_si128(line + 1);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&output[y * 8]),
+                             _mm_shuffle_epi32(right, _MM_SHUFFLE(0, 1, 2, 3)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&output[y * 8 + 4]),
+                             _mm_shuffle_epi32(left, _MM_SHUFFLE(0, 1, 2, 3)));
+        }
+        break;
+    case Rotation::Clockwise_270:
+        // Vertically flipped transpose of the tile
+        for (int i = 0; i < 8; ++i) {
+            input_lines[i] = &input[i * 8];
+            output_lines[i] = &output[(7 - i) * 8];
+        }
+        TransposeTile(input_lines, output_lines);
+        break;
+    }
+}
+
+#endif
+
+static void RotateTile(Rotation rotation, const ImageTile& input, ImageTile& output, int height,
+                       const u8 out_map[64]) {
+#ifdef ARCHITECTURE_x86_64
+    if (height == 8) {
+        if (out_map == linear_lut) {
+            RotateFullTile(rotation, input, output);
+        } else {
+            ImageTile rotated;
+            RotateFullTile(rotation, input, rotated);
+            for (size_t i = 0; i < TILE_SIZE; ++i) {
+                output[out_map[i]] = rotated[i];
+            }
+        }
+        return;
+    }
+#endif
+
+    switch (rotation) {
+    case Rotation::None:
+        RotateTile0(input, output, height, out_map);
+        break;
+    case Rotation::Clockwise_90:
+        RotateTile90(input, output, height, out_map);
+        break;
+    case Rotation::Clockwise_180:
+        RotateTile180(input, output, height, out_map);
+        break;
+    case Rotation::Clockwise_270:
+        RotateTile270(input, output, height, out_map);
+        break;
+    }
+}
+
 static void WriteTileToOutput(u32* output, const ImageTile& tile, int height, int line_stride) {
     for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < 8; ++x) {
-            output[y * line_stride + x] = tile[y * 8 + x];
+        std::memcpy(&output[y * line_stride], &tile[y * 8], 8 * sizeof(u32));
+    }
+}
+
+/**
+ * Converts one received strip of `row_height` lines to RGB32, rotating and arranging it for
+ * output. `tiles` is scratch space for the strip's tiles.
+ */
+static void ConvertStrip(const ConversionConfiguration& cvt, const u8* input_Y, ImageTile* tiles,
+                         u32* output_buffer, unsigned int row_height) {
+    const u8* input_U = input_Y + 8 * cvt.input_line_width;
+    const u8* input_V = input_U + 8 * cvt.input_line_width / 2;
+    const ConvertFunction convert = GetConvertFunction(cvt.input_format);
+
+    if (cvt.rotation == Rotation::None && cvt.block_alignment == BlockAlignment::Linear) {
+        // The tiles would only be written back line by line, so convert straight to the output
+        convert(input_Y, input_U, input_V, output_buffer, 8, cvt.input_line_width,
+                cvt.input_line_width, row_height, cvt.coefficients);
+        return;
+    }
+
+    convert(input_Y, input_U, input_V, tiles[0].data(), TILE_SIZE, 8, cvt.input_line_width,
+            row_height, cvt.coefficients);
+
+    // LUT used to remap writes to a tile. Used to allow linear or swizzled output without
+    // requiring two different code paths.
+    const u8* tile_remap = nullptr;
+    switch (cvt.block_alignment) {
+    case BlockAlignment::Linear:
+        tile_remap = linear_lut;
+        break;
+    case BlockAlignment::Block8x8:
+        tile_remap = morton_lut;
+        break;
+    }
+
+    const size_t num_tiles = cvt.input_line_width / 8;
+    ImageTile tmp_tile;
+
+    for (size_t i = 0; i < num_tiles; ++i) {
+        int image_strip_width = 0;
+        int output_stride = 0;
+
+        switch (cvt.rotation) {
+        case Rotation::None:
+            RotateTile(cvt.rotation, tiles[i], tmp_tile, row_height, tile_remap);
+            image_strip_width = cvt.input_line_width;
+            output_stride = 8;
+            break;
+        case Rotation::Clockwise_90:
+            RotateTile(cvt.rotation, tiles[i], tmp_tile, row_height, tile_remap);
+            image_strip_width = 8;
+            output_stride = 8 * row_height;
+            break;
+        case Rotation::Clockwise_180:
+            // For 180 and 270 degree rotations we also invert the order of tiles in the strip,
+            // since the rotates are done individually on each tile.
+            RotateTile(cvt.rotation, tiles[num_tiles - i - 1], tmp_tile, row_height, tile_remap);
+            image_strip_width = cvt.input_line_width;
+            output_stride = 8;
+            break;
+        case Rotation::Clockwise_270:
+            RotateTile(cvt.rotation, tiles[num_tiles - i - 1], tmp_tile, row_height, tile_remap);
+            image_strip_width = 8;
+            output_stride = 8 * row_height;
+            break;
+        }
+
+        switch (cvt.block_alignment) {
+        case BlockAlignment::Linear:
+            WriteTileToOutput(output_buffer, tmp_tile, row_height, image_strip_width);
+            output_buffer += output_stride;
+            break;
+        case BlockAlignment::Block8x8:
+            WriteTileToOutput(output_buffer, tmp_tile, 8, 8);
+            output_buffer += TILE_SIZE;
+            break;
         }
     }
 }
 
+/// Returns the end of the address range touched by a CDMA transfer of `size` bytes
+static VAddr GetTransferEnd(const ConversionBuffer& buf, size_t size) {
+    // Transfers can go a little past the requested size, so round up generously
+    const size_t num_units = size / buf.transfer_unit + 2;
+    return static_cast<VAddr>(buf.address + num_units * (buf.transfer_unit + buf.gap));
+}
+
+/// Returns whether the output of the conversion could overwrite input data not received yet
+static bool OutputOverlapsInput(const ConversionConfiguration& cvt) {
+    const ConversionBuffer* sources[3];
+    size_t source_sizes[3];
+    size_t num_sources = 0;
+
+    const size_t image_size = cvt.input_line_width * cvt.input_lines;
+    switch (cvt.input_format) {
+    case InputFormat::YUV422_Indiv8:
+    case InputFormat::YUV420_Indiv8:
+    case InputFormat::YUV422_Indiv16:
+    case InputFormat::YUV420_Indiv16: {
+        const bool is_16bit = cvt.input_format == InputFormat::YUV422_Indiv16 ||
+                              cvt.input_format == InputFormat::YUV420_Indiv16;
+        const bool is_420 = cvt.input_format == InputFormat::YUV420_Indiv8 ||
+                            cvt.input_format == InputFormat::YUV420_Indiv16;
+        const size_t luma_size = image_size * (is_16bit ? 2 : 1);
+        const size_t chroma_size = is_420 ? luma_size / 4 : luma_size / 2;
+        sources[num_sources] = &cvt.src_Y;
+        source_sizes[num_sources++] = luma_size;
+        sources[num_sources] = &cvt.src_U;
+        source_sizes[num_sources++] = chroma_size;
+        sources[num_sources] = &cvt.src_V;
+        source_sizes[num_sources++] = chroma_size;
+        break;
+    }
+    case InputFormat::YUYV422_Interleaved:
+        sources[num_sources] = &cvt.src_YUYV;
+        source_sizes[num_sources++] = image_size * 2;
+        break;
+    }
+
+    if (cvt.dst.transfer_unit == 0)
+        return true;
+    const VAddr dst_start = cvt.dst.address;
+    const VAddr dst_end = GetTransferEnd(cvt.dst, image_size * 4);
+
+    for (size_t i = 0; i < num_sources; ++i) {
+        const ConversionBuffer& src = *sources[i];
+        if (src.transfer_unit == 0)
+            return true;
+        if (src.address < dst_end && dst_start < GetTransferEnd(src, source_sizes[i]))
+            return true;
+    }
+    return false;
+}
+
 /**
  * Performs a Y2R colorspace conversion.
  *
@@ -249,6 +732,10 @@ static void WriteTileToOutput(u32* output, const ImageTile& tile, int height, in
  * diverging code paths to keep the amount of branches in check. Some steps are also merged to
  * increase efficiency.
  *
+ * Since strips are converted independently, all of them are received first, then converted on the
+ * Y2R thread pool and finally sent in order. This gives the same result as converting one strip
+ * at a time, unless the output overlaps the input, in which case strips are processed one by one.
+ *
  * Output for all valid settings combinations matches hardware, however output in some edge-cases
  * differs:
  *
@@ -268,115 +755,61 @@ void PerformConversion(ConversionConfiguration& cvt) {
     size_t num_tiles = cvt.input_line_width / 8;
     ASSERT(num_tiles <= MAX_TILES);
 
-    // Buffer used as a CDMA source/target.
-    std::unique_ptr<u8[]> data_buffer(new u8[cvt.input_line_width * 8 * 4]);
-    // Intermediate storage for decoded 8x8 image tiles. Always stored as RGB32.
-    std::unique_ptr<ImageTile[]> tiles(new ImageTile[num_tiles]);
-    ImageTile tmp_tile;
-
-    // LUT used to remap writes to a tile. Used to allow linear or swizzled output without
-    // requiring two different code paths.
-    const u8* tile_remap = nullptr;
-    switch (cvt.block_alignment) {
-    case BlockAlignment::Linear:
-        tile_remap = linear_lut;
-        break;
-    case BlockAlignment::Block8x8:
-        tile_remap = morton_lut;
-        break;
-    }
+    const size_t num_strips = (cvt.input_lines + 7) / 8;
+    const size_t strip_pixels = cvt.input_line_width * 8;
+    const size_t batch_size = OutputOverlapsInput(cvt) ? 1 : num_strips;
 
-    for (unsigned int y = 0; y < cvt.input_lines; y += 8) {
-        unsigned int row_height = std::min(cvt.input_lines - y, 8u);
+    // The received YUV data and the RGB32 pixels to be sent for each strip of a batch. Sending may
+    // read up to a transfer unit past the end of the last strip.
+    input_buffer.resize(batch_size * strip_pixels * 2);
+    output_buffer.resize(batch_size * strip_pixels + cvt.dst.transfer_unit);
+    // Intermediate storage for decoded 8x8 image tiles. Always stored as RGB32.
+    tiles_buffer.resize(batch_size * num_tiles);
 
-        // Total size in pixels of incoming data required for this strip.
-        const size_t row_data_size = row_height * cvt.input_line_width;
+    const auto row_height = [&cvt](size_t strip) {
+        return std::min<unsigned int>(cvt.input_lines - static_cast<unsigned int>(strip) * 8, 8u);
+    };
 
-        u8* input_Y = data_buffer.get();
-        u8* input_U = input_Y + 8 * cvt.input_line_width;
-        u8* input_V = input_U + 8 * cvt.input_line_width / 2;
+    for (size_t first_strip = 0; first_strip < num_strips; first_strip += batch_size) {
+        const size_t batch_strips = std::min(batch_size, num_strips - first_strip);
 
-        switch (cvt.input_format) {
-        case InputFormat::YUV422_Indiv8:
-            ReceiveData<1>(input_Y, cvt.src_Y, row_data_size);
-            ReceiveData<1>(input_U, cvt.src_U, row_data_size / 2);
-            ReceiveData<1>(input_V, cvt.src_V, row_data_size / 2);
-            break;
-        case InputFormat::YUV420_Indiv8:
-            ReceiveData<1>(input_Y, cvt.src_Y, row_data_size);
-            ReceiveData<1>(input_U, cvt.src_U, row_data_size / 4);
-            ReceiveData<1>(input_V, cvt.src_V, row_data_size / 4);
-            break;
-        case InputFormat::YUV422_Indiv16:
-            ReceiveData<2>(input_Y, cvt.src_Y, row_data_size);
-            ReceiveData<2>(input_U, cvt.src_U, row_data_size / 2);
-            ReceiveData<2>(input_V, cvt.src_V, row_data_size / 2);
-            break;
-        case InputFormat::YUV420_Indiv16:
-            ReceiveData<2>(input_Y, cvt.src_Y, row_data_size);
-            ReceiveData<2>(input_U, cvt.src_U, row_data_size / 4);
-            ReceiveData<2>(input_V, cvt.src_V, row_data_size / 4);
-            break;
-        case InputFormat::YUYV422_Interleaved:
-            input_U = nullptr;
-            input_V = nullptr;
-            ReceiveData<1>(input_Y, cvt.src_YUYV, row_data_size * 2);
-            break;
+        for (size_t i = 0; i < batch_strips; ++i) {
+            // Total size in pixels of incoming data required for this strip.
+            const size_t row_data_size = row_height(first_strip + i) * cvt.input_line_width;
+            ReceiveStrip(cvt, &input_buffer[i * strip_pixels * 2], row_data_size);
         }
 
-        // Note(yuriks): If additional optimization is required, input_format can be moved to a
-        // template parameter, so that its dispatch can be moved to outside the inner loop.
-        ConvertYUVToRGB(cvt.input_format, input_Y, input_U, input_V, tiles.get(),
-                        cvt.input_line_width, row_height, cvt.coefficients);
-
-        u32* output_buffer = reinterpret_cast<u32*>(data_buffer.get());
-
-        for (size_t i = 0; i < num_tiles; ++i) {
-            int image_strip_width = 0;
-            int output_stride = 0;
-
-            switch (cvt.rotation) {
-            case Rotation::None:
-                RotateTile0(tiles[i], tmp_tile, row_height, tile_remap);
-                image_strip_width = cvt.input_line_width;
-                output_stride = 8;
-                break;
-            case Rotation::Clockwise_90:
-                RotateTile90(tiles[i], tmp_tile, row_height, tile_remap);
-                image_strip_width = 8;
-                output_stride = 8 * row_height;
-                break;
-            case Rotation::Clockwise_180:
-                // For 180 and 270 degree rotations we also invert the order of tiles in the strip,
-                // since the rotates are done individually on each tile.
-                RotateTile180(tiles[num_tiles - i - 1], tmp_tile, row_height, tile_remap);
-                image_strip_width = cvt.input_line_width;
-                output_stride = 8;
-                break;
-            case Rotation::Clockwise_270:
-                RotateTile270(tiles[num_tiles - i - 1], tmp_tile, row_height, tile_remap);
-                image_strip_width = 8;
-                output_stride = 8 * row_height;
-                break;
-            }
-
-            switch (cvt.block_alignment) {
-            case BlockAlignment::Linear:
-                WriteTileToOutput(output_buffer, tmp_tile, row_height, image_strip_width);
-                output_buffer += output_stride;
-                break;
-            case BlockAlignment::Block8x8:
-                WriteTileToOutput(output_buffer, tmp_tile, 8, 8);
-                output_buffer += TILE_SIZE;
-                break;
+        const auto convert_strip = [&](size_t i) {
+            ConvertStrip(cvt, &input_buffer[i * strip_pixels * 2], &tiles_buffer[i * num_tiles],
+                         &output_buffer[i * strip_pixels], row_height(first_strip + i));
+        };
+        if (thread_pool != nullptr && batch_strips > 1) {
+            thread_pool->ParallelFor(batch_strips, convert_strip);
+        } else {
+            for (size_t i = 0; i < batch_strips; ++i) {
+                convert_strip(i);
             }
         }
 
-        // Note(yuriks): If additional optimization is required, output_format can be moved to a
-        // template parameter, so that its dispatch can be moved to outside the inner loop.
-        SendData(reinterpret_cast<u32*>(data_buffer.get()), cvt.dst, (int)row_data_size,
-                 cvt.output_format, (u8)cvt.alpha);
+        for (size_t i = 0; i < batch_strips; ++i) {
+            const size_t row_data_size = row_height(first_strip + i) * cvt.input_line_width;
+            SendStrip(cvt, &output_buffer[i * strip_pixels], static_cast<int>(row_data_size));
+        }
     }
 }
+
+void Init() {
+    const size_t num_threads =
+        std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), MAX_THREADS);
+    thread_pool = std::make_unique<Common::ThreadPool>(num_threads - 1, "Y2R");
+}
+
+void Shutdown() {
+    thread_pool.reset();
+    input_buffer = {};
+    output_buffer = {};
+    tiles_buffer = {};
+}
+
 }
 }
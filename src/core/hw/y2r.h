@@ -13,5 +13,10 @@ struct ConversionConfiguration;
 namespace HW {
 namespace Y2R {
 void PerformConversion(Service::Y2R::ConversionConfiguration& cvt);
+
+/// Starts the threads used to convert image strips in parallel
+void Init();
+/// Stops the conversion threads
+void Shutdown();
 }
 }
@@ -341,7 +341,8 @@ SharedPtr<CodeSet> ElfReader::LoadInto(u32 vaddr) {
     }
 
     codeset->entrypoint = base_addr + header->e_entry;
-    codeset->memory = std::make_shared<std::vector<u8>>(std::move(program_image));
+    codeset->memory =
+        std::make_shared<Kernel::MemoryBlock>(program_image.begin(), program_image.end());
 
     LOG_DEBUG(Loader, "Done loading.");
 
@@ -166,7 +166,7 @@ ResultStatus AppLoader_NCCH::LoadExec() {
             exheader_header.codeset_info.data.num_max_pages * Memory::PAGE_SIZE + bss_page_size;
 
         codeset->entrypoint = codeset->code.addr;
-        codeset->memory = std::make_shared<std::vector<u8>>(std::move(code));
+        codeset->memory = std::make_shared<Kernel::MemoryBlock>(code.begin(), code.end());
 
         Kernel::g_current_process = Kernel::Process::Create(std::move(codeset));
 
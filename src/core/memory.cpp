@@ -2,11 +2,18 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
 #include <cstring>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <new>
+#include "audio_core/hle/buffer_cache.h"
 #include "common/assert.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
+#include "common/memory_util.h"
 #include "common/swap.h"
 #include "core/hle/kernel/process.h"
 #include "core/memory.h"
@@ -63,6 +70,13 @@ struct PageTable {
      */
     std::array<PageType, PAGE_TABLE_NUM_ENTRIES> attributes;
 
+    /**
+     * Array of memory pointers backing each page of type `Memory` or `RasterizerCachedMemory`.
+     * Unlike `pointers`, entries stay set while a page is cached, so that the slow paths reach the
+     * memory of cached pages without looking up the VMA of the current process.
+     */
+    std::array<u8*, PAGE_TABLE_NUM_ENTRIES> backing_pointers;
+
     /**
      * Indicates the number of externally cached resources touching a page that should be
      * flushed before the memory is accessed
@@ -79,10 +93,216 @@ std::array<u8*, PAGE_TABLE_NUM_ENTRIES>* GetCurrentPageTablePointers() {
     return &current_page_table->pointers;
 }
 
+/// Size of the arena holding the memory which backs emulated memory. Host memory only backs the
+/// pages of it which are used.
+constexpr size_t BACKING_ARENA_SIZE = size_t(1) << 30;
+
+struct BackingArena {
+    MemoryArena arena;
+    std::mutex mutex;
+    /// Unallocated ranges of the arena, mapping their offset to their size
+    std::map<size_t, size_t> free_ranges;
+};
+
+static BackingArena& GetBackingArena() {
+    // Never destroyed, as the memory blocks owned by static objects are freed during exit
+    static BackingArena* backing_arena = [] {
+        auto* backing = new BackingArena;
+        // Hosts which can't map the arena into the fastmem region don't need it either
+        if (sizeof(void*) >= 8 && backing->arena.Create(BACKING_ARENA_SIZE))
+            backing->free_ranges.emplace(0, BACKING_ARENA_SIZE);
+        return backing;
+    }();
+    return *backing_arena;
+}
+
+static size_t RoundUpToPage(size_t size) {
+    return (size + PAGE_MASK) & ~static_cast<size_t>(PAGE_MASK);
+}
+
+u8* AllocateBackingMemory(size_t size) {
+    if (size == 0)
+        return nullptr;
+    size = RoundUpToPage(size);
+
+    BackingArena& backing = GetBackingArena();
+    {
+        std::lock_guard<std::mutex> lock(backing.mutex);
+        auto range = std::find_if(backing.free_ranges.begin(), backing.free_ranges.end(),
+                                  [size](const auto& range) { return range.second >= size; });
+        if (range != backing.free_ranges.end()) {
+            const size_t offset = range->first;
+            const size_t remaining_size = range->second - size;
+            backing.free_ranges.erase(range);
+            if (remaining_size != 0)
+                backing.free_ranges.emplace(offset + size, remaining_size);
+            return backing.arena.GetBase() + offset;
+        }
+    }
+
+    if (backing.arena.GetBase() != nullptr) {
+        LOG_CRITICAL(HW_Memory, "Backing memory arena exhausted, allocating 0x%zX bytes outside it",
+                     size);
+    }
+    u8* ptr = static_cast<u8*>(AllocateMemoryPages(size));
+    if (ptr == nullptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void FreeBackingMemory(u8* ptr, size_t size) {
+    if (ptr == nullptr)
+        return;
+    size = RoundUpToPage(size);
+
+    BackingArena& backing = GetBackingArena();
+    if (!backing.arena.Contains(ptr)) {
+        FreeMemoryPages(ptr, size);
+        return;
+    }
+
+    size_t offset = ptr - backing.arena.GetBase();
+    backing.arena.Discard(offset, size);
+
+    // Merge the range with the free ones around it
+    std::lock_guard<std::mutex> lock(backing.mutex);
+    auto next = backing.free_ranges.lower_bound(offset);
+    if (next != backing.free_ranges.end() && offset + size == next->first) {
+        size += next->second;
+        next = backing.free_ranges.erase(next);
+    }
+    if (next != backing.free_ranges.begin()) {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == offset) {
+            previous->second += size;
+            return;
+        }
+    }
+    backing.free_ranges.emplace(offset, size);
+}
+
+/// Size of the fastmem region: the 32-bit address space, followed by a guard page catching the
+/// accesses which cross its end
+constexpr u64 FASTMEM_REGION_SIZE = 0x100000000ull + PAGE_SIZE;
+
+u8* fastmem_base = nullptr;
+/// Page of the arena mapped where unmapped memory is accessed through the fastmem region
+static u8* fastmem_scratch_page = nullptr;
+
+/// Returns whether a page is mapped in the fastmem region, which is the case for the memory pages
+/// backed by the arena
+static bool IsFastmemPage(u32 page) {
+    const PageType type = current_page_table->attributes[page];
+    return (type == PageType::Memory || type == PageType::RasterizerCachedMemory) &&
+           GetBackingArena().arena.Contains(current_page_table->backing_pointers[page]);
+}
+
+static u8* GetFastmemPointer(u32 page) {
+    return fastmem_base + static_cast<size_t>(page) * PAGE_SIZE;
+}
+
+/// Maps the pages of the fastmem region like they are in the current page table
+static void UpdateFastmemPages(u32 page, u32 num_pages) {
+    if (fastmem_base == nullptr)
+        return;
+
+    const MemoryArena& arena = GetBackingArena().arena;
+    const u32 end = page + num_pages;
+    while (page != end) {
+        u8* const pointer = current_page_table->backing_pointers[page];
+        u32 run = 1;
+        if (IsFastmemPage(page)) {
+            // Pages backed by consecutive memory are mapped with a single view
+            while (page + run != end && IsFastmemPage(page + run) &&
+                   current_page_table->backing_pointers[page + run] ==
+                       pointer + static_cast<size_t>(run) * PAGE_SIZE) {
+                ++run;
+            }
+            arena.MapView(pointer - arena.GetBase(), static_cast<size_t>(run) * PAGE_SIZE,
+                          GetFastmemPointer(page));
+            for (u32 i = page; i != page + run; ++i) {
+                if (current_page_table->attributes[i] == PageType::RasterizerCachedMemory)
+                    ProtectMemoryPages(GetFastmemPointer(i), PAGE_SIZE, false);
+            }
+        } else {
+            while (page + run != end && !IsFastmemPage(page + run))
+                ++run;
+            ResetAddressSpace(GetFastmemPointer(page), static_cast<size_t>(run) * PAGE_SIZE);
+        }
+        page += run;
+    }
+}
+
+static bool HandleFastmemFault(uintptr_t address) {
+    const uintptr_t base = reinterpret_cast<uintptr_t>(fastmem_base);
+    if (fastmem_base == nullptr || address < base || address - base >= 0x100000000ull)
+        return false;
+
+    const VAddr vaddr = static_cast<VAddr>(address - base);
+    const u32 page = vaddr >> PAGE_BITS;
+    switch (current_page_table->attributes[page]) {
+    case PageType::Unmapped: {
+        // Through the page table, these accesses read zero and drop the writes. Here a zeroed
+        // scratch page is mapped at the address instead, and used until the page is mapped.
+        LOG_ERROR(HW_Memory, "unmapped fastmem access @ 0x%08X", vaddr);
+        const MemoryArena& arena = GetBackingArena().arena;
+        std::memset(fastmem_scratch_page, 0, PAGE_SIZE);
+        return arena.MapView(fastmem_scratch_page - arena.GetBase(), PAGE_SIZE,
+                             GetFastmemPointer(page));
+    }
+    case PageType::RasterizerCachedMemory:
+        // The page table flushes cached pages before reading them, and also invalidates them
+        // before writing them. Whether this access reads or writes isn't known, so both are done,
+        // which leaves the page uncached and accessible again for the retried access.
+        RasterizerFlushAndInvalidateRegion(VirtualToPhysicalAddress(page << PAGE_BITS),
+                                           PAGE_SIZE);
+        return current_page_table->attributes[page] == PageType::Memory;
+    case PageType::Memory:
+        LOG_CRITICAL(HW_Memory, "Memory page not backed by the arena @ 0x%08X", vaddr);
+        return false;
+    default:
+        // MMIO isn't mapped into processes, and can't be handled by retrying the access
+        LOG_CRITICAL(HW_Memory, "fastmem access to MMIO @ 0x%08X", vaddr);
+        return false;
+    }
+}
+
+bool EnableFastmem() {
+    if (fastmem_base != nullptr)
+        return true;
+
+    if (sizeof(void*) < 8 || GetBackingArena().arena.GetBase() == nullptr)
+        return false;
+
+    if (fastmem_scratch_page == nullptr)
+        fastmem_scratch_page = AllocateBackingMemory(PAGE_SIZE);
+    if (!GetBackingArena().arena.Contains(fastmem_scratch_page))
+        return false;
+
+    fastmem_base =
+        static_cast<u8*>(ReserveAddressSpace(static_cast<size_t>(FASTMEM_REGION_SIZE)));
+    if (fastmem_base == nullptr)
+        return false;
+
+    InstallMemoryFaultHandler(HandleFastmemFault);
+    UpdateFastmemPages(0, PAGE_TABLE_NUM_ENTRIES);
+    return true;
+}
+
+void DisableFastmem() {
+    if (fastmem_base == nullptr)
+        return;
+
+    UninstallMemoryFaultHandler();
+    ReleaseAddressSpace(fastmem_base, static_cast<size_t>(FASTMEM_REGION_SIZE));
+    fastmem_base = nullptr;
+}
+
 static void MapPages(u32 base, u32 size, u8* memory, PageType type) {
     LOG_DEBUG(HW_Memory, "Mapping %p onto %08X-%08X", memory, base * PAGE_SIZE,
               (base + size) * PAGE_SIZE);
 
+    const u32 first_page = base;
     u32 end = base + size;
 
     while (base != end) {
@@ -98,18 +318,23 @@ static void MapPages(u32 base, u32 size, u8* memory, PageType type) {
 
         current_page_table->attributes[base] = type;
         current_page_table->pointers[base] = memory;
+        current_page_table->backing_pointers[base] = memory;
         current_page_table->cached_res_count[base] = 0;
 
         base += 1;
         if (memory != nullptr)
             memory += PAGE_SIZE;
     }
+
+    UpdateFastmemPages(first_page, size);
 }
 
 void InitMemoryMap() {
     main_page_table.pointers.fill(nullptr);
     main_page_table.attributes.fill(PageType::Unmapped);
+    main_page_table.backing_pointers.fill(nullptr);
     main_page_table.cached_res_count.fill(0);
+    UpdateFastmemPages(0, PAGE_TABLE_NUM_ENTRIES);
 }
 
 void MapMemoryRegion(VAddr base, u32 size, u8* target) {
@@ -133,25 +358,13 @@ void UnmapRegion(VAddr base, u32 size) {
 }
 
 /**
- * Gets a pointer to the exact memory at the virtual address (i.e. not page aligned)
- * using a VMA from the current process
+ * Gets a pointer to the exact memory at the virtual address (i.e. not page aligned) of a page of
+ * type `Memory` or `RasterizerCachedMemory`
  */
-static u8* GetPointerFromVMA(VAddr vaddr) {
-    u8* direct_pointer = nullptr;
-
-    auto& vma = Kernel::g_current_process->vm_manager.FindVMA(vaddr)->second;
-    switch (vma.type) {
-    case Kernel::VMAType::AllocatedMemoryBlock:
-        direct_pointer = vma.backing_block->data() + vma.offset;
-        break;
-    case Kernel::VMAType::BackingMemory:
-        direct_pointer = vma.backing_memory;
-        break;
-    default:
-        UNREACHABLE();
-    }
-
-    return direct_pointer + (vaddr - vma.base);
+static u8* GetBackingPointer(VAddr vaddr) {
+    u8* page_pointer = current_page_table->backing_pointers[vaddr >> PAGE_BITS];
+    DEBUG_ASSERT_MSG(page_pointer != nullptr, "Memory page without a pointer @ %08X", vaddr);
+    return page_pointer + (vaddr & PAGE_MASK);
 }
 
 /**
@@ -192,7 +405,7 @@ T Read(const VAddr vaddr) {
         RasterizerFlushRegion(VirtualToPhysicalAddress(vaddr), sizeof(T));
 
         T value;
-        std::memcpy(&value, GetPointerFromVMA(vaddr), sizeof(T));
+        std::memcpy(&value, GetBackingPointer(vaddr), sizeof(T));
         return value;
     }
     case PageType::Special:
@@ -231,7 +444,7 @@ void Write(const VAddr vaddr, const T data) {
     case PageType::RasterizerCachedMemory: {
         RasterizerFlushAndInvalidateRegion(VirtualToPhysicalAddress(vaddr), sizeof(T));
 
-        std::memcpy(GetPointerFromVMA(vaddr), &data, sizeof(T));
+        std::memcpy(GetBackingPointer(vaddr), &data, sizeof(T));
         break;
     }
     case PageType::Special:
@@ -278,7 +491,7 @@ u8* GetPointer(const VAddr vaddr) {
     }
 
     if (current_page_table->attributes[vaddr >> PAGE_BITS] == PageType::RasterizerCachedMemory) {
-        return GetPointerFromVMA(vaddr);
+        return GetBackingPointer(vaddr);
     }
 
     LOG_ERROR(HW_Memory, "unknown GetPointer @ 0x%08x", vaddr);
@@ -326,6 +539,9 @@ void RasterizerMarkRegionCached(PAddr start, u32 size, int count_delta) {
             case PageType::Memory:
                 page_type = PageType::RasterizerCachedMemory;
                 current_page_table->pointers[vaddr >> PAGE_BITS] = nullptr;
+                // Accesses through the fastmem region now fault, see HandleFastmemFault
+                if (fastmem_base != nullptr && IsFastmemPage(vaddr >> PAGE_BITS))
+                    ProtectMemoryPages(GetFastmemPointer(vaddr >> PAGE_BITS), PAGE_SIZE, false);
                 break;
             case PageType::Special:
                 page_type = PageType::RasterizerCachedSpecial;
@@ -344,7 +560,9 @@ void RasterizerMarkRegionCached(PAddr start, u32 size, int count_delta) {
             case PageType::RasterizerCachedMemory:
                 page_type = PageType::Memory;
                 current_page_table->pointers[vaddr >> PAGE_BITS] =
-                    GetPointerFromVMA(vaddr & ~PAGE_MASK);
+                    current_page_table->backing_pointers[vaddr >> PAGE_BITS];
+                if (fastmem_base != nullptr && IsFastmemPage(vaddr >> PAGE_BITS))
+                    ProtectMemoryPages(GetFastmemPointer(vaddr >> PAGE_BITS), PAGE_SIZE, true);
                 break;
             case PageType::RasterizerCachedSpecial:
                 page_type = PageType::Special;
@@ -367,6 +585,8 @@ void RasterizerFlushAndInvalidateRegion(PAddr start, u32 size) {
     if (VideoCore::g_renderer != nullptr) {
         VideoCore::g_renderer->Rasterizer()->FlushAndInvalidateRegion(start, size);
     }
+    // The DSP also keeps decoded copies of audio buffers in cached regions
+    DSP::HLE::InvalidateDecodedBuffers(start, size);
 }
 
 u8 Read8(const VAddr addr) {
@@ -417,7 +637,7 @@ void ReadBlock(const VAddr src_addr, void* dest_buffer, const size_t size) {
         case PageType::RasterizerCachedMemory: {
             RasterizerFlushRegion(VirtualToPhysicalAddress(current_vaddr), copy_amount);
 
-            std::memcpy(dest_buffer, GetPointerFromVMA(current_vaddr), copy_amount);
+            std::memcpy(dest_buffer, GetBackingPointer(current_vaddr), copy_amount);
             break;
         }
         case PageType::RasterizerCachedSpecial: {
@@ -488,7 +708,7 @@ void WriteBlock(const VAddr dest_addr, const void* src_buffer, const size_t size
             RasterizerFlushAndInvalidateRegion(VirtualToPhysicalAddress(current_vaddr),
                                                copy_amount);
 
-            std::memcpy(GetPointerFromVMA(current_vaddr), src_buffer, copy_amount);
+            std::memcpy(GetBackingPointer(current_vaddr), src_buffer, copy_amount);
             break;
         }
         case PageType::RasterizerCachedSpecial: {
@@ -545,7 +765,7 @@ void ZeroBlock(const VAddr dest_addr, const size_t size) {
             RasterizerFlushAndInvalidateRegion(VirtualToPhysicalAddress(current_vaddr),
                                                copy_amount);
 
-            std::memset(GetPointerFromVMA(current_vaddr), 0, copy_amount);
+            std::memset(GetBackingPointer(current_vaddr), 0, copy_amount);
             break;
         }
         case PageType::RasterizerCachedSpecial: {
@@ -600,7 +820,7 @@ void CopyBlock(VAddr dest_addr, VAddr src_addr, const size_t size) {
         case PageType::RasterizerCachedMemory: {
             RasterizerFlushRegion(VirtualToPhysicalAddress(current_vaddr), copy_amount);
 
-            WriteBlock(dest_addr, GetPointerFromVMA(current_vaddr), copy_amount);
+            WriteBlock(dest_addr, GetBackingPointer(current_vaddr), copy_amount);
             break;
         }
         case PageType::RasterizerCachedSpecial: {
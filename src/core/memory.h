@@ -6,6 +6,7 @@
 
 #include <array>
 #include <cstddef>
+#include <cstring>
 #include <string>
 #include "common/common_types.h"
 
@@ -187,4 +188,67 @@ void RasterizerFlushAndInvalidateRegion(PAddr start, u32 size);
  * retrieve the current page table for that purpose.
  */
 std::array<u8*, PAGE_TABLE_NUM_ENTRIES>* GetCurrentPageTablePointers();
+
+/**
+ * Allocates page-aligned host memory to back emulated memory. Where the host supports it, the
+ * memory comes from the arena which the fastmem region is mapped from.
+ */
+u8* AllocateBackingMemory(size_t size);
+void FreeBackingMemory(u8* ptr, size_t size);
+
+/// Allocator for containers backing emulated memory, using AllocateBackingMemory
+template <typename T>
+struct BackingMemoryAllocator {
+    using value_type = T;
+
+    BackingMemoryAllocator() = default;
+    template <typename U>
+    BackingMemoryAllocator(const BackingMemoryAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        return reinterpret_cast<T*>(AllocateBackingMemory(n * sizeof(T)));
+    }
+    void deallocate(T* ptr, size_t n) {
+        FreeBackingMemory(reinterpret_cast<u8*>(ptr), n * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const BackingMemoryAllocator<U>&) const {
+        return true;
+    }
+    template <typename U>
+    bool operator!=(const BackingMemoryAllocator<U>&) const {
+        return false;
+    }
+};
+
+/**
+ * Base of the fastmem region, or null if it is disabled. This host region is laid out like the
+ * emulated address space: the regular memory pages of the current page table are mapped in it at
+ * their virtual address, so that they can be accessed with a single load or store. Accessing the
+ * other pages, including the ones cached by the rasterizer, faults and is handled like the page
+ * table does.
+ */
+extern u8* fastmem_base;
+
+/**
+ * Enables the fastmem region, if the host supports it.
+ * @returns Whether the fastmem region is enabled
+ */
+bool EnableFastmem();
+void DisableFastmem();
+
+/// Reads a value from the fastmem region, which must be enabled
+template <typename T>
+inline T FastmemRead(VAddr vaddr) {
+    T value;
+    std::memcpy(&value, fastmem_base + vaddr, sizeof(T));
+    return value;
+}
+
+/// Writes a value to the fastmem region, which must be enabled
+template <typename T>
+inline void FastmemWrite(VAddr vaddr, const T data) {
+    std::memcpy(fastmem_base + vaddr, &data, sizeof(T));
+}
 }
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <chrono>
 #include <mutex>
 #include <thread>
@@ -12,6 +13,7 @@
 
 using namespace std::chrono_literals;
 using DoubleSecs = std::chrono::duration<double, std::chrono::seconds::period>;
+using DoubleMicros = std::chrono::duration<double, std::chrono::microseconds::period>;
 using std::chrono::duration_cast;
 using std::chrono::microseconds;
 
@@ -79,13 +81,19 @@ void FrameLimiter::DoFrameLimiting(u64 current_system_time_us) {
     // values increase the time needed to recover and limit framerate again after spikes.
     constexpr microseconds MAX_LAG_TIME_US = 25ms;
 
+    AdvanceFrameSkip();
+
     if (!Settings::values.toggle_framelimit) {
         return;
     }
 
     auto now = Clock::now();
 
-    frame_limiting_delta_err += microseconds(current_system_time_us - previous_system_time_us);
+    // A speed target above 100% shrinks the walltime each emulated microsecond is allowed to take
+    const double speed = std::max<u16>(Settings::values.frame_limit, 1) / 100.0;
+    const u64 emulated_time_us = current_system_time_us - previous_system_time_us;
+    frame_limiting_delta_err +=
+        duration_cast<microseconds>(DoubleMicros(static_cast<double>(emulated_time_us) / speed));
     frame_limiting_delta_err -= duration_cast<microseconds>(now - previous_walltime);
     frame_limiting_delta_err =
         MathUtil::Clamp(frame_limiting_delta_err, -MAX_LAG_TIME_US, MAX_LAG_TIME_US);
@@ -102,4 +110,18 @@ void FrameLimiter::DoFrameLimiting(u64 current_system_time_us) {
     previous_walltime = now;
 }
 
+void FrameLimiter::AdvanceFrameSkip() {
+    const u32 period = Settings::values.frame_skip_period;
+    const u32 skip = period == 0 ? 0 : std::min<u32>(Settings::values.frame_skip, period - 1);
+    if (skip == 0) {
+        frame_skip_index = 0;
+        frame_skipped = false;
+        return;
+    }
+
+    // The first frame of each period is rendered, followed by the skipped ones
+    frame_skip_index = (frame_skip_index + 1) % period;
+    frame_skipped = frame_skip_index != 0 && frame_skip_index <= skip;
+}
+
 } // namespace Core
@@ -68,9 +68,25 @@ class FrameLimiter {
 public:
     using Clock = std::chrono::high_resolution_clock;
 
+    /**
+     * Waits until the walltime catches up with the emulated time, scaled by the configured speed
+     * target, and decides whether the next frame is skipped. Called once per emulated frame.
+     */
     void DoFrameLimiting(u64 current_system_time_us);
 
+    /**
+     * Returns whether the current frame is skipped, in which case it is not presented and its draws
+     * to the buffers shown on the screens are dropped. Its other draws still run, as the
+     * application can read back or sample what they render. Only valid on the emulation thread.
+     */
+    bool IsFrameSkipped() const {
+        return frame_skipped;
+    }
+
 private:
+    /// Moves on to the next frame of the frame skip period
+    void AdvanceFrameSkip();
+
     /// Emulated system time (in microseconds) at the last limiter invocation
     u64 previous_system_time_us = 0;
     /// Walltime at the last limiter invocation
@@ -78,6 +94,11 @@ private:
 
     /// Accumulated difference between walltime and emulated time
     std::chrono::microseconds frame_limiting_delta_err{0};
+
+    /// Index of the current frame in the frame skip period
+    u32 frame_skip_index = 0;
+    /// Whether the current frame is skipped
+    bool frame_skipped = false;
 };
 
 } // namespace Core
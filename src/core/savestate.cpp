@@ -0,0 +1,241 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cinttypes>
+#include <cstring>
+#include <vector>
+#include "audio_core/audio_core.h"
+#include "common/chunk_file.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/scm_rev.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/hle/kernel/savestate.h"
+#include "core/hle/service/service.h"
+#include "core/hw/hw.h"
+#include "core/memory.h"
+#include "core/savestate.h"
+#include "video_core/pica.h"
+#include "video_core/renderer_base.h"
+#include "video_core/video_core.h"
+
+namespace SaveState {
+
+constexpr u32 SAVE_STATE_MAGIC = 0x54534343; // "CCST"
+constexpr u32 SAVE_STATE_VERSION = 1;
+
+/// Upper bound of the uncompressed size, which also keeps all run lengths within 32 bits
+constexpr u64 MAX_STATE_SIZE = 0x40000000;
+
+struct Header {
+    u32 magic;
+    u32 version;
+    u64 program_id;
+    char scm_rev[40];
+    u64 uncompressed_size;
+    u64 compressed_size;
+};
+static_assert(sizeof(Header) == 72, "Header has incorrect size");
+
+/// Zero runs shorter than this are stored as literals
+constexpr size_t MIN_ZERO_RUN = 16;
+
+/**
+ * Compresses the state by run-length encoding runs of zero bytes, which make up most of the
+ * emulated memory. The output is a sequence of (literal length, zero run length) u32 pairs, each
+ * followed by the literal bytes.
+ */
+static std::vector<u8> Compress(const std::vector<u8>& data) {
+    std::vector<u8> out;
+    out.reserve(data.size() / 4);
+
+    const auto emit = [&out](const u8* literal, u32 literal_length, u32 zero_length) {
+        const size_t pos = out.size();
+        out.resize(pos + 2 * sizeof(u32) + literal_length);
+        std::memcpy(&out[pos], &literal_length, sizeof(u32));
+        std::memcpy(&out[pos + sizeof(u32)], &zero_length, sizeof(u32));
+        std::memcpy(&out[pos + 2 * sizeof(u32)], literal, literal_length);
+    };
+
+    size_t literal_start = 0;
+    size_t i = 0;
+    while (i < data.size()) {
+        if (data[i] != 0) {
+            ++i;
+            continue;
+        }
+
+        size_t run_end = i;
+        while (run_end < data.size() && data[run_end] == 0)
+            ++run_end;
+
+        if (run_end - i >= MIN_ZERO_RUN || run_end == data.size()) {
+            emit(data.data() + literal_start, static_cast<u32>(i - literal_start),
+                 static_cast<u32>(run_end - i));
+            literal_start = run_end;
+        }
+        i = run_end;
+    }
+
+    if (literal_start < data.size()) {
+        emit(&data[literal_start], static_cast<u32>(data.size() - literal_start), 0);
+    }
+
+    return out;
+}
+
+static bool Decompress(const std::vector<u8>& in, std::vector<u8>& out) {
+    size_t in_pos = 0;
+    size_t out_pos = 0;
+    while (in_pos < in.size()) {
+        if (in.size() - in_pos < 2 * sizeof(u32))
+            return false;
+
+        u32 literal_length, zero_length;
+        std::memcpy(&literal_length, &in[in_pos], sizeof(u32));
+        std::memcpy(&zero_length, &in[in_pos + sizeof(u32)], sizeof(u32));
+        in_pos += 2 * sizeof(u32);
+
+        if (in.size() - in_pos < literal_length || out.size() - out_pos < literal_length)
+            return false;
+        std::memcpy(&out[out_pos], &in[in_pos], literal_length);
+        in_pos += literal_length;
+        out_pos += literal_length;
+
+        if (out.size() - out_pos < zero_length)
+            return false;
+        std::memset(&out[out_pos], 0, zero_length);
+        out_pos += zero_length;
+    }
+    return out_pos == out.size();
+}
+
+/// Serializes the whole emulated system. Subsystems are ordered so that the kernel objects exist
+/// before anything referring to them is restored.
+static void DoState(PointerWrap& p) {
+    CoreTiming::DoState(p);
+    HW::DoState(p);
+    Kernel::DoState(p);
+    Service::DoState(p);
+    AudioCore::DoState(p);
+    Pica::DoState(p);
+}
+
+static void InitHeader(Header& header, u64 program_id) {
+    std::memset(&header, 0, sizeof(header));
+    header.magic = SAVE_STATE_MAGIC;
+    header.version = SAVE_STATE_VERSION;
+    header.program_id = program_id;
+    std::strncpy(header.scm_rev, Common::g_scm_rev, sizeof(header.scm_rev));
+}
+
+bool Save(const std::string& path, u64 program_id) {
+    // Make sure emulated memory contains everything the GPU has rendered
+    Memory::RasterizerFlushRegion(Memory::VRAM_PADDR, Memory::VRAM_SIZE);
+    Memory::RasterizerFlushRegion(Memory::FCRAM_PADDR, Memory::FCRAM_N3DS_SIZE);
+
+    u8* ptr = nullptr;
+    PointerWrap measure(&ptr, PointerWrap::MODE_MEASURE);
+    DoState(measure);
+    if (measure.error == PointerWrap::ERROR_FAILURE) {
+        LOG_ERROR(Core, "Failed to save state: the emulated system could not be serialized");
+        return false;
+    }
+
+    const size_t size = reinterpret_cast<size_t>(ptr);
+    if (size > MAX_STATE_SIZE) {
+        LOG_ERROR(Core, "Failed to save state: the state is too large (%zu bytes)", size);
+        return false;
+    }
+
+    std::vector<u8> data(size);
+    ptr = data.data();
+    PointerWrap write(&ptr, PointerWrap::MODE_WRITE);
+    DoState(write);
+    if (write.error == PointerWrap::ERROR_FAILURE || ptr != data.data() + data.size()) {
+        LOG_ERROR(Core, "Failed to save state: the serialized size changed");
+        return false;
+    }
+
+    const std::vector<u8> compressed = Compress(data);
+
+    Header header;
+    InitHeader(header, program_id);
+    header.uncompressed_size = data.size();
+    header.compressed_size = compressed.size();
+
+    FileUtil::CreateFullPath(path);
+    FileUtil::IOFile file(path, "wb");
+    if (!file.IsOpen() || file.WriteObject(header) != 1 ||
+        file.WriteBytes(compressed.data(), compressed.size()) != compressed.size()) {
+        LOG_ERROR(Core, "Failed to write save state to %s", path.c_str());
+        return false;
+    }
+
+    LOG_INFO(Core, "Saved state to %s (%zu bytes, %zu compressed)", path.c_str(), data.size(),
+             compressed.size());
+    return true;
+}
+
+bool Load(const std::string& path, u64 program_id) {
+    FileUtil::IOFile file(path, "rb");
+    Header header;
+    if (!file.IsOpen() || file.ReadBytes(&header, sizeof(header)) != sizeof(header)) {
+        LOG_ERROR(Core, "Failed to read save state from %s", path.c_str());
+        return false;
+    }
+
+    Header expected;
+    InitHeader(expected, program_id);
+    if (header.magic != expected.magic || header.version != expected.version) {
+        LOG_ERROR(Core, "%s is not a supported save state", path.c_str());
+        return false;
+    }
+    if (header.program_id != expected.program_id) {
+        LOG_ERROR(Core, "Save state is for title %016" PRIX64 ", the running title is %016" PRIX64,
+                  header.program_id, program_id);
+        return false;
+    }
+    if (std::memcmp(header.scm_rev, expected.scm_rev, sizeof(header.scm_rev)) != 0) {
+        LOG_ERROR(Core, "Save state was created by a different build");
+        return false;
+    }
+    if (header.uncompressed_size > MAX_STATE_SIZE ||
+        header.compressed_size > file.GetSize() - sizeof(header)) {
+        LOG_ERROR(Core, "Save state header is corrupted");
+        return false;
+    }
+
+    std::vector<u8> compressed(header.compressed_size);
+    std::vector<u8> data(header.uncompressed_size);
+    if (file.ReadBytes(compressed.data(), compressed.size()) != compressed.size() ||
+        !Decompress(compressed, data)) {
+        LOG_ERROR(Core, "Save state data is corrupted");
+        return false;
+    }
+    compressed.clear();
+
+    // Write back and drop everything the rasterizer caches, it is recreated after loading
+    Memory::RasterizerFlushAndInvalidateRegion(Memory::VRAM_PADDR, Memory::VRAM_SIZE);
+    Memory::RasterizerFlushAndInvalidateRegion(Memory::FCRAM_PADDR, Memory::FCRAM_N3DS_SIZE);
+
+    u8* ptr = data.data();
+    PointerWrap read(&ptr, PointerWrap::MODE_READ);
+    DoState(read);
+    if (read.error == PointerWrap::ERROR_FAILURE || ptr != data.data() + data.size()) {
+        LOG_CRITICAL(Core, "Failed to load state from %s", path.c_str());
+        Core::System::GetInstance().SetStatus(Core::System::ResultStatus::ErrorUnknown,
+                                              "Failed to load save state");
+        return false;
+    }
+
+    Core::CPU().ClearInstructionCache();
+    VideoCore::g_renderer->ResetRasterizer();
+
+    LOG_INFO(Core, "Loaded state from %s", path.c_str());
+    return true;
+}
+
+} // namespace SaveState
@@ -0,0 +1,31 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include "common/common_types.h"
+
+namespace SaveState {
+
+/**
+ * Saves the state of the emulated system to a file. Has to be called between two iterations of
+ * the CPU loop, on the thread running the emulation.
+ * @param path Path of the file to write
+ * @param program_id Program id of the running title, stored to reject loading into other titles
+ * @returns Whether the state was saved successfully
+ */
+bool Save(const std::string& path, u64 program_id);
+
+/**
+ * Restores the state of the emulated system from a file written by Save. The running title has to
+ * be the one the state was saved from, and the state has to be written by the same build.
+ * @param path Path of the file to read
+ * @param program_id Program id of the running title
+ * @returns Whether the state was loaded successfully. If the state was rejected after restoring
+ *          it started, the system status is set to an error as it can't keep running.
+ */
+bool Load(const std::string& path, u64 program_id);
+
+} // namespace SaveState
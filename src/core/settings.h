@@ -91,10 +91,16 @@ struct Values {
 
     // Renderer
     bool use_hw_renderer;
+    bool use_headless_renderer; ///< Set by frontends running without a window, not configurable
     bool use_shader_jit;
+    bool use_disk_shader_cache;
+    u32 sw_rasterizer_threads;
     float resolution_factor;
     bool use_vsync;
     bool toggle_framelimit;
+    u16 frame_limit;
+    u16 frame_skip;
+    u16 frame_skip_period;
 
     LayoutOption layout_option;
     bool swap_screen;
@@ -118,6 +124,9 @@ struct Values {
     std::string sink_id;
     bool enable_audio_stretching;
     std::string audio_device_id;
+    std::string audio_file_path;
+    bool audio_file_sample_exact;
+    u32 dsp_threads;
 
     // Camera
     std::array<std::string, Service::CAM::NumCameras> camera_name;
@@ -0,0 +1,232 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include "common/common_funcs.h"
+#include "common/file_util.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "core/hle/kernel/memory.h"
+#include "core/hle/kernel/process.h"
+#include "core/hle/kernel/vm_manager.h"
+#include "core/hw/gpu.h"
+#include "core/hw/hw.h"
+#include "core/hw/lcd.h"
+#include "core/memory.h"
+#include "core/tracer/player.h"
+#include "video_core/pica_state.h"
+#include "video_core/renderer_base.h"
+#include "video_core/video_core.h"
+
+namespace CiTrace {
+
+bool Player::Load(const std::string& filename) {
+    FileUtil::IOFile file(filename, "rb");
+    data.resize(static_cast<size_t>(file.GetSize()));
+    if (!file.IsOpen() || file.ReadBytes(data.data(), data.size()) != data.size()) {
+        LOG_ERROR(HW_GPU, "Failed to read CiTrace %s", filename.c_str());
+        return false;
+    }
+
+    if (data.size() < sizeof(CTHeader)) {
+        LOG_ERROR(HW_GPU, "CiTrace %s is truncated", filename.c_str());
+        return false;
+    }
+    std::memcpy(&header, data.data(), sizeof(CTHeader));
+
+    if (std::memcmp(header.magic, CTHeader::ExpectedMagicWord(), 4) != 0 ||
+        header.version != CTHeader::ExpectedVersion() || header.header_size != sizeof(CTHeader)) {
+        LOG_ERROR(HW_GPU, "%s is not a CiTrace of version %u", filename.c_str(),
+                  CTHeader::ExpectedVersion());
+        return false;
+    }
+
+    const u64 stream_end = header.stream_offset + u64(header.stream_size) * sizeof(CTStreamElement);
+    if (stream_end > data.size()) {
+        LOG_ERROR(HW_GPU, "CiTrace %s is truncated", filename.c_str());
+        return false;
+    }
+    stream.resize(header.stream_size);
+    std::memcpy(stream.data(), data.data() + header.stream_offset,
+                stream.size() * sizeof(CTStreamElement));
+
+    frame_count = static_cast<u32>(
+        std::count_if(stream.begin(), stream.end(),
+                      [](const auto& element) { return element.type == FrameMarker; }));
+    position = 0;
+    return true;
+}
+
+void Player::Start() {
+    using namespace Kernel;
+
+    g_current_process = Process::Create(CodeSet::Create("CiTrace", 0));
+    VMManager& vm_manager = g_current_process->vm_manager;
+
+    // Back all of FCRAM with the linear heaps of the memory regions, which is what the kernel
+    // allocates from when applications request linear memory
+    for (MemoryRegion region : {MemoryRegion::APPLICATION, MemoryRegion::SYSTEM,
+                                MemoryRegion::BASE}) {
+        MemoryRegionInfo* info = GetMemoryRegion(region);
+        // The storage was reserved to the size of the region, so resizing doesn't move it
+        info->linear_heap_memory->resize(info->size);
+        vm_manager.MapMemoryBlock(g_current_process->GetLinearHeapAreaAddress() + info->base,
+                                  info->linear_heap_memory, 0, info->size,
+                                  MemoryState::Continuous);
+    }
+    HandleSpecialMapping(vm_manager, {Memory::VRAM_VADDR, Memory::VRAM_SIZE, false, false});
+
+    RestoreInitialState();
+}
+
+void Player::Rewind() {
+    position = 0;
+    RestoreInitialState();
+}
+
+bool Player::ReplayFrame() {
+    while (position < stream.size()) {
+        const CTStreamElement& element = stream[position++];
+        switch (element.type) {
+        case FrameMarker:
+            VideoCore::g_renderer->SwapBuffers();
+            return true;
+        case MemoryLoad:
+            ApplyMemoryLoad(element.memory_load);
+            break;
+        case RegisterWrite:
+            ApplyRegisterWrite(element.register_write);
+            break;
+        default:
+            LOG_ERROR(HW_GPU, "Unknown CiTrace stream element type 0x%X", element.type);
+            break;
+        }
+    }
+    return false;
+}
+
+u64 Player::HashScreen(int screen_index) {
+    const auto& framebuffer = GPU::g_regs.framebuffer_config[screen_index];
+    const PAddr framebuffer_addr =
+        framebuffer.active_fb == 0 ? framebuffer.address_left1 : framebuffer.address_left2;
+
+    std::vector<u8> pixels(framebuffer.stride * framebuffer.height);
+    Memory::RasterizerFlushRegion(framebuffer_addr, static_cast<u32>(pixels.size()));
+    Memory::ReadBlock(Memory::PhysicalToVirtualAddress(framebuffer_addr), pixels.data(),
+                      pixels.size());
+    return Common::ComputeHash64(pixels.data(), pixels.size());
+}
+
+std::vector<u32> Player::ReadInitialState(u32 offset, u32 size, size_t max_size) const {
+    if (offset + u64(size) * sizeof(u32) > data.size()) {
+        LOG_ERROR(HW_GPU, "CiTrace initial state at 0x%X is out of bounds", offset);
+        return {};
+    }
+    if (size > max_size) {
+        LOG_WARNING(HW_GPU, "CiTrace initial state at 0x%X has %u words, only %zu are used",
+                    offset, size, max_size);
+        size = static_cast<u32>(max_size);
+    }
+    std::vector<u32> words(size);
+    std::memcpy(words.data(), data.data() + offset, size * sizeof(u32));
+    return words;
+}
+
+/// Loads the program, swizzle data and float uniforms of a shader stage from a trace
+static void RestoreShaderSetup(Pica::Shader::ShaderSetup& setup, const Pica::ShaderRegs& config,
+                               const std::vector<u32>& program, const std::vector<u32>& swizzle,
+                               const std::vector<u32>& float_uniforms) {
+    std::copy(program.begin(), program.end(), setup.program_code.begin());
+    std::copy(swizzle.begin(), swizzle.end(), setup.swizzle_data.begin());
+
+    // The float uniforms are stored as 24-bit floats, four words per uniform
+    for (size_t i = 0; i < float_uniforms.size(); ++i)
+        setup.uniforms.f[i / 4][i % 4] = Pica::float24::FromRaw(float_uniforms[i]);
+
+    // The boolean and integer uniforms are mirrors of registers, which the CommandProcessor only
+    // updates when they are written
+    for (unsigned i = 0; i < setup.uniforms.b.size(); ++i)
+        setup.uniforms.b[i] = (config.bool_uniforms.Value() & (1 << i)) != 0;
+    for (unsigned i = 0; i < setup.uniforms.i.size(); ++i) {
+        const auto& values = config.int_uniforms[i];
+        setup.uniforms.i[i] = Math::Vec4<u8>(values.x, values.y, values.z, values.w);
+    }
+}
+
+void Player::RestoreInitialState() {
+    const auto& offsets = header.initial_state_offsets;
+    auto& state = Pica::g_state;
+
+    const auto gpu_registers =
+        ReadInitialState(offsets.gpu_registers, offsets.gpu_registers_size, GPU::Regs::NumIds());
+    std::copy(gpu_registers.begin(), gpu_registers.end(), &GPU::g_regs[0]);
+
+    const auto lcd_registers =
+        ReadInitialState(offsets.lcd_registers, offsets.lcd_registers_size, LCD::Regs::NumIds());
+    std::copy(lcd_registers.begin(), lcd_registers.end(), &LCD::g_regs[0]);
+
+    const auto pica_registers = ReadInitialState(
+        offsets.pica_registers, offsets.pica_registers_size, state.regs.reg_array.size());
+    std::copy(pica_registers.begin(), pica_registers.end(), state.regs.reg_array.begin());
+
+    const auto default_attributes =
+        ReadInitialState(offsets.default_attributes, offsets.default_attributes_size,
+                         4 * ARRAY_SIZE(state.input_default_attributes.attr));
+    for (size_t i = 0; i < default_attributes.size(); ++i) {
+        state.input_default_attributes.attr[i / 4][i % 4] =
+            Pica::float24::FromRaw(default_attributes[i]);
+    }
+
+    RestoreShaderSetup(
+        state.vs, state.regs.vs,
+        ReadInitialState(offsets.vs_program_binary, offsets.vs_program_binary_size,
+                         state.vs.program_code.size()),
+        ReadInitialState(offsets.vs_swizzle_data, offsets.vs_swizzle_data_size,
+                         state.vs.swizzle_data.size()),
+        ReadInitialState(offsets.vs_float_uniforms, offsets.vs_float_uniforms_size,
+                         4 * ARRAY_SIZE(state.vs.uniforms.f)));
+    RestoreShaderSetup(
+        state.gs, state.regs.gs,
+        ReadInitialState(offsets.gs_program_binary, offsets.gs_program_binary_size,
+                         state.gs.program_code.size()),
+        ReadInitialState(offsets.gs_swizzle_data, offsets.gs_swizzle_data_size,
+                         state.gs.swizzle_data.size()),
+        ReadInitialState(offsets.gs_float_uniforms, offsets.gs_float_uniforms_size,
+                         4 * ARRAY_SIZE(state.gs.uniforms.f)));
+}
+
+void Player::ApplyMemoryLoad(const CTMemoryLoad& load) {
+    if (load.file_offset + u64(load.size) > data.size()) {
+        LOG_ERROR(HW_GPU, "CiTrace memory load at 0x%X is out of bounds", load.file_offset);
+        return;
+    }
+    Memory::WriteBlock(Memory::PhysicalToVirtualAddress(load.physical_address),
+                       data.data() + load.file_offset, load.size);
+}
+
+void Player::ApplyRegisterWrite(const CTRegisterWrite& write) {
+    // The trace records the physical addresses of the registers, while the hardware is written
+    // through their mapping in the IO area
+    const u32 addr = write.physical_address - Memory::IO_AREA_PADDR + Memory::IO_AREA_VADDR;
+    switch (write.size) {
+    case CTRegisterWrite::SIZE_8:
+        HW::Write<u8>(addr, static_cast<u8>(write.value));
+        break;
+    case CTRegisterWrite::SIZE_16:
+        HW::Write<u16>(addr, static_cast<u16>(write.value));
+        break;
+    case CTRegisterWrite::SIZE_32:
+        HW::Write<u32>(addr, static_cast<u32>(write.value));
+        break;
+    case CTRegisterWrite::SIZE_64:
+        HW::Write<u64>(addr, write.value);
+        break;
+    default:
+        LOG_ERROR(HW_GPU, "Unknown CiTrace register write size 0x%X", write.size);
+        break;
+    }
+}
+
+} // namespace CiTrace
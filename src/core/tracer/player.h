@@ -0,0 +1,74 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+#include "core/tracer/citrace.h"
+
+namespace CiTrace {
+
+/**
+ * Plays back a CiTrace written by the Recorder. The GPU, LCD and Pica state at the start of the
+ * recording is restored, then the memory loads and register writes of the stream are applied to
+ * the emulated hardware one frame at a time, so that the command lists run through the
+ * CommandProcessor and the rasterizer like they did when recording.
+ */
+class Player {
+public:
+    /**
+     * Reads a trace from a file.
+     * @param filename Path of the trace
+     * @returns True if the file is a valid CiTrace
+     */
+    bool Load(const std::string& filename);
+
+    /**
+     * Maps FCRAM and VRAM in a new process so that the physical addresses used by the trace can be
+     * accessed, and restores the state at the start of the trace. The system must have been
+     * initialized with System::InitHardware.
+     */
+    void Start();
+
+    /**
+     * Replays the stream up to the end of the next frame, which is presented through the renderer.
+     * @returns False if the end of the stream was reached before the end of a frame
+     */
+    bool ReplayFrame();
+
+    /// Restarts the playback from the beginning of the stream, restoring the initial state
+    void Rewind();
+
+    /// Returns the number of frames in the trace
+    u32 GetFrameCount() const {
+        return frame_count;
+    }
+
+    /**
+     * Computes a hash of the framebuffer currently displayed on a screen, to compare the output
+     * of different replays.
+     * @param screen_index 0 for the top screen, 1 for the bottom one
+     */
+    static u64 HashScreen(int screen_index);
+
+private:
+    /// Returns the words of an initial state array, at most max_size of them
+    std::vector<u32> ReadInitialState(u32 offset, u32 size, size_t max_size) const;
+
+    void RestoreInitialState();
+    void ApplyMemoryLoad(const CTMemoryLoad& load);
+    void ApplyRegisterWrite(const CTRegisterWrite& write);
+
+    std::vector<u8> data;
+    CTHeader header;
+    std::vector<CTStreamElement> stream;
+    u32 frame_count = 0;
+
+    /// Index of the next stream element to replay
+    size_t position = 0;
+};
+
+} // namespace CiTrace
@@ -0,0 +1,205 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <catch.hpp>
+#include "audio_core/codec.h"
+#include "common/common_types.h"
+#include "common/math_util.h"
+#include "tests/benchmark.h"
+
+namespace Codec {
+
+// The original sample at a time implementations, used as a reference for the optimized ones
+namespace Reference {
+
+static StereoBuffer16 DecodeADPCM(const u8* const data, const size_t sample_count,
+                                  const std::array<s16, 16>& adpcm_coeff, ADPCMState& state) {
+    // GC-ADPCM with scale factor and variable coefficients.
+    // Frames are 8 bytes long containing 14 samples each.
+    // Samples are 4 bits (one nibble) long.
+
+    constexpr size_t FRAME_LEN = 8;
+    constexpr size_t SAMPLES_PER_FRAME = 14;
+    constexpr std::array<int, 16> SIGNED_NIBBLES = {
+        {0, 1, 2, 3, 4, 5, 6, 7, -8, -7, -6, -5, -4, -3, -2, -1}};
+
+    const size_t ret_size =
+        sample_count % 2 == 0 ? sample_count : sample_count + 1; // Ensure multiple of two.
+    StereoBuffer16 ret(ret_size);
+
+    int yn1 = state.yn1, yn2 = state.yn2;
+
+    const size_t NUM_FRAMES =
+        (sample_count + (SAMPLES_PER_FRAME - 1)) / SAMPLES_PER_FRAME; // Round up.
+    for (size_t framei = 0; framei < NUM_FRAMES; framei++) {
+        const int frame_header = data[framei * FRAME_LEN];
+        const int scale = 1 << (frame_header & 0xF);
+        const int idx = (frame_header >> 4) & 0x7;
+
+        // Coefficients are fixed point with 11 bits fractional part.
+        const int coef1 = adpcm_coeff[idx * 2 + 0];
+        const int coef2 = adpcm_coeff[idx * 2 + 1];
+
+        // Decodes an audio sample. One nibble produces one sample.
+        const auto decode_sample = [&](const int nibble) -> s16 {
+            const int xn = nibble * scale;
+            // We first transform everything into 11 bit fixed point, perform the second order
+            // digital filter, then transform back.
+            // 0x400 == 0.5 in 11 bit fixed point.
+            // Filter: y[n] = x[n] + 0.5 + c1 * y[n-1] + c2 * y[n-2]
+            int val = ((xn << 11) + 0x400 + coef1 * yn1 + coef2 * yn2) >> 11;
+            // Clamp to output range.
+            val = MathUtil::Clamp(val, -32768, 32767);
+            // Advance output feedback.
+            yn2 = yn1;
+            yn1 = val;
+            return (s16)val;
+        };
+
+        size_t outputi = framei * SAMPLES_PER_FRAME;
+        size_t datai = framei * FRAME_LEN + 1;
+        for (size_t i = 0; i < SAMPLES_PER_FRAME && outputi < sample_count; i += 2) {
+            const s16 sample1 = decode_sample(SIGNED_NIBBLES[data[datai] >> 4]);
+            ret[outputi].fill(sample1);
+            outputi++;
+
+            const s16 sample2 = decode_sample(SIGNED_NIBBLES[data[datai] & 0xF]);
+            ret[outputi].fill(sample2);
+            outputi++;
+
+            datai++;
+        }
+    }
+
+    state.yn1 = yn1;
+    state.yn2 = yn2;
+
+    return ret;
+}
+
+static s16 SignExtendS8(u8 x) {
+    // The data is actually signed PCM8.
+    // We sign extend this to signed PCM16.
+    return static_cast<s16>(static_cast<s8>(x));
+}
+
+static StereoBuffer16 DecodePCM8(const unsigned num_channels, const u8* const data,
+                                 const size_t sample_count) {
+        StereoBuffer16 ret(sample_count);
+
+    if (num_channels == 1) {
+        for (size_t i = 0; i < sample_count; i++) {
+            ret[i].fill(SignExtendS8(data[i]));
+        }
+    } else {
+        for (size_t i = 0; i < sample_count; i++) {
+            ret[i][0] = SignExtendS8(data[i * 2 + 0]);
+            ret[i][1] = SignExtendS8(data[i * 2 + 1]);
+        }
+    }
+
+    return ret;
+}
+
+static StereoBuffer16 DecodePCM16(const unsigned num_channels, const u8* const data,
+                                  const size_t sample_count) {
+        StereoBuffer16 ret(sample_count);
+
+    if (num_channels == 1) {
+        for (size_t i = 0; i < sample_count; i++) {
+            s16 sample;
+            std::memcpy(&sample, data + i * sizeof(s16), sizeof(s16));
+            ret[i].fill(sample);
+        }
+    } else {
+        std::memcpy(ret.data(), data, sample_count * 2 * sizeof(u16));
+    }
+
+    return ret;
+}
+
+} // namespace Reference
+
+static std::vector<u8> RandomData(size_t size, std::mt19937& random) {
+    std::vector<u8> data(size);
+    std::uniform_int_distribution<int> byte(0, 255);
+    for (u8& value : data)
+        value = static_cast<u8>(byte(random));
+    return data;
+}
+
+static std::array<s16, 16> RandomCoefficients(std::mt19937& random) {
+    std::uniform_int_distribution<int> coefficient(-4096, 4096);
+    std::array<s16, 16> coefficients;
+    for (s16& value : coefficients)
+        value = static_cast<s16>(coefficient(random));
+    return coefficients;
+}
+
+TEST_CASE("Codec decoders match the reference implementation", "[audio_core]") {
+    std::mt19937 random(42);
+
+    for (size_t sample_count : {0, 1, 7, 13, 14, 15, 16, 28, 31, 100, 1001}) {
+        const std::vector<u8> data = RandomData(sample_count * 4 + 8, random);
+
+        for (unsigned num_channels : {1u, 2u}) {
+            REQUIRE(DecodePCM8(num_channels, data.data(), sample_count) ==
+                    Reference::DecodePCM8(num_channels, data.data(), sample_count));
+            REQUIRE(DecodePCM16(num_channels, data.data(), sample_count) ==
+                    Reference::DecodePCM16(num_channels, data.data(), sample_count));
+        }
+
+        const std::array<s16, 16> coefficients = RandomCoefficients(random);
+        ADPCMState state{1234, -4321};
+        ADPCMState expected_state = state;
+        REQUIRE(DecodeADPCM(data.data(), sample_count, coefficients, state) ==
+                Reference::DecodeADPCM(data.data(), sample_count, coefficients, expected_state));
+        REQUIRE(state.yn1 == expected_state.yn1);
+        REQUIRE(state.yn2 == expected_state.yn2);
+    }
+}
+
+TEST_CASE("Codec decoders benchmark", "[.][benchmark]") {
+    std::mt19937 random(42);
+    const size_t sample_count = 32768;
+    const int iterations = 200;
+    const std::vector<u8> data = RandomData(sample_count * 4, random);
+
+    // Random ADPCM data mostly clips, which isn't representative. Use small scales and stable
+    // filters instead, so the output stays in range like real audio.
+    std::vector<u8> adpcm_data = data;
+    for (size_t i = 0; i < adpcm_data.size(); i += 8)
+        adpcm_data[i] = (adpcm_data[i] & 0x70) | (adpcm_data[i] % 6);
+    std::array<s16, 16> coefficients;
+    for (size_t i = 0; i < 8; ++i) {
+        coefficients[i * 2] = static_cast<s16>(random() % 1600);
+        coefficients[i * 2 + 1] = -static_cast<s16>(random() % 400);
+    }
+
+    const auto measure = [iterations](auto&& decode) {
+        return Benchmark::Measure(iterations, decode);
+    };
+    const auto report = [](const char* name, double reference_ns, double optimized_ns) {
+        Benchmark::Report(name, "reference", reference_ns, "optimized", optimized_ns);
+    };
+
+    report("PCM8 mono", measure([&] { Reference::DecodePCM8(1, data.data(), sample_count); }),
+           measure([&] { DecodePCM8(1, data.data(), sample_count); }));
+    report("PCM8 stereo", measure([&] { Reference::DecodePCM8(2, data.data(), sample_count); }),
+           measure([&] { DecodePCM8(2, data.data(), sample_count); }));
+    report("PCM16 mono", measure([&] { Reference::DecodePCM16(1, data.data(), sample_count); }),
+           measure([&] { DecodePCM16(1, data.data(), sample_count); }));
+
+    ADPCMState state{};
+    report("ADPCM", measure([&] {
+               Reference::DecodeADPCM(adpcm_data.data(), sample_count, coefficients, state);
+           }),
+           measure([&] { DecodeADPCM(adpcm_data.data(), sample_count, coefficients, state); }));
+}
+
+} // namespace Codec
@@ -0,0 +1,147 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <limits>
+#include <random>
+#include <catch.hpp>
+#include "audio_core/hle/common.h"
+#include "audio_core/hle/mix.h"
+#include "common/common_types.h"
+#include "common/math_util.h"
+#include "tests/benchmark.h"
+
+namespace DSP {
+namespace HLE {
+
+// The original scalar implementations, used as a reference for the optimized ones
+namespace Reference {
+
+static s16 ClampToS16(s32 value) {
+    return static_cast<s16>(MathUtil::Clamp(value, -32768, 32767));
+}
+
+static std::array<s16, 2> AddAndClampToS16(const std::array<s16, 2>& a,
+                                           const std::array<s16, 2>& b) {
+    return {ClampToS16(static_cast<s32>(a[0]) + static_cast<s32>(b[0])),
+            ClampToS16(static_cast<s32>(a[1]) + static_cast<s32>(b[1]))};
+}
+
+static void MixStereoIntoQuad(QuadFrame32& dest, const StereoFrame16& source,
+                              const std::array<float, 4>& gains) {
+    for (size_t samplei = 0; samplei < samples_per_frame; samplei++) {
+        dest[samplei][0] += static_cast<s32>(gains[0] * source[samplei][0]);
+        dest[samplei][1] += static_cast<s32>(gains[1] * source[samplei][1]);
+        dest[samplei][2] += static_cast<s32>(gains[2] * source[samplei][0]);
+        dest[samplei][3] += static_cast<s32>(gains[3] * source[samplei][1]);
+    }
+}
+
+static void DownmixStereoAndMix(StereoFrame16& dest, const QuadFrame32& source, float gain) {
+    for (size_t samplei = 0; samplei < samples_per_frame; samplei++) {
+        const auto& sample = source[samplei];
+        s16 left = ClampToS16(static_cast<s32>(gain * sample[0] + gain * sample[2]));
+        s16 right = ClampToS16(static_cast<s32>(gain * sample[1] + gain * sample[3]));
+        dest[samplei] = AddAndClampToS16(dest[samplei], {left, right});
+    }
+}
+
+static void DownmixMonoAndMix(StereoFrame16& dest, const QuadFrame32& source, float gain) {
+    for (size_t samplei = 0; samplei < samples_per_frame; samplei++) {
+        const auto& sample = source[samplei];
+        s16 mono = ClampToS16(static_cast<s32>(
+            (gain * sample[0] + gain * sample[1] + gain * sample[2] + gain * sample[3]) / 2));
+        dest[samplei] = AddAndClampToS16(dest[samplei], {mono, mono});
+    }
+}
+
+} // namespace Reference
+
+static StereoFrame16 RandomStereoFrame(std::mt19937& random) {
+    std::uniform_int_distribution<int> sample(std::numeric_limits<s16>::min(),
+                                              std::numeric_limits<s16>::max());
+    StereoFrame16 frame;
+    for (auto& stereo : frame) {
+        stereo = {static_cast<s16>(sample(random)), static_cast<s16>(sample(random))};
+    }
+    return frame;
+}
+
+/// Generates samples in the range reached by mixing a few sources, so that downmixing saturates
+static QuadFrame32 RandomQuadFrame(std::mt19937& random) {
+    std::uniform_int_distribution<s32> sample(-200000, 200000);
+    QuadFrame32 frame;
+    for (auto& quad : frame) {
+        for (s32& channel : quad) {
+            channel = sample(random);
+        }
+    }
+    return frame;
+}
+
+static float RandomGain(std::mt19937& random) {
+    return std::uniform_real_distribution<float>(-2.0f, 2.0f)(random);
+}
+
+TEST_CASE("DSP::HLE mixing matches the reference implementation", "[audio_core]") {
+    std::mt19937 random(42);
+
+    for (int i = 0; i < 100; ++i) {
+        const StereoFrame16 stereo = RandomStereoFrame(random);
+        const QuadFrame32 quad = RandomQuadFrame(random);
+        const std::array<float, 4> gains = {RandomGain(random), RandomGain(random),
+                                            RandomGain(random), RandomGain(random)};
+        const float gain = RandomGain(random);
+
+        QuadFrame32 expected_quad = quad;
+        QuadFrame32 actual_quad = quad;
+        Reference::MixStereoIntoQuad(expected_quad, stereo, gains);
+        MixStereoIntoQuad(actual_quad, stereo, gains);
+        REQUIRE(actual_quad == expected_quad);
+
+        StereoFrame16 expected_stereo = stereo;
+        StereoFrame16 actual_stereo = stereo;
+        Reference::DownmixStereoAndMix(expected_stereo, quad, gain);
+        DownmixStereoAndMix(actual_stereo, quad, gain);
+        REQUIRE(actual_stereo == expected_stereo);
+
+        expected_stereo = stereo;
+        actual_stereo = stereo;
+        Reference::DownmixMonoAndMix(expected_stereo, quad, gain);
+        DownmixMonoAndMix(actual_stereo, quad, gain);
+        REQUIRE(actual_stereo == expected_stereo);
+    }
+}
+
+TEST_CASE("DSP::HLE mixing benchmark", "[.][benchmark]") {
+    std::mt19937 random(42);
+    const int iterations = 100000;
+
+    const StereoFrame16 stereo = RandomStereoFrame(random);
+    const QuadFrame32 quad = RandomQuadFrame(random);
+    const std::array<float, 4> gains = {0.5f, 0.75f, 0.25f, 1.0f};
+
+    const auto measure = [iterations](auto&& mix) {
+        return Benchmark::Measure(iterations, mix);
+    };
+
+    QuadFrame32 quad_accumulator = {};
+    StereoFrame16 stereo_accumulator = {};
+    const auto report = [](const char* name, double reference_ns, double optimized_ns) {
+        Benchmark::Report(name, "reference", reference_ns, "optimized", optimized_ns);
+    };
+
+    report("MixStereoIntoQuad",
+           measure([&] { Reference::MixStereoIntoQuad(quad_accumulator, stereo, gains); }),
+           measure([&] { MixStereoIntoQuad(quad_accumulator, stereo, gains); }));
+    report("DownmixStereoAndMix",
+           measure([&] { Reference::DownmixStereoAndMix(stereo_accumulator, quad, 0.5f); }),
+           measure([&] { DownmixStereoAndMix(stereo_accumulator, quad, 0.5f); }));
+    report("DownmixMonoAndMix",
+           measure([&] { Reference::DownmixMonoAndMix(stereo_accumulator, quad, 0.5f); }),
+           measure([&] { DownmixMonoAndMix(stereo_accumulator, quad, 0.5f); }));
+}
+
+} // namespace HLE
+} // namespace DSP
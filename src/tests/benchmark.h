@@ -0,0 +1,49 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+
+// Helpers for the benchmarks comparing an optimized implementation with the one it replaced.
+// Benchmarks are test cases tagged "[.][benchmark]", which are hidden from the regular test run
+// and are run by the benchmarks target.
+namespace Benchmark {
+
+/**
+ * Runs a function repeatedly
+ * @param iterations Number of times to run the function
+ * @param function Function to run, taking no arguments
+ * @returns The average duration of a run in nanoseconds
+ */
+template <typename Function>
+double Measure(int iterations, Function&& function) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        function();
+    const auto duration = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(duration).count() / iterations;
+}
+
+/**
+ * Prints the average durations of two implementations and the speedup of the second one
+ * @param name Name of the benchmarked operation
+ * @param reference_name Name of the implementation being replaced
+ * @param reference_ns Average duration of the replaced implementation, as returned by Measure
+ * @param optimized_name Name of the new implementation
+ * @param optimized_ns Average duration of the new implementation, as returned by Measure
+ */
+inline void Report(const char* name, const char* reference_name, double reference_ns,
+                   const char* optimized_name, double optimized_ns) {
+    // Long operations are printed in microseconds to keep the numbers readable
+    const bool micro = reference_ns >= 10000.0;
+    const double scale = micro ? 0.001 : 1.0;
+    const char* unit = micro ? "us" : "ns";
+    std::printf("%-36s %s %.1f %s, %s %.1f %s (%.2fx)\n", name, reference_name,
+                reference_ns * scale, unit, optimized_name, optimized_ns * scale, unit,
+                reference_ns / optimized_ns);
+}
+
+} // namespace Benchmark
@@ -0,0 +1,181 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstdarg>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include <catch.hpp>
+#include "common/file_util.h"
+#include "common/logging/backend.h"
+#include "common/logging/filter.h"
+#include "common/logging/log.h"
+#include "common/logging/text_formatter.h"
+#include "tests/benchmark.h"
+
+namespace Log {
+
+static const std::string log_path = "logging_test.log";
+
+/// Reads the lines of the log file which contain the given marker
+static std::vector<std::string> ReadLogLines(const std::string& path, const std::string& marker) {
+    std::string contents;
+    FileUtil::ReadFileToString(true, path.c_str(), contents);
+    std::vector<std::string> lines;
+    size_t start = 0;
+    for (size_t end; (end = contents.find('\n', start)) != std::string::npos; start = end + 1) {
+        std::string line = contents.substr(start, end - start);
+        if (line.find(marker) != std::string::npos)
+            lines.push_back(std::move(line));
+    }
+    return lines;
+}
+
+TEST_CASE("Logging writes the messages of all threads in order", "[common]") {
+    SetConsoleOutput(false);
+    SetLogFile(log_path);
+
+    const int num_threads = 4;
+    const int num_messages = 2000;
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < num_threads; ++thread) {
+        threads.emplace_back([thread] {
+            for (int i = 0; i < num_messages; ++i)
+                LOG_INFO(Common, "ordering thread %d message %d", thread, i);
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    // Messages not fitting in a queue slot
+    const std::string long_message(1000, 'x');
+    LOG_INFO(Common, "long message %s", long_message.c_str());
+
+    Flush();
+    const auto lines = ReadLogLines(log_path, "ordering thread");
+    REQUIRE(lines.size() == num_threads * num_messages);
+    for (int thread = 0; thread < num_threads; ++thread) {
+        int next = 0;
+        const std::string prefix = "ordering thread " + std::to_string(thread) + " message ";
+        for (const std::string& line : lines) {
+            const size_t position = line.find(prefix);
+            if (position != std::string::npos) {
+                REQUIRE(line.substr(position + prefix.size()) == std::to_string(next));
+                ++next;
+            }
+        }
+        REQUIRE(next == num_messages);
+    }
+
+    const auto long_lines = ReadLogLines(log_path, "long message");
+    REQUIRE(long_lines.size() == 1);
+    REQUIRE(long_lines[0].find("long message " + long_message) != std::string::npos);
+
+    SetLogFile("");
+    SetConsoleOutput(true);
+    FileUtil::Delete(log_path);
+}
+
+TEST_CASE("Logging rotates the log file", "[common]") {
+    SetConsoleOutput(false);
+    SetLogFile(log_path, 4096);
+
+    for (int i = 0; i < 200; ++i)
+        LOG_INFO(Common, "rotation message %d", i);
+    Flush();
+
+    // Every message is in one of the files, the current one being smaller than the limit
+    REQUIRE(FileUtil::Exists(log_path + ".1"));
+    REQUIRE(FileUtil::GetSize(log_path) < 4096);
+    const size_t num_lines = ReadLogLines(log_path + ".1", "rotation message").size() +
+                             ReadLogLines(log_path, "rotation message").size();
+    REQUIRE(num_lines > 0);
+    REQUIRE(ReadLogLines(log_path, "rotation message 199").size() +
+                ReadLogLines(log_path + ".1", "rotation message 199").size() ==
+            1);
+
+    SetLogFile("");
+    SetConsoleOutput(true);
+    FileUtil::Delete(log_path);
+    FileUtil::Delete(log_path + ".1");
+}
+
+TEST_CASE("Logging filter is checked inline", "[common]") {
+    Filter filter(Level::Info);
+    filter.SetClassLevel(Class::HW_GPU, Level::Debug);
+    SetFilter(&filter);
+
+    REQUIRE(!IsLogged(Class::Common, Level::Debug));
+    REQUIRE(IsLogged(Class::Common, Level::Info));
+    REQUIRE(IsLogged(Class::HW_GPU, Level::Debug));
+
+    // The filter is referenced, changes apply immediately
+    filter.ParseFilterString("Common:Trace");
+    REQUIRE(IsLogged(Class::Common, Level::Trace));
+
+    SetFilter(nullptr);
+    REQUIRE(IsLogged(Class::Common, Level::Trace));
+}
+
+TEST_CASE("Logging benchmark", "[.][benchmark]") {
+    // Time spent by the thread logging, in bursts of as many messages as fit in its queue, with
+    // the log written to a file like a redirected stderr would be
+    const int iterations = 500;
+    const int repeats = 200;
+    std::FILE* null_file = std::fopen(log_path.c_str(), "w");
+
+    const auto measure = [&](auto&& log) {
+        double total = 0;
+        for (int repeat = 0; repeat < repeats; ++repeat) {
+            int i = 0;
+            total += Benchmark::Measure(iterations, [&] { log(i++); });
+            Flush();
+        }
+        return total / repeats;
+    };
+
+    // The previous backend formatted and wrote the messages on the thread logging them
+    const double synchronous_ns = measure([&](int i) {
+        const auto print = [&](const char* format, ...) {
+            va_list args;
+            va_start(args, format);
+            const Entry entry = CreateEntry(Class::HW_GPU, Level::Debug, __FILE__, __LINE__,
+                                            __func__, format, args);
+            va_end(args);
+            std::array<char, 4 * 1024> format_buffer;
+            FormatLogMessage(entry, format_buffer.data(), format_buffer.size());
+            std::fputs(format_buffer.data(), null_file);
+            std::fputc('\n', null_file);
+            std::fflush(null_file);
+        };
+        print("Processed command 0x%08X at 0x%08X (%d)", i * 3, i * 4, i);
+    });
+
+    SetConsoleOutput(false);
+    SetLogFile(log_path + ".async");
+    const double queued_ns = measure([&](int i) {
+        LOG_DEBUG(HW_GPU, "Processed command 0x%08X at 0x%08X (%d)", i * 3, i * 4, i);
+    });
+    SetLogFile("");
+    SetConsoleOutput(true);
+
+    // A filtered out message
+    Filter filter(Level::Info);
+    SetFilter(&filter);
+    const double filtered_ns = measure([&](int i) {
+        LOG_DEBUG(HW_GPU, "Processed command 0x%08X at 0x%08X (%d)", i * 3, i * 4, i);
+    });
+    SetFilter(nullptr);
+
+    std::fclose(null_file);
+    FileUtil::Delete(log_path);
+    FileUtil::Delete(log_path + ".async");
+    Benchmark::Report("Logging", "synchronous", synchronous_ns, "queued", queued_ns);
+    Benchmark::Report("Logging filtered out message", "queued", queued_ns, "filtered",
+                      filtered_ns);
+}
+
+} // namespace Log
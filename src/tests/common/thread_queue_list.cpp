@@ -0,0 +1,209 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <random>
+#include <vector>
+#include <catch.hpp>
+#include "common/thread_queue_list.h"
+#include "tests/benchmark.h"
+
+namespace Common {
+
+// The original deque based implementation, used as a reference for the indexed one
+namespace Reference {
+
+template <class T, unsigned int N>
+struct ThreadQueueList {
+    typedef unsigned int Priority;
+
+    Priority contains(const T& uid) const {
+        for (Priority i = 0; i < N; ++i) {
+            if (std::find(queues[i].cbegin(), queues[i].cend(), uid) != queues[i].cend())
+                return i;
+        }
+        return -1;
+    }
+
+    T get_first() const {
+        for (const auto& queue : queues) {
+            if (!queue.empty())
+                return queue.front();
+        }
+        return T();
+    }
+
+    T pop_first() {
+        return pop_first_better(N);
+    }
+
+    T pop_first_better(Priority priority) {
+        for (Priority i = 0; i < priority; ++i) {
+            if (!queues[i].empty()) {
+                T first = queues[i].front();
+                queues[i].pop_front();
+                return first;
+            }
+        }
+        return T();
+    }
+
+    void push_front(Priority priority, const T& thread_id) {
+        queues[priority].push_front(thread_id);
+    }
+
+    void push_back(Priority priority, const T& thread_id) {
+        queues[priority].push_back(thread_id);
+    }
+
+    void move(const T& thread_id, Priority old_priority, Priority new_priority) {
+        remove(old_priority, thread_id);
+        push_back(new_priority, thread_id);
+    }
+
+    void remove(Priority priority, const T& thread_id) {
+        auto& queue = queues[priority];
+        queue.erase(std::remove(queue.begin(), queue.end(), thread_id), queue.end());
+    }
+
+    void rotate(Priority priority) {
+        auto& queue = queues[priority];
+        if (queue.size() > 1) {
+            queue.push_back(queue.front());
+            queue.pop_front();
+        }
+    }
+
+    std::vector<T> get_queue(Priority priority) const {
+        return {queues[priority].begin(), queues[priority].end()};
+    }
+
+    std::array<std::deque<T>, N> queues;
+};
+
+} // namespace Reference
+
+namespace {
+
+struct TestThread {
+    unsigned int priority;
+    ThreadQueueListLink<TestThread> link;
+};
+
+} // anonymous namespace
+
+constexpr unsigned int NUM_LEVELS = 64;
+using IndexedQueue = ThreadQueueList<TestThread, NUM_LEVELS, &TestThread::link>;
+using ReferenceQueue = Reference::ThreadQueueList<TestThread*, NUM_LEVELS>;
+
+/// Pushes a random thread that isn't queued yet, at its own priority
+static void PushRandom(std::mt19937& random, std::vector<TestThread>& threads,
+                       IndexedQueue& indexed, ReferenceQueue& reference) {
+    TestThread& thread = threads[random() % threads.size()];
+    if (indexed.contains(&thread) != static_cast<unsigned int>(-1))
+        return;
+    if (random() % 2) {
+        indexed.push_back(thread.priority, &thread);
+        reference.push_back(thread.priority, &thread);
+    } else {
+        indexed.push_front(thread.priority, &thread);
+        reference.push_front(thread.priority, &thread);
+    }
+}
+
+TEST_CASE("ThreadQueueList matches the reference implementation", "[common]") {
+    std::mt19937 random(42);
+    std::vector<TestThread> threads(200);
+    for (TestThread& thread : threads)
+        thread.priority = random() % NUM_LEVELS;
+
+    IndexedQueue indexed;
+    ReferenceQueue reference;
+
+    for (int i = 0; i < 100000; ++i) {
+        TestThread& thread = threads[random() % threads.size()];
+        switch (random() % 7) {
+        case 0:
+        case 1:
+            PushRandom(random, threads, indexed, reference);
+            break;
+        case 2:
+            REQUIRE(indexed.pop_first() == reference.pop_first());
+            break;
+        case 3: {
+            const unsigned int priority = random() % NUM_LEVELS + 1;
+            REQUIRE(indexed.pop_first_better(priority) == reference.pop_first_better(priority));
+            break;
+        }
+        case 4:
+            // Removing a thread that isn't queued is allowed
+            indexed.remove(thread.priority, &thread);
+            reference.remove(thread.priority, &thread);
+            break;
+        case 5:
+            if (indexed.contains(&thread) != static_cast<unsigned int>(-1)) {
+                const unsigned int priority = random() % NUM_LEVELS;
+                indexed.move(&thread, thread.priority, priority);
+                reference.move(&thread, thread.priority, priority);
+                thread.priority = priority;
+            }
+            break;
+        case 6:
+            indexed.rotate(thread.priority);
+            reference.rotate(thread.priority);
+            break;
+        }
+
+        REQUIRE(indexed.get_first() == reference.get_first());
+        REQUIRE(indexed.contains(&thread) == reference.contains(&thread));
+    }
+
+    for (unsigned int priority = 0; priority < NUM_LEVELS; ++priority) {
+        REQUIRE(indexed.get_queue(priority) == reference.get_queue(priority));
+        REQUIRE(indexed.empty(priority) == reference.get_queue(priority).empty());
+    }
+
+    indexed.clear();
+    for (TestThread& thread : threads)
+        REQUIRE(indexed.contains(&thread) == static_cast<unsigned int>(-1));
+    REQUIRE(indexed.get_first() == nullptr);
+}
+
+TEST_CASE("ThreadQueueList scheduler benchmark", "[.][benchmark]") {
+    // Mimics the scheduler: a few hundred ready threads, with the running thread being preempted,
+    // put back at the front of its level and a thread of another level being removed as it starts
+    // waiting, as happens on every context switch.
+    const int iterations = 1000000;
+    std::mt19937 random(42);
+    std::vector<TestThread> threads(400);
+    for (TestThread& thread : threads)
+        thread.priority = random() % NUM_LEVELS;
+    std::vector<size_t> picks(iterations);
+    for (size_t& pick : picks)
+        pick = random() % threads.size();
+
+    const auto measure = [&](auto& queue) {
+        for (TestThread& thread : threads)
+            queue.push_back(thread.priority, &thread);
+
+        size_t i = 0;
+        return Benchmark::Measure(iterations, [&] {
+            TestThread* next = queue.pop_first();
+            queue.push_front(next->priority, next);
+            TestThread& waiting = threads[picks[i++]];
+            queue.remove(waiting.priority, &waiting);
+            queue.push_back(waiting.priority, &waiting);
+        });
+    };
+
+    ReferenceQueue reference;
+    const double reference_ns = measure(reference);
+    IndexedQueue indexed;
+    const double indexed_ns = measure(indexed);
+    Benchmark::Report("ThreadQueueList", "reference", reference_ns, "indexed", indexed_ns);
+}
+
+} // namespace Common
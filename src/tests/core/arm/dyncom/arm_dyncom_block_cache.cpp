@@ -0,0 +1,82 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include <catch.hpp>
+#include "core/arm/dyncom/arm_dyncom_block_cache.h"
+#include "tests/benchmark.h"
+
+TEST_CASE("BlockCache finds and invalidates blocks by page", "[core][arm]") {
+    BlockCache cache;
+    REQUIRE(cache.Find(0x00100000) == -1);
+
+    cache.Insert(0x00100000, 0);
+    cache.Insert(0x00100002, 16); // Thumb
+    cache.Insert(0x00100FFC, 32);
+    cache.Insert(0x00101000, 48);
+    cache.Insert(0x00102004, 64);
+    REQUIRE(cache.Find(0x00100000) == 0);
+    REQUIRE(cache.Find(0x00100002) == 16);
+    REQUIRE(cache.Find(0x00100004) == -1);
+    REQUIRE(cache.Find(0x00100FFC) == 32);
+    REQUIRE(cache.Find(0x00101000) == 48);
+    REQUIRE(cache.Find(0x00102004) == 64);
+
+    // Dropping a single byte drops its whole page
+    const u32 epoch = cache.GetEpoch();
+    cache.InvalidateRange(0x00101800, 1);
+    REQUIRE(cache.GetEpoch() != epoch);
+    REQUIRE(cache.Find(0x00100FFC) == 32);
+    REQUIRE(cache.Find(0x00101000) == -1);
+    REQUIRE(cache.Find(0x00102004) == 64);
+
+    // Ranges spanning more pages than there are cached ones
+    cache.InvalidateRange(0x00000000, 0x00101000);
+    REQUIRE(cache.Find(0x00100000) == -1);
+    REQUIRE(cache.Find(0x00100FFC) == -1);
+    REQUIRE(cache.Find(0x00102004) == 64);
+
+    // Ranges reaching the end of the address space
+    cache.Insert(0xFFFFFFFC, 80);
+    cache.InvalidateRange(0xFFFFF000, 0x2000);
+    REQUIRE(cache.Find(0xFFFFFFFC) == -1);
+    REQUIRE(cache.Find(0x00102004) == 64);
+
+    cache.Clear();
+    REQUIRE(cache.Find(0x00102004) == -1);
+}
+
+TEST_CASE("BlockCache lookup benchmark", "[.][benchmark]") {
+    // Blocks spread over 1 MiB of code, looked up in a random order like returns and indirect
+    // branches do
+    std::mt19937 random(42);
+    std::vector<u32> addresses(20000);
+    for (u32& address : addresses)
+        address = 0x00100000 + (random() % 0x100000 & ~3);
+    std::vector<u32> lookups(1000000);
+    for (u32& lookup : lookups)
+        lookup = addresses[random() % addresses.size()];
+
+    std::unordered_map<u32, int> map;
+    BlockCache cache;
+    for (size_t i = 0; i < addresses.size(); ++i) {
+        map[addresses[i]] = static_cast<int>(i);
+        cache.Insert(addresses[i], static_cast<int>(i));
+    }
+
+    const auto measure = [&](auto&& find) {
+        long long sum = 0;
+        size_t i = 0;
+        const double ns = Benchmark::Measure(static_cast<int>(lookups.size()),
+                                             [&] { sum += find(lookups[i++]); });
+        REQUIRE(sum > 0);
+        return ns;
+    };
+
+    const double map_ns = measure([&](u32 addr) { return map.find(addr)->second; });
+    const double cache_ns = measure([&](u32 addr) { return cache.Find(addr); });
+    Benchmark::Report("BlockCache", "unordered_map", map_ns, "paged", cache_ns);
+}
@@ -0,0 +1,253 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <atomic>
+#include <list>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <catch.hpp>
+#include "common/mpsc_queue.h"
+#include "core/core_timing.h"
+#include "tests/benchmark.h"
+
+namespace CoreTiming {
+
+/// Stands in for the downcount of the CPU, which the tests decrement to execute cycles
+static s64 downcount;
+static std::vector<u64> fired;
+
+static void RecordEvent(u64 userdata, int cycles_late) {
+    fired.push_back(userdata);
+}
+
+class ScopeInit final {
+public:
+    ScopeInit() {
+        Init(downcount);
+        fired.clear();
+    }
+    ~ScopeInit() {
+        Shutdown();
+    }
+};
+
+/// Executes cycles like the CPU would, then runs the events which are due
+static void RunCycles(s64 cycles) {
+    downcount -= cycles;
+    Advance();
+}
+
+TEST_CASE("CoreTiming fires events in the order they are scheduled for", "[core]") {
+    ScopeInit init;
+    const int type = RegisterEvent("test", RecordEvent);
+
+    ScheduleEvent(300, type, 0);
+    ScheduleEvent(100, type, 1);
+    ScheduleEvent(200, type, 2);
+    ScheduleEvent(100, type, 3);
+    ScheduleEvent(100, type, 4);
+    ScheduleEvent(200, type, 5);
+
+    // Events scheduled for the same time fire in the order they were scheduled in
+    RunCycles(150);
+    REQUIRE(fired == std::vector<u64>{1, 3, 4});
+    RunCycles(1000);
+    REQUIRE(fired == std::vector<u64>{1, 3, 4, 2, 5, 0});
+}
+
+TEST_CASE("CoreTiming ignores stale event handles", "[core]") {
+    ScopeInit init;
+    const int type = RegisterEvent("test", RecordEvent);
+
+    const EventHandle first = ScheduleEvent(100, type, 1);
+    REQUIRE(first != 0);
+    REQUIRE(UnscheduleEvent(first) == 100);
+
+    // The slot of the unscheduled event is reused, its handle must not cancel the new event
+    const EventHandle second = ScheduleEvent(200, type, 2);
+    REQUIRE(second != first);
+    REQUIRE(UnscheduleEvent(first) == 0);
+    RunCycles(300);
+    REQUIRE(fired == std::vector<u64>{2});
+
+    // Handles of events which already fired are ignored as well
+    ScheduleEvent(100, type, 3);
+    REQUIRE(UnscheduleEvent(second) == 0);
+    RunCycles(200);
+    REQUIRE(fired == std::vector<u64>{2, 3});
+}
+
+TEST_CASE("CoreTiming unschedules events lazily", "[core]") {
+    ScopeInit init;
+    const int type = RegisterEvent("test", RecordEvent);
+    const int other_type = RegisterEvent("other", RecordEvent);
+
+    std::vector<EventHandle> handles;
+    for (u64 i = 0; i < 1000; ++i)
+        handles.push_back(ScheduleEvent(1000 + i % 7 * 10, type, i));
+
+    // Cancelling most of the events gets the queue compacted, the remaining ones must still fire
+    // in order
+    for (u64 i = 0; i < handles.size(); ++i) {
+        if (i % 4 != 0)
+            REQUIRE(UnscheduleEvent(handles[i]) == static_cast<s64>(1000 + i % 7 * 10));
+    }
+    REQUIRE(UnscheduleEvent(type, 8) == 1010);
+    REQUIRE(IsScheduled(type));
+    REQUIRE(!IsScheduled(other_type));
+
+    std::vector<u64> expected;
+    for (u64 i = 0; i < handles.size(); ++i) {
+        if (i % 4 == 0 && i != 8)
+            expected.push_back(i);
+    }
+    std::stable_sort(expected.begin(), expected.end(),
+                     [](u64 a, u64 b) { return a % 7 < b % 7; });
+
+    RunCycles(500);
+    REQUIRE(fired.empty());
+    RunCycles(1000);
+    REQUIRE(fired == expected);
+    REQUIRE(!IsScheduled(type));
+
+    ScheduleEvent(100, other_type, 0);
+    ScheduleEvent(200, type, 1);
+    RemoveEvent(other_type);
+    REQUIRE(!IsScheduled(other_type));
+    RunCycles(300);
+    REQUIRE(fired.back() == 1);
+}
+
+TEST_CASE("CoreTiming runs events scheduled from other threads", "[core]") {
+    ScopeInit init;
+    const int type = RegisterEvent("test", RecordEvent);
+
+    const u64 num_threads = 4;
+    const u64 num_events = 1000;
+    std::atomic<u64> finished_threads(0);
+    std::vector<std::thread> threads;
+    for (u64 thread = 0; thread < num_threads; ++thread) {
+        threads.emplace_back([thread, type, &finished_threads] {
+            for (u64 i = 0; i < num_events; ++i)
+                ScheduleEvent_Threadsafe(i, type, thread << 32 | i);
+            ++finished_threads;
+        });
+    }
+
+    // The events are moved into the main queue while they are being scheduled
+    while (finished_threads != num_threads)
+        MoveEvents();
+    for (auto& thread : threads)
+        thread.join();
+
+    RunCycles(num_events);
+    REQUIRE(fired.size() == num_threads * num_events);
+    std::vector<u64> next(num_threads, 0);
+    for (u64 userdata : fired) {
+        const u64 thread = userdata >> 32;
+        REQUIRE((userdata & 0xFFFFFFFF) == next[thread]);
+        ++next[thread];
+    }
+}
+
+TEST_CASE("MPSCQueue keeps the order of each producer", "[common]") {
+    Common::MPSCQueue<std::pair<int, int>> queue;
+    const int num_threads = 4;
+    const int num_values = 100000;
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < num_threads; ++thread) {
+        threads.emplace_back([thread, &queue] {
+            for (int i = 0; i < num_values; ++i)
+                queue.Push({thread, i});
+        });
+    }
+
+    std::vector<int> next(num_threads, 0);
+    int popped = 0;
+    std::pair<int, int> value;
+    while (popped < num_threads * num_values) {
+        if (!queue.Pop(value))
+            continue;
+        REQUIRE(value.second == next[value.first]);
+        ++next[value.first];
+        ++popped;
+    }
+    for (auto& thread : threads)
+        thread.join();
+    REQUIRE(!queue.Pop(value));
+}
+
+TEST_CASE("CoreTiming timers benchmark", "[.][benchmark]") {
+    // Thousands of periodic timers, which get reset before they expire like the timeouts of
+    // threads waiting on objects are, while the CPU executes in small slices
+    const int num_timers = 4096;
+    const int iterations = 10000;
+    const s64 cycles_per_iteration = 64;
+    std::mt19937 random(42);
+    std::vector<s64> periods(num_timers);
+    for (s64& period : periods)
+        period = 1000 + random() % 100000;
+    std::vector<u64> picks(iterations);
+    for (u64& pick : picks)
+        pick = random() % num_timers;
+
+    // The sorted linked list the events were kept in before, unscheduled by searching the list
+    const double list_ns = [&] {
+        std::list<std::pair<s64, u64>> list;
+        s64 now = 0;
+        const auto schedule = [&list](s64 time, u64 timer) {
+            const auto position =
+                std::find_if(list.begin(), list.end(), [time](const auto& event) {
+                    return event.first > time;
+                });
+            list.emplace(position, time, timer);
+        };
+        for (u64 timer = 0; timer < num_timers; ++timer)
+            schedule(periods[timer], timer);
+
+        int i = 0;
+        return Benchmark::Measure(iterations, [&] {
+            const u64 timer = picks[i++];
+            list.erase(std::find_if(list.begin(), list.end(),
+                                    [timer](const auto& event) { return event.second == timer; }));
+            schedule(now + periods[timer], timer);
+
+            now += cycles_per_iteration;
+            while (list.front().first <= now) {
+                const auto event = list.front();
+                list.pop_front();
+                schedule(event.first + periods[event.second], event.second);
+            }
+        });
+    }();
+
+    const double queue_ns = [&] {
+        ScopeInit init;
+        std::vector<EventHandle> handles(num_timers);
+        int type = 0;
+        type = RegisterEvent("timer", [&](u64 timer, int cycles_late) {
+            handles[timer] = ScheduleEvent(periods[timer] - cycles_late, type, timer);
+        });
+        for (u64 timer = 0; timer < num_timers; ++timer)
+            handles[timer] = ScheduleEvent(periods[timer], type, timer);
+
+        int i = 0;
+        return Benchmark::Measure(iterations, [&] {
+            const u64 timer = picks[i++];
+            UnscheduleEvent(handles[timer]);
+            handles[timer] = ScheduleEvent(periods[timer], type, timer);
+
+            downcount -= cycles_per_iteration;
+            if (downcount < 0)
+                Advance();
+        });
+    }();
+
+    Benchmark::Report("CoreTiming 4096 timers", "sorted list", list_ns, "heap", queue_ns);
+}
+
+} // namespace CoreTiming
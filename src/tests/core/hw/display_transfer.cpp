@@ -0,0 +1,250 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <random>
+#include <vector>
+#include <catch.hpp>
+#include "common/color.h"
+#include "common/common_types.h"
+#include "common/vector_math.h"
+#include "core/hw/display_transfer.h"
+#include "core/hw/gpu.h"
+#include "video_core/utils.h"
+
+#ifdef ARCHITECTURE_x86_64
+#include "common/x64/cpu_detect.h"
+#endif
+
+namespace GPU {
+
+using PixelFormat = Regs::PixelFormat;
+using Config = Regs::DisplayTransferConfig;
+
+// The original one pixel at a time implementation, used as a reference for the specialized one
+namespace Reference {
+
+static Math::Vec4<u8> DecodePixel(PixelFormat input_format, const u8* src_pixel) {
+    switch (input_format) {
+    case PixelFormat::RGBA8:
+        return Color::DecodeRGBA8(src_pixel);
+    case PixelFormat::RGB8:
+        return Color::DecodeRGB8(src_pixel);
+    case PixelFormat::RGB565:
+        return Color::DecodeRGB565(src_pixel);
+    case PixelFormat::RGB5A1:
+        return Color::DecodeRGB5A1(src_pixel);
+    case PixelFormat::RGBA4:
+        return Color::DecodeRGBA4(src_pixel);
+    default:
+        return {0, 0, 0, 0};
+    }
+}
+
+static void EncodePixel(PixelFormat output_format, const Math::Vec4<u8>& color, u8* dst_pixel) {
+    switch (output_format) {
+    case PixelFormat::RGBA8:
+        Color::EncodeRGBA8(color, dst_pixel);
+        break;
+    case PixelFormat::RGB8:
+        Color::EncodeRGB8(color, dst_pixel);
+        break;
+    case PixelFormat::RGB565:
+        Color::EncodeRGB565(color, dst_pixel);
+        break;
+    case PixelFormat::RGB5A1:
+        Color::EncodeRGB5A1(color, dst_pixel);
+        break;
+    case PixelFormat::RGBA4:
+        Color::EncodeRGBA4(color, dst_pixel);
+        break;
+    default:
+        break;
+    }
+}
+
+static void DisplayTransfer(const Config& config, const u8* src_pointer, u8* dst_pointer) {
+    int horizontal_scale = config.scaling != config.NoScale ? 1 : 0;
+    int vertical_scale = config.scaling == config.ScaleXY ? 1 : 0;
+
+    u32 output_width = config.output_width >> horizontal_scale;
+    u32 output_height = config.output_height >> vertical_scale;
+
+    for (u32 y = 0; y < output_height; ++y) {
+        for (u32 x = 0; x < output_width; ++x) {
+            Math::Vec4<u8> src_color;
+
+            u32 input_x = x << horizontal_scale;
+            u32 input_y = y << vertical_scale;
+            u32 output_y = config.flip_vertically ? output_height - y - 1 : y;
+
+            u32 dst_bytes_per_pixel = Regs::BytesPerPixel(config.output_format);
+            u32 src_bytes_per_pixel = Regs::BytesPerPixel(config.input_format);
+            u32 src_offset;
+            u32 dst_offset;
+
+            if (config.input_linear) {
+                if (!config.dont_swizzle) {
+                    u32 coarse_y = output_y & ~7;
+                    u32 stride = output_width * dst_bytes_per_pixel;
+
+                    src_offset = (input_x + input_y * config.input_width) * src_bytes_per_pixel;
+                    dst_offset = VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel) +
+                                 coarse_y * stride;
+                } else {
+                    src_offset = (input_x + input_y * config.input_width) * src_bytes_per_pixel;
+                    dst_offset = (x + output_y * output_width) * dst_bytes_per_pixel;
+                }
+            } else {
+                if (!config.dont_swizzle) {
+                    u32 coarse_y = input_y & ~7;
+                    u32 stride = config.input_width * src_bytes_per_pixel;
+
+                    src_offset = VideoCore::GetMortonOffset(input_x, input_y, src_bytes_per_pixel) +
+                                 coarse_y * stride;
+                    dst_offset = (x + output_y * output_width) * dst_bytes_per_pixel;
+                } else {
+                    u32 out_coarse_y = output_y & ~7;
+                    u32 out_stride = output_width * dst_bytes_per_pixel;
+
+                    u32 in_coarse_y = input_y & ~7;
+                    u32 in_stride = config.input_width * src_bytes_per_pixel;
+
+                    src_offset = VideoCore::GetMortonOffset(input_x, input_y, src_bytes_per_pixel) +
+                                 in_coarse_y * in_stride;
+                    dst_offset = VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel) +
+                                 out_coarse_y * out_stride;
+                }
+            }
+
+            const u8* src_pixel = src_pointer + src_offset;
+            src_color = DecodePixel(config.input_format, src_pixel);
+            if (config.scaling == config.ScaleX) {
+                Math::Vec4<u8> pixel =
+                    DecodePixel(config.input_format, src_pixel + src_bytes_per_pixel);
+                src_color = ((src_color + pixel) / 2).Cast<u8>();
+            } else if (config.scaling == config.ScaleXY) {
+                Math::Vec4<u8> pixel1 =
+                    DecodePixel(config.input_format, src_pixel + 1 * src_bytes_per_pixel);
+                Math::Vec4<u8> pixel2 =
+                    DecodePixel(config.input_format, src_pixel + 2 * src_bytes_per_pixel);
+                Math::Vec4<u8> pixel3 =
+                    DecodePixel(config.input_format, src_pixel + 3 * src_bytes_per_pixel);
+                src_color = (((src_color + pixel1) + (pixel2 + pixel3)) / 4).Cast<u8>();
+            }
+
+            EncodePixel(config.output_format, src_color, dst_pointer + dst_offset);
+        }
+    }
+}
+
+} // namespace Reference
+
+static const PixelFormat formats[] = {PixelFormat::RGBA8, PixelFormat::RGB8, PixelFormat::RGB565,
+                                      PixelFormat::RGB5A1, PixelFormat::RGBA4};
+
+static std::vector<u8> RandomData(size_t size, std::mt19937& random) {
+    std::vector<u8> data(size);
+    for (u8& byte : data)
+        byte = static_cast<u8>(random());
+    return data;
+}
+
+static bool TransfersMatch(PixelFormat input_format, PixelFormat output_format, u32 width,
+                           u32 height, bool input_linear, bool dont_swizzle, bool flip,
+                           Config::ScalingMode scaling, std::mt19937& random) {
+    Config config{};
+    config.input_width.Assign(width);
+    config.input_height.Assign(height);
+    config.output_width.Assign(width);
+    config.output_height.Assign(height);
+    config.input_linear.Assign(input_linear);
+    config.dont_swizzle.Assign(dont_swizzle);
+    config.flip_vertically.Assign(flip);
+    config.input_format.Assign(input_format);
+    config.output_format.Assign(output_format);
+    config.scaling.Assign(scaling);
+
+    // Morton offsets of partial tiles at the right edge go past width * height pixels, and the
+    // bytes not written by the transfer have to match as well
+    const size_t size = ((height + 7) / 8 * 8 * ((width + 7) / 8 * 8) + 64) * 4;
+    const std::vector<u8> src = RandomData(size, random);
+    std::vector<u8> expected = RandomData(size, random);
+    std::vector<u8> result = expected;
+
+    Reference::DisplayTransfer(config, src.data(), expected.data());
+    SoftwareDisplayTransfer(config, src.data(), result.data());
+    return result == expected;
+}
+
+TEST_CASE("SoftwareDisplayTransfer matches the per-pixel transfer", "[core][hw]") {
+    std::mt19937 random(42);
+    for (PixelFormat input_format : formats) {
+        for (PixelFormat output_format : formats) {
+            INFO("Formats " << static_cast<u32>(input_format) << " -> "
+                            << static_cast<u32>(output_format));
+            for (bool input_linear : {false, true}) {
+                for (bool dont_swizzle : {false, true}) {
+                    for (bool flip : {false, true}) {
+                        INFO("Linear input " << input_linear << ", don't swizzle " << dont_swizzle
+                                             << ", flip " << flip);
+                        // Whole tiles take the fast paths, the other sizes the per-pixel loop
+                        REQUIRE(TransfersMatch(input_format, output_format, 64, 32, input_linear,
+                                               dont_swizzle, flip, Config::NoScale, random));
+                        REQUIRE(TransfersMatch(input_format, output_format, 24, 16, input_linear,
+                                               dont_swizzle, flip, Config::NoScale, random));
+                        REQUIRE(TransfersMatch(input_format, output_format, 20, 12, input_linear,
+                                               dont_swizzle, flip, Config::NoScale, random));
+
+                        // Scaling is only supported on tiled input
+                        if (input_linear)
+                            continue;
+                        for (auto scaling : {Config::ScaleX, Config::ScaleXY}) {
+                            INFO("Scaling " << scaling);
+                            REQUIRE(TransfersMatch(input_format, output_format, 64, 32,
+                                                   input_linear, dont_swizzle, flip, scaling,
+                                                   random));
+                            REQUIRE(TransfersMatch(input_format, output_format, 40, 24,
+                                                   input_linear, dont_swizzle, flip, scaling,
+                                                   random));
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+#ifdef ARCHITECTURE_x86_64
+
+TEST_CASE("SSSE3 RGBA8 <-> RGB8 conversions match the per-pixel ones", "[core][hw]") {
+    if (!Common::GetCPUCaps().ssse3)
+        return;
+
+    std::mt19937 random(42);
+    // Counts which aren't a multiple of the pixels converted per iteration, with guard bytes
+    // after the output to catch overruns
+    for (size_t count = 0; count < 100; ++count) {
+        INFO("Pixel count " << count);
+        const std::vector<u8> rgba8 = RandomData(count * 4, random);
+        const std::vector<u8> rgb8 = RandomData(count * 3, random);
+
+        std::vector<u8> expected_rgb8 = RandomData(count * 3 + 16, random);
+        std::vector<u8> result_rgb8 = expected_rgb8;
+        for (size_t i = 0; i < count; ++i)
+            Color::EncodeRGB8(Color::DecodeRGBA8(&rgba8[i * 4]), &expected_rgb8[i * 3]);
+        ConvertRGBA8ToRGB8_SSSE3(rgba8.data(), result_rgb8.data(), count);
+        REQUIRE(result_rgb8 == expected_rgb8);
+
+        std::vector<u8> expected_rgba8 = RandomData(count * 4 + 16, random);
+        std::vector<u8> result_rgba8 = expected_rgba8;
+        for (size_t i = 0; i < count; ++i)
+            Color::EncodeRGBA8(Color::DecodeRGB8(&rgb8[i * 3]), &expected_rgba8[i * 4]);
+        ConvertRGB8ToRGBA8_SSSE3(rgb8.data(), result_rgba8.data(), count);
+        REQUIRE(result_rgba8 == expected_rgba8);
+    }
+}
+
+#endif
+
+} // namespace GPU
@@ -0,0 +1,439 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <vector>
+#include <catch.hpp>
+#include "common/color.h"
+#include "common/common_types.h"
+#include "common/math_util.h"
+#include "common/vector_math.h"
+#include "core/hle/service/y2r_u.h"
+#include "core/hw/y2r.h"
+#include "core/memory.h"
+#include "core/memory_setup.h"
+#include "tests/benchmark.h"
+
+namespace HW {
+namespace Y2R {
+
+using namespace Service::Y2R;
+
+// The original one pixel at a time implementation, used as a reference for the optimized one
+namespace Reference {
+
+static const size_t TILE_SIZE = 8 * 8;
+using ImageTile = std::array<u32, TILE_SIZE>;
+
+static void ConvertYUVToRGB(InputFormat input_format, const u8* input_Y, const u8* input_U,
+                            const u8* input_V, ImageTile output[], unsigned int width,
+                            unsigned int height, const CoefficientSet& coefficients) {
+    for (unsigned int y = 0; y < height; ++y) {
+        for (unsigned int x = 0; x < width; ++x) {
+            s32 Y = 0;
+            s32 U = 0;
+            s32 V = 0;
+            switch (input_format) {
+            case InputFormat::YUV422_Indiv8:
+            case InputFormat::YUV422_Indiv16:
+                Y = input_Y[y * width + x];
+                U = input_U[(y * width + x) / 2];
+                V = input_V[(y * width + x) / 2];
+                break;
+            case InputFormat::YUV420_Indiv8:
+            case InputFormat::YUV420_Indiv16:
+                Y = input_Y[y * width + x];
+                U = input_U[((y / 2) * width + x) / 2];
+                V = input_V[((y / 2) * width + x) / 2];
+                break;
+            case InputFormat::YUYV422_Interleaved:
+                Y = input_Y[(y * width + x) * 2];
+                U = input_Y[(y * width + (x / 2) * 2) * 2 + 1];
+                V = input_Y[(y * width + (x / 2) * 2) * 2 + 3];
+                break;
+            }
+
+            auto& c = coefficients;
+            s32 cY = c[0] * Y;
+
+            s32 r = cY + c[1] * V;
+            s32 g = cY - c[2] * V - c[3] * U;
+            s32 b = cY + c[4] * U;
+
+            const s32 rounding_offset = 0x18;
+            r = (r >> 3) + c[5] + rounding_offset;
+            g = (g >> 3) + c[6] + rounding_offset;
+            b = (b >> 3) + c[7] + rounding_offset;
+
+            u32* out = &output[x / 8][y * 8 + x % 8];
+
+            using MathUtil::Clamp;
+            *out = ((u32)Clamp(r >> 5, 0, 0xFF) << 24) | ((u32)Clamp(g >> 5, 0, 0xFF) << 16) |
+                   ((u32)Clamp(b >> 5, 0, 0xFF) << 8);
+        }
+    }
+}
+
+template <size_t N>
+static void ReceiveData(u8* output, ConversionBuffer& buf, size_t amount_of_data) {
+    const u8* input = Memory::GetPointer(buf.address);
+    size_t output_unit = buf.transfer_unit / N;
+    while (amount_of_data > 0) {
+        for (size_t i = 0; i < output_unit; ++i) {
+            output[i] = input[i * N];
+        }
+        output += output_unit;
+        input += buf.transfer_unit + buf.gap;
+        buf.address += buf.transfer_unit + buf.gap;
+        buf.image_size -= buf.transfer_unit;
+        amount_of_data -= output_unit;
+    }
+}
+
+static void SendData(const u32* input, ConversionBuffer& buf, int amount_of_data,
+                     OutputFormat output_format, u8 alpha) {
+    u8* output = Memory::GetPointer(buf.address);
+    while (amount_of_data > 0) {
+        u8* unit_end = output + buf.transfer_unit;
+        while (output < unit_end) {
+            u32 color = *input++;
+            Math::Vec4<u8> col_vec{(u8)(color >> 24), (u8)(color >> 16), (u8)(color >> 8), alpha};
+            switch (output_format) {
+            case OutputFormat::RGBA8:
+                Color::EncodeRGBA8(col_vec, output);
+                output += 4;
+                break;
+            case OutputFormat::RGB8:
+                Color::EncodeRGB8(col_vec, output);
+                output += 3;
+                break;
+            case OutputFormat::RGB5A1:
+                Color::EncodeRGB5A1(col_vec, output);
+                output += 2;
+                break;
+            case OutputFormat::RGB565:
+                Color::EncodeRGB565(col_vec, output);
+                output += 2;
+                break;
+            }
+            amount_of_data -= 1;
+        }
+        output += buf.gap;
+        buf.address += buf.transfer_unit + buf.gap;
+        buf.image_size -= buf.transfer_unit;
+    }
+}
+
+static const u8 linear_lut[TILE_SIZE] = {
+    // clang-format off
+     0,  1,  2,  3,  4,  5,  6,  7,
+     8,  9, 10, 11, 12, 13, 14, 15,
+    16, 17, 18, 19, 20, 21, 22, 23,
+    24, 25, 26, 27, 28, 29, 30, 31,
+    32, 33, 34, 35, 36, 37, 38, 39,
+    40, 41, 42, 43, 44, 45, 46, 47,
+    48, 49, 50, 51, 52, 53, 54, 55,
+    56, 57, 58, 59, 60, 61, 62, 63,
+    // clang-format on
+};
+
+static const u8 morton_lut[TILE_SIZE] = {
+    // clang-format off
+     0,  1,  4,  5, 16, 17, 20, 21,
+     2,  3,  6,  7, 18, 19, 22, 23,
+     8,  9, 12, 13, 24, 25, 28, 29,
+    10, 11, 14, 15, 26, 27, 30, 31,
+    32, 33, 36, 37, 48, 49, 52, 53,
+    34, 35, 38, 39, 50, 51, 54, 55,
+    40, 41, 44, 45, 56, 57, 60, 61,
+    42, 43, 46, 47, 58, 59, 62, 63,
+    // clang-format on
+};
+
+static void RotateTile(Rotation rotation, const ImageTile& input, ImageTile& output, int height,
+                       const u8 out_map[64]) {
+    int out_i = 0;
+    switch (rotation) {
+    case Rotation::None:
+        for (int i = 0; i < height * 8; ++i)
+            output[out_map[i]] = input[i];
+        break;
+    case Rotation::Clockwise_90:
+        for (int x = 0; x < 8; ++x)
+            for (int y = height - 1; y >= 0; --y)
+                output[out_map[out_i++]] = input[y * 8 + x];
+        break;
+    case Rotation::Clockwise_180:
+        for (int i = height * 8 - 1; i >= 0; --i)
+            output[out_map[out_i++]] = input[i];
+        break;
+    case Rotation::Clockwise_270:
+        for (int x = 8 - 1; x >= 0; --x)
+            for (int y = 0; y < height; ++y)
+                output[out_map[out_i++]] = input[y * 8 + x];
+        break;
+    }
+}
+
+static void WriteTileToOutput(u32* output, const ImageTile& tile, int height, int line_stride) {
+    for (int y = 0; y < height; ++y)
+        for (int x = 0; x < 8; ++x)
+            output[y * line_stride + x] = tile[y * 8 + x];
+}
+
+static void PerformConversion(ConversionConfiguration& cvt) {
+    size_t num_tiles = cvt.input_line_width / 8;
+    std::vector<u8> data_buffer(cvt.input_line_width * 8 * 4);
+    std::vector<ImageTile> tiles(num_tiles);
+    ImageTile tmp_tile;
+
+    const u8* tile_remap =
+        cvt.block_alignment == BlockAlignment::Linear ? linear_lut : morton_lut;
+
+    for (unsigned int y = 0; y < cvt.input_lines; y += 8) {
+        unsigned int row_height = std::min(cvt.input_lines - y, 8u);
+        const size_t row_data_size = row_height * cvt.input_line_width;
+
+        u8* input_Y = data_buffer.data();
+        u8* input_U = input_Y + 8 * cvt.input_line_width;
+        u8* input_V = input_U + 8 * cvt.input_line_width / 2;
+
+        switch (cvt.input_format) {
+        case InputFormat::YUV422_Indiv8:
+            ReceiveData<1>(input_Y, cvt.src_Y, row_data_size);
+            ReceiveData<1>(input_U, cvt.src_U, row_data_size / 2);
+            ReceiveData<1>(input_V, cvt.src_V, row_data_size / 2);
+            break;
+        case InputFormat::YUV420_Indiv8:
+            ReceiveData<1>(input_Y, cvt.src_Y, row_data_size);
+            ReceiveData<1>(input_U, cvt.src_U, row_data_size / 4);
+            ReceiveData<1>(input_V, cvt.src_V, row_data_size / 4);
+            break;
+        case InputFormat::YUV422_Indiv16:
+            ReceiveData<2>(input_Y, cvt.src_Y, row_data_size);
+            ReceiveData<2>(input_U, cvt.src_U, row_data_size / 2);
+            ReceiveData<2>(input_V, cvt.src_V, row_data_size / 2);
+            break;
+        case InputFormat::YUV420_Indiv16:
+            ReceiveData<2>(input_Y, cvt.src_Y, row_data_size);
+            ReceiveData<2>(input_U, cvt.src_U, row_data_size / 4);
+            ReceiveData<2>(input_V, cvt.src_V, row_data_size / 4);
+            break;
+        case InputFormat::YUYV422_Interleaved:
+            input_U = nullptr;
+            input_V = nullptr;
+            ReceiveData<1>(input_Y, cvt.src_YUYV, row_data_size * 2);
+            break;
+        }
+
+        ConvertYUVToRGB(cvt.input_format, input_Y, input_U, input_V, tiles.data(),
+                        cvt.input_line_width, row_height, cvt.coefficients);
+
+        u32* output_buffer = reinterpret_cast<u32*>(data_buffer.data());
+
+        for (size_t i = 0; i < num_tiles; ++i) {
+            const bool reversed = cvt.rotation == Rotation::Clockwise_180 ||
+                                  cvt.rotation == Rotation::Clockwise_270;
+            const bool transposed = cvt.rotation == Rotation::Clockwise_90 ||
+                                    cvt.rotation == Rotation::Clockwise_270;
+            RotateTile(cvt.rotation, tiles[reversed ? num_tiles - i - 1 : i], tmp_tile,
+                       row_height, tile_remap);
+            const int image_strip_width = transposed ? 8 : cvt.input_line_width;
+            const int output_stride = transposed ? 8 * row_height : 8;
+
+            switch (cvt.block_alignment) {
+            case BlockAlignment::Linear:
+                WriteTileToOutput(output_buffer, tmp_tile, row_height, image_strip_width);
+                output_buffer += output_stride;
+                break;
+            case BlockAlignment::Block8x8:
+                WriteTileToOutput(output_buffer, tmp_tile, 8, 8);
+                output_buffer += TILE_SIZE;
+                break;
+            }
+        }
+
+        SendData(reinterpret_cast<u32*>(data_buffer.data()), cvt.dst, (int)row_data_size,
+                 cvt.output_format, (u8)cvt.alpha);
+    }
+}
+
+} // namespace Reference
+
+static const VAddr INPUT_ADDR = Memory::HEAP_VADDR;
+static const VAddr OUTPUT_ADDR = Memory::HEAP_VADDR + 0x200000;
+static const u32 MEMORY_SIZE = 0x400000;
+
+static const CoefficientSet REC601 = {{0x100, 0x166, 0xB6, 0x58, 0x1C5, -0x166F, 0x10EE, -0x1C5B}};
+static const CoefficientSet EXTREME = {{0x7FFF, -0x8000, -0x8000, 0x7FFF, -0x8000, 0x7FFF, -0x8000,
+                                        0x1234}};
+
+/// Maps a buffer as emulated memory for the test's lifetime
+class TestMemory {
+public:
+    TestMemory() : memory(MEMORY_SIZE) {
+        Memory::MapMemoryRegion(INPUT_ADDR, MEMORY_SIZE, memory.data());
+    }
+
+    ~TestMemory() {
+        Memory::UnmapRegion(INPUT_ADDR, MEMORY_SIZE);
+    }
+
+    /// Fills the memory with the same pseudo-random data on every call
+    void Reset() {
+        u32 seed = 0x12345678;
+        for (u8& byte : memory) {
+            seed = seed * 1103515245 + 12345;
+            byte = static_cast<u8>(seed >> 16);
+        }
+    }
+
+    const std::vector<u8>& GetContents() const {
+        return memory;
+    }
+
+private:
+    std::vector<u8> memory;
+};
+
+static ConversionBuffer MakeBuffer(VAddr address, u32 image_size, u16 transfer_unit, u16 gap) {
+    ConversionBuffer buffer;
+    buffer.address = address;
+    buffer.image_size = image_size;
+    buffer.transfer_unit = transfer_unit;
+    buffer.gap = gap;
+    return buffer;
+}
+
+static ConversionConfiguration MakeConfiguration(InputFormat input_format,
+                                                 OutputFormat output_format, Rotation rotation,
+                                                 BlockAlignment block_alignment, u16 width,
+                                                 u16 lines, u16 gap) {
+    ConversionConfiguration cvt{};
+    cvt.input_format = input_format;
+    cvt.output_format = output_format;
+    cvt.rotation = rotation;
+    cvt.block_alignment = block_alignment;
+    cvt.input_line_width = width;
+    cvt.input_lines = lines;
+    cvt.coefficients = REC601;
+    cvt.alpha = 0xA5;
+
+    const bool is_16bit = input_format == InputFormat::YUV422_Indiv16 ||
+                          input_format == InputFormat::YUV420_Indiv16;
+    const u16 luma_unit = width * (is_16bit ? 2 : 1);
+    const u16 chroma_unit = luma_unit / 2;
+    const u32 luma_size = luma_unit * lines;
+    cvt.src_Y = MakeBuffer(INPUT_ADDR, luma_size, luma_unit, gap);
+    cvt.src_U = MakeBuffer(INPUT_ADDR + 0x80000, luma_size / 2, chroma_unit, gap);
+    cvt.src_V = MakeBuffer(INPUT_ADDR + 0xC0000, luma_size / 2, chroma_unit, gap);
+    cvt.src_YUYV = MakeBuffer(INPUT_ADDR + 0x100000, width * lines * 2, width * 2, gap);
+
+    const u16 bytes_per_pixel = output_format == OutputFormat::RGBA8
+                                    ? 4
+                                    : output_format == OutputFormat::RGB8 ? 3 : 2;
+    // Linear output is sent a line at a time, tiled output a strip at a time
+    const u16 lines_per_unit = block_alignment == BlockAlignment::Linear ? 1 : 8;
+    const u16 output_unit = width * bytes_per_pixel * lines_per_unit;
+    cvt.dst = MakeBuffer(OUTPUT_ADDR, width * lines * bytes_per_pixel, output_unit, gap);
+    return cvt;
+}
+
+static bool ConversionsMatch(TestMemory& memory, const ConversionConfiguration& cvt) {
+    memory.Reset();
+    ConversionConfiguration reference_cvt = cvt;
+    Reference::PerformConversion(reference_cvt);
+    const std::vector<u8> expected = memory.GetContents();
+
+    memory.Reset();
+    ConversionConfiguration tested_cvt = cvt;
+    PerformConversion(tested_cvt);
+
+    return memory.GetContents() == expected &&
+           tested_cvt.dst.address == reference_cvt.dst.address &&
+           tested_cvt.src_Y.address == reference_cvt.src_Y.address &&
+           tested_cvt.src_YUYV.address == reference_cvt.src_YUYV.address;
+}
+
+static const InputFormat input_formats[] = {
+    InputFormat::YUV422_Indiv8, InputFormat::YUV420_Indiv8, InputFormat::YUV422_Indiv16,
+    InputFormat::YUV420_Indiv16, InputFormat::YUYV422_Interleaved,
+};
+static const OutputFormat output_formats[] = {
+    OutputFormat::RGBA8, OutputFormat::RGB8, OutputFormat::RGB5A1, OutputFormat::RGB565,
+};
+static const Rotation rotations[] = {
+    Rotation::None, Rotation::Clockwise_90, Rotation::Clockwise_180, Rotation::Clockwise_270,
+};
+
+TEST_CASE("Y2R::PerformConversion matches the per-pixel conversion", "[core][hw]") {
+    TestMemory memory;
+    Init();
+
+    for (InputFormat input_format : input_formats) {
+        for (OutputFormat output_format : output_formats) {
+            for (Rotation rotation : rotations) {
+                INFO("input " << static_cast<int>(input_format) << ", output "
+                              << static_cast<int>(output_format) << ", rotation "
+                              << static_cast<int>(rotation));
+
+                // Linear output, including a partial last strip
+                REQUIRE(ConversionsMatch(
+                    memory, MakeConfiguration(input_format, output_format, rotation,
+                                              BlockAlignment::Linear, 48, 30, 0)));
+                // Tiled output, with gaps between the transfers
+                REQUIRE(ConversionsMatch(
+                    memory, MakeConfiguration(input_format, output_format, rotation,
+                                              BlockAlignment::Block8x8, 64, 32, 16)));
+            }
+        }
+    }
+
+    SECTION("with out of range intermediate values") {
+        ConversionConfiguration cvt =
+            MakeConfiguration(InputFormat::YUV422_Indiv8, OutputFormat::RGBA8, Rotation::None,
+                              BlockAlignment::Linear, 64, 16, 0);
+        cvt.coefficients = EXTREME;
+        REQUIRE(ConversionsMatch(memory, cvt));
+    }
+
+    SECTION("with the output overlapping the input") {
+        ConversionConfiguration cvt =
+            MakeConfiguration(InputFormat::YUYV422_Interleaved, OutputFormat::RGBA8,
+                              Rotation::None, BlockAlignment::Linear, 64, 32, 0);
+        cvt.dst.address = cvt.src_YUYV.address + 0x100;
+        REQUIRE(ConversionsMatch(memory, cvt));
+    }
+
+    Shutdown();
+}
+
+TEST_CASE("Y2R::PerformConversion benchmark", "[.][benchmark]") {
+    TestMemory memory;
+    Init();
+
+    const ConversionConfiguration cvt =
+        MakeConfiguration(InputFormat::YUV420_Indiv8, OutputFormat::RGBA8, Rotation::None,
+                          BlockAlignment::Linear, 400, 240, 0);
+    const int iterations = 200;
+    memory.Reset();
+
+    const auto measure = [&](void (*convert)(ConversionConfiguration&)) {
+        return Benchmark::Measure(iterations, [&] {
+            ConversionConfiguration iteration_cvt = cvt;
+            convert(iteration_cvt);
+        });
+    };
+    Benchmark::Report("Y2R 400x240 YUV420 -> RGBA8", "per-pixel",
+                      measure(Reference::PerformConversion), "optimized",
+                      measure(PerformConversion));
+    REQUIRE(ConversionsMatch(memory, cvt));
+
+    Shutdown();
+}
+
+} // namespace Y2R
+} // namespace HW
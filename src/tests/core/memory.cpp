@@ -0,0 +1,103 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <memory>
+#include <catch.hpp>
+#include "common/common_types.h"
+#include "core/hle/kernel/vm_manager.h"
+#include "core/memory.h"
+#include "core/memory_setup.h"
+#include "video_core/rasterizer_interface.h"
+#include "video_core/renderer_base.h"
+#include "video_core/video_core.h"
+
+namespace Memory {
+
+/// Value which the test rasterizer writes back to the regions it flushes
+constexpr u32 FLUSHED_VALUE = 0x12345678;
+
+/// Rasterizer standing in for a surface cached from emulated memory
+class TestRasterizer final : public VideoCore::RasterizerInterface {
+public:
+    explicit TestRasterizer(u8* memory) : memory(memory) {}
+
+    void AddTriangle(const Pica::Shader::OutputVertex& v0, const Pica::Shader::OutputVertex& v1,
+                     const Pica::Shader::OutputVertex& v2) override {}
+    void DrawTriangles() override {}
+    void NotifyPicaRegisterChanged(u32 id) override {}
+    void FlushAll() override {}
+    void FlushRegion(PAddr addr, u32 size) override {}
+
+    void FlushAndInvalidateRegion(PAddr addr, u32 size) override {
+        ++flush_count;
+        std::memcpy(memory + (addr - VRAM_PADDR), &FLUSHED_VALUE, sizeof(FLUSHED_VALUE));
+        RasterizerMarkRegionCached(addr, size, -1);
+    }
+
+    int flush_count = 0;
+
+private:
+    u8* memory;
+};
+
+class TestRenderer final : public RendererBase {
+public:
+    explicit TestRenderer(std::unique_ptr<TestRasterizer> test_rasterizer) {
+        rasterizer = std::move(test_rasterizer);
+    }
+
+    void SwapBuffers() override {}
+    void SetWindow(EmuWindow* window) override {}
+    bool Init() override {
+        return true;
+    }
+    void ShutDown() override {}
+};
+
+TEST_CASE("Fastmem region follows the page table", "[core][memory]") {
+    InitMemoryMap();
+    if (!EnableFastmem())
+        return;
+
+    constexpr u32 size = 4 * PAGE_SIZE;
+    Kernel::MemoryBlock block(size);
+    MapMemoryRegion(VRAM_VADDR, size, block.data());
+
+    auto test_rasterizer = std::make_unique<TestRasterizer>(block.data());
+    TestRasterizer* rasterizer = test_rasterizer.get();
+    VideoCore::g_renderer = std::make_unique<TestRenderer>(std::move(test_rasterizer));
+
+    SECTION("accesses go to the mapped memory") {
+        Write32(VRAM_VADDR, 1);
+        REQUIRE(FastmemRead<u32>(VRAM_VADDR) == 1);
+        FastmemWrite<u32>(VRAM_VADDR + PAGE_SIZE, 2);
+        REQUIRE(Read32(VRAM_VADDR + PAGE_SIZE) == 2);
+    }
+
+    SECTION("cached pages are flushed before they are accessed") {
+        RasterizerMarkRegionCached(VRAM_PADDR + PAGE_SIZE, PAGE_SIZE, 1);
+        REQUIRE(FastmemRead<u32>(VRAM_VADDR + PAGE_SIZE) == FLUSHED_VALUE);
+        REQUIRE(rasterizer->flush_count == 1);
+
+        // The page is accessible again until it is cached again
+        FastmemWrite<u32>(VRAM_VADDR + PAGE_SIZE, 3);
+        REQUIRE(Read32(VRAM_VADDR + PAGE_SIZE) == 3);
+        REQUIRE(rasterizer->flush_count == 1);
+    }
+
+    SECTION("unmapped pages read zero") {
+        REQUIRE(FastmemRead<u32>(VRAM_VADDR + size) == 0);
+        FastmemWrite<u32>(VRAM_VADDR + size, 4);
+
+        UnmapRegion(VRAM_VADDR, size);
+        REQUIRE(FastmemRead<u32>(VRAM_VADDR) == 0);
+    }
+
+    VideoCore::g_renderer.reset();
+    UnmapRegion(VRAM_VADDR, size);
+    DisableFastmem();
+}
+
+} // namespace Memory
@@ -0,0 +1,218 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <catch.hpp>
+#include "common/common_types.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/hw/gpu.h"
+#include "core/hw/hw.h"
+#include "core/memory.h"
+#include "core/memory_setup.h"
+#include "core/settings.h"
+#include "video_core/command_processor.h"
+#include "video_core/pica.h"
+#include "video_core/pica_state.h"
+#include "video_core/regs.h"
+#include "video_core/renderer_base.h"
+#include "video_core/renderer_headless/renderer_headless.h"
+#include "video_core/video_core.h"
+
+namespace Pica {
+
+/// Size of the render targets, in pixels along each side
+constexpr u32 TARGET_SIZE = 8;
+constexpr u32 TARGET_BYTES = TARGET_SIZE * TARGET_SIZE * 4;
+
+/// Render target transferred to the top screen
+constexpr PAddr SCREEN_BUFFER = Memory::VRAM_PADDR + 0x10000;
+/// Render target which the application samples as a texture
+constexpr PAddr TEXTURE_BUFFER = Memory::VRAM_PADDR + 0x20000;
+constexpr PAddr VERTEX_BUFFER = Memory::VRAM_PADDR + 0x30000;
+
+/// Sets up the emulated GPU with VRAM and the software rasterizer
+class ScopeInit final {
+public:
+    ScopeInit() : vram(Memory::VRAM_SIZE) {
+        Memory::InitMemoryMap();
+        Memory::MapMemoryRegion(Memory::VRAM_VADDR, Memory::VRAM_SIZE, vram.data());
+
+        CoreTiming::Init(downcount);
+        GPU::Init();
+        Pica::Init();
+        VideoCore::g_hw_renderer_enabled = false;
+        VideoCore::g_shader_jit_enabled = false;
+        VideoCore::g_renderer = std::make_unique<RendererHeadless>();
+        VideoCore::g_renderer->Init();
+
+        Settings::values.toggle_framelimit = false;
+        Settings::values.frame_skip = 0;
+        Settings::values.frame_skip_period = 1;
+        Core::System::GetInstance().frame_limiter.DoFrameLimiting(0);
+    }
+
+    ~ScopeInit() {
+        Settings::values.frame_skip = 0;
+        Settings::values.frame_skip_period = 1;
+        Core::System::GetInstance().frame_limiter.DoFrameLimiting(0);
+
+        VideoCore::g_renderer.reset();
+        Pica::Shutdown();
+        GPU::Shutdown();
+        CoreTiming::Shutdown();
+        Memory::UnmapRegion(Memory::VRAM_VADDR, Memory::VRAM_SIZE);
+    }
+
+private:
+    std::vector<u8> vram;
+    s64 downcount = 0;
+};
+
+/// Converts a positive float to the raw value of a float24
+static u32 ToFloat24(float value) {
+    u32 hex;
+    std::memcpy(&hex, &value, sizeof(hex));
+    return (((hex >> 23) - 64) << 16) | ((hex & 0x7FFFFF) >> 7);
+}
+
+/**
+ * Sets up a draw of a triangle covering the lower left half of an 8x8 RGBA8 render target, with
+ * a vertex shader passing the position and color of the vertices through.
+ */
+static void SetupDraw() {
+    auto& regs = g_state.regs;
+
+    // mov o0, v0; mov o1, v1; end
+    g_state.vs.program_code[0] = 0x13 << 26 | 0 << 21 | 0 << 12;
+    g_state.vs.program_code[1] = 0x13 << 26 | 1 << 21 | 1 << 12;
+    g_state.vs.program_code[2] = 0x22 << 26;
+    // Writes all components of the destination without swizzling the source
+    g_state.vs.swizzle_data[0] = 0x36F;
+    regs.vs.main_offset.Assign(0);
+    regs.vs.max_input_attribute_index.Assign(1);
+    regs.vs.input_attribute_to_register_map_low = 0x10;
+    regs.vs.output_mask.Assign(0x3);
+
+    const float vertices[3][8] = {
+        {-1.0f, -1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f},
+        {1.0f, -1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f},
+        {-1.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f},
+    };
+    std::memcpy(Memory::GetPhysicalPointer(VERTEX_BUFFER), vertices, sizeof(vertices));
+
+    auto& attributes = regs.pipeline.vertex_attributes;
+    attributes.base_address.Assign(VERTEX_BUFFER / 16);
+    attributes.format0.Assign(PipelineRegs::VertexAttributeFormat::FLOAT);
+    attributes.size0.Assign(3);
+    attributes.format1.Assign(PipelineRegs::VertexAttributeFormat::FLOAT);
+    attributes.size1.Assign(3);
+    attributes.max_attribute_index.Assign(1);
+    attributes.attribute_loaders[0].data_offset.Assign(0);
+    attributes.attribute_loaders[0].comp0.Assign(0);
+    attributes.attribute_loaders[0].comp1.Assign(1);
+    attributes.attribute_loaders[0].byte_count.Assign(sizeof(vertices[0]));
+    attributes.attribute_loaders[0].component_count.Assign(2);
+    regs.pipeline.num_vertices = 3;
+
+    using Semantic = RasterizerRegs::VSOutputAttributes::Semantic;
+    regs.rasterizer.vs_output_total.Assign(2);
+    regs.rasterizer.vs_output_attributes[0].map_x.Assign(Semantic::POSITION_X);
+    regs.rasterizer.vs_output_attributes[0].map_y.Assign(Semantic::POSITION_Y);
+    regs.rasterizer.vs_output_attributes[0].map_z.Assign(Semantic::POSITION_Z);
+    regs.rasterizer.vs_output_attributes[0].map_w.Assign(Semantic::POSITION_W);
+    regs.rasterizer.vs_output_attributes[1].map_x.Assign(Semantic::COLOR_R);
+    regs.rasterizer.vs_output_attributes[1].map_y.Assign(Semantic::COLOR_G);
+    regs.rasterizer.vs_output_attributes[1].map_z.Assign(Semantic::COLOR_B);
+    regs.rasterizer.vs_output_attributes[1].map_w.Assign(Semantic::COLOR_A);
+    regs.rasterizer.viewport_size_x.Assign(ToFloat24(TARGET_SIZE / 2.0f));
+    regs.rasterizer.viewport_size_y.Assign(ToFloat24(TARGET_SIZE / 2.0f));
+
+    // The texture combiners pass the vertex color through, which is written without blending
+    auto& output_merger = regs.framebuffer.output_merger;
+    output_merger.logic_op.Assign(FramebufferRegs::LogicOp::Copy);
+    output_merger.red_enable.Assign(1);
+    output_merger.green_enable.Assign(1);
+    output_merger.blue_enable.Assign(1);
+    output_merger.alpha_enable.Assign(1);
+
+    auto& framebuffer = regs.framebuffer.framebuffer;
+    framebuffer.allow_color_write.Assign(0xF);
+    framebuffer.color_format.Assign(FramebufferRegs::ColorFormat::RGBA8);
+    framebuffer.width.Assign(TARGET_SIZE);
+    framebuffer.height.Assign(TARGET_SIZE - 1);
+}
+
+/// Draws the triangle to a render target, through a command list like the application would
+static void Draw(PAddr target) {
+    g_state.regs.framebuffer.framebuffer.color_buffer_address.Assign(target / 8);
+
+    CommandProcessor::CommandHeader header{};
+    header.cmd_id.Assign(PICA_REG_INDEX(pipeline.trigger_draw));
+    header.parameter_mask.Assign(0xF);
+    const u32 command_list[] = {1, header.hex};
+    CommandProcessor::ProcessCommandList(command_list, sizeof(command_list));
+}
+
+/// Transfers a render target to the top screen
+static void TransferToScreen(PAddr source) {
+    auto& config = GPU::g_regs.display_transfer_config;
+    config.input_address = source / 8;
+    config.output_address = GPU::g_regs.framebuffer_config[0].address_left1 / 8;
+    config.input_width.Assign(TARGET_SIZE);
+    config.input_height.Assign(TARGET_SIZE);
+    config.output_width.Assign(TARGET_SIZE);
+    config.output_height.Assign(TARGET_SIZE);
+    config.input_format.Assign(GPU::Regs::PixelFormat::RGBA8);
+    config.output_format.Assign(GPU::Regs::PixelFormat::RGB8);
+    GPU::Write<u32>(HW::VADDR_GPU + GPU_REG_INDEX(display_transfer_config.trigger) * 4, 1);
+}
+
+static void Clear(PAddr target) {
+    std::memset(Memory::GetPhysicalPointer(target), 0, TARGET_BYTES);
+}
+
+static bool IsDrawn(PAddr target) {
+    const u8* data = Memory::GetPhysicalPointer(target);
+    return std::any_of(data, data + TARGET_BYTES, [](u8 byte) { return byte != 0; });
+}
+
+TEST_CASE("Skipped frames only drop the draws to the screens", "[video_core]") {
+    ScopeInit init;
+    SetupDraw();
+
+    // Presented frame, rendering a texture and the screen which it is used on
+    Clear(SCREEN_BUFFER);
+    Clear(TEXTURE_BUFFER);
+    Draw(TEXTURE_BUFFER);
+    Draw(SCREEN_BUFFER);
+    TransferToScreen(SCREEN_BUFFER);
+    REQUIRE(IsDrawn(TEXTURE_BUFFER));
+    REQUIRE(IsDrawn(SCREEN_BUFFER));
+
+    Settings::values.frame_skip = 1;
+    Settings::values.frame_skip_period = 2;
+    Core::System::GetInstance().frame_limiter.DoFrameLimiting(0);
+    REQUIRE(Core::System::GetInstance().frame_limiter.IsFrameSkipped());
+
+    // Skipped frame, the texture has to be rendered as the application may still sample it
+    Clear(SCREEN_BUFFER);
+    Clear(TEXTURE_BUFFER);
+    Draw(TEXTURE_BUFFER);
+    Draw(SCREEN_BUFFER);
+    TransferToScreen(SCREEN_BUFFER);
+    REQUIRE(IsDrawn(TEXTURE_BUFFER));
+    REQUIRE(!IsDrawn(SCREEN_BUFFER));
+
+    // The next frame is presented again
+    Core::System::GetInstance().frame_limiter.DoFrameLimiting(0);
+    REQUIRE(!Core::System::GetInstance().frame_limiter.IsFrameSkipped());
+    Draw(SCREEN_BUFFER);
+    REQUIRE(IsDrawn(SCREEN_BUFFER));
+}
+
+} // namespace Pica
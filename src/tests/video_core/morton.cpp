@@ -0,0 +1,152 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include <catch.hpp>
+#include "common/common_types.h"
+#include "tests/benchmark.h"
+#include "video_core/morton.h"
+#include "video_core/utils.h"
+
+namespace VideoCore {
+
+// The original one pixel at a time implementation, used as a reference for the optimized one
+namespace Reference {
+
+static void MortonCopy(u32 width, u32 height, u32 bytes_per_pixel, u32 linear_bytes_per_pixel,
+                       bool swap_depth_stencil, u8* morton_data, u8* linear_data,
+                       bool morton_to_linear) {
+    u8* data_ptrs[2];
+    u32 depth_stencil_shifts[2] = {24, 8};
+
+    if (morton_to_linear) {
+        std::swap(depth_stencil_shifts[0], depth_stencil_shifts[1]);
+    }
+
+    for (unsigned y = 0; y < height; ++y) {
+        for (unsigned x = 0; x < width; ++x) {
+            const u32 coarse_y = y & ~7;
+            u32 morton_offset =
+                GetMortonOffset(x, y, bytes_per_pixel) + coarse_y * width * bytes_per_pixel;
+            u32 linear_pixel_index = (x + (height - 1 - y) * width) * linear_bytes_per_pixel;
+
+            data_ptrs[morton_to_linear] = morton_data + morton_offset;
+            data_ptrs[!morton_to_linear] = &linear_data[linear_pixel_index];
+
+            if (swap_depth_stencil) {
+                u32 depth_stencil;
+                memcpy(&depth_stencil, data_ptrs[1], sizeof(u32));
+                depth_stencil = (depth_stencil << depth_stencil_shifts[0]) |
+                                (depth_stencil >> depth_stencil_shifts[1]);
+
+                memcpy(data_ptrs[0], &depth_stencil, sizeof(u32));
+            } else {
+                memcpy(data_ptrs[0], data_ptrs[1], bytes_per_pixel);
+            }
+        }
+    }
+}
+
+} // namespace Reference
+
+/// Pixel layouts used by the OpenGL rasterizer cache when copying surfaces
+struct PixelLayout {
+    const char* name;
+    u32 bytes_per_pixel;
+    u32 linear_bytes_per_pixel;
+    /// Offset of the pixels within the linear buffer, D24 is stored in the high bytes of a u32
+    u32 linear_offset;
+    bool swap_depth_stencil;
+};
+
+static const PixelLayout layouts[] = {
+    {"RGBA8", 4, 4, 0, false},
+    {"RGB8", 3, 3, 0, false},
+    {"RGB5A1", 2, 2, 0, false},
+    {"RGB565", 2, 2, 0, false},
+    {"RGBA4", 2, 2, 0, false},
+    {"I8", 1, 1, 0, false},
+    {"D16", 2, 2, 0, false},
+    {"D24", 3, 4, 1, false},
+    {"D24S8", 4, 4, 0, true},
+};
+
+static std::vector<u8> RandomData(size_t size, std::mt19937& random) {
+    std::vector<u8> data(size);
+    for (u8& byte : data)
+        byte = static_cast<u8>(random());
+    return data;
+}
+
+static bool CopiesMatch(const PixelLayout& layout, u32 width, u32 height, bool morton_to_linear,
+                        std::mt19937& random) {
+    // Partial tiles at the right edge extend past width * height pixels in the Morton layout
+    const size_t morton_size = ((height + 7) / 8 * width + 8 * 8) * 8 * layout.bytes_per_pixel;
+    const size_t linear_size = width * height * layout.linear_bytes_per_pixel;
+    std::vector<u8> morton = RandomData(morton_size, random);
+    std::vector<u8> linear = RandomData(linear_size, random);
+    std::vector<u8> expected_morton = morton;
+    std::vector<u8> expected_linear = linear;
+
+    Reference::MortonCopy(width, height, layout.bytes_per_pixel, layout.linear_bytes_per_pixel,
+                          layout.swap_depth_stencil, expected_morton.data(),
+                          expected_linear.data() + layout.linear_offset, morton_to_linear);
+    MortonCopy(width, height, layout.bytes_per_pixel, layout.linear_bytes_per_pixel,
+               layout.swap_depth_stencil, morton.data(), linear.data() + layout.linear_offset,
+               morton_to_linear);
+    return morton == expected_morton && linear == expected_linear;
+}
+
+TEST_CASE("VideoCore::MortonCopy matches the per-pixel copy", "[video_core]") {
+    std::mt19937 random(42);
+    for (const PixelLayout& layout : layouts) {
+        INFO("Pixel layout " << layout.name);
+        for (bool morton_to_linear : {true, false}) {
+            INFO("Morton to linear: " << morton_to_linear);
+            REQUIRE(CopiesMatch(layout, 8, 8, morton_to_linear, random));
+            REQUIRE(CopiesMatch(layout, 64, 32, morton_to_linear, random));
+            REQUIRE(CopiesMatch(layout, 400, 240, morton_to_linear, random));
+            // Sizes which aren't a multiple of the tile size
+            REQUIRE(CopiesMatch(layout, 20, 12, morton_to_linear, random));
+        }
+    }
+}
+
+TEST_CASE("VideoCore::MortonCopy benchmark", "[.][benchmark]") {
+    std::mt19937 random(42);
+    const u32 width = 400;
+    const u32 height = 240;
+    const int iterations = 200;
+
+    using CopyFunction = void (*)(u32, u32, u32, u32, bool, u8*, u8*, bool);
+    for (const PixelLayout& layout : layouts) {
+        std::vector<u8> morton = RandomData(width * height * layout.bytes_per_pixel, random);
+        std::vector<u8> linear =
+            RandomData(width * height * layout.linear_bytes_per_pixel, random);
+
+        const auto measure = [&](CopyFunction copy, bool morton_to_linear) {
+            return Benchmark::Measure(iterations, [&] {
+                copy(width, height, layout.bytes_per_pixel, layout.linear_bytes_per_pixel,
+                     layout.swap_depth_stencil, morton.data(),
+                     linear.data() + layout.linear_offset, morton_to_linear);
+            });
+        };
+
+        for (bool morton_to_linear : {true, false}) {
+            const std::string name = "MortonCopy " + std::to_string(width) + "x" +
+                                     std::to_string(height) + " " + layout.name +
+                                     (morton_to_linear ? " load" : " flush");
+            Benchmark::Report(name.c_str(), "per-pixel",
+                              measure(Reference::MortonCopy, morton_to_linear), "tiled",
+                              measure(MortonCopy, morton_to_linear));
+        }
+        REQUIRE(CopiesMatch(layout, width, height, true, random));
+    }
+}
+
+} // namespace VideoCore
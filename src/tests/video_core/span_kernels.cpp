@@ -0,0 +1,297 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+#include <catch.hpp>
+#include "common/common_types.h"
+#include "video_core/regs_framebuffer.h"
+#include "video_core/regs_texturing.h"
+#include "video_core/swrasterizer/span_kernels.h"
+
+#ifdef ARCHITECTURE_x86_64
+#include "common/x64/cpu_detect.h"
+#endif
+
+namespace Pica {
+namespace Rasterizer {
+
+using Operation = TexturingRegs::TevStageConfig::Operation;
+using BlendEquation = FramebufferRegs::BlendEquation;
+using BlendFactor = FramebufferRegs::BlendFactor;
+
+struct KernelSet {
+    const char* name;
+    const SpanKernels& kernels;
+};
+
+/// Returns the optimized span kernels supported by the host CPU
+static std::vector<KernelSet> GetOptimizedKernels() {
+    std::vector<KernelSet> sets;
+#ifdef ARCHITECTURE_x86_64
+    const auto& caps = Common::GetCPUCaps();
+    if (caps.sse4_1)
+        sets.push_back({"SSE4.1", GetSSE41SpanKernels()});
+    if (caps.avx2)
+        sets.push_back({"AVX2", GetAVX2SpanKernels()});
+#endif
+    return sets;
+}
+
+struct Span {
+    alignas(32) std::array<u16, SPAN_SIZE> values;
+};
+
+/// Random channel values, a quarter of them being 0 and another quarter 255 to hit saturation
+static Span RandomSpan(std::mt19937& random) {
+    Span span;
+    for (u16& value : span.values) {
+        switch (random() % 4) {
+        case 0:
+            value = 0;
+            break;
+        case 1:
+            value = 255;
+            break;
+        default:
+            value = static_cast<u16>(random() % 256);
+            break;
+        }
+    }
+    return span;
+}
+
+TEST_CASE("Span kernels match the generic ones", "[video_core]") {
+    const SpanKernels& generic = GetGenericSpanKernels();
+    std::mt19937 random(42);
+
+    for (const KernelSet& set : GetOptimizedKernels()) {
+        INFO("Kernels " << set.name);
+        const SpanKernels& kernels = set.kernels;
+
+        for (int iteration = 0; iteration < 1000; ++iteration) {
+            const Span a = RandomSpan(random);
+            const Span b = RandomSpan(random);
+            const Span c = RandomSpan(random);
+            Span expected, result;
+
+            generic.invert(expected.values.data(), a.values.data());
+            kernels.invert(result.values.data(), a.values.data());
+            REQUIRE(result.values == expected.values);
+
+            generic.min(expected.values.data(), a.values.data(), b.values.data());
+            kernels.min(result.values.data(), a.values.data(), b.values.data());
+            REQUIRE(result.values == expected.values);
+
+            for (Operation op :
+                 {Operation::Replace, Operation::Modulate, Operation::Add, Operation::AddSigned,
+                  Operation::Lerp, Operation::Subtract, Operation::MultiplyThenAdd,
+                  Operation::AddThenMultiply}) {
+                INFO("Combiner operation " << static_cast<u32>(op));
+                generic.combine(op, expected.values.data(), a.values.data(), b.values.data(),
+                                c.values.data());
+                kernels.combine(op, result.values.data(), a.values.data(), b.values.data(),
+                                c.values.data());
+                REQUIRE(result.values == expected.values);
+            }
+
+            const Span in0[3] = {a, RandomSpan(random), RandomSpan(random)};
+            const Span in1[3] = {b, RandomSpan(random), RandomSpan(random)};
+            const u16* const in0_channels[3] = {in0[0].values.data(), in0[1].values.data(),
+                                                in0[2].values.data()};
+            const u16* const in1_channels[3] = {in1[0].values.data(), in1[1].values.data(),
+                                                in1[2].values.data()};
+            generic.dot3(expected.values.data(), in0_channels, in1_channels);
+            kernels.dot3(result.values.data(), in0_channels, in1_channels);
+            REQUIRE(result.values == expected.values);
+
+            for (unsigned multiplier : {1, 2, 4}) {
+                INFO("Multiplier " << multiplier);
+                generic.scale(expected.values.data(), a.values.data(), multiplier);
+                kernels.scale(result.values.data(), a.values.data(), multiplier);
+                REQUIRE(result.values == expected.values);
+            }
+
+            alignas(32) std::array<float, SPAN_SIZE> fog_factors;
+            for (float& factor : fog_factors) {
+                const unsigned pick = random() % 4;
+                factor = pick == 0 ? 0.0f
+                                   : pick == 1 ? 1.0f
+                                               : std::uniform_real_distribution<float>()(random);
+            }
+            for (u16 fog_color : {u16(0), u16(255), c.values[0]}) {
+                INFO("Fog color " << fog_color);
+                expected = a;
+                result = a;
+                generic.fog(expected.values.data(), fog_factors.data(), fog_color);
+                kernels.fog(result.values.data(), fog_factors.data(), fog_color);
+                REQUIRE(result.values == expected.values);
+            }
+        }
+    }
+}
+
+/**
+ * Returns the values of a blend factor for one color channel, computed from the channel and the
+ * alpha of the source, destination and constant colors like the pixel pipeline does
+ */
+static Span BlendFactorSpan(BlendFactor factor, const Span& src, const Span& src_alpha,
+                            const Span& dest, const Span& dest_alpha, u16 constant,
+                            u16 constant_alpha) {
+    Span span;
+    for (size_t i = 0; i < SPAN_SIZE; ++i) {
+        u16& value = span.values[i];
+        switch (factor) {
+        case BlendFactor::Zero:
+            value = 0;
+            break;
+        case BlendFactor::One:
+            value = 255;
+            break;
+        case BlendFactor::SourceColor:
+            value = src.values[i];
+            break;
+        case BlendFactor::OneMinusSourceColor:
+            value = 255 - src.values[i];
+            break;
+        case BlendFactor::DestColor:
+            value = dest.values[i];
+            break;
+        case BlendFactor::OneMinusDestColor:
+            value = 255 - dest.values[i];
+            break;
+        case BlendFactor::SourceAlpha:
+            value = src_alpha.values[i];
+            break;
+        case BlendFactor::OneMinusSourceAlpha:
+            value = 255 - src_alpha.values[i];
+            break;
+        case BlendFactor::DestAlpha:
+            value = dest_alpha.values[i];
+            break;
+        case BlendFactor::OneMinusDestAlpha:
+            value = 255 - dest_alpha.values[i];
+            break;
+        case BlendFactor::ConstantColor:
+            value = constant;
+            break;
+        case BlendFactor::OneMinusConstantColor:
+            value = 255 - constant;
+            break;
+        case BlendFactor::ConstantAlpha:
+            value = constant_alpha;
+            break;
+        case BlendFactor::OneMinusConstantAlpha:
+            value = 255 - constant_alpha;
+            break;
+        case BlendFactor::SourceAlphaSaturate:
+            value = std::min<u16>(src_alpha.values[i], 255 - dest_alpha.values[i]);
+            break;
+        }
+    }
+    return span;
+}
+
+TEST_CASE("Span blend kernels match the generic one for all blend factors", "[video_core]") {
+    const SpanKernels& generic = GetGenericSpanKernels();
+    std::mt19937 random(42);
+
+    for (const KernelSet& set : GetOptimizedKernels()) {
+        INFO("Kernels " << set.name);
+        for (int iteration = 0; iteration < 20; ++iteration) {
+            const Span src = RandomSpan(random);
+            const Span src_alpha = RandomSpan(random);
+            const Span dest = RandomSpan(random);
+            const Span dest_alpha = RandomSpan(random);
+            const u16 constant = static_cast<u16>(random() % 256);
+            const u16 constant_alpha = static_cast<u16>(random() % 256);
+
+            for (u32 src_factor = 0; src_factor <= 14; ++src_factor) {
+                const Span src_factors =
+                    BlendFactorSpan(static_cast<BlendFactor>(src_factor), src, src_alpha, dest,
+                                    dest_alpha, constant, constant_alpha);
+                for (u32 dest_factor = 0; dest_factor <= 14; ++dest_factor) {
+                    const Span dest_factors =
+                        BlendFactorSpan(static_cast<BlendFactor>(dest_factor), src, src_alpha,
+                                        dest, dest_alpha, constant, constant_alpha);
+                    for (BlendEquation equation :
+                         {BlendEquation::Add, BlendEquation::Subtract,
+                          BlendEquation::ReverseSubtract, BlendEquation::Min,
+                          BlendEquation::Max}) {
+                        INFO("Factors " << src_factor << ", " << dest_factor << ", equation "
+                                        << static_cast<u32>(equation));
+                        Span expected, result;
+                        generic.blend(equation, expected.values.data(), src.values.data(),
+                                      src_factors.values.data(), dest.values.data(),
+                                      dest_factors.values.data());
+                        set.kernels.blend(equation, result.values.data(), src.values.data(),
+                                          src_factors.values.data(), dest.values.data(),
+                                          dest_factors.values.data());
+                        REQUIRE(result.values == expected.values);
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Span kernels handle partial spans", "[video_core]") {
+    // The rasterizer shades spans of fewer than SPAN_SIZE fragments with whatever the unused
+    // lanes contain, which must not affect the used ones
+    const SpanKernels& generic = GetGenericSpanKernels();
+    std::mt19937 random(42);
+
+    for (const KernelSet& set : GetOptimizedKernels()) {
+        INFO("Kernels " << set.name);
+        for (size_t count = 1; count < SPAN_SIZE; ++count) {
+            INFO("Fragment count " << count);
+            const Span a = RandomSpan(random);
+            const Span b = RandomSpan(random);
+            const Span c = RandomSpan(random);
+
+            // Unused lanes of the spans given to the optimized kernels hold arbitrary values
+            Span a_padded = a, b_padded = b, c_padded = c;
+            for (size_t i = count; i < SPAN_SIZE; ++i) {
+                a_padded.values[i] = static_cast<u16>(random());
+                b_padded.values[i] = static_cast<u16>(random());
+                c_padded.values[i] = static_cast<u16>(random());
+            }
+
+            const auto used_lanes_match = [count](const Span& result, const Span& expected) {
+                return std::equal(result.values.begin(), result.values.begin() + count,
+                                  expected.values.begin());
+            };
+
+            Span expected, result;
+            for (Operation op :
+                 {Operation::Replace, Operation::Modulate, Operation::Add, Operation::AddSigned,
+                  Operation::Lerp, Operation::Subtract, Operation::MultiplyThenAdd,
+                  Operation::AddThenMultiply}) {
+                INFO("Combiner operation " << static_cast<u32>(op));
+                generic.combine(op, expected.values.data(), a.values.data(), b.values.data(),
+                                c.values.data());
+                set.kernels.combine(op, result.values.data(), a_padded.values.data(),
+                                    b_padded.values.data(), c_padded.values.data());
+                REQUIRE(used_lanes_match(result, expected));
+            }
+
+            for (BlendEquation equation :
+                 {BlendEquation::Add, BlendEquation::Subtract, BlendEquation::ReverseSubtract,
+                  BlendEquation::Min, BlendEquation::Max}) {
+                INFO("Blend equation " << static_cast<u32>(equation));
+                generic.blend(equation, expected.values.data(), a.values.data(),
+                              b.values.data(), c.values.data(), a.values.data());
+                set.kernels.blend(equation, result.values.data(), a_padded.values.data(),
+                                  b_padded.values.data(), c_padded.values.data(),
+                                  a_padded.values.data());
+                REQUIRE(used_lanes_match(result, expected));
+            }
+        }
+    }
+}
+
+} // namespace Rasterizer
+} // namespace Pica
@@ -0,0 +1,126 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <random>
+#include <vector>
+#include <catch.hpp>
+#include "common/common_types.h"
+#include "common/vector_math.h"
+#include "video_core/regs_texturing.h"
+#include "video_core/texture/etc1.h"
+#include "video_core/texture/texture_decode.h"
+
+namespace Pica {
+namespace Texture {
+
+using TextureFormat = TexturingRegs::TextureFormat;
+
+static const TextureFormat formats[] = {
+    TextureFormat::RGBA8, TextureFormat::RGB8, TextureFormat::RGB5A1, TextureFormat::RGB565,
+    TextureFormat::RGBA4, TextureFormat::IA8,  TextureFormat::RG8,    TextureFormat::I8,
+    TextureFormat::A8,    TextureFormat::IA4,  TextureFormat::I4,     TextureFormat::A4,
+    TextureFormat::ETC1,  TextureFormat::ETC1A4,
+};
+
+static std::vector<u8> RandomData(size_t size, std::mt19937& random) {
+    std::vector<u8> data(size);
+    for (u8& byte : data)
+        byte = static_cast<u8>(random());
+    return data;
+}
+
+static bool TexelsMatch(const Math::Vec4<u8>& a, const Math::Vec4<u8>& b) {
+    return a.r() == b.r() && a.g() == b.g() && a.b() == b.b() && a.a() == b.a();
+}
+
+/**
+ * Returns the texel LookupTexelInTile gives with disable_alpha set, from the one it gives without.
+ * Formats with an alpha but no color channel show it as the color, and intensity formats with an
+ * alpha show it in the green channel.
+ */
+static Math::Vec4<u8> DisableAlpha(TextureFormat format, const Math::Vec4<u8>& texel) {
+    switch (format) {
+    case TextureFormat::IA8:
+    case TextureFormat::IA4:
+        return {texel.r(), texel.a(), 0, 255};
+    case TextureFormat::A8:
+    case TextureFormat::A4:
+        return {texel.a(), texel.a(), texel.a(), 255};
+    default:
+        return {texel.r(), texel.g(), texel.b(), 255};
+    }
+}
+
+/**
+ * Decodes a texture of random data with DecodeTexture and checks every texel against
+ * LookupTexelInTile, with and without disable_alpha.
+ */
+static bool DecodesMatch(TextureFormat format, unsigned int width, unsigned int height,
+                         bool flip_vertically, std::mt19937& random) {
+    TextureInfo info;
+    info.physical_address = 0;
+    info.width = width;
+    info.height = height;
+    info.format = format;
+    // Partial tiles at the right edge are stored whole
+    const size_t tile_size = CalculateTileSize(format);
+    info.stride = tile_size * ((width + 7) / 8);
+
+    const std::vector<u8> source = RandomData(info.stride * ((height + 7) / 8), random);
+    std::vector<Math::Vec4<u8>> decoded(width * height);
+    DecodeTexture(source.data(), info, decoded.data(), flip_vertically);
+
+    for (unsigned int y = 0; y < height; ++y) {
+        for (unsigned int x = 0; x < width; ++x) {
+            const u8* tile = source.data() + (y / 8) * info.stride + (x / 8) * tile_size;
+            const unsigned int line = flip_vertically ? height - 1 - y : y;
+            const Math::Vec4<u8>& texel = decoded[line * width + x];
+            if (!TexelsMatch(texel, LookupTexelInTile(tile, x % 8, y % 8, info, false)))
+                return false;
+            if (!TexelsMatch(DisableAlpha(format, texel),
+                             LookupTexelInTile(tile, x % 8, y % 8, info, true)))
+                return false;
+        }
+    }
+    return true;
+}
+
+TEST_CASE("DecodeTexture matches LookupTexelInTile", "[video_core]") {
+    std::mt19937 random(42);
+    for (TextureFormat format : formats) {
+        INFO("Texture format " << static_cast<u32>(format));
+        for (bool flip_vertically : {false, true}) {
+            INFO("Flip vertically: " << flip_vertically);
+            REQUIRE(DecodesMatch(format, 8, 8, flip_vertically, random));
+            REQUIRE(DecodesMatch(format, 64, 32, flip_vertically, random));
+            // Sizes which aren't a multiple of the tile size
+            REQUIRE(DecodesMatch(format, 20, 12, flip_vertically, random));
+            REQUIRE(DecodesMatch(format, 5, 3, flip_vertically, random));
+            REQUIRE(DecodesMatch(format, 13, 27, flip_vertically, random));
+        }
+    }
+}
+
+TEST_CASE("DecodeETC1Subtile matches SampleETC1Subtile", "[video_core]") {
+    std::mt19937_64 random(42);
+    for (int i = 0; i < 10000; ++i) {
+        const u64 value = random();
+        // Padded lines check that the stride is respected
+        const ptrdiff_t stride = 6;
+        std::vector<Math::Vec4<u8>> decoded(4 * stride, Math::Vec4<u8>{1, 2, 3, 4});
+        DecodeETC1Subtile(value, decoded.data(), stride);
+
+        for (unsigned int y = 0; y < 4; ++y) {
+            for (unsigned int x = 0; x < stride; ++x) {
+                const Math::Vec4<u8> expected =
+                    x < 4 ? Math::MakeVec(SampleETC1Subtile(value, x, y), u8(255))
+                          : Math::Vec4<u8>{1, 2, 3, 4};
+                REQUIRE(TexelsMatch(decoded[y * stride + x], expected));
+            }
+        }
+    }
+}
+
+} // namespace Texture
+} // namespace Pica
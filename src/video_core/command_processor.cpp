@@ -2,14 +2,18 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
+#include <limits>
 #include <memory>
 #include <utility>
 #include "common/assert.h"
+#include "common/chunk_file.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
 #include "common/vector_math.h"
+#include "core/core.h"
 #include "core/hle/service/gsp_gpu.h"
 #include "core/hw/gpu.h"
 #include "core/memory.h"
@@ -298,6 +302,13 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
     // It seems like these trigger vertex rendering
     case PICA_REG_INDEX(pipeline.trigger_draw):
     case PICA_REG_INDEX(pipeline.trigger_draw_indexed): {
+        // Skipped frames aren't presented, so their draws to the buffers which are transferred to
+        // the screens are dropped. Draws to other buffers, like render-to-texture targets and
+        // shadow maps, still run as the application can sample or read back what they render.
+        if (Core::System::GetInstance().frame_limiter.IsFrameSkipped() &&
+            GPU::IsScreenSource(regs.framebuffer.framebuffer.GetColorBufferPhysicalAddress()))
+            break;
+
         MICROPROFILE_SCOPE(GPU_Drawing);
 
 #if PICA_LOG_TEV
@@ -338,80 +349,118 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
 
         DebugUtils::MemoryAccessTracker memory_accesses;
 
-        // Simple circular-replacement vertex cache
-        // The size has been tuned for optimal balance between hit-rate and the cost of lookup
-        const size_t VERTEX_CACHE_SIZE = 32;
-        std::array<u16, VERTEX_CACHE_SIZE> vertex_cache_ids;
-        std::array<Shader::OutputVertex, VERTEX_CACHE_SIZE> vertex_cache;
-        Shader::OutputVertex output_vertex;
-
-        unsigned int vertex_cache_pos = 0;
-        vertex_cache_ids.fill(-1);
-
         auto* shader_engine = Shader::GetEngine();
-        Shader::UnitState shader_unit;
 
         shader_engine->SetupBatch(g_state.vs, regs.vs.main_offset);
 
-        for (unsigned int index = 0; index < regs.pipeline.num_vertices; ++index) {
+        const unsigned int num_vertices = regs.pipeline.num_vertices;
+        auto GetVertex = [&](unsigned int index) -> unsigned int {
             // Indexed rendering doesn't use the start offset
-            unsigned int vertex =
-                is_indexed ? (index_u16 ? index_address_16[index] : index_address_8[index])
-                           : (index + regs.pipeline.vertex_offset);
+            return is_indexed ? (index_u16 ? index_address_16[index] : index_address_8[index])
+                              : (index + regs.pipeline.vertex_offset);
+        };
+
+        // Each vertex referenced by the draw gets shaded exactly once
+        auto& unique_vertices = g_state.draw.unique_vertices;
+        auto& shaded_vertices = g_state.draw.shaded_vertices;
+        // Position in unique_vertices of each vertex id in [min_vertex, max_vertex], or -1
+        auto& vertex_slots = g_state.draw.vertex_slots;
+        unsigned int min_vertex = 0;
+
+        unique_vertices.clear();
+
+        if (is_indexed) {
+            // Pre-scan the index buffer for the range of referenced vertices, which allows
+            // deduplicating them with a directly indexed table
+            unsigned int max_vertex = 0;
+            min_vertex = std::numeric_limits<unsigned int>::max();
+            for (unsigned int index = 0; index < num_vertices; ++index) {
+                const unsigned int vertex = GetVertex(index);
+                min_vertex = std::min(min_vertex, vertex);
+                max_vertex = std::max(max_vertex, vertex);
 
-            // -1 is a common special value used for primitive restart. Since it's unknown if
-            // the PICA supports it, and it would mess up the caching, guard against it here.
-            ASSERT(vertex != -1);
-
-            bool vertex_cache_hit = false;
-
-            if (is_indexed) {
                 if (g_debug_context && Pica::g_debug_context->recorder) {
                     int size = index_u16 ? 2 : 1;
                     memory_accesses.AddAccess(base_address + index_info.offset + size * index,
                                               size);
                 }
+            }
 
-                for (unsigned int i = 0; i < VERTEX_CACHE_SIZE; ++i) {
-                    if (vertex == vertex_cache_ids[i]) {
-                        output_vertex = vertex_cache[i];
-                        vertex_cache_hit = true;
-                        break;
-                    }
+            if (num_vertices != 0)
+                vertex_slots.assign(max_vertex - min_vertex + 1, -1);
+
+            for (unsigned int index = 0; index < num_vertices; ++index) {
+                const unsigned int vertex = GetVertex(index);
+                int& slot = vertex_slots[vertex - min_vertex];
+                if (slot == -1) {
+                    slot = static_cast<int>(unique_vertices.size());
+                    unique_vertices.push_back({index, vertex});
                 }
             }
+        } else {
+            for (unsigned int index = 0; index < num_vertices; ++index) {
+                const unsigned int vertex = GetVertex(index);
+
+                // -1 is a common special value used for primitive restart. Since it's unknown if
+                // the PICA supports it, guard against it here.
+                ASSERT(vertex != -1);
+
+                unique_vertices.push_back({index, vertex});
+            }
+        }
+
+        MICROPROFILE_META_CPU("Shaded vertices", static_cast<int>(unique_vertices.size()));
+        MICROPROFILE_META_CPU("Reused vertices",
+                              static_cast<int>(num_vertices - unique_vertices.size()));
+
+        // Vertices are shaded in batches so that the shader engine can amortize the cost of an
+        // invocation over multiple vertices
+        const size_t VERTEX_BATCH_SIZE = 32;
+        std::array<Shader::UnitState, VERTEX_BATCH_SIZE> shader_units;
+        shaded_vertices.resize(unique_vertices.size());
+
+        for (size_t batch_start = 0; batch_start < unique_vertices.size();
+             batch_start += VERTEX_BATCH_SIZE) {
+            const size_t batch_size =
+                std::min(VERTEX_BATCH_SIZE, unique_vertices.size() - batch_start);
+
+            for (size_t i = 0; i < batch_size; ++i) {
+                const auto& unique_vertex = unique_vertices[batch_start + i];
 
-            if (!vertex_cache_hit) {
                 // Initialize data for the current vertex
-                Shader::AttributeBuffer input, output{};
-                loader.LoadVertex(base_address, index, vertex, input, memory_accesses);
+                Shader::AttributeBuffer input;
+                loader.LoadVertex(base_address, unique_vertex.index, unique_vertex.vertex, input,
+                                  memory_accesses);
 
                 // Send to vertex shader
                 if (g_debug_context)
                     g_debug_context->OnEvent(DebugContext::Event::VertexShaderInvocation,
                                              (void*)&input);
-                shader_unit.LoadInput(regs.vs, input);
-                shader_engine->Run(g_state.vs, shader_unit);
-                shader_unit.WriteOutput(regs.vs, output);
+                shader_units[i].LoadInput(regs.vs, input);
+            }
 
-                // Retrieve vertex from register data
-                output_vertex = Shader::OutputVertex::FromAttributeBuffer(regs.rasterizer, output);
+            shader_engine->RunBatch(g_state.vs, shader_units.data(), batch_size);
 
-                if (is_indexed) {
-                    vertex_cache[vertex_cache_pos] = output_vertex;
-                    vertex_cache_ids[vertex_cache_pos] = vertex;
-                    vertex_cache_pos = (vertex_cache_pos + 1) % VERTEX_CACHE_SIZE;
-                }
+            for (size_t i = 0; i < batch_size; ++i) {
+                // Retrieve vertex from register data
+                Shader::AttributeBuffer output{};
+                shader_units[i].WriteOutput(regs.vs, output);
+                shaded_vertices[batch_start + i] =
+                    Shader::OutputVertex::FromAttributeBuffer(regs.rasterizer, output);
             }
+        }
 
-            // Send to renderer
-            using Pica::Shader::OutputVertex;
-            auto AddTriangle = [](const OutputVertex& v0, const OutputVertex& v1,
-                                  const OutputVertex& v2) {
-                VideoCore::g_renderer->Rasterizer()->AddTriangle(v0, v1, v2);
-            };
-
-            primitive_assembler.SubmitVertex(output_vertex, AddTriangle);
+        // Send to renderer
+        using Pica::Shader::OutputVertex;
+        auto AddTriangle = [](const OutputVertex& v0, const OutputVertex& v1,
+                              const OutputVertex& v2) {
+            VideoCore::g_renderer->Rasterizer()->AddTriangle(v0, v1, v2);
+        };
+
+        for (unsigned int index = 0; index < num_vertices; ++index) {
+            const unsigned int slot =
+                is_indexed ? vertex_slots[GetVertex(index) - min_vertex] : index;
+            primitive_assembler.SubmitVertex(shaded_vertices[slot], AddTriangle);
         }
 
         for (auto& range : memory_accesses.ranges) {
@@ -620,6 +669,15 @@ void ProcessCommandList(const u32* list, u32 size) {
     }
 }
 
+void DoState(PointerWrap& p) {
+    p.Do(vs_float_regs_counter);
+    p.DoArray(vs_uniform_write_buffer, 4);
+    p.Do(gs_float_regs_counter);
+    p.DoArray(gs_uniform_write_buffer, 4);
+    p.Do(default_attr_counter);
+    p.DoArray(default_attr_write_buffer, 3);
+}
+
 } // namespace
 
 } // namespace
@@ -8,6 +8,8 @@
 #include "common/bit_field.h"
 #include "common/common_types.h"
 
+class PointerWrap;
+
 namespace Pica {
 
 namespace CommandProcessor {
@@ -36,6 +38,9 @@ static_assert(sizeof(CommandHeader) == sizeof(u32), "CommandHeader has incorrect
 
 void ProcessCommandList(const u32* list, u32 size);
 
+/// Serializes partially written uniforms and default attributes for save states
+void DoState(PointerWrap& p);
+
 } // namespace
 
 } // namespace
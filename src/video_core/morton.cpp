@@ -0,0 +1,223 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstddef>
+#include <cstring>
+#include "common/assert.h"
+#include "common/common_funcs.h"
+#include "video_core/morton.h"
+#include "video_core/utils.h"
+
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
+
+namespace VideoCore {
+
+namespace {
+
+/**
+ * Copies an 8x8 tile. linear_tile points to the first pixel of the tile's first line, following
+ * lines are linear_stride bytes apart.
+ */
+using TileFunction = void (*)(u8* morton_tile, u8* linear_tile, ptrdiff_t linear_stride,
+                              u32 linear_bytes_per_pixel);
+
+template <u32 bytes_per_pixel, bool swap_depth_stencil, bool morton_to_linear>
+FORCE_INLINE void CopyPixel(u8* morton_pixel, u8* linear_pixel) {
+    if (swap_depth_stencil) {
+        u32 value;
+        std::memcpy(&value, morton_to_linear ? morton_pixel : linear_pixel, sizeof(u32));
+        value = morton_to_linear ? (value << 8) | (value >> 24) : (value << 24) | (value >> 8);
+        std::memcpy(morton_to_linear ? linear_pixel : morton_pixel, &value, sizeof(u32));
+    } else if (morton_to_linear) {
+        std::memcpy(linear_pixel, morton_pixel, bytes_per_pixel);
+    } else {
+        std::memcpy(morton_pixel, linear_pixel, bytes_per_pixel);
+    }
+}
+
+template <u32 bytes_per_pixel, bool swap_depth_stencil, bool morton_to_linear>
+void CopyTile(u8* morton_tile, u8* linear_tile, ptrdiff_t linear_stride,
+              u32 linear_bytes_per_pixel) {
+    for (u32 y = 0; y < 8; ++y) {
+        u8* linear_line = linear_tile + y * linear_stride;
+        for (u32 x = 0; x < 8; x += 2) {
+            // Horizontally adjacent pairs of pixels are adjacent in Morton order as well
+            u8* morton_pair = morton_tile + MortonInterleave(x, y) * bytes_per_pixel;
+            u8* linear_pair = linear_line + x * linear_bytes_per_pixel;
+            if (linear_bytes_per_pixel == bytes_per_pixel && !swap_depth_stencil) {
+                if (morton_to_linear) {
+                    std::memcpy(linear_pair, morton_pair, 2 * bytes_per_pixel);
+                } else {
+                    std::memcpy(morton_pair, linear_pair, 2 * bytes_per_pixel);
+                }
+            } else {
+                CopyPixel<bytes_per_pixel, swap_depth_stencil, morton_to_linear>(morton_pair,
+                                                                                 linear_pair);
+                CopyPixel<bytes_per_pixel, swap_depth_stencil, morton_to_linear>(
+                    morton_pair + bytes_per_pixel, linear_pair + linear_bytes_per_pixel);
+            }
+        }
+    }
+}
+
+#ifdef ARCHITECTURE_x86_64
+
+// The SSE2 versions copy two lines of a tile at a time. Each group of four pixels in Morton order
+// is a 2x2 block, and the blocks making up a pair of lines start at pixels 0, 4, 16 and 20 from
+// the first one.
+
+__m128i Load(const u8* source) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+}
+
+void Store(u8* dest, __m128i value) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), value);
+}
+
+template <bool swap_depth_stencil, bool morton_to_linear>
+__m128i ConvertPixels(__m128i value) {
+    if (!swap_depth_stencil)
+        return value;
+    if (morton_to_linear)
+        return _mm_or_si128(_mm_slli_epi32(value, 8), _mm_srli_epi32(value, 24));
+    return _mm_or_si128(_mm_slli_epi32(value, 24), _mm_srli_epi32(value, 8));
+}
+
+template <bool swap_depth_stencil, bool morton_to_linear>
+void CopyTile32(u8* morton_tile, u8* linear_tile, ptrdiff_t linear_stride, u32) {
+    const auto convert = ConvertPixels<swap_depth_stencil, morton_to_linear>;
+    for (u32 y = 0; y < 8; y += 2) {
+        u8* blocks = morton_tile + MortonInterleave(0, y) * 4;
+        u8* line0 = linear_tile + y * linear_stride;
+        u8* line1 = line0 + linear_stride;
+        if (morton_to_linear) {
+            const __m128i block0 = convert(Load(blocks));
+            const __m128i block1 = convert(Load(blocks + 4 * 4));
+            const __m128i block2 = convert(Load(blocks + 16 * 4));
+            const __m128i block3 = convert(Load(blocks + 20 * 4));
+            Store(line0, _mm_unpacklo_epi64(block0, block1));
+            Store(line0 + 16, _mm_unpacklo_epi64(block2, block3));
+            Store(line1, _mm_unpackhi_epi64(block0, block1));
+            Store(line1 + 16, _mm_unpackhi_epi64(block2, block3));
+        } else {
+            const __m128i left0 = convert(Load(line0));
+            const __m128i right0 = convert(Load(line0 + 16));
+            const __m128i left1 = convert(Load(line1));
+            const __m128i right1 = convert(Load(line1 + 16));
+            Store(blocks, _mm_unpacklo_epi64(left0, left1));
+            Store(blocks + 4 * 4, _mm_unpackhi_epi64(left0, left1));
+            Store(blocks + 16 * 4, _mm_unpacklo_epi64(right0, right1));
+            Store(blocks + 20 * 4, _mm_unpackhi_epi64(right0, right1));
+        }
+    }
+}
+
+template <bool morton_to_linear>
+void CopyTile16(u8* morton_tile, u8* linear_tile, ptrdiff_t linear_stride, u32) {
+    for (u32 y = 0; y < 8; y += 2) {
+        u8* blocks = morton_tile + MortonInterleave(0, y) * 2;
+        u8* line0 = linear_tile + y * linear_stride;
+        u8* line1 = line0 + linear_stride;
+        if (morton_to_linear) {
+            // Each 32-bit lane holds a pair of pixels, sort them by line
+            const __m128i left = _mm_shuffle_epi32(Load(blocks), _MM_SHUFFLE(3, 1, 2, 0));
+            const __m128i right =
+                _mm_shuffle_epi32(Load(blocks + 16 * 2), _MM_SHUFFLE(3, 1, 2, 0));
+            Store(line0, _mm_unpacklo_epi64(left, right));
+            Store(line1, _mm_unpackhi_epi64(left, right));
+        } else {
+            const __m128i pairs0 = Load(line0);
+            const __m128i pairs1 = Load(line1);
+            Store(blocks, _mm_unpacklo_epi32(pairs0, pairs1));
+            Store(blocks + 16 * 2, _mm_unpackhi_epi32(pairs0, pairs1));
+        }
+    }
+}
+
+#endif
+
+template <u32 bytes_per_pixel, bool swap_depth_stencil, bool morton_to_linear>
+void CopyImage(u32 width, u32 height, u32 linear_bytes_per_pixel, u8* morton_data,
+               u8* linear_data) {
+    if (width % 8 != 0 || height % 8 != 0) {
+        for (u32 y = 0; y < height; ++y) {
+            for (u32 x = 0; x < width; ++x) {
+                const u32 coarse_y = y & ~7;
+                const u32 morton_offset = GetMortonOffset(x, y, bytes_per_pixel) +
+                                          coarse_y * width * bytes_per_pixel;
+                const u32 linear_offset = (x + (height - 1 - y) * width) * linear_bytes_per_pixel;
+                CopyPixel<bytes_per_pixel, swap_depth_stencil, morton_to_linear>(
+                    morton_data + morton_offset, linear_data + linear_offset);
+            }
+        }
+        return;
+    }
+
+    TileFunction copy_tile = CopyTile<bytes_per_pixel, swap_depth_stencil, morton_to_linear>;
+#ifdef ARCHITECTURE_x86_64
+    if (linear_bytes_per_pixel == bytes_per_pixel) {
+        if (bytes_per_pixel == 4)
+            copy_tile = CopyTile32<swap_depth_stencil, morton_to_linear>;
+        else if (bytes_per_pixel == 2 && !swap_depth_stencil)
+            copy_tile = CopyTile16<morton_to_linear>;
+    }
+#endif
+
+    // Lines are stored bottom to top in the linear layout
+    const ptrdiff_t linear_stride = -static_cast<ptrdiff_t>(width * linear_bytes_per_pixel);
+    for (u32 y = 0; y < height; y += 8) {
+        u8* morton_tile = morton_data + y * width * bytes_per_pixel;
+        u8* linear_tile = linear_data + (height - 1 - y) * width * linear_bytes_per_pixel;
+        for (u32 x = 0; x < width; x += 8) {
+            copy_tile(morton_tile, linear_tile, linear_stride, linear_bytes_per_pixel);
+            morton_tile += 8 * 8 * bytes_per_pixel;
+            linear_tile += 8 * linear_bytes_per_pixel;
+        }
+    }
+}
+
+template <bool morton_to_linear>
+void CopyImage(u32 width, u32 height, u32 bytes_per_pixel, u32 linear_bytes_per_pixel,
+               bool swap_depth_stencil, u8* morton_data, u8* linear_data) {
+    if (swap_depth_stencil) {
+        ASSERT(bytes_per_pixel == 4 && linear_bytes_per_pixel == 4);
+        return CopyImage<4, true, morton_to_linear>(width, height, linear_bytes_per_pixel,
+                                                    morton_data, linear_data);
+    }
+
+    switch (bytes_per_pixel) {
+    case 1:
+        return CopyImage<1, false, morton_to_linear>(width, height, linear_bytes_per_pixel,
+                                                     morton_data, linear_data);
+    case 2:
+        return CopyImage<2, false, morton_to_linear>(width, height, linear_bytes_per_pixel,
+                                                     morton_data, linear_data);
+    case 3:
+        return CopyImage<3, false, morton_to_linear>(width, height, linear_bytes_per_pixel,
+                                                     morton_data, linear_data);
+    case 4:
+        return CopyImage<4, false, morton_to_linear>(width, height, linear_bytes_per_pixel,
+                                                     morton_data, linear_data);
+    default:
+        UNREACHABLE_MSG("Unsupported pixel size %u", bytes_per_pixel);
+    }
+}
+
+} // anonymous namespace
+
+void MortonCopy(u32 width, u32 height, u32 bytes_per_pixel, u32 linear_bytes_per_pixel,
+                bool swap_depth_stencil, u8* morton_data, u8* linear_data, bool morton_to_linear) {
+    ASSERT(linear_bytes_per_pixel >= bytes_per_pixel);
+    if (morton_to_linear) {
+        CopyImage<true>(width, height, bytes_per_pixel, linear_bytes_per_pixel,
+                        swap_depth_stencil, morton_data, linear_data);
+    } else {
+        CopyImage<false>(width, height, bytes_per_pixel, linear_bytes_per_pixel,
+                         swap_depth_stencil, morton_data, linear_data);
+    }
+}
+
+} // namespace VideoCore
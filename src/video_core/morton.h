@@ -0,0 +1,32 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/common_types.h"
+
+namespace VideoCore {
+
+/**
+ * Copies an image between the tiled Morton layout used by the Pica (see GetMortonOffset) and a
+ * linear layout with the lines stored bottom to top, as used by OpenGL.
+ *
+ * Images whose size is a multiple of the 8x8 tiles are copied a whole tile at a time, others
+ * fall back to copying pixel by pixel.
+ *
+ * @param width,height Size of the image in pixels
+ * @param bytes_per_pixel Size of a pixel in the Morton layout, between 1 and 4 bytes
+ * @param linear_bytes_per_pixel Distance between pixels in the linear layout. Only the first
+ *                               bytes_per_pixel bytes of each pixel are accessed.
+ * @param swap_depth_stencil Convert D24S8 values between the Pica order (stencil in the high
+ *                           byte) and the OpenGL order (stencil in the low byte), requires
+ *                           4 bytes per pixel
+ * @param morton_data Image in the Morton layout
+ * @param linear_data Image in the linear layout
+ * @param morton_to_linear Whether to copy from morton_data to linear_data or the other way round
+ */
+void MortonCopy(u32 width, u32 height, u32 bytes_per_pixel, u32 linear_bytes_per_pixel,
+                bool swap_depth_stencil, u8* morton_data, u8* linear_data, bool morton_to_linear);
+
+} // namespace VideoCore
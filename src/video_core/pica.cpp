@@ -3,6 +3,8 @@
 // Refer to the license.txt file included.
 
 #include <cstring>
+#include "common/chunk_file.h"
+#include "video_core/command_processor.h"
 #include "video_core/pica.h"
 #include "video_core/pica_state.h"
 #include "video_core/regs_pipeline.h"
@@ -19,6 +21,15 @@ void Shutdown() {
     Shader::Shutdown();
 }
 
+void DoState(PointerWrap& p) {
+    auto section = p.Section("Pica", 1);
+    if (!section) {
+        return;
+    }
+    g_state.DoState(p);
+    CommandProcessor::DoState(p);
+}
+
 template <typename T>
 void Zero(T& o) {
     memset(&o, 0, sizeof(o));
@@ -32,4 +43,24 @@ void State::Reset() {
     Zero(immediate);
     primitive_assembler.Reconfigure(PipelineRegs::TriangleTopology::List);
 }
+
+static void DoShaderSetup(PointerWrap& p, Shader::ShaderSetup& setup) {
+    // The engine data is set up again before the next shader invocation
+    p.DoVoid(&setup.uniforms, sizeof(setup.uniforms));
+    p.DoArray(setup.program_code.data(), static_cast<int>(setup.program_code.size()));
+    p.DoArray(setup.swizzle_data.data(), static_cast<int>(setup.swizzle_data.size()));
+}
+
+void State::DoState(PointerWrap& p) {
+    p.DoVoid(&regs, sizeof(regs));
+    DoShaderSetup(p, vs);
+    DoShaderSetup(p, gs);
+    p.DoVoid(&input_default_attributes, sizeof(input_default_attributes));
+    p.DoVoid(&proctex, sizeof(proctex));
+    p.DoVoid(&lighting, sizeof(lighting));
+    p.DoVoid(&fog, sizeof(fog));
+    p.DoVoid(&immediate.input_vertex, sizeof(immediate.input_vertex));
+    p.Do(immediate.current_attribute);
+    primitive_assembler.DoState(p);
+}
 }
@@ -5,6 +5,8 @@
 #pragma once
 
 #include "video_core/regs_texturing.h"
+class PointerWrap;
+
 namespace Pica {
 
 /// Initialize Pica state
@@ -13,4 +15,7 @@ void Init();
 /// Shutdown Pica state
 void Shutdown();
 
+/// Serializes the Pica state for save states
+void DoState(PointerWrap& p);
+
 } // namespace
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <array>
+#include <vector>
 #include "common/bit_field.h"
 #include "common/common_types.h"
 #include "common/vector_math.h"
@@ -12,12 +13,18 @@
 #include "video_core/regs.h"
 #include "video_core/shader/shader.h"
 
+class PointerWrap;
+
 namespace Pica {
 
 /// Struct used to describe current Pica state
 struct State {
     void Reset();
 
+    /// Serializes the state for save states. The command list is not included, as save states are
+    /// never made while a command list is processed.
+    void DoState(PointerWrap& p);
+
     /// Pica registers
     Regs regs;
 
@@ -139,6 +146,21 @@ struct State {
         u32 current_attribute = 0;
     } immediate;
 
+    /// Buffers used while processing a draw, kept across draws to avoid reallocating them
+    struct DrawState {
+        struct UniqueVertex {
+            unsigned int index; ///< First position in the draw which uses the vertex
+            unsigned int vertex;
+        };
+        /// Vertices referenced by the draw, each of which gets shaded exactly once
+        std::vector<UniqueVertex> unique_vertices;
+        /// Output of the vertex shader for each of unique_vertices
+        std::vector<Shader::OutputVertex> shaded_vertices;
+        /// Position in unique_vertices of each vertex id in the range referenced by an indexed
+        /// draw, or -1
+        std::vector<int> vertex_slots;
+    } draw;
+
     // This is constructed with a dummy triangle topology
     PrimitiveAssembler<Shader::OutputVertex> primitive_assembler;
 };
@@ -7,6 +7,8 @@
 #include <functional>
 #include "video_core/regs_pipeline.h"
 
+class PointerWrap;
+
 namespace Pica {
 
 /*
@@ -39,6 +41,8 @@ struct PrimitiveAssembler {
      */
     void Reconfigure(PipelineRegs::TriangleTopology topology);
 
+    void DoState(PointerWrap& p);
+
 private:
     PipelineRegs::TriangleTopology topology;
 
@@ -63,5 +63,8 @@ public:
                                    ScreenInfo& screen_info) {
         return false;
     }
+
+    /// Loads the resources which the title with the given program ID has cached on disk
+    virtual void LoadDiskResources(u64 program_id) {}
 };
 }
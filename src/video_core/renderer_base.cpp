@@ -19,5 +19,22 @@ void RendererBase::RefreshRasterizerSetting() {
         } else {
             rasterizer = std::make_unique<VideoCore::SWRasterizer>();
         }
+
+        if (disk_resources_loaded) {
+            rasterizer->LoadDiskResources(program_id);
+        }
+    }
+}
+
+void RendererBase::ResetRasterizer() {
+    rasterizer = nullptr;
+    RefreshRasterizerSetting();
+}
+
+void RendererBase::LoadDiskResources(u64 program_id_) {
+    program_id = program_id_;
+    disk_resources_loaded = true;
+    if (rasterizer != nullptr) {
+        rasterizer->LoadDiskResources(program_id);
     }
 }
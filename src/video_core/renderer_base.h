@@ -49,6 +49,12 @@ public:
 
     void RefreshRasterizerSetting();
 
+    /// Recreates the rasterizer, discarding all state it has cached from emulated memory
+    void ResetRasterizer();
+
+    /// Loads the disk caches of the current title, including in rasterizers created later on
+    void LoadDiskResources(u64 program_id);
+
 protected:
     std::unique_ptr<VideoCore::RasterizerInterface> rasterizer;
     f32 m_current_fps = 0.0f; ///< Current framerate, should be set by the renderer
@@ -56,4 +62,6 @@ protected:
 
 private:
     bool opengl_rasterizer_active = false;
+    bool disk_resources_loaded = false;
+    u64 program_id = 0;
 };
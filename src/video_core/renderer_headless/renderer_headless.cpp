@@ -0,0 +1,47 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/logging/log.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/frontend/emu_window.h"
+#include "core/tracer/recorder.h"
+#include "video_core/debug_utils/debug_utils.h"
+#include "video_core/renderer_headless/renderer_headless.h"
+#include "video_core/video_core.h"
+
+void RendererHeadless::SwapBuffers() {
+    Core::System::GetInstance().perf_stats.EndSystemFrame();
+
+    render_window->PollEvents();
+    if (!Core::System::GetInstance().frame_limiter.IsFrameSkipped()) {
+        render_window->SwapBuffers();
+    }
+
+    Core::System::GetInstance().frame_limiter.DoFrameLimiting(CoreTiming::GetGlobalTimeUs());
+    Core::System::GetInstance().perf_stats.BeginSystemFrame();
+
+    RefreshRasterizerSetting();
+    m_current_frame++;
+
+    if (Pica::g_debug_context && Pica::g_debug_context->recorder) {
+        Pica::g_debug_context->recorder->FrameFinished();
+    }
+}
+
+void RendererHeadless::SetWindow(EmuWindow* window) {
+    render_window = window;
+}
+
+bool RendererHeadless::Init() {
+    if (VideoCore::g_hw_renderer_enabled) {
+        LOG_WARNING(Render, "The headless renderer only supports the software rasterizer");
+        VideoCore::g_hw_renderer_enabled = false;
+    }
+
+    RefreshRasterizerSetting();
+    return true;
+}
+
+void RendererHeadless::ShutDown() {}
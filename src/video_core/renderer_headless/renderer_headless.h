@@ -0,0 +1,37 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "video_core/renderer_base.h"
+
+class EmuWindow;
+
+/**
+ * Renderer which doesn't require a graphics context. Draws are handled by the software rasterizer
+ * and nothing is presented: the window is only notified of each frame through SwapBuffers, and can
+ * read the screens from emulated memory if it needs them. Skipped frames aren't passed to the
+ * window, and their draws to the screens are dropped by the command processor, so frame skipping
+ * limits the rasterization work to the frames the window looks at.
+ */
+class RendererHeadless : public RendererBase {
+public:
+    /// Swap buffers (render frame)
+    void SwapBuffers() override;
+
+    /**
+     * Set the emulator window to use for renderer
+     * @param window EmuWindow handle to emulator window to use for rendering
+     */
+    void SetWindow(EmuWindow* window) override;
+
+    /// Initialize the renderer
+    bool Init() override;
+
+    /// Shutdown the renderer
+    void ShutDown() override;
+
+private:
+    EmuWindow* render_window = nullptr; ///< Handle to render window
+};
@@ -1160,22 +1160,57 @@ void RasterizerOpenGL::SamplerInfo::SyncWithConfig(
     }
 }
 
+void RasterizerOpenGL::LoadDiskResources(u64 program_id) {
+    shader_disk_cache.Open(program_id);
+}
+
+void RasterizerOpenGL::CompileCachedShaders() {
+    auto generated_shaders = shader_disk_cache.TakeGeneratedShaders();
+    if (generated_shaders.empty())
+        return;
+
+    // The programs are only checked once they are used, which lets the driver compile them in the
+    // background in the meantime
+    const std::string vertex_shader = GLShader::GenerateVertexShader();
+    for (const auto& generated : generated_shaders) {
+        if (shader_cache.count(generated.first) != 0)
+            continue;
+
+        auto shader = std::make_unique<PicaShader>();
+        shader->pending = std::make_unique<GLShader::PendingProgram>(GLShader::StartLoadingProgram(
+            vertex_shader.c_str(), generated.second.c_str()));
+        shader_cache.emplace(generated.first, std::move(shader));
+    }
+}
+
 void RasterizerOpenGL::SetShader() {
     auto config = GLShader::PicaShaderConfig::BuildFromRegs(Pica::g_state.regs);
-    std::unique_ptr<PicaShader> shader = std::make_unique<PicaShader>();
+
+    CompileCachedShaders();
 
     // Find (or generate) the GLSL shader for the current TEV state
     auto cached_shader = shader_cache.find(config);
-    if (cached_shader != shader_cache.end()) {
+    if (cached_shader != shader_cache.end() && cached_shader->second->pending == nullptr) {
         current_shader = cached_shader->second.get();
 
         state.draw.shader_program = current_shader->shader.handle;
         state.Apply();
     } else {
-        LOG_DEBUG(Render_OpenGL, "Creating new shader");
+        std::unique_ptr<PicaShader> shader;
+        if (cached_shader != shader_cache.end()) {
+            // Precompiled from the disk cache, only the program's status remains to be checked
+            shader = std::move(cached_shader->second);
+            shader_cache.erase(cached_shader);
+            shader->shader.Create(*shader->pending);
+            shader->pending.reset();
+        } else {
+            LOG_DEBUG(Render_OpenGL, "Creating new shader");
 
-        shader->shader.Create(GLShader::GenerateVertexShader().c_str(),
-                              GLShader::GenerateFragmentShader(config).c_str());
+            shader = std::make_unique<PicaShader>();
+            shader->shader.Create(GLShader::GenerateVertexShader().c_str(),
+                                  GLShader::GenerateFragmentShader(config).c_str());
+            shader_disk_cache.Add(config);
+        }
 
         state.draw.shader_program = shader->shader.handle;
         state.Apply();
@@ -25,7 +25,9 @@
 #include "video_core/regs_texturing.h"
 #include "video_core/renderer_opengl/gl_rasterizer_cache.h"
 #include "video_core/renderer_opengl/gl_resource_manager.h"
+#include "video_core/renderer_opengl/gl_shader_disk_cache.h"
 #include "video_core/renderer_opengl/gl_shader_gen.h"
+#include "video_core/renderer_opengl/gl_shader_util.h"
 #include "video_core/renderer_opengl/gl_state.h"
 #include "video_core/renderer_opengl/pica_to_gl.h"
 #include "video_core/shader/shader.h"
@@ -50,10 +52,23 @@ public:
     bool AccelerateDisplay(const GPU::Regs::FramebufferConfig& config, PAddr framebuffer_addr,
                            u32 pixel_stride, ScreenInfo& screen_info) override;
 
+    void LoadDiskResources(u64 program_id) override;
+
     /// OpenGL shader generated for a given Pica register state
     struct PicaShader {
+        ~PicaShader() {
+            // A program that was never used hasn't been handed over to the shader resource yet
+            if (pending) {
+                glDeleteShader(pending->vertex_shader_id);
+                glDeleteShader(pending->fragment_shader_id);
+                glDeleteProgram(pending->program_id);
+            }
+        }
+
         /// OpenGL shader resource
         OGLShader shader;
+        /// Program being compiled, set until the shader is first used
+        std::unique_ptr<GLShader::PendingProgram> pending;
     };
 
 private:
@@ -162,6 +177,9 @@ private:
     /// Sets the OpenGL shader in accordance with the current PICA register state
     void SetShader();
 
+    /// Starts compiling the shaders generated from the disk cache which aren't cached yet
+    void CompileCachedShaders();
+
     /// Syncs the cull mode to match the PICA register
     void SyncCullMode();
 
@@ -259,6 +277,7 @@ private:
 
     std::unordered_map<GLShader::PicaShaderConfig, std::unique_ptr<PicaShader>> shader_cache;
     const PicaShader* current_shader = nullptr;
+    GLShader::ShaderDiskCache shader_disk_cache;
     bool shader_dirty;
 
     struct {
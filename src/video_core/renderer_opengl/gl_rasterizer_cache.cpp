@@ -18,11 +18,11 @@
 #include "core/frontend/emu_window.h"
 #include "core/memory.h"
 #include "core/settings.h"
+#include "video_core/morton.h"
 #include "video_core/pica_state.h"
 #include "video_core/renderer_opengl/gl_rasterizer_cache.h"
 #include "video_core/renderer_opengl/gl_state.h"
 #include "video_core/texture/texture_decode.h"
-#include "video_core/utils.h"
 #include "video_core/video_core.h"
 
 struct FormatTuple {
@@ -58,50 +58,10 @@ RasterizerCacheOpenGL::~RasterizerCacheOpenGL() {
 static void MortonCopyPixels(CachedSurface::PixelFormat pixel_format, u32 width, u32 height,
                              u32 bytes_per_pixel, u32 gl_bytes_per_pixel, u8* morton_data,
                              u8* gl_data, bool morton_to_gl) {
-    using PixelFormat = CachedSurface::PixelFormat;
-
-    u8* data_ptrs[2];
-    u32 depth_stencil_shifts[2] = {24, 8};
-
-    if (morton_to_gl) {
-        std::swap(depth_stencil_shifts[0], depth_stencil_shifts[1]);
-    }
-
-    if (pixel_format == PixelFormat::D24S8) {
-        for (unsigned y = 0; y < height; ++y) {
-            for (unsigned x = 0; x < width; ++x) {
-                const u32 coarse_y = y & ~7;
-                u32 morton_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) +
-                                    coarse_y * width * bytes_per_pixel;
-                u32 gl_pixel_index = (x + (height - 1 - y) * width) * gl_bytes_per_pixel;
-
-                data_ptrs[morton_to_gl] = morton_data + morton_offset;
-                data_ptrs[!morton_to_gl] = &gl_data[gl_pixel_index];
-
-                // Swap depth and stencil value ordering since 3DS does not match OpenGL
-                u32 depth_stencil;
-                memcpy(&depth_stencil, data_ptrs[1], sizeof(u32));
-                depth_stencil = (depth_stencil << depth_stencil_shifts[0]) |
-                                (depth_stencil >> depth_stencil_shifts[1]);
-
-                memcpy(data_ptrs[0], &depth_stencil, sizeof(u32));
-            }
-        }
-    } else {
-        for (unsigned y = 0; y < height; ++y) {
-            for (unsigned x = 0; x < width; ++x) {
-                const u32 coarse_y = y & ~7;
-                u32 morton_offset = VideoCore::GetMortonOffset(x, y, bytes_per_pixel) +
-                                    coarse_y * width * bytes_per_pixel;
-                u32 gl_pixel_index = (x + (height - 1 - y) * width) * gl_bytes_per_pixel;
-
-                data_ptrs[morton_to_gl] = morton_data + morton_offset;
-                data_ptrs[!morton_to_gl] = &gl_data[gl_pixel_index];
-
-                memcpy(data_ptrs[0], data_ptrs[1], bytes_per_pixel);
-            }
-        }
-    }
+    // Swap depth and stencil value ordering since 3DS does not match OpenGL
+    const bool swap_depth_stencil = pixel_format == CachedSurface::PixelFormat::D24S8;
+    VideoCore::MortonCopy(width, height, bytes_per_pixel, gl_bytes_per_pixel, swap_depth_stencil,
+                          morton_data, gl_data, morton_to_gl);
 }
 
 void RasterizerCacheOpenGL::BlitTextures(GLuint src_tex, GLuint dst_tex,
@@ -347,12 +307,7 @@ CachedSurface* RasterizerCacheOpenGL::GetSurface(const CachedSurface& params, bo
                 tex_info.SetDefaultStride();
                 tex_info.physical_address = params.addr;
 
-                for (unsigned y = 0; y < params.height; ++y) {
-                    for (unsigned x = 0; x < params.width; ++x) {
-                        tex_buffer[x + params.width * y] = Pica::Texture::LookupTexture(
-                            texture_src_data, x, params.height - 1 - y, tex_info);
-                    }
-                }
+                Pica::Texture::DecodeTexture(texture_src_data, tex_info, tex_buffer.data(), true);
 
                 glTexImage2D(GL_TEXTURE_2D, 0, tuple.internal_format, params.width, params.height,
                              0, GL_RGBA, GL_UNSIGNED_BYTE, tex_buffer.data());
@@ -97,6 +97,13 @@ public:
         handle = GLShader::LoadProgram(vert_shader, frag_shader);
     }
 
+    /// Creates the internal OpenGL resource from a program started with StartLoadingProgram
+    void Create(const GLShader::PendingProgram& program) {
+        if (handle != 0)
+            return;
+        handle = GLShader::FinishLoadingProgram(program);
+    }
+
     /// Deletes the internal OpenGL resource
     void Release() {
         if (handle == 0)
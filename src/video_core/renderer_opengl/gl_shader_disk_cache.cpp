@@ -0,0 +1,123 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cinttypes>
+#include <cstring>
+#include <functional>
+#include "common/common_paths.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/string_util.h"
+#include "video_core/renderer_opengl/gl_shader_disk_cache.h"
+
+namespace GLShader {
+
+/// Version of the disk cache format, bump this when changing PicaShaderConfig or the generator
+constexpr u32 DISK_CACHE_VERSION = 1;
+
+namespace {
+
+/// Collects the configurations stored in the disk cache
+class ConfigCollector final : public LinearDiskCacheReader<u64, u8> {
+public:
+    void Read(const u64& key, const u8* value, u32 value_size) override {
+        if (value_size != sizeof(PicaShaderConfig::State)) {
+            LOG_WARNING(Render_OpenGL, "Skipping malformed entry of the shader disk cache");
+            return;
+        }
+
+        PicaShaderConfig config;
+        std::memcpy(&config.state, value, sizeof(PicaShaderConfig::State));
+        configs.push_back(config);
+    }
+
+    std::vector<PicaShaderConfig> configs;
+};
+
+} // anonymous namespace
+
+ShaderDiskCache::~ShaderDiskCache() {
+    StopGenerating();
+}
+
+void ShaderDiskCache::Open(u64 program_id) {
+    StopGenerating();
+    disk_cache.Close();
+    is_open = false;
+    stored_configs.clear();
+
+    const std::string dir = FileUtil::GetUserPath(D_CACHE_IDX) + SHADER_DIR DIR_SEP;
+    if (!FileUtil::CreateFullPath(dir)) {
+        LOG_ERROR(Render_OpenGL, "Failed to create shader cache directory %s", dir.c_str());
+        return;
+    }
+
+    const std::string filename = Common::StringFromFormat(
+        "%sfs_glsl_v%u_%016" PRIx64 ".bin", dir.c_str(), DISK_CACHE_VERSION, program_id);
+
+    ConfigCollector collector;
+    disk_cache.OpenAndRead(filename.c_str(), collector);
+    is_open = true;
+    for (const PicaShaderConfig& config : collector.configs) {
+        stored_configs.insert(std::hash<PicaShaderConfig>()(config));
+    }
+
+    LOG_INFO(Render_OpenGL, "Loaded %zu shader configurations from %s", collector.configs.size(),
+             filename.c_str());
+
+    if (!collector.configs.empty()) {
+        generator_thread = std::thread(&ShaderDiskCache::GenerateShaders, this,
+                                       std::move(collector.configs));
+    }
+}
+
+void ShaderDiskCache::Add(const PicaShaderConfig& config) {
+    if (!is_open)
+        return;
+
+    const u64 key = std::hash<PicaShaderConfig>()(config);
+    if (!stored_configs.insert(key).second)
+        return;
+
+    disk_cache.Append(key, reinterpret_cast<const u8*>(&config.state),
+                      sizeof(PicaShaderConfig::State));
+    disk_cache.Sync();
+}
+
+std::vector<std::pair<PicaShaderConfig, std::string>> ShaderDiskCache::TakeGeneratedShaders() {
+    std::vector<std::pair<PicaShaderConfig, std::string>> shaders;
+    if (shaders_available) {
+        std::lock_guard<std::mutex> lock(generated_shaders_mutex);
+        shaders.swap(generated_shaders);
+        shaders_available = false;
+    }
+    return shaders;
+}
+
+void ShaderDiskCache::GenerateShaders(std::vector<PicaShaderConfig> configs) {
+    for (const PicaShaderConfig& config : configs) {
+        if (stop_generating)
+            break;
+
+        std::string source = GenerateFragmentShader(config);
+
+        std::lock_guard<std::mutex> lock(generated_shaders_mutex);
+        generated_shaders.emplace_back(config, std::move(source));
+        shaders_available = true;
+    }
+}
+
+void ShaderDiskCache::StopGenerating() {
+    if (generator_thread.joinable()) {
+        stop_generating = true;
+        generator_thread.join();
+        stop_generating = false;
+    }
+
+    std::lock_guard<std::mutex> lock(generated_shaders_mutex);
+    generated_shaders.clear();
+    shaders_available = false;
+}
+
+} // namespace GLShader
@@ -0,0 +1,55 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "common/common_types.h"
+#include "common/linear_disk_cache.h"
+#include "video_core/renderer_opengl/gl_shader_gen.h"
+
+namespace GLShader {
+
+/**
+ * Records the PicaShaderConfigs used by a title on disk. When the title is loaded again, the
+ * fragment shaders of all recorded configurations are generated on a background thread, so that
+ * they can be compiled before they are needed.
+ */
+class ShaderDiskCache {
+public:
+    ~ShaderDiskCache();
+
+    /// Opens the cache of the title with the given program ID and starts generating its shaders
+    void Open(u64 program_id);
+
+    /// Records a configuration, if it isn't part of the cache yet
+    void Add(const PicaShaderConfig& config);
+
+    /// Returns the fragment shaders that have been generated since the last call
+    std::vector<std::pair<PicaShaderConfig, std::string>> TakeGeneratedShaders();
+
+private:
+    void GenerateShaders(std::vector<PicaShaderConfig> configs);
+    void StopGenerating();
+
+    LinearDiskCache<u64, u8> disk_cache;
+    bool is_open = false;
+    /// Hashes of the configurations stored in the cache
+    std::unordered_set<u64> stored_configs;
+
+    std::thread generator_thread;
+    std::atomic<bool> stop_generating{false};
+    /// Set when generated_shaders isn't empty, so that polling doesn't need to take the lock
+    std::atomic<bool> shaders_available{false};
+    std::mutex generated_shaders_mutex;
+    std::vector<std::pair<PicaShaderConfig, std::string>> generated_shaders;
+};
+
+} // namespace GLShader
@@ -11,27 +11,54 @@
 namespace GLShader {
 
 GLuint LoadProgram(const char* vertex_shader, const char* fragment_shader) {
+    return FinishLoadingProgram(StartLoadingProgram(vertex_shader, fragment_shader));
+}
 
-    // Create the shaders
-    GLuint vertex_shader_id = glCreateShader(GL_VERTEX_SHADER);
-    GLuint fragment_shader_id = glCreateShader(GL_FRAGMENT_SHADER);
+PendingProgram StartLoadingProgram(const char* vertex_shader, const char* fragment_shader) {
+    PendingProgram program;
+    program.vertex_shader = vertex_shader;
+    program.fragment_shader = fragment_shader;
 
-    GLint result = GL_FALSE;
-    int info_log_length;
+    // Create the shaders
+    program.vertex_shader_id = glCreateShader(GL_VERTEX_SHADER);
+    program.fragment_shader_id = glCreateShader(GL_FRAGMENT_SHADER);
 
     // Compile Vertex Shader
     LOG_DEBUG(Render_OpenGL, "Compiling vertex shader...");
 
-    glShaderSource(vertex_shader_id, 1, &vertex_shader, nullptr);
-    glCompileShader(vertex_shader_id);
+    glShaderSource(program.vertex_shader_id, 1, &vertex_shader, nullptr);
+    glCompileShader(program.vertex_shader_id);
+
+    // Compile Fragment Shader
+    LOG_DEBUG(Render_OpenGL, "Compiling fragment shader...");
+
+    glShaderSource(program.fragment_shader_id, 1, &fragment_shader, nullptr);
+    glCompileShader(program.fragment_shader_id);
+
+    // Link the program
+    LOG_DEBUG(Render_OpenGL, "Linking program...");
+
+    program.program_id = glCreateProgram();
+    glAttachShader(program.program_id, program.vertex_shader_id);
+    glAttachShader(program.program_id, program.fragment_shader_id);
+
+    glLinkProgram(program.program_id);
+
+    return program;
+}
+
+GLuint FinishLoadingProgram(const PendingProgram& program) {
+    GLint result = GL_FALSE;
+    int info_log_length;
 
     // Check Vertex Shader
-    glGetShaderiv(vertex_shader_id, GL_COMPILE_STATUS, &result);
-    glGetShaderiv(vertex_shader_id, GL_INFO_LOG_LENGTH, &info_log_length);
+    glGetShaderiv(program.vertex_shader_id, GL_COMPILE_STATUS, &result);
+    glGetShaderiv(program.vertex_shader_id, GL_INFO_LOG_LENGTH, &info_log_length);
 
     if (info_log_length > 1) {
         std::vector<char> vertex_shader_error(info_log_length);
-        glGetShaderInfoLog(vertex_shader_id, info_log_length, nullptr, &vertex_shader_error[0]);
+        glGetShaderInfoLog(program.vertex_shader_id, info_log_length, nullptr,
+                           &vertex_shader_error[0]);
         if (result == GL_TRUE) {
             LOG_DEBUG(Render_OpenGL, "%s", &vertex_shader_error[0]);
         } else {
@@ -39,19 +66,14 @@ GLuint LoadProgram(const char* vertex_shader, const char* fragment_shader) {
         }
     }
 
-    // Compile Fragment Shader
-    LOG_DEBUG(Render_OpenGL, "Compiling fragment shader...");
-
-    glShaderSource(fragment_shader_id, 1, &fragment_shader, nullptr);
-    glCompileShader(fragment_shader_id);
-
     // Check Fragment Shader
-    glGetShaderiv(fragment_shader_id, GL_COMPILE_STATUS, &result);
-    glGetShaderiv(fragment_shader_id, GL_INFO_LOG_LENGTH, &info_log_length);
+    glGetShaderiv(program.fragment_shader_id, GL_COMPILE_STATUS, &result);
+    glGetShaderiv(program.fragment_shader_id, GL_INFO_LOG_LENGTH, &info_log_length);
 
     if (info_log_length > 1) {
         std::vector<char> fragment_shader_error(info_log_length);
-        glGetShaderInfoLog(fragment_shader_id, info_log_length, nullptr, &fragment_shader_error[0]);
+        glGetShaderInfoLog(program.fragment_shader_id, info_log_length, nullptr,
+                           &fragment_shader_error[0]);
         if (result == GL_TRUE) {
             LOG_DEBUG(Render_OpenGL, "%s", &fragment_shader_error[0]);
         } else {
@@ -60,22 +82,13 @@ GLuint LoadProgram(const char* vertex_shader, const char* fragment_shader) {
         }
     }
 
-    // Link the program
-    LOG_DEBUG(Render_OpenGL, "Linking program...");
-
-    GLuint program_id = glCreateProgram();
-    glAttachShader(program_id, vertex_shader_id);
-    glAttachShader(program_id, fragment_shader_id);
-
-    glLinkProgram(program_id);
-
     // Check the program
-    glGetProgramiv(program_id, GL_LINK_STATUS, &result);
-    glGetProgramiv(program_id, GL_INFO_LOG_LENGTH, &info_log_length);
+    glGetProgramiv(program.program_id, GL_LINK_STATUS, &result);
+    glGetProgramiv(program.program_id, GL_INFO_LOG_LENGTH, &info_log_length);
 
     if (info_log_length > 1) {
         std::vector<char> program_error(info_log_length);
-        glGetProgramInfoLog(program_id, info_log_length, nullptr, &program_error[0]);
+        glGetProgramInfoLog(program.program_id, info_log_length, nullptr, &program_error[0]);
         if (result == GL_TRUE) {
             LOG_DEBUG(Render_OpenGL, "%s", &program_error[0]);
         } else {
@@ -85,15 +98,15 @@ GLuint LoadProgram(const char* vertex_shader, const char* fragment_shader) {
 
     // If the program linking failed at least one of the shaders was probably bad
     if (result == GL_FALSE) {
-        LOG_ERROR(Render_OpenGL, "Vertex shader:\n%s", vertex_shader);
-        LOG_ERROR(Render_OpenGL, "Fragment shader:\n%s", fragment_shader);
+        LOG_ERROR(Render_OpenGL, "Vertex shader:\n%s", program.vertex_shader.c_str());
+        LOG_ERROR(Render_OpenGL, "Fragment shader:\n%s", program.fragment_shader.c_str());
     }
     ASSERT_MSG(result == GL_TRUE, "Shader not linked");
 
-    glDeleteShader(vertex_shader_id);
-    glDeleteShader(fragment_shader_id);
+    glDeleteShader(program.vertex_shader_id);
+    glDeleteShader(program.fragment_shader_id);
 
-    return program_id;
+    return program.program_id;
 }
 
 } // namespace GLShader
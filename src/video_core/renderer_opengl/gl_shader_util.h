@@ -4,10 +4,24 @@
 
 #pragma once
 
+#include <string>
 #include <glad/glad.h>
 
 namespace GLShader {
 
+/**
+ * OpenGL shader program whose compilation has been started by StartLoadingProgram. Drivers may
+ * keep compiling it in the background until its status is queried by FinishLoadingProgram.
+ */
+struct PendingProgram {
+    GLuint program_id;
+    GLuint vertex_shader_id;
+    GLuint fragment_shader_id;
+    /// Sources, kept to be logged in case of an error
+    std::string vertex_shader;
+    std::string fragment_shader;
+};
+
 /**
  * Utility function to create and compile an OpenGL GLSL shader program (vertex + fragment shader)
  * @param vertex_shader String of the GLSL vertex shader program
@@ -16,4 +30,17 @@ namespace GLShader {
  */
 GLuint LoadProgram(const char* vertex_shader, const char* fragment_shader);
 
+/**
+ * Starts compiling and linking an OpenGL GLSL shader program without waiting for the result
+ * @param vertex_shader String of the GLSL vertex shader program
+ * @param fragment_shader String of the GLSL fragment shader program
+ */
+PendingProgram StartLoadingProgram(const char* vertex_shader, const char* fragment_shader);
+
+/**
+ * Waits for a program started by StartLoadingProgram to be linked and checks the result
+ * @returns Handle of the newly created OpenGL shader object
+ */
+GLuint FinishLoadingProgram(const PendingProgram& program);
+
 } // namespace
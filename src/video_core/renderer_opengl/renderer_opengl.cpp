@@ -99,10 +99,41 @@ RendererOpenGL::~RendererOpenGL() = default;
 
 /// Swap buffers (render frame)
 void RendererOpenGL::SwapBuffers() {
+    // Skipped frames are neither uploaded nor presented, only the per-frame bookkeeping is done
+    const bool frame_skipped = Core::System::GetInstance().frame_limiter.IsFrameSkipped();
+
     // Maintain the rasterizer's state as a priority
     OpenGLState prev_state = OpenGLState::GetCurState();
     state.Apply();
 
+    if (!frame_skipped) {
+        LoadScreens();
+        DrawScreens();
+    }
+
+    Core::System::GetInstance().perf_stats.EndSystemFrame();
+
+    // Swap buffers
+    render_window->PollEvents();
+    if (!frame_skipped) {
+        render_window->SwapBuffers();
+    }
+
+    Core::System::GetInstance().frame_limiter.DoFrameLimiting(CoreTiming::GetGlobalTimeUs());
+    Core::System::GetInstance().perf_stats.BeginSystemFrame();
+
+    prev_state.Apply();
+    RefreshRasterizerSetting();
+
+    if (Pica::g_debug_context && Pica::g_debug_context->recorder) {
+        Pica::g_debug_context->recorder->FrameFinished();
+    }
+}
+
+/**
+ * Loads the contents of both LCDs into their screen textures.
+ */
+void RendererOpenGL::LoadScreens() {
     for (int i : {0, 1}) {
         const auto& framebuffer = GPU::g_regs.framebuffer_config[i];
 
@@ -136,24 +167,6 @@ void RendererOpenGL::SwapBuffers() {
             screen_infos[i].texture.height = framebuffer.height;
         }
     }
-
-    DrawScreens();
-
-    Core::System::GetInstance().perf_stats.EndSystemFrame();
-
-    // Swap buffers
-    render_window->PollEvents();
-    render_window->SwapBuffers();
-
-    Core::System::GetInstance().frame_limiter.DoFrameLimiting(CoreTiming::GetGlobalTimeUs());
-    Core::System::GetInstance().perf_stats.BeginSystemFrame();
-
-    prev_state.Apply();
-    RefreshRasterizerSetting();
-
-    if (Pica::g_debug_context && Pica::g_debug_context->recorder) {
-        Pica::g_debug_context->recorder->FrameFinished();
-    }
 }
 
 /**
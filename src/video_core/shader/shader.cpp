@@ -84,6 +84,12 @@ void UnitState::WriteOutput(const ShaderRegs& config, AttributeBuffer& output) {
 
 MICROPROFILE_DEFINE(GPU_Shader, "GPU", "Shader", MP_RGB(50, 50, 240));
 
+void ShaderEngine::RunBatch(const ShaderSetup& setup, UnitState* states, size_t count) const {
+    for (size_t i = 0; i < count; ++i) {
+        Run(setup, states[i]);
+    }
+}
+
 #ifdef ARCHITECTURE_x86_64
 static std::unique_ptr<JitX64Engine> jit_engine;
 #endif // ARCHITECTURE_x86_64
@@ -109,6 +115,17 @@ void Shutdown() {
 #endif // ARCHITECTURE_x86_64
 }
 
+void LoadDiskCache(u64 program_id) {
+#ifdef ARCHITECTURE_x86_64
+    if (VideoCore::g_shader_jit_enabled) {
+        if (jit_engine == nullptr) {
+            jit_engine = std::make_unique<JitX64Engine>();
+        }
+        jit_engine->LoadDiskCache(program_id);
+    }
+#endif // ARCHITECTURE_x86_64
+}
+
 } // namespace Shader
 
 } // namespace Pica
@@ -175,12 +175,26 @@ public:
      * @param state Shader unit state, must be setup with input data before each shader invocation.
      */
     virtual void Run(const ShaderSetup& setup, UnitState& state) const = 0;
+
+    /**
+     * Runs the currently setup shader on several vertices. Engines which can amortize the cost of
+     * an invocation over multiple vertices override this, by default `Run` is called for each one.
+     *
+     * @param setup Shader engine state, must be setup with SetupBatch on each shader change.
+     * @param states Array of `count` shader unit states, each setup with the input data of one
+     *               vertex.
+     * @param count Number of vertices to process.
+     */
+    virtual void RunBatch(const ShaderSetup& setup, UnitState* states, size_t count) const;
 };
 
 // TODO(yuriks): Remove and make it non-global state somewhere
 ShaderEngine* GetEngine();
 void Shutdown();
 
+/// Loads the disk cache of compiled shaders of a title if it's supported by the shader engine
+void LoadDiskCache(u64 program_id);
+
 } // namespace Shader
 
 } // namespace Pica
@@ -2,8 +2,16 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cinttypes>
+#include <string>
+#include <utility>
+#include "common/common_paths.h"
+#include "common/file_util.h"
 #include "common/hash.h"
+#include "common/logging/log.h"
 #include "common/microprofile.h"
+#include "common/string_util.h"
 #include "video_core/shader/shader.h"
 #include "video_core/shader/shader_jit_x64.h"
 #include "video_core/shader/shader_jit_x64_compiler.h"
@@ -11,25 +19,182 @@
 namespace Pica {
 namespace Shader {
 
+// The disk cache stores the Pica programs which have been compiled, as the generated code refers
+// to addresses which change between runs. Each entry is keyed by the cache key of the program and
+// holds the number of used program code words, the number of used swizzle data words and the
+// used words of both arrays. Unused words at the end of the arrays are zero.
+
+/// Version of the disk cache format, bump this when changing the layout of entries
+constexpr u32 DISK_CACHE_VERSION = 1;
+
+using ProgramCode = std::array<u32, MAX_PROGRAM_CODE_LENGTH>;
+using SwizzleData = std::array<u32, MAX_SWIZZLE_DATA_LENGTH>;
+
+static u64 GetCacheKey(const ProgramCode& program_code, const SwizzleData& swizzle_data) {
+    u64 code_hash = Common::ComputeHash64(&program_code, sizeof(program_code));
+    u64 swizzle_hash = Common::ComputeHash64(&swizzle_data, sizeof(swizzle_data));
+    return code_hash ^ swizzle_hash;
+}
+
+/// Returns the number of words up to and including the last non-zero one
+template <size_t N>
+static u32 GetUsedLength(const std::array<u32, N>& data) {
+    size_t length = N;
+    while (length > 0 && data[length - 1] == 0)
+        --length;
+    return static_cast<u32>(length);
+}
+
+static bool UnpackProgram(const std::vector<u32>& data, ProgramCode& program_code,
+                          SwizzleData& swizzle_data) {
+    if (data.size() < 2)
+        return false;
+
+    const u32 code_length = data[0];
+    const u32 swizzle_length = data[1];
+    if (code_length > program_code.size() || swizzle_length > swizzle_data.size() ||
+        data.size() != 2 + code_length + swizzle_length)
+        return false;
+
+    auto code_begin = data.begin() + 2;
+    auto swizzle_begin = code_begin + code_length;
+    program_code.fill(0);
+    std::copy(code_begin, swizzle_begin, program_code.begin());
+    swizzle_data.fill(0);
+    std::copy(swizzle_begin, data.end(), swizzle_data.begin());
+    return true;
+}
+
+namespace {
+
+/// Collects all entries of the disk cache
+class ProgramCollector final : public LinearDiskCacheReader<u64, u32> {
+public:
+    void Read(const u64& key, const u32* value, u32 value_size) override {
+        keys.push_back(key);
+        programs.emplace_back(value, value + value_size);
+    }
+
+    std::vector<u64> keys;
+    std::vector<std::vector<u32>> programs;
+};
+
+} // anonymous namespace
+
 JitX64Engine::JitX64Engine() = default;
-JitX64Engine::~JitX64Engine() = default;
+
+JitX64Engine::~JitX64Engine() {
+    StopPrecompiling();
+}
 
 void JitX64Engine::SetupBatch(ShaderSetup& setup, unsigned int entry_point) {
     ASSERT(entry_point < MAX_PROGRAM_CODE_LENGTH);
     setup.engine_data.entry_point = entry_point;
 
-    u64 code_hash = Common::ComputeHash64(&setup.program_code, sizeof(setup.program_code));
-    u64 swizzle_hash = Common::ComputeHash64(&setup.swizzle_data, sizeof(setup.swizzle_data));
+    u64 cache_key = GetCacheKey(setup.program_code, setup.swizzle_data);
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        auto iter = cache.find(cache_key);
+        if (iter != cache.end()) {
+            setup.engine_data.cached_shader = iter->second.get();
+            return;
+        }
+    }
+
+    // The precompilation thread may insert the same program meanwhile, in which case its shader is
+    // used and this one is dropped
+    auto shader = std::make_unique<JitShader>();
+    shader->Compile(&setup.program_code, &setup.swizzle_data);
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        auto result = cache.emplace(cache_key, std::move(shader));
+        setup.engine_data.cached_shader = result.first->second.get();
+    }
+
+    if (disk_cache_open && disk_cache_keys.insert(cache_key).second) {
+        const u32 code_length = GetUsedLength(setup.program_code);
+        const u32 swizzle_length = GetUsedLength(setup.swizzle_data);
+
+        ProgramData data;
+        data.reserve(2 + code_length + swizzle_length);
+        data.push_back(code_length);
+        data.push_back(swizzle_length);
+        data.insert(data.end(), setup.program_code.begin(),
+                    setup.program_code.begin() + code_length);
+        data.insert(data.end(), setup.swizzle_data.begin(),
+                    setup.swizzle_data.begin() + swizzle_length);
+
+        disk_cache.Append(cache_key, data.data(), static_cast<u32>(data.size()));
+        disk_cache.Sync();
+    }
+}
+
+void JitX64Engine::LoadDiskCache(u64 program_id) {
+    StopPrecompiling();
+    disk_cache.Close();
+    disk_cache_open = false;
+    disk_cache_keys.clear();
+
+    const std::string dir = FileUtil::GetUserPath(D_CACHE_IDX) + SHADER_DIR DIR_SEP;
+    if (!FileUtil::CreateFullPath(dir)) {
+        LOG_ERROR(HW_GPU, "Failed to create shader cache directory %s", dir.c_str());
+        return;
+    }
+
+    const std::string filename = Common::StringFromFormat(
+        "%svs_jit_v%u_%016" PRIx64 ".bin", dir.c_str(), DISK_CACHE_VERSION, program_id);
+
+    ProgramCollector collector;
+    disk_cache.OpenAndRead(filename.c_str(), collector);
+    disk_cache_open = true;
+    disk_cache_keys.insert(collector.keys.begin(), collector.keys.end());
+
+    LOG_INFO(HW_GPU, "Loaded %zu shader programs from %s", collector.programs.size(),
+             filename.c_str());
+
+    if (!collector.programs.empty()) {
+        precompile_thread = std::thread(&JitX64Engine::PrecompilePrograms, this,
+                                        std::move(collector.programs));
+    }
+}
+
+void JitX64Engine::PrecompilePrograms(std::vector<ProgramData> programs) {
+    auto program_code = std::make_unique<ProgramCode>();
+    auto swizzle_data = std::make_unique<SwizzleData>();
+    size_t num_compiled = 0;
+
+    for (const ProgramData& data : programs) {
+        if (stop_precompile)
+            break;
+
+        if (!UnpackProgram(data, *program_code, *swizzle_data)) {
+            LOG_WARNING(HW_GPU, "Skipping malformed entry of the shader disk cache");
+            continue;
+        }
+
+        u64 cache_key = GetCacheKey(*program_code, *swizzle_data);
+        {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            if (cache.count(cache_key) != 0)
+                continue;
+        }
 
-    u64 cache_key = code_hash ^ swizzle_hash;
-    auto iter = cache.find(cache_key);
-    if (iter != cache.end()) {
-        setup.engine_data.cached_shader = iter->second.get();
-    } else {
         auto shader = std::make_unique<JitShader>();
-        shader->Compile(&setup.program_code, &setup.swizzle_data);
-        setup.engine_data.cached_shader = shader.get();
-        cache.emplace_hint(iter, cache_key, std::move(shader));
+        shader->Compile(program_code.get(), swizzle_data.get());
+
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        if (cache.emplace(cache_key, std::move(shader)).second)
+            ++num_compiled;
+    }
+
+    LOG_INFO(HW_GPU, "Precompiled %zu shader programs", num_compiled);
+}
+
+void JitX64Engine::StopPrecompiling() {
+    if (precompile_thread.joinable()) {
+        stop_precompile = true;
+        precompile_thread.join();
+        stop_precompile = false;
     }
 }
 
@@ -44,5 +209,14 @@ void JitX64Engine::Run(const ShaderSetup& setup, UnitState& state) const {
     shader->Run(setup, state, setup.engine_data.entry_point);
 }
 
+void JitX64Engine::RunBatch(const ShaderSetup& setup, UnitState* states, size_t count) const {
+    ASSERT(setup.engine_data.cached_shader != nullptr);
+
+    MICROPROFILE_SCOPE(GPU_Shader);
+
+    const JitShader* shader = static_cast<const JitShader*>(setup.engine_data.cached_shader);
+    shader->RunBatch(setup, states, count, setup.engine_data.entry_point);
+}
+
 } // namespace Shader
 } // namespace Pica
@@ -4,9 +4,15 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 #include "common/common_types.h"
+#include "common/linear_disk_cache.h"
 #include "video_core/shader/shader.h"
 
 namespace Pica {
@@ -21,9 +27,33 @@ public:
 
     void SetupBatch(ShaderSetup& setup, unsigned int entry_point) override;
     void Run(const ShaderSetup& setup, UnitState& state) const override;
+    void RunBatch(const ShaderSetup& setup, UnitState* states, size_t count) const override;
+
+    /**
+     * Opens the on-disk cache of shader programs used by a title and compiles all programs
+     * recorded in it on a background thread. Programs compiled afterwards are appended to it.
+     * @param program_id Program ID of the title, used to name the cache file.
+     */
+    void LoadDiskCache(u64 program_id);
 
 private:
+    /// Shader program as stored in the disk cache, see shader_jit_x64.cpp for the layout
+    using ProgramData = std::vector<u32>;
+
+    void PrecompilePrograms(std::vector<ProgramData> programs);
+    void StopPrecompiling();
+
+    /// Guards `cache`, which is also filled by the precompilation thread
+    std::mutex cache_mutex;
     std::unordered_map<u64, std::unique_ptr<JitShader>> cache;
+
+    LinearDiskCache<u64, u32> disk_cache;
+    bool disk_cache_open = false;
+    /// Programs which are already stored in the disk cache
+    std::unordered_set<u64> disk_cache_keys;
+
+    std::thread precompile_thread;
+    std::atomic<bool> stop_precompile{false};
 };
 
 } // namespace Shader
@@ -120,6 +120,8 @@ static const Reg64 COND0 = r13;
 static const Reg64 COND1 = r14;
 /// Pointer to the UnitState instance for the current VS unit
 static const Reg64 STATE = r15;
+/// Stack pointer of the loop over the vertices of a batch, used to return to it from `END`
+static const Reg64 BATCH_STACK = rbp;
 /// SIMD scratch register
 static const Xmm SCRATCH = xmm0;
 /// Loaded with the first swizzled source register, otherwise can be used as a scratch register
@@ -140,6 +142,8 @@ static const Xmm NEGBIT = xmm15;
 static const BitSet32 persistent_regs = BuildRegSet({
     // Pointers to register blocks
     SETUP, STATE,
+    // Stack pointer of the batch loop
+    BATCH_STACK,
     // Cached registers
     ADDROFFS_REG_0, ADDROFFS_REG_1, LOOPCOUNT_REG, COND0, COND1,
     // Constants
@@ -597,7 +601,8 @@ void JitShader::Compile_RSQ(Instruction instr) {
 void JitShader::Compile_NOP(Instruction instr) {}
 
 void JitShader::Compile_END(Instruction instr) {
-    ABI_PopRegistersAndAdjustStack(*this, ABI_ALL_CALLEE_SAVED, 8, 16);
+    // Unwind any subroutine calls and return to the batch loop
+    lea(rsp, ptr[BATCH_STACK - 16]);
     ret();
 }
 
@@ -849,19 +854,16 @@ void JitShader::Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_
     FindReturnOffsets();
 
     // The stack pointer is 8 modulo 16 at the entry of a procedure
-    // We reserve 16 bytes and assign a dummy value to the first 8 bytes, to catch any potential
-    // return checks (see Compile_Return) that happen in shader main routine.
+    // We reserve 16 bytes for the address of the first instruction and the number of vertices left
     ABI_PushRegistersAndAdjustStack(*this, ABI_ALL_CALLEE_SAVED, 8, 16);
-    mov(qword[rsp + 8], 0xFFFFFFFFFFFFFFFFULL);
+    mov(qword[rsp], ABI_PARAM3);
+    mov(qword[rsp + 8], ABI_PARAM4);
+    mov(BATCH_STACK, rsp);
 
+    // ABI_PARAM4 may alias SETUP, so it has to be saved before this
     mov(SETUP, ABI_PARAM1);
     mov(STATE, ABI_PARAM2);
 
-    // Zero address/loop  registers
-    xor_(ADDROFFS_REG_0.cvt32(), ADDROFFS_REG_0.cvt32());
-    xor_(ADDROFFS_REG_1.cvt32(), ADDROFFS_REG_1.cvt32());
-    xor_(LOOPCOUNT_REG, LOOPCOUNT_REG);
-
     // Used to set a register to one
     static const __m128 one = {1.f, 1.f, 1.f, 1.f};
     mov(rax, reinterpret_cast<size_t>(&one));
@@ -872,8 +874,31 @@ void JitShader::Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_
     mov(rax, reinterpret_cast<size_t>(&neg));
     movaps(NEGBIT, xword[rax]);
 
-    // Jump to start of the shader program
-    jmp(ABI_PARAM3);
+    // Run the shader program once for each UnitState of the batch. The uniform pointer and the
+    // constants above stay in registers across vertices, only the per-vertex state is reset.
+    Label vertex_loop, batch_end;
+    cmp(qword[rsp + 8], 0);
+    je(batch_end);
+    L(vertex_loop);
+
+    // Zero address/loop  registers
+    xor_(ADDROFFS_REG_0.cvt32(), ADDROFFS_REG_0.cvt32());
+    xor_(ADDROFFS_REG_1.cvt32(), ADDROFFS_REG_1.cvt32());
+    xor_(LOOPCOUNT_REG, LOOPCOUNT_REG);
+
+    // The main routine is entered like a subroutine, with a dummy return offset on the stack to
+    // catch any potential return checks (see Compile_Return) that happen in it. `END` returns here.
+    push(qword, 0xFFFFFFFF);
+    call(qword[rsp + 8]);
+    add(rsp, 8);
+
+    add(STATE, static_cast<u32>(sizeof(UnitState)));
+    sub(qword[rsp + 8], 1);
+    jnz(vertex_loop);
+
+    L(batch_end);
+    ABI_PopRegistersAndAdjustStack(*this, ABI_ALL_CALLEE_SAVED, 8, 16);
+    ret();
 
     // Compile entire program
     Compile_Block(static_cast<unsigned>(program_code->size()));
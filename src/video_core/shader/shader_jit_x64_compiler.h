@@ -34,7 +34,13 @@ public:
     JitShader();
 
     void Run(const ShaderSetup& setup, UnitState& state, unsigned offset) const {
-        program(&setup, &state, instruction_labels[offset].getAddress());
+        program(&setup, &state, instruction_labels[offset].getAddress(), 1);
+    }
+
+    /// Runs the shader for each of the `count` consecutive unit states in a single call
+    void RunBatch(const ShaderSetup& setup, UnitState* states, size_t count,
+                  unsigned offset) const {
+        program(&setup, states, instruction_labels[offset].getAddress(), count);
     }
 
     void Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code,
@@ -116,7 +122,8 @@ private:
     unsigned program_counter = 0; ///< Offset of the next instruction to decode
     bool looping = false;         ///< True if compiling a loop, used to check for nested loops
 
-    using CompiledShader = void(const void* setup, void* state, const u8* start_addr);
+    using CompiledShader = void(const void* setup, void* states, const u8* start_addr,
+                                size_t count);
     CompiledShader* program = nullptr;
 };
 
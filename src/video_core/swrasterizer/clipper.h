@@ -4,18 +4,32 @@
 
 #pragma once
 
+#include <functional>
+
 namespace Pica {
 
 namespace Shader {
 struct OutputVertex;
 }
 
+namespace Rasterizer {
+struct Vertex;
+}
+
 namespace Clipper {
 
 using Shader::OutputVertex;
 
+using TriangleHandler = std::function<void(
+    const Rasterizer::Vertex& v0, const Rasterizer::Vertex& v1, const Rasterizer::Vertex& v2)>;
+
+/// Clips the given triangle and sends the resulting triangles to the software rasterizer
 void ProcessTriangle(const OutputVertex& v0, const OutputVertex& v1, const OutputVertex& v2);
 
+/// Clips the given triangle and calls triangle_handler for each of the resulting triangles
+void ProcessTriangle(const OutputVertex& v0, const OutputVertex& v1, const OutputVertex& v2,
+                     const TriangleHandler& triangle_handler);
+
 } // namespace
 
 } // namespace
@@ -0,0 +1,784 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/math_util.h"
+#include "common/thread.h"
+#include "common/vector_math.h"
+#include "video_core/pica_state.h"
+#include "video_core/swrasterizer/framebuffer.h"
+#include "video_core/swrasterizer/pixel_pipeline.h"
+
+namespace Pica {
+namespace Rasterizer {
+
+using Operation = TexturingRegs::TevStageConfig::Operation;
+
+PixelPipelineConfig PixelPipelineConfig::BuildFromRegs(const Regs& regs) {
+    PixelPipelineConfig res;
+
+    auto& state = res.state;
+    std::memset(&state, 0, sizeof(PixelPipelineConfig::State));
+
+    // Copy relevant tev stages fields.
+    // const_color isn't part of the key because of its high variance.
+    const auto& tev_stages = regs.texturing.GetTevStages();
+    DEBUG_ASSERT(state.tev_stages.size() == tev_stages.size());
+    for (size_t i = 0; i < tev_stages.size(); i++) {
+        const auto& tev_stage = tev_stages[i];
+        state.tev_stages[i].sources_raw = tev_stage.sources_raw;
+        state.tev_stages[i].modifiers_raw = tev_stage.modifiers_raw;
+        state.tev_stages[i].ops_raw = tev_stage.ops_raw;
+        state.tev_stages[i].scales_raw = tev_stage.scales_raw;
+    }
+
+    state.combiner_buffer_update_rgb =
+        static_cast<u8>(regs.texturing.tev_combiner_buffer_input.update_mask_rgb);
+    state.combiner_buffer_update_a =
+        static_cast<u8>(regs.texturing.tev_combiner_buffer_input.update_mask_a);
+
+    state.fog_mode = regs.texturing.fog_mode;
+    state.fog_flip = regs.texturing.fog_flip != 0;
+
+    const auto& output_merger = regs.framebuffer.output_merger;
+    const auto& framebuffer = regs.framebuffer.framebuffer;
+
+    state.alpha_test_enable = output_merger.alpha_test.enable != 0;
+    if (state.alpha_test_enable)
+        state.alpha_test_func = output_merger.alpha_test.func;
+
+    state.stencil_action_enable = output_merger.stencil_test.enable &&
+                                  framebuffer.depth_format == FramebufferRegs::DepthFormat::D24S8;
+    if (state.stencil_action_enable) {
+        state.stencil_test_func = output_merger.stencil_test.func;
+        state.stencil_fail_action = output_merger.stencil_test.action_stencil_fail;
+        state.depth_fail_action = output_merger.stencil_test.action_depth_fail;
+        state.depth_pass_action = output_merger.stencil_test.action_depth_pass;
+    }
+
+    state.depth_test_enable = output_merger.depth_test_enable != 0;
+    if (state.depth_test_enable)
+        state.depth_test_func = output_merger.depth_test_func;
+    state.depth_format = framebuffer.depth_format;
+
+    state.depth_stencil_write_enable = framebuffer.allow_depth_stencil_write != 0;
+    state.depth_write_enable = output_merger.depth_write_enable != 0;
+
+    state.alphablend_enable = output_merger.alphablend_enable != 0;
+    if (state.alphablend_enable) {
+        state.blend_equation_rgb = output_merger.alpha_blending.blend_equation_rgb;
+        state.blend_equation_a = output_merger.alpha_blending.blend_equation_a;
+        state.factor_source_rgb = output_merger.alpha_blending.factor_source_rgb;
+        state.factor_dest_rgb = output_merger.alpha_blending.factor_dest_rgb;
+        state.factor_source_a = output_merger.alpha_blending.factor_source_a;
+        state.factor_dest_a = output_merger.alpha_blending.factor_dest_a;
+    } else {
+        state.logic_op = output_merger.logic_op;
+    }
+
+    state.color_write_enable = framebuffer.allow_color_write != 0;
+    state.color_write_mask = {{
+        output_merger.red_enable != 0, output_merger.green_enable != 0,
+        output_merger.blue_enable != 0, output_merger.alpha_enable != 0,
+    }};
+
+    return res;
+}
+
+namespace {
+
+template <FramebufferRegs::CompareFunc func>
+bool Compare(u32 lhs, u32 rhs) {
+    switch (func) {
+    case FramebufferRegs::CompareFunc::Never:
+        return false;
+    case FramebufferRegs::CompareFunc::Always:
+        return true;
+    case FramebufferRegs::CompareFunc::Equal:
+        return lhs == rhs;
+    case FramebufferRegs::CompareFunc::NotEqual:
+        return lhs != rhs;
+    case FramebufferRegs::CompareFunc::LessThan:
+        return lhs < rhs;
+    case FramebufferRegs::CompareFunc::LessThanOrEqual:
+        return lhs <= rhs;
+    case FramebufferRegs::CompareFunc::GreaterThan:
+        return lhs > rhs;
+    case FramebufferRegs::CompareFunc::GreaterThanOrEqual:
+        return lhs >= rhs;
+    }
+    return false;
+}
+
+void FillSpan(ColorSpan& span, const Math::Vec4<u8>& color) {
+    for (unsigned channel = 0; channel < 4; ++channel) {
+        std::fill(std::begin(span.channels[channel]), std::end(span.channels[channel]),
+                  color[channel]);
+    }
+}
+
+const ColorSpan& GetOneSpan() {
+    static const ColorSpan one = [] {
+        ColorSpan span;
+        FillSpan(span, {255, 255, 255, 255});
+        return span;
+    }();
+    return one;
+}
+
+} // anonymous namespace
+
+PixelPipeline::CompareFunction PixelPipeline::GetCompareFunction(
+    FramebufferRegs::CompareFunc func) {
+    using CompareFunc = FramebufferRegs::CompareFunc;
+
+    switch (func) {
+    case CompareFunc::Never:
+        return Compare<CompareFunc::Never>;
+    case CompareFunc::Always:
+        return Compare<CompareFunc::Always>;
+    case CompareFunc::Equal:
+        return Compare<CompareFunc::Equal>;
+    case CompareFunc::NotEqual:
+        return Compare<CompareFunc::NotEqual>;
+    case CompareFunc::LessThan:
+        return Compare<CompareFunc::LessThan>;
+    case CompareFunc::LessThanOrEqual:
+        return Compare<CompareFunc::LessThanOrEqual>;
+    case CompareFunc::GreaterThan:
+        return Compare<CompareFunc::GreaterThan>;
+    case CompareFunc::GreaterThanOrEqual:
+        return Compare<CompareFunc::GreaterThanOrEqual>;
+    }
+    return Compare<CompareFunc::Never>;
+}
+
+PixelPipeline::SpanSource PixelPipeline::GetTevSource(
+    TexturingRegs::TevStageConfig::Source source) {
+    using Source = TexturingRegs::TevStageConfig::Source;
+
+    switch (source) {
+    case Source::PrimaryColor:
+
+    // HACK: Until we implement fragment lighting, use primary_color
+    case Source::PrimaryFragmentColor:
+        return SpanSource::PrimaryColor;
+
+    // HACK: Until we implement fragment lighting, use zero
+    case Source::SecondaryFragmentColor:
+        return SpanSource::Zero;
+
+    case Source::Texture0:
+        return SpanSource::Texture0;
+
+    case Source::Texture1:
+        return SpanSource::Texture1;
+
+    case Source::Texture2:
+        return SpanSource::Texture2;
+
+    case Source::Texture3:
+        return SpanSource::Texture3;
+
+    case Source::PreviousBuffer:
+        return SpanSource::PreviousBuffer;
+
+    case Source::Constant:
+        return SpanSource::Constant;
+
+    case Source::Previous:
+        return SpanSource::Previous;
+
+    default:
+        LOG_ERROR(HW_GPU, "Unknown color combiner source %d", (int)source);
+        UNIMPLEMENTED();
+        return SpanSource::Zero;
+    }
+}
+
+PixelPipeline::ColorInput PixelPipeline::GetColorInput(
+    TexturingRegs::TevStageConfig::Source source,
+    TexturingRegs::TevStageConfig::ColorModifier modifier) {
+    using ColorModifier = TexturingRegs::TevStageConfig::ColorModifier;
+
+    const SpanSource span = GetTevSource(source);
+
+    switch (modifier) {
+    case ColorModifier::SourceColor:
+    default:
+        return {span, {{0, 1, 2}}, false};
+
+    case ColorModifier::OneMinusSourceColor:
+        return {span, {{0, 1, 2}}, true};
+
+    case ColorModifier::SourceAlpha:
+        return {span, {{3, 3, 3}}, false};
+
+    case ColorModifier::OneMinusSourceAlpha:
+        return {span, {{3, 3, 3}}, true};
+
+    case ColorModifier::SourceRed:
+        return {span, {{0, 0, 0}}, false};
+
+    case ColorModifier::OneMinusSourceRed:
+        return {span, {{0, 0, 0}}, true};
+
+    case ColorModifier::SourceGreen:
+        return {span, {{1, 1, 1}}, false};
+
+    case ColorModifier::OneMinusSourceGreen:
+        return {span, {{1, 1, 1}}, true};
+
+    case ColorModifier::SourceBlue:
+        return {span, {{2, 2, 2}}, false};
+
+    case ColorModifier::OneMinusSourceBlue:
+        return {span, {{2, 2, 2}}, true};
+    }
+}
+
+PixelPipeline::ChannelInput PixelPipeline::GetAlphaInput(
+    TexturingRegs::TevStageConfig::Source source,
+    TexturingRegs::TevStageConfig::AlphaModifier modifier) {
+    using AlphaModifier = TexturingRegs::TevStageConfig::AlphaModifier;
+
+    const SpanSource span = GetTevSource(source);
+
+    switch (modifier) {
+    case AlphaModifier::SourceAlpha:
+    default:
+        return {span, 3, false};
+
+    case AlphaModifier::OneMinusSourceAlpha:
+        return {span, 3, true};
+
+    case AlphaModifier::SourceRed:
+        return {span, 0, false};
+
+    case AlphaModifier::OneMinusSourceRed:
+        return {span, 0, true};
+
+    case AlphaModifier::SourceGreen:
+        return {span, 1, false};
+
+    case AlphaModifier::OneMinusSourceGreen:
+        return {span, 1, true};
+
+    case AlphaModifier::SourceBlue:
+        return {span, 2, false};
+
+    case AlphaModifier::OneMinusSourceBlue:
+        return {span, 2, true};
+    }
+}
+
+PixelPipeline::ChannelInput PixelPipeline::GetBlendFactor(unsigned channel,
+                                                          FramebufferRegs::BlendFactor factor) {
+    DEBUG_ASSERT(channel < 4);
+
+    const u8 index = static_cast<u8>(channel);
+
+    switch (factor) {
+    case FramebufferRegs::BlendFactor::Zero:
+        return {SpanSource::Zero, index, false};
+
+    case FramebufferRegs::BlendFactor::One:
+        return {SpanSource::One, index, false};
+
+    case FramebufferRegs::BlendFactor::SourceColor:
+        return {SpanSource::Previous, index, false};
+
+    case FramebufferRegs::BlendFactor::OneMinusSourceColor:
+        return {SpanSource::Previous, index, true};
+
+    case FramebufferRegs::BlendFactor::DestColor:
+        return {SpanSource::Dest, index, false};
+
+    case FramebufferRegs::BlendFactor::OneMinusDestColor:
+        return {SpanSource::Dest, index, true};
+
+    case FramebufferRegs::BlendFactor::SourceAlpha:
+        return {SpanSource::Previous, 3, false};
+
+    case FramebufferRegs::BlendFactor::OneMinusSourceAlpha:
+        return {SpanSource::Previous, 3, true};
+
+    case FramebufferRegs::BlendFactor::DestAlpha:
+        return {SpanSource::Dest, 3, false};
+
+    case FramebufferRegs::BlendFactor::OneMinusDestAlpha:
+        return {SpanSource::Dest, 3, true};
+
+    case FramebufferRegs::BlendFactor::ConstantColor:
+        return {SpanSource::BlendConstant, index, false};
+
+    case FramebufferRegs::BlendFactor::OneMinusConstantColor:
+        return {SpanSource::BlendConstant, index, true};
+
+    case FramebufferRegs::BlendFactor::ConstantAlpha:
+        return {SpanSource::BlendConstant, 3, false};
+
+    case FramebufferRegs::BlendFactor::OneMinusConstantAlpha:
+        return {SpanSource::BlendConstant, 3, true};
+
+    case FramebufferRegs::BlendFactor::SourceAlphaSaturate:
+        // Returns 1.0 for the alpha channel
+        if (channel == 3)
+            return {SpanSource::One, 3, false};
+        return {SpanSource::AlphaSaturate, 0, false};
+
+    default:
+        LOG_CRITICAL(HW_GPU, "Unknown blend factor %x", static_cast<u32>(factor));
+        UNIMPLEMENTED();
+        return {SpanSource::Previous, index, false};
+    }
+}
+
+PixelPipeline::PixelPipeline(const PixelPipelineConfig& config) {
+    const auto& state = config.state;
+
+    for (unsigned index = 0; index < tev_stages.size(); ++index) {
+        const auto tev_stage = static_cast<TexturingRegs::TevStageConfig>(state.tev_stages[index]);
+        auto& stage = tev_stages[index];
+
+        stage.color_inputs = {{
+            GetColorInput(tev_stage.color_source1, tev_stage.color_modifier1),
+            GetColorInput(tev_stage.color_source2, tev_stage.color_modifier2),
+            GetColorInput(tev_stage.color_source3, tev_stage.color_modifier3),
+        }};
+        stage.color_op = tev_stage.color_op;
+
+        // The alpha combiner is unused for Dot3_RGBA, which also places its result in alpha
+        if (stage.color_op == Operation::Dot3_RGBA) {
+            stage.alpha_inputs = {{
+                {SpanSource::Zero, 3, false},
+                {SpanSource::Zero, 3, false},
+                {SpanSource::Zero, 3, false},
+            }};
+        } else {
+            stage.alpha_inputs = {{
+                GetAlphaInput(tev_stage.alpha_source1, tev_stage.alpha_modifier1),
+                GetAlphaInput(tev_stage.alpha_source2, tev_stage.alpha_modifier2),
+                GetAlphaInput(tev_stage.alpha_source3, tev_stage.alpha_modifier3),
+            }};
+        }
+        stage.alpha_op = tev_stage.alpha_op;
+
+        stage.color_multiplier = tev_stage.GetColorMultiplier();
+        stage.alpha_multiplier = tev_stage.GetAlphaMultiplier();
+
+        stage.uses_constant = false;
+        for (unsigned i = 0; i < 3; ++i) {
+            for (SpanSource source : {stage.color_inputs[i].source, stage.alpha_inputs[i].source}) {
+                if (source == SpanSource::Constant)
+                    stage.uses_constant = true;
+                if (source == SpanSource::PreviousBuffer)
+                    uses_combiner_buffer = true;
+            }
+        }
+
+        const auto& color_in = stage.color_inputs[0];
+        const auto& alpha_in = stage.alpha_inputs[0];
+        stage.passthrough =
+            stage.color_op == Operation::Replace && color_in.source == SpanSource::Previous &&
+            color_in.channels == std::array<u8, 3>{{0, 1, 2}} && !color_in.invert &&
+            stage.alpha_op == Operation::Replace && alpha_in.source == SpanSource::Previous &&
+            alpha_in.channel == 3 && !alpha_in.invert && stage.color_multiplier == 1 &&
+            stage.alpha_multiplier == 1;
+
+        stage.update_buffer_color = index < 4 && (state.combiner_buffer_update_rgb & (1 << index));
+        stage.update_buffer_alpha = index < 4 && (state.combiner_buffer_update_a & (1 << index));
+    }
+
+    if (state.alpha_test_enable)
+        alpha_test = GetCompareFunction(state.alpha_test_func);
+
+    fog_enable = state.fog_mode == TexturingRegs::FogMode::Fog;
+    fog_flip = state.fog_flip;
+
+    stencil_action_enable = state.stencil_action_enable;
+    stencil_test = GetCompareFunction(state.stencil_test_func);
+    stencil_fail_action = state.stencil_fail_action;
+    depth_fail_action = state.depth_fail_action;
+    depth_pass_action = state.depth_pass_action;
+
+    if (state.depth_test_enable)
+        depth_test = GetCompareFunction(state.depth_test_func);
+    const unsigned num_bits = FramebufferRegs::DepthBitsPerPixel(state.depth_format);
+    depth_scale = static_cast<float>((1 << num_bits) - 1);
+    depth_stencil_write_enable = state.depth_stencil_write_enable;
+    depth_write_enable = state.depth_stencil_write_enable && state.depth_write_enable;
+
+    alphablend_enable = state.alphablend_enable;
+    if (alphablend_enable) {
+        for (unsigned channel = 0; channel < 3; ++channel) {
+            blend_equations[channel] = state.blend_equation_rgb;
+            src_factors[channel] = GetBlendFactor(channel, state.factor_source_rgb);
+            dst_factors[channel] = GetBlendFactor(channel, state.factor_dest_rgb);
+        }
+        blend_equations[3] = state.blend_equation_a;
+        src_factors[3] = GetBlendFactor(3, state.factor_source_a);
+        dst_factors[3] = GetBlendFactor(3, state.factor_dest_a);
+
+        for (unsigned channel = 0; channel < 4; ++channel) {
+            for (SpanSource source : {src_factors[channel].source, dst_factors[channel].source}) {
+                if (source == SpanSource::BlendConstant)
+                    uses_blend_constant = true;
+                if (source == SpanSource::AlphaSaturate)
+                    uses_alpha_saturate = true;
+            }
+        }
+    }
+    logic_op = state.logic_op;
+
+    color_write_enable = state.color_write_enable;
+    color_write_mask = state.color_write_mask;
+}
+
+void PixelPipeline::Shade(const FragmentSpan& span, u16 y) const {
+    const auto& regs = g_state.regs;
+    const SpanKernels& kernels = GetSpanKernels();
+    const ColorSpan zero{};
+
+    ColorSpan combiner_output{};
+    ColorSpan combiner_buffer;
+    ColorSpan next_combiner_buffer;
+    ColorSpan constant;
+    ColorSpan dest_color{};
+    ColorSpan blend_const;
+    ColorSpan alpha_saturate;
+
+    std::array<const ColorSpan*, static_cast<size_t>(SpanSource::Count)> spans;
+    auto SetSpan = [&spans](SpanSource source, const ColorSpan& values) {
+        spans[static_cast<size_t>(source)] = &values;
+    };
+    SetSpan(SpanSource::Zero, zero);
+    SetSpan(SpanSource::One, GetOneSpan());
+    SetSpan(SpanSource::PrimaryColor, span.primary_color);
+    SetSpan(SpanSource::Texture0, span.texture_color[0]);
+    SetSpan(SpanSource::Texture1, span.texture_color[1]);
+    SetSpan(SpanSource::Texture2, span.texture_color[2]);
+    SetSpan(SpanSource::Texture3, span.texture_color[3]);
+    SetSpan(SpanSource::PreviousBuffer, combiner_buffer);
+    SetSpan(SpanSource::Constant, constant);
+    SetSpan(SpanSource::Previous, combiner_output);
+    SetSpan(SpanSource::Dest, dest_color);
+    SetSpan(SpanSource::BlendConstant, blend_const);
+    SetSpan(SpanSource::AlphaSaturate, alpha_saturate);
+
+    // Returns the selected channel, inverted into the given channel of `temp` if needed
+    auto GetChannel = [&](SpanSource source, u8 channel, bool invert, ColorSpan& temp,
+                          unsigned temp_channel) -> const u16* {
+        const u16* values = spans[static_cast<size_t>(source)]->channels[channel];
+        if (!invert)
+            return values;
+        kernels.invert(temp.channels[temp_channel], values);
+        return temp.channels[temp_channel];
+    };
+
+    // Texture environment - consists of 6 stages of color and alpha combining.
+    //
+    // Color combiners take three input color values from some source (e.g. interpolated
+    // vertex color, texture color, previous stage, etc), perform some very simple
+    // operations on each of them (e.g. inversion) and then calculate the output color
+    // with some basic arithmetic. Alpha combiners can be configured separately but work
+    // analogously.
+    if (uses_combiner_buffer) {
+        combiner_buffer = zero;
+        const auto& buffer_color = regs.texturing.tev_combiner_buffer_color;
+        FillSpan(next_combiner_buffer,
+                 {static_cast<u8>(buffer_color.r), static_cast<u8>(buffer_color.g),
+                  static_cast<u8>(buffer_color.b), static_cast<u8>(buffer_color.a)});
+    }
+
+    const auto regs_tev_stages = regs.texturing.GetTevStages();
+    for (unsigned tev_stage_index = 0; tev_stage_index < tev_stages.size(); ++tev_stage_index) {
+        const auto& stage = tev_stages[tev_stage_index];
+
+        if (!stage.passthrough) {
+            if (stage.uses_constant) {
+                const auto& regs_stage = regs_tev_stages[tev_stage_index];
+                FillSpan(constant, {static_cast<u8>(regs_stage.const_r),
+                                    static_cast<u8>(regs_stage.const_g),
+                                    static_cast<u8>(regs_stage.const_b),
+                                    static_cast<u8>(regs_stage.const_a)});
+            }
+
+            // Inverted inputs, the color combiner uses the rgb channels and the alpha combiner
+            // the alpha channel of each
+            ColorSpan modified[3];
+
+            // color combiner
+            // NOTE: Not sure if the alpha combiner might use the color output of the previous
+            //       stage as input. Hence, we currently don't directly write the result to
+            //       combiner_output.rgb(), but instead store it in a temporary variable until
+            //       alpha combining has been done.
+            const u16* color_input[3][3];
+            for (unsigned i = 0; i < 3; ++i) {
+                const auto& input = stage.color_inputs[i];
+                for (unsigned channel = 0; channel < 3; ++channel) {
+                    // Replicated channels only need to be inverted once
+                    if (channel > 0 && input.channels[channel] == input.channels[0]) {
+                        color_input[i][channel] = color_input[i][0];
+                        continue;
+                    }
+                    color_input[i][channel] = GetChannel(
+                        input.source, input.channels[channel], input.invert, modified[i], channel);
+                }
+            }
+
+            ColorSpan stage_output;
+            const u16* color_output[3];
+            if (stage.color_op == Operation::Dot3_RGB || stage.color_op == Operation::Dot3_RGBA) {
+                kernels.dot3(stage_output.channels[0], color_input[0], color_input[1]);
+                color_output[0] = color_output[1] = color_output[2] = stage_output.channels[0];
+            } else {
+                for (unsigned i = 0; i < 3; ++i) {
+                    kernels.combine(stage.color_op, stage_output.channels[i], color_input[0][i],
+                                    color_input[1][i], color_input[2][i]);
+                    color_output[i] = stage_output.channels[i];
+                }
+            }
+
+            const u16* alpha_output;
+            if (stage.color_op == Operation::Dot3_RGBA) {
+                // result of Dot3_RGBA operation is also placed to the alpha component
+                alpha_output = color_output[0];
+            } else {
+                // alpha combiner
+                const u16* alpha_input[3];
+                for (unsigned i = 0; i < 3; ++i) {
+                    const auto& input = stage.alpha_inputs[i];
+                    alpha_input[i] =
+                        GetChannel(input.source, input.channel, input.invert, modified[i], 3);
+                }
+                kernels.combine(stage.alpha_op, stage_output.channels[3], alpha_input[0],
+                                alpha_input[1], alpha_input[2]);
+                alpha_output = stage_output.channels[3];
+            }
+
+            for (unsigned i = 0; i < 3; ++i) {
+                kernels.scale(combiner_output.channels[i], color_output[i],
+                              stage.color_multiplier);
+            }
+            kernels.scale(combiner_output.channels[3], alpha_output, stage.alpha_multiplier);
+        }
+
+        if (uses_combiner_buffer) {
+            combiner_buffer = next_combiner_buffer;
+
+            if (stage.update_buffer_color) {
+                std::copy(&combiner_output.channels[0][0], &combiner_output.channels[3][0],
+                          &next_combiner_buffer.channels[0][0]);
+            }
+
+            if (stage.update_buffer_alpha) {
+                std::copy(std::begin(combiner_output.channels[3]),
+                          std::end(combiner_output.channels[3]), next_combiner_buffer.channels[3]);
+            }
+        }
+    }
+
+    const auto& output_merger = regs.framebuffer.output_merger;
+
+    // Whether each fragment has passed all tests so far
+    bool alive[SPAN_SIZE];
+    for (unsigned i = 0; i < SPAN_SIZE; ++i) {
+        alive[i] = i < span.count;
+    }
+
+    // TODO: Does alpha testing happen before or after stencil?
+    if (alpha_test != nullptr) {
+        const u32 ref = output_merger.alpha_test.ref;
+        for (unsigned i = 0; i < span.count; ++i) {
+            alive[i] = alpha_test(combiner_output.channels[3][i], ref);
+        }
+    }
+
+    // Apply fog combiner
+    // Not fully accurate. We'd have to know what data type is used to
+    // store the depth etc. Using float for now until we know more
+    // about Pica datatypes
+    if (fog_enable) {
+        const Math::Vec3<u8> fog_color = {
+            static_cast<u8>(regs.texturing.fog_color.r.Value()),
+            static_cast<u8>(regs.texturing.fog_color.g.Value()),
+            static_cast<u8>(regs.texturing.fog_color.b.Value()),
+        };
+
+        float fog_factor[SPAN_SIZE];
+        for (unsigned i = 0; i < SPAN_SIZE; ++i) {
+            // Get index into fog LUT
+            float fog_index;
+            if (fog_flip) {
+                fog_index = (1.0f - span.depth[i]) * 128.0f;
+            } else {
+                fog_index = span.depth[i] * 128.0f;
+            }
+
+            // Generate clamped fog factor from LUT for given fog index
+            float fog_i = MathUtil::Clamp(floorf(fog_index), 0.0f, 127.0f);
+            float fog_f = fog_index - fog_i;
+            const auto& fog_lut_entry = g_state.fog.lut[static_cast<unsigned int>(fog_i)];
+            fog_factor[i] = fog_lut_entry.ToFloat() + fog_lut_entry.DiffToFloat() * fog_f;
+            fog_factor[i] = MathUtil::Clamp(fog_factor[i], 0.0f, 1.0f);
+        }
+
+        // Blend the fog
+        for (unsigned i = 0; i < 3; i++) {
+            kernels.fog(combiner_output.channels[i], fog_factor, fog_color[i]);
+        }
+    }
+
+    const auto stencil_test_regs = output_merger.stencil_test;
+    const u8 stencil_ref = static_cast<u8>(stencil_test_regs.reference_value);
+    const u8 stencil_input_mask = static_cast<u8>(stencil_test_regs.input_mask);
+    const u8 stencil_write_mask = static_cast<u8>(stencil_test_regs.write_mask);
+
+    for (unsigned i = 0; i < span.count; ++i) {
+        if (!alive[i])
+            continue;
+
+        // Fragments which fail one of the tests below are discarded
+        alive[i] = false;
+
+        const u16 x = span.x[i];
+        u8 old_stencil = 0;
+
+        auto UpdateStencil = [&](FramebufferRegs::StencilAction action) {
+            u8 new_stencil = PerformStencilAction(action, old_stencil, stencil_ref);
+            if (depth_stencil_write_enable)
+                SetStencil(x >> 4, y >> 4, (new_stencil & stencil_write_mask) |
+                                               (old_stencil & ~stencil_write_mask));
+        };
+
+        if (stencil_action_enable) {
+            old_stencil = GetStencil(x >> 4, y >> 4);
+            u8 dest = old_stencil & stencil_input_mask;
+            u8 ref = stencil_ref & stencil_input_mask;
+
+            if (!stencil_test(ref, dest)) {
+                UpdateStencil(stencil_fail_action);
+                continue;
+            }
+        }
+
+        // Convert float to integer
+        u32 z = (u32)(span.depth[i] * depth_scale);
+
+        if (depth_test != nullptr) {
+            u32 ref_z = GetDepth(x >> 4, y >> 4);
+
+            if (!depth_test(z, ref_z)) {
+                if (stencil_action_enable)
+                    UpdateStencil(depth_fail_action);
+                continue;
+            }
+        }
+
+        if (depth_write_enable)
+            SetDepth(x >> 4, y >> 4, z);
+
+        // The stencil depth_pass action is executed even if depth testing is disabled
+        if (stencil_action_enable)
+            UpdateStencil(depth_pass_action);
+
+        alive[i] = true;
+        const auto pixel = GetPixel(x >> 4, y >> 4);
+        for (unsigned channel = 0; channel < 4; ++channel) {
+            dest_color.channels[channel][i] = pixel[channel];
+        }
+    }
+
+    if (!color_write_enable)
+        return;
+
+    ColorSpan blend_output;
+
+    if (alphablend_enable) {
+        if (uses_blend_constant) {
+            FillSpan(blend_const, {
+                                      static_cast<u8>(output_merger.blend_const.r),
+                                      static_cast<u8>(output_merger.blend_const.g),
+                                      static_cast<u8>(output_merger.blend_const.b),
+                                      static_cast<u8>(output_merger.blend_const.a),
+                                  });
+        }
+
+        if (uses_alpha_saturate) {
+            kernels.invert(alpha_saturate.channels[0], dest_color.channels[3]);
+            kernels.min(alpha_saturate.channels[0], combiner_output.channels[3],
+                        alpha_saturate.channels[0]);
+        }
+
+        ColorSpan src_factor_temp, dst_factor_temp;
+        for (unsigned channel = 0; channel < 4; ++channel) {
+            const auto& src_factor = src_factors[channel];
+            const auto& dst_factor = dst_factors[channel];
+            kernels.blend(blend_equations[channel], blend_output.channels[channel],
+                          combiner_output.channels[channel],
+                          GetChannel(src_factor.source, src_factor.channel, src_factor.invert,
+                                     src_factor_temp, channel),
+                          dest_color.channels[channel],
+                          GetChannel(dst_factor.source, dst_factor.channel, dst_factor.invert,
+                                     dst_factor_temp, channel));
+        }
+    } else {
+        for (unsigned i = 0; i < span.count; ++i) {
+            for (unsigned channel = 0; channel < 4; ++channel) {
+                blend_output.channels[channel][i] =
+                    LogicOp(static_cast<u8>(combiner_output.channels[channel][i]),
+                            static_cast<u8>(dest_color.channels[channel][i]), logic_op);
+            }
+        }
+    }
+
+    for (unsigned i = 0; i < span.count; ++i) {
+        if (!alive[i])
+            continue;
+
+        Math::Vec4<u8> result;
+        for (unsigned channel = 0; channel < 4; ++channel) {
+            const auto& source = color_write_mask[channel] ? blend_output : dest_color;
+            result[channel] = static_cast<u8>(source.channels[channel][i]);
+        }
+
+        DrawPixel(span.x[i] >> 4, y >> 4, result);
+    }
+}
+
+namespace {
+std::mutex pipeline_cache_mutex;
+std::unordered_map<PixelPipelineConfig, std::unique_ptr<PixelPipeline>> pipeline_cache;
+} // anonymous namespace
+
+const PixelPipeline& GetPixelPipeline(const Regs& regs) {
+    const auto config = PixelPipelineConfig::BuildFromRegs(regs);
+
+    // Consecutive triangles almost always share their state, so each thread remembers the last
+    // pipeline it used to avoid taking the lock
+    thread_local PixelPipelineConfig last_config;
+    thread_local const PixelPipeline* last_pipeline = nullptr;
+    if (last_pipeline != nullptr && config == last_config)
+        return *last_pipeline;
+
+    std::lock_guard<std::mutex> lock(pipeline_cache_mutex);
+    auto& pipeline = pipeline_cache[config];
+    if (pipeline == nullptr)
+        pipeline = std::make_unique<PixelPipeline>(config);
+
+    last_config = config;
+    last_pipeline = pipeline.get();
+    return *pipeline;
+}
+
+} // namespace Rasterizer
+} // namespace Pica
@@ -0,0 +1,231 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include "common/common_types.h"
+#include "common/hash.h"
+#include "video_core/regs.h"
+#include "video_core/swrasterizer/span_kernels.h"
+
+namespace Pica {
+namespace Rasterizer {
+
+/// Fragments of a single row which are covered by a triangle and are shaded together
+struct FragmentSpan {
+    unsigned count = 0;
+    /// Horizontal sample positions in 12.4 fixed point
+    u16 x[SPAN_SIZE];
+    float depth[SPAN_SIZE];
+    ColorSpan primary_color;
+    ColorSpan texture_color[4];
+};
+
+/**
+ * This struct contains all Pica state which determines the structure of the pixel pipeline and is
+ * used as the cache key for compiled pipelines, similar to GLShader::PicaShaderConfig. Values which
+ * only feed into the computations (constant colors, reference values and masks) are not part of
+ * it and are read from the registers while shading, so changing them doesn't require a new
+ * pipeline.
+ *
+ * A union is used so that copies and comparisons include the padding bytes, see PicaShaderConfig.
+ */
+union PixelPipelineConfig {
+
+    /// Construct a PixelPipelineConfig with the given Pica register configuration.
+    static PixelPipelineConfig BuildFromRegs(const Regs& regs);
+
+    bool operator==(const PixelPipelineConfig& o) const {
+        return std::memcmp(&state, &o.state, sizeof(PixelPipelineConfig::State)) == 0;
+    };
+
+    /// TevStageConfig without the constant color, see PicaShaderConfig::TevStageConfigRaw
+    struct TevStageConfigRaw {
+        u32 sources_raw;
+        u32 modifiers_raw;
+        u32 ops_raw;
+        u32 scales_raw;
+        explicit operator TexturingRegs::TevStageConfig() const noexcept {
+            TexturingRegs::TevStageConfig stage;
+            stage.sources_raw = sources_raw;
+            stage.modifiers_raw = modifiers_raw;
+            stage.ops_raw = ops_raw;
+            stage.const_color = 0;
+            stage.scales_raw = scales_raw;
+            return stage;
+        }
+    };
+
+    struct State {
+        std::array<TevStageConfigRaw, 6> tev_stages;
+        u8 combiner_buffer_update_rgb;
+        u8 combiner_buffer_update_a;
+
+        TexturingRegs::FogMode fog_mode;
+        bool fog_flip;
+
+        bool alpha_test_enable;
+        FramebufferRegs::CompareFunc alpha_test_func;
+
+        bool stencil_action_enable;
+        FramebufferRegs::CompareFunc stencil_test_func;
+        FramebufferRegs::StencilAction stencil_fail_action;
+        FramebufferRegs::StencilAction depth_fail_action;
+        FramebufferRegs::StencilAction depth_pass_action;
+
+        bool depth_test_enable;
+        FramebufferRegs::CompareFunc depth_test_func;
+        FramebufferRegs::DepthFormat depth_format;
+
+        bool depth_stencil_write_enable;
+        bool depth_write_enable;
+
+        bool alphablend_enable;
+        FramebufferRegs::BlendEquation blend_equation_rgb;
+        FramebufferRegs::BlendEquation blend_equation_a;
+        FramebufferRegs::BlendFactor factor_source_rgb;
+        FramebufferRegs::BlendFactor factor_dest_rgb;
+        FramebufferRegs::BlendFactor factor_source_a;
+        FramebufferRegs::BlendFactor factor_dest_a;
+        FramebufferRegs::LogicOp logic_op;
+
+        bool color_write_enable;
+        std::array<bool, 4> color_write_mask;
+    } state;
+};
+#if (__GNUC__ >= 5) || defined(__clang__) || defined(_MSC_VER)
+static_assert(std::is_trivially_copyable<PixelPipelineConfig::State>::value,
+              "PixelPipelineConfig::State must be trivially copyable");
+#endif
+
+/**
+ * Texture environment, fog and per-fragment operations specialized for one PixelPipelineConfig.
+ * Register fields which select sources, operations and tests are decoded once when the pipeline
+ * is compiled, so shading a span only has to follow the precomputed selections.
+ */
+class PixelPipeline {
+public:
+    explicit PixelPipeline(const PixelPipelineConfig& config);
+
+    /**
+     * Shades all fragments of the span and writes the results to the framebuffer. All fragments
+     * of a span belong to row `y` (12.4 fixed point).
+     */
+    void Shade(const FragmentSpan& span, u16 y) const;
+
+private:
+    /// Spans available as inputs while shading
+    enum class SpanSource : u8 {
+        Zero,
+        One,
+        PrimaryColor,
+        Texture0,
+        Texture1,
+        Texture2,
+        Texture3,
+        PreviousBuffer,
+        Constant,
+        Previous,
+        Dest,
+        BlendConstant,
+        /// min(source alpha, 1 - dest alpha) in the first channel
+        AlphaSaturate,
+        Count,
+    };
+
+    /// Channels of a span selected by a TEV color modifier
+    struct ColorInput {
+        SpanSource source;
+        std::array<u8, 3> channels;
+        bool invert;
+    };
+
+    /// Single channel of a span, selected by a TEV alpha modifier or a blend factor
+    struct ChannelInput {
+        SpanSource source;
+        u8 channel;
+        bool invert;
+    };
+
+    struct TevStage {
+        std::array<ColorInput, 3> color_inputs;
+        std::array<ChannelInput, 3> alpha_inputs;
+        TexturingRegs::TevStageConfig::Operation color_op;
+        TexturingRegs::TevStageConfig::Operation alpha_op;
+        unsigned color_multiplier;
+        unsigned alpha_multiplier;
+        bool uses_constant;
+        /// Whether the stage leaves the combiner output unchanged
+        bool passthrough;
+        bool update_buffer_color;
+        bool update_buffer_alpha;
+    };
+
+    using CompareFunction = bool (*)(u32 lhs, u32 rhs);
+
+    static CompareFunction GetCompareFunction(FramebufferRegs::CompareFunc func);
+    static SpanSource GetTevSource(TexturingRegs::TevStageConfig::Source source);
+    static ColorInput GetColorInput(TexturingRegs::TevStageConfig::Source source,
+                                    TexturingRegs::TevStageConfig::ColorModifier modifier);
+    static ChannelInput GetAlphaInput(TexturingRegs::TevStageConfig::Source source,
+                                      TexturingRegs::TevStageConfig::AlphaModifier modifier);
+    static ChannelInput GetBlendFactor(unsigned channel, FramebufferRegs::BlendFactor factor);
+
+    std::array<TevStage, 6> tev_stages;
+    /// Whether any stage reads the combiner buffer, which otherwise doesn't need to be tracked
+    bool uses_combiner_buffer = false;
+
+    /// nullptr if the alpha test is disabled
+    CompareFunction alpha_test = nullptr;
+
+    bool fog_enable;
+    bool fog_flip;
+
+    bool stencil_action_enable;
+    CompareFunction stencil_test;
+    FramebufferRegs::StencilAction stencil_fail_action;
+    FramebufferRegs::StencilAction depth_fail_action;
+    FramebufferRegs::StencilAction depth_pass_action;
+
+    /// nullptr if the depth test is disabled
+    CompareFunction depth_test = nullptr;
+    /// Largest value representable in the depth buffer
+    float depth_scale;
+    bool depth_stencil_write_enable;
+    bool depth_write_enable;
+
+    bool alphablend_enable;
+    std::array<FramebufferRegs::BlendEquation, 4> blend_equations;
+    std::array<ChannelInput, 4> src_factors;
+    std::array<ChannelInput, 4> dst_factors;
+    bool uses_blend_constant = false;
+    bool uses_alpha_saturate = false;
+    FramebufferRegs::LogicOp logic_op;
+
+    bool color_write_enable;
+    std::array<bool, 4> color_write_mask;
+};
+
+/**
+ * Returns the pixel pipeline for the given register state, compiling it if it isn't cached yet.
+ * May be called from multiple threads at once, the returned pipelines are never destroyed.
+ */
+const PixelPipeline& GetPixelPipeline(const Regs& regs);
+
+} // namespace Rasterizer
+} // namespace Pica
+
+namespace std {
+template <>
+struct hash<Pica::Rasterizer::PixelPipelineConfig> {
+    size_t operator()(const Pica::Rasterizer::PixelPipelineConfig& k) const {
+        return Common::ComputeHash64(&k.state,
+                                     sizeof(Pica::Rasterizer::PixelPipelineConfig::State));
+    }
+};
+} // namespace std
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include "common/common_types.h"
+#include "common/math_util.h"
 #include "video_core/shader/shader.h"
 
 namespace Pica {
@@ -45,6 +47,19 @@ struct Vertex : Shader::OutputVertex {
 
 void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2);
 
+/**
+ * Rasterizes only the pixels of the given triangle which lie inside clip_rect.
+ * @param clip_rect Region in whole pixels of rasterizer coordinates, right and bottom exclusive.
+ */
+void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2,
+                     const MathUtil::Rectangle<u16>& clip_rect);
+
+/**
+ * Returns the region which ProcessTriangle scans for the given triangle, in whole pixels of
+ * rasterizer coordinates with right and bottom exclusive.
+ */
+MathUtil::Rectangle<u16> GetTriangleBounds(const Vertex& v0, const Vertex& v1, const Vertex& v2);
+
 } // namespace Rasterizer
 
 } // namespace Pica
@@ -0,0 +1,184 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/math_util.h"
+#include "video_core/swrasterizer/span_kernels.h"
+
+#ifdef ARCHITECTURE_x86_64
+#include "common/x64/cpu_detect.h"
+#endif
+
+namespace Pica {
+namespace Rasterizer {
+
+namespace {
+
+using Operation = TexturingRegs::TevStageConfig::Operation;
+using BlendEquation = FramebufferRegs::BlendEquation;
+
+void Invert(u16* dst, const u16* src) {
+    for (size_t i = 0; i < SPAN_SIZE; ++i) {
+        dst[i] = 255 - src[i];
+    }
+}
+
+void Min(u16* dst, const u16* a, const u16* b) {
+    for (size_t i = 0; i < SPAN_SIZE; ++i) {
+        dst[i] = std::min(a[i], b[i]);
+    }
+}
+
+void Combine(Operation op, u16* dst, const u16* in0, const u16* in1, const u16* in2) {
+    switch (op) {
+    case Operation::Replace:
+        std::copy(in0, in0 + SPAN_SIZE, dst);
+        break;
+
+    case Operation::Modulate:
+        for (size_t i = 0; i < SPAN_SIZE; ++i) {
+            dst[i] = in0[i] * in1[i] / 255;
+        }
+        break;
+
+    case Operation::Add:
+        for (size_t i = 0; i < SPAN_SIZE; ++i) {
+            dst[i] = std::min(255, in0[i] + in1[i]);
+        }
+        break;
+
+    case Operation::AddSigned:
+        // TODO(bunnei): Verify that the color conversion from (float) 0.5f to
+        // (byte) 128 is correct
+        for (size_t i = 0; i < SPAN_SIZE; ++i) {
+            dst[i] = MathUtil::Clamp<int>(in0[i] + in1[i] - 128, 0, 255);
+        }
+        break;
+
+    case Operation::Lerp:
+        for (size_t i = 0; i < SPAN_SIZE; ++i) {
+            dst[i] = (in0[i] * in2[i] + in1[i] * (255 - in2[i])) / 255;
+        }
+        break;
+
+    case Operation::Subtract:
+        for (size_t i = 0; i < SPAN_SIZE; ++i) {
+            dst[i] = std::max(0, in0[i] - in1[i]);
+        }
+        break;
+
+    case Operation::MultiplyThenAdd:
+        for (size_t i = 0; i < SPAN_SIZE; ++i) {
+            dst[i] = std::min(255, (in0[i] * in1[i] + 255 * in2[i]) / 255);
+        }
+        break;
+
+    case Operation::AddThenMultiply:
+        for (size_t i = 0; i < SPAN_SIZE; ++i) {
+            dst[i] = std::min(255, in0[i] + in1[i]) * in2[i] / 255;
+        }
+        break;
+
+    default:
+        LOG_ERROR(HW_GPU, "Unknown combiner operation %d", static_cast<int>(op));
+        UNIMPLEMENTED();
+        std::fill(dst, dst + SPAN_SIZE, 0);
+        break;
+    }
+}
+
+void Dot3(u16* dst, const u16* const in0[3], const u16* const in1[3]) {
+    // Not fully accurate.  Worst case scenario seems to yield a +/-3 error.  Some HW results
+    // indicate that the per-component computation can't have a higher precision than 1/256,
+    // while dot3_rgb((0x80,g0,b0), (0x7F,g1,b1)) and dot3_rgb((0x80,g0,b0), (0x80,g1,b1)) give
+    // different results.
+    for (size_t i = 0; i < SPAN_SIZE; ++i) {
+        int result = 0;
+        for (size_t c = 0; c < 3; ++c) {
+            result += ((in0[c][i] * 2 - 255) * (in1[c][i] * 2 - 255) + 128) / 256;
+        }
+        dst[i] = MathUtil::Clamp(result, 0, 255);
+    }
+}
+
+void Scale(u16* dst, const u16* src, unsigned multiplier) {
+    for (size_t i = 0; i < SPAN_SIZE; ++i) {
+        dst[i] = std::min(255u, src[i] * multiplier);
+    }
+}
+
+void Fog(u16* dst, const float* factor, u16 fog_color) {
+    for (size_t i = 0; i < SPAN_SIZE; ++i) {
+        dst[i] = static_cast<u8>(factor[i] * dst[i] + (1.0f - factor[i]) * fog_color);
+    }
+}
+
+void Blend(BlendEquation equation, u16* dst, const u16* src, const u16* src_factor,
+           const u16* dest, const u16* dest_factor) {
+    for (size_t i = 0; i < SPAN_SIZE; ++i) {
+        const int src_result = src[i] * src_factor[i];
+        const int dst_result = dest[i] * dest_factor[i];
+        int result;
+
+        switch (equation) {
+        case BlendEquation::Add:
+            result = (src_result + dst_result) / 255;
+            break;
+
+        case BlendEquation::Subtract:
+            result = (src_result - dst_result) / 255;
+            break;
+
+        case BlendEquation::ReverseSubtract:
+            result = (dst_result - src_result) / 255;
+            break;
+
+        // TODO: How do these two actually work?  OpenGL doesn't include the blend factors in the
+        //       min/max computations, but is this what the 3DS actually does?
+        case BlendEquation::Min:
+            result = std::min(src[i], dest[i]);
+            break;
+
+        case BlendEquation::Max:
+            result = std::max(src[i], dest[i]);
+            break;
+
+        default:
+            LOG_CRITICAL(HW_GPU, "Unknown RGB blend equation %x", static_cast<u32>(equation));
+            UNIMPLEMENTED();
+            result = 0;
+            break;
+        }
+
+        dst[i] = MathUtil::Clamp(result, 0, 255);
+    }
+}
+
+} // anonymous namespace
+
+const SpanKernels& GetGenericSpanKernels() {
+    static const SpanKernels kernels = {Invert, Min, Combine, Dot3, Scale, Fog, Blend};
+    return kernels;
+}
+
+const SpanKernels& GetSpanKernels() {
+#ifdef ARCHITECTURE_x86_64
+    static const SpanKernels& kernels = []() -> const SpanKernels& {
+        const auto& caps = Common::GetCPUCaps();
+        if (caps.avx2)
+            return GetAVX2SpanKernels();
+        if (caps.sse4_1)
+            return GetSSE41SpanKernels();
+        return GetGenericSpanKernels();
+    }();
+    return kernels;
+#else
+    return GetGenericSpanKernels();
+#endif
+}
+
+} // namespace Rasterizer
+} // namespace Pica
@@ -0,0 +1,69 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include "common/common_types.h"
+#include "video_core/regs_framebuffer.h"
+#include "video_core/regs_texturing.h"
+
+namespace Pica {
+namespace Rasterizer {
+
+/// Number of fragments processed together by the span kernels
+constexpr size_t SPAN_SIZE = 16;
+
+/**
+ * Colors of a span of fragments, stored as one array per channel (r, g, b, a) so that channel
+ * swizzles are free and each operation applies to all fragments at once. Values are in the range
+ * [0, 255], widened to 16 bits to leave room for intermediate products.
+ */
+struct ColorSpan {
+    alignas(32) u16 channels[4][SPAN_SIZE];
+};
+
+/**
+ * Operations applied to all SPAN_SIZE lanes of their arguments at once. All of them produce
+ * results identical to the per-fragment functions in texturing.h and framebuffer.h. Arguments are
+ * pointers to arrays of SPAN_SIZE elements aligned like ColorSpan::channels and may alias.
+ */
+struct SpanKernels {
+    /// dst = 255 - src
+    void (*invert)(u16* dst, const u16* src);
+
+    /// dst = min(a, b)
+    void (*min)(u16* dst, const u16* a, const u16* b);
+
+    /// Single channel of a TEV combiner operation, equivalent to ColorCombine/AlphaCombine
+    void (*combine)(TexturingRegs::TevStageConfig::Operation op, u16* dst, const u16* in0,
+                    const u16* in1, const u16* in2);
+
+    /// Dot3_RGB/Dot3_RGBA combiner operation on the channels of the first two inputs
+    void (*dot3)(u16* dst, const u16* const in0[3], const u16* const in1[3]);
+
+    /// dst = min(255, src * multiplier), with multiplier being 1, 2 or 4
+    void (*scale)(u16* dst, const u16* src, unsigned multiplier);
+
+    /// dst = (u8)(factor * dst + (1 - factor) * fog_color)
+    void (*fog)(u16* dst, const float* factor, u16 fog_color);
+
+    /// Single channel of EvaluateBlendEquation
+    void (*blend)(FramebufferRegs::BlendEquation equation, u16* dst, const u16* src,
+                  const u16* src_factor, const u16* dest, const u16* dest_factor);
+};
+
+/// Returns the span kernels best suited for the host CPU
+const SpanKernels& GetSpanKernels();
+
+/// Returns the portable span kernels, which serve as reference for the optimized ones
+const SpanKernels& GetGenericSpanKernels();
+
+#ifdef ARCHITECTURE_x86_64
+const SpanKernels& GetSSE41SpanKernels();
+const SpanKernels& GetAVX2SpanKernels();
+#endif
+
+} // namespace Rasterizer
+} // namespace Pica
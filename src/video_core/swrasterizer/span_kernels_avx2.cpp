@@ -0,0 +1,122 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+// This file is compiled with AVX2 code generation enabled, see video_core/CMakeLists.txt
+
+#include <immintrin.h>
+#include "video_core/swrasterizer/span_kernels_x64.h"
+
+namespace Pica {
+namespace Rasterizer {
+
+namespace {
+
+struct AVX2Ops {
+    using Vector = __m256i;
+    using Wide = __m256i;
+    using Float = __m256;
+    static constexpr size_t LANES = 16;
+
+    static Vector Load(const u16* src) {
+        return _mm256_load_si256(reinterpret_cast<const __m256i*>(src));
+    }
+    static void Store(u16* dst, Vector v) {
+        _mm256_store_si256(reinterpret_cast<__m256i*>(dst), v);
+    }
+    static Vector Set1(u16 value) {
+        return _mm256_set1_epi16(static_cast<short>(value));
+    }
+    static Vector Add(Vector a, Vector b) {
+        return _mm256_add_epi16(a, b);
+    }
+    static Vector Sub(Vector a, Vector b) {
+        return _mm256_sub_epi16(a, b);
+    }
+    static Vector SubSat(Vector a, Vector b) {
+        return _mm256_subs_epu16(a, b);
+    }
+    static Vector Mul(Vector a, Vector b) {
+        return _mm256_mullo_epi16(a, b);
+    }
+    static Vector Min(Vector a, Vector b) {
+        return _mm256_min_epu16(a, b);
+    }
+    static Vector Max(Vector a, Vector b) {
+        return _mm256_max_epu16(a, b);
+    }
+    template <int count>
+    static Vector ShiftRight(Vector v) {
+        return _mm256_srli_epi16(v, count);
+    }
+
+    static Wide WidenLow(Vector v) {
+        return _mm256_cvtepu16_epi32(_mm256_castsi256_si128(v));
+    }
+    static Wide WidenHigh(Vector v) {
+        return _mm256_cvtepu16_epi32(_mm256_extracti128_si256(v, 1));
+    }
+    static Vector Narrow(Wide low, Wide high) {
+        // packus works within each 128-bit half, restore the element order afterwards
+        return _mm256_permute4x64_epi64(_mm256_packus_epi32(low, high), 0xD8);
+    }
+    static Wide Set1Wide(s32 value) {
+        return _mm256_set1_epi32(value);
+    }
+    static Wide AddWide(Wide a, Wide b) {
+        return _mm256_add_epi32(a, b);
+    }
+    static Wide SubWide(Wide a, Wide b) {
+        return _mm256_sub_epi32(a, b);
+    }
+    static Wide MulWide(Wide a, Wide b) {
+        return _mm256_mullo_epi32(a, b);
+    }
+    static Wide MinWide(Wide a, Wide b) {
+        return _mm256_min_epi32(a, b);
+    }
+    static Wide MaxWide(Wide a, Wide b) {
+        return _mm256_max_epi32(a, b);
+    }
+    static Wide AndWide(Wide a, Wide b) {
+        return _mm256_and_si256(a, b);
+    }
+    static Wide CompareGreaterWide(Wide a, Wide b) {
+        return _mm256_cmpgt_epi32(a, b);
+    }
+    template <int count>
+    static Wide ShiftRightArithWide(Wide v) {
+        return _mm256_srai_epi32(v, count);
+    }
+
+    static Float LoadFloat(const float* src) {
+        return _mm256_loadu_ps(src);
+    }
+    static Float Set1Float(float value) {
+        return _mm256_set1_ps(value);
+    }
+    static Float AddFloat(Float a, Float b) {
+        return _mm256_add_ps(a, b);
+    }
+    static Float SubFloat(Float a, Float b) {
+        return _mm256_sub_ps(a, b);
+    }
+    static Float MulFloat(Float a, Float b) {
+        return _mm256_mul_ps(a, b);
+    }
+    static Float ToFloat(Wide v) {
+        return _mm256_cvtepi32_ps(v);
+    }
+    static Wide TruncateToWide(Float v) {
+        return _mm256_cvttps_epi32(v);
+    }
+};
+
+} // anonymous namespace
+
+const SpanKernels& GetAVX2SpanKernels() {
+    return X64SpanKernels<AVX2Ops>::Get();
+}
+
+} // namespace Rasterizer
+} // namespace Pica
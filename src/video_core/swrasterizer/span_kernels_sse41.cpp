@@ -0,0 +1,121 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+// This file is compiled with SSE4.1 code generation enabled, see video_core/CMakeLists.txt
+
+#include <smmintrin.h>
+#include "video_core/swrasterizer/span_kernels_x64.h"
+
+namespace Pica {
+namespace Rasterizer {
+
+namespace {
+
+struct SSE41Ops {
+    using Vector = __m128i;
+    using Wide = __m128i;
+    using Float = __m128;
+    static constexpr size_t LANES = 8;
+
+    static Vector Load(const u16* src) {
+        return _mm_load_si128(reinterpret_cast<const __m128i*>(src));
+    }
+    static void Store(u16* dst, Vector v) {
+        _mm_store_si128(reinterpret_cast<__m128i*>(dst), v);
+    }
+    static Vector Set1(u16 value) {
+        return _mm_set1_epi16(static_cast<short>(value));
+    }
+    static Vector Add(Vector a, Vector b) {
+        return _mm_add_epi16(a, b);
+    }
+    static Vector Sub(Vector a, Vector b) {
+        return _mm_sub_epi16(a, b);
+    }
+    static Vector SubSat(Vector a, Vector b) {
+        return _mm_subs_epu16(a, b);
+    }
+    static Vector Mul(Vector a, Vector b) {
+        return _mm_mullo_epi16(a, b);
+    }
+    static Vector Min(Vector a, Vector b) {
+        return _mm_min_epu16(a, b);
+    }
+    static Vector Max(Vector a, Vector b) {
+        return _mm_max_epu16(a, b);
+    }
+    template <int count>
+    static Vector ShiftRight(Vector v) {
+        return _mm_srli_epi16(v, count);
+    }
+
+    static Wide WidenLow(Vector v) {
+        return _mm_cvtepu16_epi32(v);
+    }
+    static Wide WidenHigh(Vector v) {
+        return _mm_cvtepu16_epi32(_mm_unpackhi_epi64(v, v));
+    }
+    static Vector Narrow(Wide low, Wide high) {
+        return _mm_packus_epi32(low, high);
+    }
+    static Wide Set1Wide(s32 value) {
+        return _mm_set1_epi32(value);
+    }
+    static Wide AddWide(Wide a, Wide b) {
+        return _mm_add_epi32(a, b);
+    }
+    static Wide SubWide(Wide a, Wide b) {
+        return _mm_sub_epi32(a, b);
+    }
+    static Wide MulWide(Wide a, Wide b) {
+        return _mm_mullo_epi32(a, b);
+    }
+    static Wide MinWide(Wide a, Wide b) {
+        return _mm_min_epi32(a, b);
+    }
+    static Wide MaxWide(Wide a, Wide b) {
+        return _mm_max_epi32(a, b);
+    }
+    static Wide AndWide(Wide a, Wide b) {
+        return _mm_and_si128(a, b);
+    }
+    static Wide CompareGreaterWide(Wide a, Wide b) {
+        return _mm_cmpgt_epi32(a, b);
+    }
+    template <int count>
+    static Wide ShiftRightArithWide(Wide v) {
+        return _mm_srai_epi32(v, count);
+    }
+
+    static Float LoadFloat(const float* src) {
+        return _mm_loadu_ps(src);
+    }
+    static Float Set1Float(float value) {
+        return _mm_set1_ps(value);
+    }
+    static Float AddFloat(Float a, Float b) {
+        return _mm_add_ps(a, b);
+    }
+    static Float SubFloat(Float a, Float b) {
+        return _mm_sub_ps(a, b);
+    }
+    static Float MulFloat(Float a, Float b) {
+        return _mm_mul_ps(a, b);
+    }
+    static Float ToFloat(Wide v) {
+        return _mm_cvtepi32_ps(v);
+    }
+    static Wide TruncateToWide(Float v) {
+        return _mm_cvttps_epi32(v);
+    }
+};
+
+} // anonymous namespace
+
+const SpanKernels& GetSSE41SpanKernels() {
+    return X64SpanKernels<SSE41Ops>::Get();
+}
+
+} // namespace Rasterizer
+} // namespace Pica
@@ -0,0 +1,255 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+// Vectorized span kernels, written against a small set of vector operations (`Ops`) so the same
+// code serves both the SSE4.1 and the AVX2 variant. This header is only meant to be included by
+// the translation units compiled for the respective instruction set. Everything is kept in an
+// anonymous namespace so that code built for different instruction sets can't get merged at link
+// time.
+//
+// Ops has to provide:
+//  - Vector: vector of Ops::LANES unsigned 16-bit lanes, operated on by Load, Store, Set1, Add,
+//    Sub, SubSat (unsigned saturating), Mul (low 16 bits), Min, Max (unsigned) and ShiftRight<n>.
+//  - Wide: vector of Ops::LANES / 2 signed 32-bit lanes, produced by WidenLow/WidenHigh and turned
+//    back into a Vector with Narrow. Operated on by Set1Wide, AddWide, SubWide, MulWide, MinWide,
+//    MaxWide, AndWide, CompareGreaterWide, ShiftRightArithWide<n>.
+//  - Float: vector of Ops::LANES / 2 floats, operated on by LoadFloat, Set1Float, AddFloat,
+//    SubFloat, MulFloat, ToFloat and TruncateToWide.
+
+#include <cstddef>
+#include "common/common_types.h"
+#include "video_core/swrasterizer/span_kernels.h"
+
+namespace Pica {
+namespace Rasterizer {
+
+namespace {
+
+template <typename Ops>
+struct X64SpanKernels {
+    using V = typename Ops::Vector;
+    using W = typename Ops::Wide;
+    using F = typename Ops::Float;
+    using Operation = TexturingRegs::TevStageConfig::Operation;
+    using BlendEquation = FramebufferRegs::BlendEquation;
+
+    static constexpr size_t LANES = Ops::LANES;
+    static_assert(SPAN_SIZE % LANES == 0, "Span size must be a multiple of the vector size");
+
+    /// Exact x / 255 for 0 <= x <= 65025
+    static V Div255(V x) {
+        return Ops::template ShiftRight<8>(
+            Ops::Add(Ops::Add(x, Ops::Set1(1)), Ops::template ShiftRight<8>(x)));
+    }
+
+    /// Exact x / 255 for 0 <= x <= 2 * 65025
+    static W Div255Wide(W x) {
+        // The estimate is off by at most one, which is fixed by checking the remainder
+        W q = Ops::template ShiftRightArithWide<8>(Ops::AddWide(
+            Ops::AddWide(x, Ops::Set1Wide(1)), Ops::template ShiftRightArithWide<8>(x)));
+        const W r = Ops::SubWide(x, Ops::MulWide(q, Ops::Set1Wide(255)));
+        // The comparison yields -1 in lanes where the remainder is too large
+        return Ops::SubWide(q, Ops::CompareGreaterWide(r, Ops::Set1Wide(254)));
+    }
+
+    /// x / 256 rounded towards zero, like C++ integer division
+    static W Div256Wide(W x) {
+        const W bias = Ops::AndWide(Ops::template ShiftRightArithWide<31>(x), Ops::Set1Wide(255));
+        return Ops::template ShiftRightArithWide<8>(Ops::AddWide(x, bias));
+    }
+
+    static W ClampWide(W x) {
+        return Ops::MinWide(Ops::MaxWide(x, Ops::Set1Wide(0)), Ops::Set1Wide(255));
+    }
+
+    static void Invert(u16* dst, const u16* src) {
+        const V max = Ops::Set1(255);
+        for (size_t i = 0; i < SPAN_SIZE; i += LANES) {
+            Ops::Store(dst + i, Ops::Sub(max, Ops::Load(src + i)));
+        }
+    }
+
+    static void Min(u16* dst, const u16* a, const u16* b) {
+        for (size_t i = 0; i < SPAN_SIZE; i += LANES) {
+            Ops::Store(dst + i, Ops::Min(Ops::Load(a + i), Ops::Load(b + i)));
+        }
+    }
+
+    template <typename Func>
+    static void ForEachVector(u16* dst, const u16* in0, const u16* in1, const u16* in2,
+                              Func func) {
+        for (size_t i = 0; i < SPAN_SIZE; i += LANES) {
+            Ops::Store(dst + i, func(Ops::Load(in0 + i), Ops::Load(in1 + i), Ops::Load(in2 + i)));
+        }
+    }
+
+    static void Combine(Operation op, u16* dst, const u16* in0, const u16* in1, const u16* in2) {
+        const V max = Ops::Set1(255);
+
+        switch (op) {
+        case Operation::Replace:
+            ForEachVector(dst, in0, in1, in2, [](V a, V b, V c) { return a; });
+            break;
+
+        case Operation::Modulate:
+            ForEachVector(dst, in0, in1, in2, [](V a, V b, V c) { return Div255(Ops::Mul(a, b)); });
+            break;
+
+        case Operation::Add:
+            ForEachVector(dst, in0, in1, in2,
+                          [max](V a, V b, V c) { return Ops::Min(Ops::Add(a, b), max); });
+            break;
+
+        case Operation::AddSigned: {
+            const V half = Ops::Set1(128);
+            ForEachVector(dst, in0, in1, in2, [max, half](V a, V b, V c) {
+                return Ops::Min(Ops::SubSat(Ops::Add(a, b), half), max);
+            });
+            break;
+        }
+
+        case Operation::Lerp:
+            ForEachVector(dst, in0, in1, in2, [max](V a, V b, V c) {
+                return Div255(Ops::Add(Ops::Mul(a, c), Ops::Mul(b, Ops::Sub(max, c))));
+            });
+            break;
+
+        case Operation::Subtract:
+            ForEachVector(dst, in0, in1, in2, [](V a, V b, V c) { return Ops::SubSat(a, b); });
+            break;
+
+        case Operation::MultiplyThenAdd:
+            // (a * b + 255 * c) / 255 == a * b / 255 + c
+            ForEachVector(dst, in0, in1, in2, [max](V a, V b, V c) {
+                return Ops::Min(Ops::Add(Div255(Ops::Mul(a, b)), c), max);
+            });
+            break;
+
+        case Operation::AddThenMultiply:
+            ForEachVector(dst, in0, in1, in2, [max](V a, V b, V c) {
+                return Div255(Ops::Mul(Ops::Min(Ops::Add(a, b), max), c));
+            });
+            break;
+
+        default:
+            GetGenericSpanKernels().combine(op, dst, in0, in1, in2);
+            break;
+        }
+    }
+
+    static W Dot3Half(const V in0[3], const V in1[3], bool high) {
+        const W one_minus = Ops::Set1Wide(255);
+        W result = Ops::Set1Wide(0);
+        for (size_t c = 0; c < 3; ++c) {
+            const W a = high ? Ops::WidenHigh(in0[c]) : Ops::WidenLow(in0[c]);
+            const W b = high ? Ops::WidenHigh(in1[c]) : Ops::WidenLow(in1[c]);
+            const W product = Ops::MulWide(Ops::SubWide(Ops::AddWide(a, a), one_minus),
+                                           Ops::SubWide(Ops::AddWide(b, b), one_minus));
+            result = Ops::AddWide(result, Div256Wide(Ops::AddWide(product, Ops::Set1Wide(128))));
+        }
+        return ClampWide(result);
+    }
+
+    static void Dot3(u16* dst, const u16* const in0[3], const u16* const in1[3]) {
+        for (size_t i = 0; i < SPAN_SIZE; i += LANES) {
+            const V a[3] = {Ops::Load(in0[0] + i), Ops::Load(in0[1] + i), Ops::Load(in0[2] + i)};
+            const V b[3] = {Ops::Load(in1[0] + i), Ops::Load(in1[1] + i), Ops::Load(in1[2] + i)};
+            Ops::Store(dst + i, Ops::Narrow(Dot3Half(a, b, false), Dot3Half(a, b, true)));
+        }
+    }
+
+    static void Scale(u16* dst, const u16* src, unsigned multiplier) {
+        const V max = Ops::Set1(255);
+        const V factor = Ops::Set1(static_cast<u16>(multiplier));
+        for (size_t i = 0; i < SPAN_SIZE; i += LANES) {
+            Ops::Store(dst + i, Ops::Min(Ops::Mul(Ops::Load(src + i), factor), max));
+        }
+    }
+
+    static W FogHalf(W color, F factor, F fog_color) {
+        // Evaluated in the same order as the scalar code to get bit-identical results
+        const F one = Ops::Set1Float(1.0f);
+        return Ops::TruncateToWide(
+            Ops::AddFloat(Ops::MulFloat(factor, Ops::ToFloat(color)),
+                          Ops::MulFloat(Ops::SubFloat(one, factor), fog_color)));
+    }
+
+    static void Fog(u16* dst, const float* factor, u16 fog_color) {
+        const F fog = Ops::Set1Float(static_cast<float>(fog_color));
+        for (size_t i = 0; i < SPAN_SIZE; i += LANES) {
+            const V color = Ops::Load(dst + i);
+            const W low = FogHalf(Ops::WidenLow(color), Ops::LoadFloat(factor + i), fog);
+            const W high =
+                FogHalf(Ops::WidenHigh(color), Ops::LoadFloat(factor + i + LANES / 2), fog);
+            // Conversion to u8 in the scalar code keeps the lowest 8 bits
+            Ops::Store(dst + i, Ops::Narrow(Ops::AndWide(low, Ops::Set1Wide(0xFF)),
+                                            Ops::AndWide(high, Ops::Set1Wide(0xFF))));
+        }
+    }
+
+    static W BlendHalf(BlendEquation equation, W src, W src_factor, W dest, W dest_factor) {
+        const W src_result = Ops::MulWide(src, src_factor);
+        const W dst_result = Ops::MulWide(dest, dest_factor);
+        W result;
+        if (equation == BlendEquation::Add) {
+            result = Ops::AddWide(src_result, dst_result);
+        } else if (equation == BlendEquation::Subtract) {
+            result = Ops::SubWide(src_result, dst_result);
+        } else {
+            result = Ops::SubWide(dst_result, src_result);
+        }
+        // Negative results get clamped to zero either way, so they don't need to be divided
+        return Ops::MinWide(Div255Wide(Ops::MaxWide(result, Ops::Set1Wide(0))),
+                            Ops::Set1Wide(255));
+    }
+
+    static void Blend(BlendEquation equation, u16* dst, const u16* src, const u16* src_factor,
+                      const u16* dest, const u16* dest_factor) {
+        switch (equation) {
+        case BlendEquation::Add:
+        case BlendEquation::Subtract:
+        case BlendEquation::ReverseSubtract:
+            for (size_t i = 0; i < SPAN_SIZE; i += LANES) {
+                const V s = Ops::Load(src + i);
+                const V sf = Ops::Load(src_factor + i);
+                const V d = Ops::Load(dest + i);
+                const V df = Ops::Load(dest_factor + i);
+                const W low = BlendHalf(equation, Ops::WidenLow(s), Ops::WidenLow(sf),
+                                        Ops::WidenLow(d), Ops::WidenLow(df));
+                const W high = BlendHalf(equation, Ops::WidenHigh(s), Ops::WidenHigh(sf),
+                                         Ops::WidenHigh(d), Ops::WidenHigh(df));
+                Ops::Store(dst + i, Ops::Narrow(low, high));
+            }
+            break;
+
+        case BlendEquation::Min:
+            for (size_t i = 0; i < SPAN_SIZE; i += LANES) {
+                Ops::Store(dst + i, Ops::Min(Ops::Load(src + i), Ops::Load(dest + i)));
+            }
+            break;
+
+        case BlendEquation::Max:
+            for (size_t i = 0; i < SPAN_SIZE; i += LANES) {
+                Ops::Store(dst + i, Ops::Max(Ops::Load(src + i), Ops::Load(dest + i)));
+            }
+            break;
+
+        default:
+            GetGenericSpanKernels().blend(equation, dst, src, src_factor, dest, dest_factor);
+            break;
+        }
+    }
+
+    static const SpanKernels& Get() {
+        static const SpanKernels kernels = {Invert, Min, Combine, Dot3, Scale, Fog, Blend};
+        return kernels;
+    }
+};
+
+} // anonymous namespace
+
+} // namespace Rasterizer
+} // namespace Pica
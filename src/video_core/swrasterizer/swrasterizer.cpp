@@ -2,14 +2,86 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <thread>
+#include "core/settings.h"
+#include "video_core/pica_state.h"
+#include "video_core/regs_framebuffer.h"
 #include "video_core/swrasterizer/clipper.h"
+#include "video_core/swrasterizer/rasterizer.h"
 #include "video_core/swrasterizer/swrasterizer.h"
+#include "video_core/swrasterizer/texture_cache.h"
+#include "video_core/swrasterizer/tile_binner.h"
 
 namespace VideoCore {
 
+SWRasterizer::SWRasterizer() {
+    unsigned num_threads = Settings::values.sw_rasterizer_threads;
+    if (num_threads == 0)
+        num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    if (num_threads > 1)
+        binner = std::make_unique<Pica::Rasterizer::TileBinner>(num_threads);
+}
+
+SWRasterizer::~SWRasterizer() {
+    // Releases the pages marked as cached by decoded textures
+    Pica::Rasterizer::ClearDecodedTextures();
+}
+
 void SWRasterizer::AddTriangle(const Pica::Shader::OutputVertex& v0,
                                const Pica::Shader::OutputVertex& v1,
                                const Pica::Shader::OutputVertex& v2) {
-    Pica::Clipper::ProcessTriangle(v0, v1, v2);
+    if (!binner) {
+        Pica::Clipper::ProcessTriangle(v0, v1, v2);
+        return;
+    }
+
+    using Pica::Rasterizer::Vertex;
+    Pica::Clipper::ProcessTriangle(
+        v0, v1, v2, [this](const Vertex& vtx0, const Vertex& vtx1, const Vertex& vtx2) {
+            binner->AddTriangle(vtx0, vtx1, vtx2);
+        });
+}
+
+void SWRasterizer::DrawTriangles() {
+    FlushAll();
+
+    // The framebuffer is written without going through Memory, so textures decoded from it (when
+    // rendering to a texture) have to be discarded here
+    const auto& framebuffer = Pica::g_state.regs.framebuffer.framebuffer;
+    const u32 num_pixels = framebuffer.GetWidth() * framebuffer.GetHeight();
+    if (framebuffer.allow_color_write != 0) {
+        Pica::Rasterizer::InvalidateDecodedTextures(
+            framebuffer.GetColorBufferPhysicalAddress(),
+            num_pixels * Pica::FramebufferRegs::BytesPerColorPixel(framebuffer.color_format));
+    }
+    if (framebuffer.allow_depth_stencil_write != 0) {
+        Pica::Rasterizer::InvalidateDecodedTextures(
+            framebuffer.GetDepthBufferPhysicalAddress(),
+            num_pixels * Pica::FramebufferRegs::BytesPerDepthPixel(framebuffer.depth_format));
+    }
+}
+
+void SWRasterizer::NotifyPicaRegisterChanged(u32 id) {
+    // This is called after the register has been written. Queued triangles are drawn with the
+    // register state of their draw call, which works because a draw call's own trigger register is
+    // reported here right after its triangles have been queued: the binner is always empty by the
+    // time any other register changes.
+    FlushAll();
+}
+
+void SWRasterizer::FlushAll() {
+    if (binner)
+        binner->Flush();
+}
+
+void SWRasterizer::FlushRegion(PAddr addr, u32 size) {
+    FlushAll();
+}
+
+void SWRasterizer::FlushAndInvalidateRegion(PAddr addr, u32 size) {
+    FlushAll();
+    Pica::Rasterizer::InvalidateDecodedTextures(addr, size);
 }
 }
@@ -0,0 +1,84 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "core/memory.h"
+#include "video_core/swrasterizer/texture_cache.h"
+
+namespace Pica {
+namespace Rasterizer {
+
+MICROPROFILE_DEFINE(GPU_TextureDecode, "GPU", "Texture Decode", MP_RGB(100, 100, 255));
+
+using TextureKey = std::tuple<PAddr, TexturingRegs::TextureFormat, unsigned int, unsigned int>;
+
+static std::mutex texture_cache_mutex;
+static std::map<TextureKey, std::unique_ptr<DecodedTexture>> texture_cache;
+
+static std::unique_ptr<DecodedTexture> DecodeTexture(const Texture::TextureInfo& info) {
+    MICROPROFILE_SCOPE(GPU_TextureDecode);
+
+    auto texture = std::make_unique<DecodedTexture>();
+    texture->info = info;
+    texture->size = static_cast<u32>(info.stride * ((info.height + 7) / 8));
+    texture->texels.resize(info.width * info.height);
+
+    const u8* source = Memory::GetPhysicalPointer(info.physical_address);
+    if (source == nullptr) {
+        LOG_ERROR(HW_GPU, "Texture at invalid address 0x%08x", info.physical_address);
+        texture->memory_marked = false;
+        return texture;
+    }
+
+    Texture::DecodeTexture(source, info, texture->texels.data());
+
+    texture->memory_marked = texture->size != 0;
+    if (texture->memory_marked)
+        Memory::RasterizerMarkRegionCached(info.physical_address, texture->size, 1);
+    return texture;
+}
+
+static void UnmarkTexture(const DecodedTexture& texture) {
+    if (texture.memory_marked)
+        Memory::RasterizerMarkRegionCached(texture.info.physical_address, texture.size, -1);
+}
+
+const DecodedTexture& GetDecodedTexture(const Texture::TextureInfo& info) {
+    const TextureKey key{info.physical_address, info.format, info.width, info.height};
+
+    std::lock_guard<std::mutex> lock(texture_cache_mutex);
+    auto& texture = texture_cache[key];
+    if (texture == nullptr)
+        texture = DecodeTexture(info);
+    return *texture;
+}
+
+void InvalidateDecodedTextures(PAddr address, u32 size) {
+    std::lock_guard<std::mutex> lock(texture_cache_mutex);
+    for (auto it = texture_cache.begin(); it != texture_cache.end();) {
+        const DecodedTexture& texture = *it->second;
+        const PAddr texture_address = texture.info.physical_address;
+        if (texture_address < address + size && address < texture_address + texture.size) {
+            UnmarkTexture(texture);
+            it = texture_cache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ClearDecodedTextures() {
+    std::lock_guard<std::mutex> lock(texture_cache_mutex);
+    for (const auto& entry : texture_cache)
+        UnmarkTexture(*entry.second);
+    texture_cache.clear();
+}
+
+} // namespace Rasterizer
+} // namespace Pica
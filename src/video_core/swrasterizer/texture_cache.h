@@ -0,0 +1,45 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <vector>
+#include "common/common_types.h"
+#include "common/vector_math.h"
+#include "video_core/texture/texture_decode.h"
+
+namespace Pica {
+namespace Rasterizer {
+
+/// A texture decoded to RGBA8, which can be sampled without going through emulated memory
+struct DecodedTexture {
+    Texture::TextureInfo info;
+    /// Size in bytes of the encoded texture in emulated memory
+    u32 size;
+    /// Whether the pages holding the texture are marked as cached
+    bool memory_marked;
+    /// Texel (s, t) is stored at texels[t * info.width + s]
+    std::vector<Math::Vec4<u8>> texels;
+
+    /// Returns the same texel as Texture::LookupTexture(data, s, t, info)
+    Math::Vec4<u8> Lookup(unsigned int s, unsigned int t) const {
+        return texels[t * info.width + s];
+    }
+};
+
+/**
+ * Returns the decoded texture described by info, decoding it if it isn't cached yet. The pages
+ * of cached textures are marked as cached by the rasterizer, so writes to them invalidate the
+ * texture through InvalidateDecodedTextures. May be called from several threads at once.
+ */
+const DecodedTexture& GetDecodedTexture(const Texture::TextureInfo& info);
+
+/// Discards all decoded textures overlapping the given region
+void InvalidateDecodedTextures(PAddr address, u32 size);
+
+/// Discards all decoded textures
+void ClearDecodedTextures();
+
+} // namespace Rasterizer
+} // namespace Pica
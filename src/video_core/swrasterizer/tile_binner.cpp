@@ -0,0 +1,97 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/microprofile.h"
+#include "video_core/pica_state.h"
+#include "video_core/regs_framebuffer.h"
+#include "video_core/swrasterizer/tile_binner.h"
+
+namespace Pica {
+namespace Rasterizer {
+
+// Tile edge length in pixels. Being a multiple of 8 keeps each tile made up of whole 8x8 blocks of
+// the swizzled framebuffer, so threads don't touch the same cache lines much.
+constexpr unsigned TILE_SIZE = 32;
+
+MICROPROFILE_DEFINE(GPU_TileBinning, "GPU", "Tile Binning", MP_RGB(50, 50, 200));
+
+TileBinner::TileBinner(size_t num_threads) : thread_pool(num_threads - 1, "SWRasterizer") {}
+
+void TileBinner::AddTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2) {
+    const auto bounds = GetTriangleBounds(v0, v1, v2);
+
+    // Pixels outside of the framebuffer are written to memory belonging to other pixels, in which
+    // case the result depends on the order of the writes and the batch is drawn serially.
+    const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
+    if (bounds.right > framebuffer.GetWidth() || bounds.bottom > framebuffer.GetHeight())
+        parallel_safe = false;
+
+    triangles.push_back({v0, v1, v2, bounds});
+}
+
+void TileBinner::Flush() {
+    if (triangles.empty())
+        return;
+
+    if (!parallel_safe || thread_pool.GetThreadCount() == 1) {
+        FlushSerial();
+        return;
+    }
+
+    const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
+    const unsigned tiles_x = (framebuffer.GetWidth() + TILE_SIZE - 1) / TILE_SIZE;
+    const unsigned tiles_y = (framebuffer.GetHeight() + TILE_SIZE - 1) / TILE_SIZE;
+
+    {
+        MICROPROFILE_SCOPE(GPU_TileBinning);
+
+        if (bins.size() < tiles_x * tiles_y)
+            bins.resize(tiles_x * tiles_y);
+
+        for (u32 index = 0; index < triangles.size(); ++index) {
+            const auto& bounds = triangles[index].bounds;
+            if (bounds.left >= bounds.right || bounds.top >= bounds.bottom)
+                continue;
+
+            for (unsigned y = bounds.top / TILE_SIZE; y <= (bounds.bottom - 1u) / TILE_SIZE; ++y) {
+                for (unsigned x = bounds.left / TILE_SIZE; x <= (bounds.right - 1u) / TILE_SIZE;
+                     ++x) {
+                    const u32 tile = y * tiles_x + x;
+                    if (bins[tile].empty())
+                        active_tiles.push_back(tile);
+                    bins[tile].push_back(index);
+                }
+            }
+        }
+    }
+
+    thread_pool.ParallelFor(active_tiles.size(), [&](size_t i) {
+        const u32 tile = active_tiles[i];
+        const u16 left = static_cast<u16>(tile % tiles_x * TILE_SIZE);
+        const u16 top = static_cast<u16>(tile / tiles_x * TILE_SIZE);
+        const MathUtil::Rectangle<u16> clip_rect(left, top, left + TILE_SIZE, top + TILE_SIZE);
+
+        for (u32 index : bins[tile]) {
+            const auto& triangle = triangles[index];
+            ProcessTriangle(triangle.v0, triangle.v1, triangle.v2, clip_rect);
+        }
+    });
+
+    for (u32 tile : active_tiles) {
+        bins[tile].clear();
+    }
+    active_tiles.clear();
+    triangles.clear();
+}
+
+void TileBinner::FlushSerial() {
+    for (const auto& triangle : triangles) {
+        ProcessTriangle(triangle.v0, triangle.v1, triangle.v2);
+    }
+    triangles.clear();
+    parallel_safe = true;
+}
+
+} // namespace Rasterizer
+} // namespace Pica
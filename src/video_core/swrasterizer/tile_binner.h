@@ -0,0 +1,58 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "common/common_types.h"
+#include "common/math_util.h"
+#include "common/thread_pool.h"
+#include "video_core/swrasterizer/rasterizer.h"
+
+namespace Pica {
+namespace Rasterizer {
+
+/**
+ * Defers rasterization of the triangles it is given, sorts them into screen-space tiles and
+ * rasterizes the tiles in parallel. Within a tile, triangles are processed in the order in which
+ * they were added, so depth, stencil and blending results are identical to rasterizing the
+ * triangles one after another.
+ *
+ * The queued triangles are rasterized using the Pica state at the time Flush is called, hence
+ * the owner needs to flush before any register affecting rasterization is changed.
+ */
+class TileBinner {
+public:
+    /// @param num_threads Total number of host threads used to rasterize, including the caller.
+    explicit TileBinner(size_t num_threads);
+
+    void AddTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2);
+
+    /// Rasterizes all queued triangles and returns once they have been written to memory.
+    void Flush();
+
+private:
+    struct Triangle {
+        Vertex v0, v1, v2;
+        MathUtil::Rectangle<u16> bounds;
+    };
+
+    /// Rasterizes all queued triangles on the calling thread.
+    void FlushSerial();
+
+    std::vector<Triangle> triangles;
+    /// Whether all queued triangles stay within the framebuffer and may be drawn in parallel
+    bool parallel_safe = true;
+
+    /// Indices into `triangles` for each tile, row-major
+    std::vector<std::vector<u32>> bins;
+    /// Tiles which have at least one triangle in the current batch
+    std::vector<u32> active_tiles;
+
+    Common::ThreadPool thread_pool;
+};
+
+} // namespace Rasterizer
+} // namespace Pica
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <array>
+#include <cstddef>
 #include "common/bit_field.h"
 #include "common/color.h"
 #include "common/common_types.h"
@@ -109,6 +110,52 @@ union ETC1Tile {
 
         return ret.Cast<u8>();
     }
+
+    /// Decodes all texels of the subtile, equivalent to calling GetRGB for each of them
+    void Decode(Math::Vec4<u8>* output, ptrdiff_t stride) const {
+        // Base colors and modifier tables of the left/top (0) and right/bottom (1) halves
+        std::array<Math::Vec3<int>, 2> base;
+        const std::array<unsigned, 2> table_index = {
+            {static_cast<unsigned>(table_index_1.Value()),
+             static_cast<unsigned>(table_index_2.Value())}};
+
+        if (differential_mode) {
+            const Math::Vec3<int> base_5 = {static_cast<int>(differential.r),
+                                            static_cast<int>(differential.g),
+                                            static_cast<int>(differential.b)};
+            const Math::Vec3<int> delta = {static_cast<int>(differential.dr),
+                                           static_cast<int>(differential.dg),
+                                           static_cast<int>(differential.db)};
+            for (size_t half = 0; half < 2; ++half) {
+                const Math::Vec3<int> value = half == 0 ? base_5 : base_5 + delta;
+                base[half] = {Color::Convert5To8(value.r()), Color::Convert5To8(value.g()),
+                              Color::Convert5To8(value.b())};
+            }
+        } else {
+            base[0] = {Color::Convert4To8(static_cast<u8>(separate.r1)),
+                       Color::Convert4To8(static_cast<u8>(separate.g1)),
+                       Color::Convert4To8(static_cast<u8>(separate.b1))};
+            base[1] = {Color::Convert4To8(static_cast<u8>(separate.r2)),
+                       Color::Convert4To8(static_cast<u8>(separate.g2)),
+                       Color::Convert4To8(static_cast<u8>(separate.b2))};
+        }
+
+        for (unsigned int y = 0; y < 4; ++y) {
+            for (unsigned int x = 0; x < 4; ++x) {
+                const unsigned int texel = 4 * x + y;
+                const size_t half = ((flip ? y : x) < 2) ? 0 : 1;
+
+                int modifier = etc1_modifier_table[table_index[half]][GetTableSubIndex(texel)];
+                if (GetNegationFlag(texel))
+                    modifier *= -1;
+
+                output[y * stride + x] = {
+                    static_cast<u8>(MathUtil::Clamp(base[half].r() + modifier, 0, 255)),
+                    static_cast<u8>(MathUtil::Clamp(base[half].g() + modifier, 0, 255)),
+                    static_cast<u8>(MathUtil::Clamp(base[half].b() + modifier, 0, 255)), 255};
+            }
+        }
+    }
 };
 
 } // anonymous namespace
@@ -118,5 +165,10 @@ Math::Vec3<u8> SampleETC1Subtile(u64 value, unsigned int x, unsigned int y) {
     return tile.GetRGB(x, y);
 }
 
+void DecodeETC1Subtile(u64 value, Math::Vec4<u8>* output, ptrdiff_t stride) {
+    ETC1Tile tile{value};
+    tile.Decode(output, stride);
+}
+
 } // namespace Texture
 } // namespace Pica
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include "common/common_types.h"
 #include "common/vector_math.h"
 
@@ -12,5 +13,13 @@ namespace Texture {
 
 Math::Vec3<u8> SampleETC1Subtile(u64 value, unsigned int x, unsigned int y);
 
+/**
+ * Decodes all texels of a 4x4 ETC1 subtile, with full alpha.
+ * @param value Encoded subtile
+ * @param output Texel (x, y) is written to output[y * stride + x]
+ * @param stride Distance between output lines in texels
+ */
+void DecodeETC1Subtile(u64 value, Math::Vec4<u8>* output, ptrdiff_t stride);
+
 } // namespace Texture
 } // namespace Pica
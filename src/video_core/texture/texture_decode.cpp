@@ -2,6 +2,9 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include "common/assert.h"
 #include "common/color.h"
 #include "common/logging/log.h"
@@ -13,6 +16,10 @@
 #include "video_core/texture/texture_decode.h"
 #include "video_core/utils.h"
 
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
+
 using TextureFormat = Pica::TexturingRegs::TextureFormat;
 
 namespace Pica {
@@ -21,6 +28,8 @@ namespace Texture {
 constexpr size_t TILE_SIZE = 8 * 8;
 constexpr size_t ETC1_SUBTILES = 2 * 2;
 
+static_assert(sizeof(Math::Vec4<u8>) == 4, "Decoded texels are expected to be packed RGBA8");
+
 size_t CalculateTileSize(TextureFormat format) {
     switch (format) {
     case TextureFormat::RGBA8:
@@ -212,6 +221,403 @@ Math::Vec4<u8> LookupTexelInTile(const u8* source, unsigned int x, unsigned int
     }
 }
 
+namespace {
+
+/// Decodes the texel with the given index within a tile, in Morton order
+template <TextureFormat format>
+Math::Vec4<u8> DecodeTexel(const u8* source, size_t index);
+
+template <>
+Math::Vec4<u8> DecodeTexel<TextureFormat::RGBA8>(const u8* source, size_t index) {
+    return Color::DecodeRGBA8(source + index * 4);
+}
+
+template <>
+Math::Vec4<u8> DecodeTexel<TextureFormat::RGB8>(const u8* source, size_t index) {
+    return Color::DecodeRGB8(source + index * 3);
+}
+
+template <>
+Math::Vec4<u8> DecodeTexel<TextureFormat::RGB5A1>(const u8* source, size_t index) {
+    return Color::DecodeRGB5A1(source + index * 2);
+}
+
+template <>
+Math::Vec4<u8> DecodeTexel<TextureFormat::RGB565>(const u8* source, size_t index) {
+    return Color::DecodeRGB565(source + index * 2);
+}
+
+template <>
+Math::Vec4<u8> DecodeTexel<TextureFormat::RGBA4>(const u8* source, size_t index) {
+    return Color::DecodeRGBA4(source + index * 2);
+}
+
+template <>
+Math::Vec4<u8> DecodeTexel<TextureFormat::IA8>(const u8* source, size_t index) {
+    const u8* source_ptr = source + index * 2;
+    return {source_ptr[1], source_ptr[1], source_ptr[1], source_ptr[0]};
+}
+
+template <>
+Math::Vec4<u8> DecodeTexel<TextureFormat::RG8>(const u8* source, size_t index) {
+    auto res = Color::DecodeRG8(source + index * 2);
+    return {res.r(), res.g(), 0, 255};
+}
+
+template <>
+Math::Vec4<u8> DecodeTexel<TextureFormat::I8>(const u8* source, size_t index) {
+    return {source[index], source[index], source[index], 255};
+}
+
+template <>
+Math::Vec4<u8> DecodeTexel<TextureFormat::A8>(const u8* source, size_t index) {
+    return {0, 0, 0, source[index]};
+}
+
+template <>
+Math::Vec4<u8> DecodeTexel<TextureFormat::IA4>(const u8* source, size_t index) {
+    const u8 i = Color::Convert4To8((source[index] & 0xF0) >> 4);
+    const u8 a = Color::Convert4To8(source[index] & 0xF);
+    return {i, i, i, a};
+}
+
+template <>
+Math::Vec4<u8> DecodeTexel<TextureFormat::I4>(const u8* source, size_t index) {
+    const u8 i = Color::Convert4To8((source[index / 2] >> (index % 2 * 4)) & 0xF);
+    return {i, i, i, 255};
+}
+
+template <>
+Math::Vec4<u8> DecodeTexel<TextureFormat::A4>(const u8* source, size_t index) {
+    const u8 a = Color::Convert4To8((source[index / 2] >> (index % 2 * 4)) & 0xF);
+    return {0, 0, 0, a};
+}
+
+/// Decodes all texels of a tile to RGBA8, keeping them in Morton order
+template <TextureFormat format>
+void DecodeMortonTexels(const u8* source, Math::Vec4<u8>* output) {
+    for (size_t i = 0; i < TILE_SIZE; ++i) {
+        output[i] = DecodeTexel<format>(source, i);
+    }
+}
+
+#ifdef ARCHITECTURE_x86_64
+
+// The SSE2 versions below decode 8 texels at a time in 16-bit lanes, and then interleave the
+// r | g << 8 and b | a << 8 halves of each texel.
+
+__m128i Load(const u8* source) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+}
+
+void StoreTexels(__m128i rg, __m128i ba, Math::Vec4<u8>* output) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm_unpacklo_epi16(rg, ba));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 4), _mm_unpackhi_epi16(rg, ba));
+}
+
+/// Combines two 8-bit channels held in 16-bit lanes
+__m128i Combine(__m128i low, __m128i high) {
+    return _mm_or_si128(low, _mm_slli_epi16(high, 8));
+}
+
+// Bit replication to 8 bits, as done by Color::ConvertNTo8
+__m128i Convert4To8(__m128i value) {
+    return _mm_or_si128(_mm_slli_epi16(value, 4), value);
+}
+
+__m128i Convert5To8(__m128i value) {
+    return _mm_or_si128(_mm_slli_epi16(value, 3), _mm_srli_epi16(value, 2));
+}
+
+__m128i Convert6To8(__m128i value) {
+    return _mm_or_si128(_mm_slli_epi16(value, 2), _mm_srli_epi16(value, 4));
+}
+
+/// Extracts a channel of the given width and position from 16-bit lanes
+template <int shift, int width>
+__m128i Extract(__m128i value) {
+    const __m128i shifted = shift == 0 ? value : _mm_srli_epi16(value, shift);
+    return shift + width == 16 ? shifted : _mm_and_si128(shifted, _mm_set1_epi16((1 << width) - 1));
+}
+
+/// Decodes 16 texels stored as one byte of intensity (I8) or alpha (A8)
+template <TextureFormat format>
+void Decode16Bytes(__m128i value, Math::Vec4<u8>* output) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i full = _mm_set1_epi8(static_cast<char>(0xFF));
+    if (format == TextureFormat::I8) {
+        StoreTexels(_mm_unpacklo_epi8(value, value), _mm_unpacklo_epi8(value, full), output);
+        StoreTexels(_mm_unpackhi_epi8(value, value), _mm_unpackhi_epi8(value, full), output + 8);
+    } else {
+        StoreTexels(zero, _mm_unpacklo_epi8(zero, value), output);
+        StoreTexels(zero, _mm_unpackhi_epi8(zero, value), output + 8);
+    }
+}
+
+template <>
+void DecodeMortonTexels<TextureFormat::RGBA8>(const u8* source, Math::Vec4<u8>* output) {
+    for (size_t i = 0; i < TILE_SIZE; i += 4) {
+        // Reverse the bytes of each texel: swap the bytes of each 16-bit half, then the halves
+        const __m128i value = Load(source + i * 4);
+        const __m128i swapped = _mm_or_si128(_mm_slli_epi16(value, 8), _mm_srli_epi16(value, 8));
+        const __m128i result = _mm_shufflehi_epi16(
+            _mm_shufflelo_epi16(swapped, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), result);
+    }
+}
+
+template <>
+void DecodeMortonTexels<TextureFormat::RGB5A1>(const u8* source, Math::Vec4<u8>* output) {
+    for (size_t i = 0; i < TILE_SIZE; i += 8) {
+        const __m128i value = Load(source + i * 2);
+        const __m128i r = Convert5To8(Extract<11, 5>(value));
+        const __m128i g = Convert5To8(Extract<6, 5>(value));
+        const __m128i b = Convert5To8(Extract<1, 5>(value));
+        // 0 - 1 sets all bits of the lane
+        const __m128i alpha_mask = _mm_sub_epi16(_mm_setzero_si128(), Extract<0, 1>(value));
+        const __m128i a = _mm_srli_epi16(alpha_mask, 8);
+        StoreTexels(Combine(r, g), Combine(b, a), output + i);
+    }
+}
+
+template <>
+void DecodeMortonTexels<TextureFormat::RGB565>(const u8* source, Math::Vec4<u8>* output) {
+    for (size_t i = 0; i < TILE_SIZE; i += 8) {
+        const __m128i value = Load(source + i * 2);
+        const __m128i r = Convert5To8(Extract<11, 5>(value));
+        const __m128i g = Convert6To8(Extract<5, 6>(value));
+        const __m128i b = Convert5To8(Extract<0, 5>(value));
+        StoreTexels(Combine(r, g), _mm_or_si128(b, _mm_set1_epi16(static_cast<s16>(0xFF00))),
+                    output + i);
+    }
+}
+
+template <>
+void DecodeMortonTexels<TextureFormat::RGBA4>(const u8* source, Math::Vec4<u8>* output) {
+    for (size_t i = 0; i < TILE_SIZE; i += 8) {
+        const __m128i value = Load(source + i * 2);
+        const __m128i r = Convert4To8(Extract<12, 4>(value));
+        const __m128i g = Convert4To8(Extract<8, 4>(value));
+        const __m128i b = Convert4To8(Extract<4, 4>(value));
+        const __m128i a = Convert4To8(Extract<0, 4>(value));
+        StoreTexels(Combine(r, g), Combine(b, a), output + i);
+    }
+}
+
+template <>
+void DecodeMortonTexels<TextureFormat::IA8>(const u8* source, Math::Vec4<u8>* output) {
+    for (size_t i = 0; i < TILE_SIZE; i += 8) {
+        // Alpha is stored in the low byte, intensity in the high byte
+        const __m128i value = Load(source + i * 2);
+        const __m128i intensity = _mm_srli_epi16(value, 8);
+        const __m128i ba = _mm_or_si128(intensity, _mm_slli_epi16(value, 8));
+        StoreTexels(Combine(intensity, intensity), ba, output + i);
+    }
+}
+
+template <>
+void DecodeMortonTexels<TextureFormat::RG8>(const u8* source, Math::Vec4<u8>* output) {
+    for (size_t i = 0; i < TILE_SIZE; i += 8) {
+        // Green is stored in the low byte, red in the high byte
+        const __m128i value = Load(source + i * 2);
+        const __m128i rg = _mm_or_si128(_mm_srli_epi16(value, 8), _mm_slli_epi16(value, 8));
+        StoreTexels(rg, _mm_set1_epi16(static_cast<s16>(0xFF00)), output + i);
+    }
+}
+
+template <>
+void DecodeMortonTexels<TextureFormat::I8>(const u8* source, Math::Vec4<u8>* output) {
+    for (size_t i = 0; i < TILE_SIZE; i += 16) {
+        Decode16Bytes<TextureFormat::I8>(Load(source + i), output + i);
+    }
+}
+
+template <>
+void DecodeMortonTexels<TextureFormat::A8>(const u8* source, Math::Vec4<u8>* output) {
+    for (size_t i = 0; i < TILE_SIZE; i += 16) {
+        Decode16Bytes<TextureFormat::A8>(Load(source + i), output + i);
+    }
+}
+
+template <>
+void DecodeMortonTexels<TextureFormat::IA4>(const u8* source, Math::Vec4<u8>* output) {
+    for (size_t i = 0; i < TILE_SIZE; i += 8) {
+        const __m128i value = _mm_unpacklo_epi8(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(source + i)), _mm_setzero_si128());
+        const __m128i intensity = Convert4To8(Extract<4, 4>(value));
+        const __m128i alpha = Convert4To8(Extract<0, 4>(value));
+        StoreTexels(Combine(intensity, intensity), Combine(intensity, alpha), output + i);
+    }
+}
+
+/// Expands 8 bytes of 4-bit texels (low nibble first) to 16 bytes of 8-bit texels
+__m128i Expand4BitTexels(const u8* source) {
+    const __m128i value = _mm_unpacklo_epi8(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(source)), _mm_setzero_si128());
+    const __m128i texels = Combine(Extract<0, 4>(value), Extract<4, 4>(value));
+    // No carries between the bytes, since each one is below 16
+    return Convert4To8(texels);
+}
+
+template <>
+void DecodeMortonTexels<TextureFormat::I4>(const u8* source, Math::Vec4<u8>* output) {
+    for (size_t i = 0; i < TILE_SIZE; i += 16) {
+        Decode16Bytes<TextureFormat::I8>(Expand4BitTexels(source + i / 2), output + i);
+    }
+}
+
+template <>
+void DecodeMortonTexels<TextureFormat::A4>(const u8* source, Math::Vec4<u8>* output) {
+    for (size_t i = 0; i < TILE_SIZE; i += 16) {
+        Decode16Bytes<TextureFormat::A8>(Expand4BitTexels(source + i / 2), output + i);
+    }
+}
+
+/// Rearranges the texels of a tile from Morton order to lines
+void UnswizzleTile(const Math::Vec4<u8>* morton, Math::Vec4<u8>* output, ptrdiff_t stride) {
+    // Each group of 4 texels in Morton order is a 2x2 block, the blocks making up a pair of lines
+    // start at offsets 0, 4, 16 and 20 from the first one.
+    for (unsigned int y = 0; y < 8; y += 2) {
+        const Math::Vec4<u8>* blocks = morton + VideoCore::MortonInterleave(0, y);
+        const __m128i block0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks));
+        const __m128i block1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + 4));
+        const __m128i block2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + 16));
+        const __m128i block3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + 20));
+
+        __m128i* line0 = reinterpret_cast<__m128i*>(output + y * stride);
+        __m128i* line1 = reinterpret_cast<__m128i*>(output + (y + 1) * stride);
+        _mm_storeu_si128(line0, _mm_unpacklo_epi64(block0, block1));
+        _mm_storeu_si128(line0 + 1, _mm_unpacklo_epi64(block2, block3));
+        _mm_storeu_si128(line1, _mm_unpackhi_epi64(block0, block1));
+        _mm_storeu_si128(line1 + 1, _mm_unpackhi_epi64(block2, block3));
+    }
+}
+
+#else
+
+/// Rearranges the texels of a tile from Morton order to lines
+void UnswizzleTile(const Math::Vec4<u8>* morton, Math::Vec4<u8>* output, ptrdiff_t stride) {
+    for (unsigned int y = 0; y < 8; ++y) {
+        for (unsigned int x = 0; x < 8; x += 2) {
+            // Horizontally adjacent pairs of texels are adjacent in Morton order
+            std::memcpy(output + y * stride + x, morton + VideoCore::MortonInterleave(x, y),
+                        2 * sizeof(Math::Vec4<u8>));
+        }
+    }
+}
+
+#endif
+
+template <TextureFormat format>
+void DecodeTileTexels(const u8* source, Math::Vec4<u8>* output, ptrdiff_t stride) {
+    alignas(16) std::array<Math::Vec4<u8>, TILE_SIZE> morton;
+    DecodeMortonTexels<format>(source, morton.data());
+    UnswizzleTile(morton.data(), output, stride);
+}
+
+void DecodeETC1Tile(const u8* source, bool has_alpha, Math::Vec4<u8>* output, ptrdiff_t stride) {
+    const size_t subtile_size = has_alpha ? 16 : 8;
+
+    // ETC1 further subdivides each 8x8 tile into four 4x4 subtiles
+    for (unsigned int subtile_index = 0; subtile_index < ETC1_SUBTILES; ++subtile_index) {
+        const u8* subtile_ptr = source + subtile_index * subtile_size;
+        Math::Vec4<u8>* subtile_output =
+            output + (subtile_index / 2) * 4 * stride + (subtile_index % 2) * 4;
+
+        u64_le packed_alpha = 0;
+        if (has_alpha) {
+            memcpy(&packed_alpha, subtile_ptr, sizeof(u64));
+            subtile_ptr += sizeof(u64);
+        }
+
+        u64_le subtile_data;
+        memcpy(&subtile_data, subtile_ptr, sizeof(u64));
+        DecodeETC1Subtile(subtile_data, subtile_output, stride);
+
+        if (has_alpha) {
+            for (unsigned int y = 0; y < 4; ++y) {
+                for (unsigned int x = 0; x < 4; ++x) {
+                    subtile_output[y * stride + x].a() =
+                        Color::Convert4To8((packed_alpha >> (4 * (x * 4 + y))) & 0xF);
+                }
+            }
+        }
+    }
+}
+
+} // anonymous namespace
+
+void DecodeTile(const u8* source, TextureFormat format, Math::Vec4<u8>* output,
+                ptrdiff_t stride) {
+    switch (format) {
+    case TextureFormat::RGBA8:
+        return DecodeTileTexels<TextureFormat::RGBA8>(source, output, stride);
+    case TextureFormat::RGB8:
+        return DecodeTileTexels<TextureFormat::RGB8>(source, output, stride);
+    case TextureFormat::RGB5A1:
+        return DecodeTileTexels<TextureFormat::RGB5A1>(source, output, stride);
+    case TextureFormat::RGB565:
+        return DecodeTileTexels<TextureFormat::RGB565>(source, output, stride);
+    case TextureFormat::RGBA4:
+        return DecodeTileTexels<TextureFormat::RGBA4>(source, output, stride);
+    case TextureFormat::IA8:
+        return DecodeTileTexels<TextureFormat::IA8>(source, output, stride);
+    case TextureFormat::RG8:
+        return DecodeTileTexels<TextureFormat::RG8>(source, output, stride);
+    case TextureFormat::I8:
+        return DecodeTileTexels<TextureFormat::I8>(source, output, stride);
+    case TextureFormat::A8:
+        return DecodeTileTexels<TextureFormat::A8>(source, output, stride);
+    case TextureFormat::IA4:
+        return DecodeTileTexels<TextureFormat::IA4>(source, output, stride);
+    case TextureFormat::I4:
+        return DecodeTileTexels<TextureFormat::I4>(source, output, stride);
+    case TextureFormat::A4:
+        return DecodeTileTexels<TextureFormat::A4>(source, output, stride);
+    case TextureFormat::ETC1:
+        return DecodeETC1Tile(source, false, output, stride);
+    case TextureFormat::ETC1A4:
+        return DecodeETC1Tile(source, true, output, stride);
+    default:
+        LOG_ERROR(HW_GPU, "Unknown texture format: %x", (u32)format);
+        DEBUG_ASSERT(false);
+        for (unsigned int y = 0; y < 8; ++y) {
+            std::fill_n(output + y * stride, 8, Math::Vec4<u8>{});
+        }
+        return;
+    }
+}
+
+void DecodeTexture(const u8* source, const TextureInfo& info, Math::Vec4<u8>* output,
+                   bool flip_vertically) {
+    const size_t tile_size = CalculateTileSize(info.format);
+    const ptrdiff_t stride = flip_vertically ? -static_cast<ptrdiff_t>(info.width) : info.width;
+    Math::Vec4<u8>* first_line = flip_vertically ? output + (info.height - 1) * info.width : output;
+
+    for (unsigned int y = 0; y < info.height; y += 8) {
+        const u8* tile = source + (y / 8) * info.stride;
+        Math::Vec4<u8>* tile_output = first_line + y * stride;
+
+        for (unsigned int x = 0; x < info.width; x += 8, tile += tile_size, tile_output += 8) {
+            if (x + 8 <= info.width && y + 8 <= info.height) {
+                DecodeTile(tile, info.format, tile_output, stride);
+                continue;
+            }
+
+            // Partial tiles at the right or bottom edge may not be fully backed by memory, so only
+            // the texels inside the texture are read from them
+            const unsigned int tile_width = std::min(info.width - x, 8u);
+            const unsigned int tile_height = std::min(info.height - y, 8u);
+            for (unsigned int fine_y = 0; fine_y < tile_height; ++fine_y) {
+                for (unsigned int fine_x = 0; fine_x < tile_width; ++fine_x) {
+                    tile_output[fine_y * stride + fine_x] =
+                        LookupTexelInTile(tile, fine_x, fine_y, info, false);
+                }
+            }
+        }
+    }
+}
+
 TextureInfo TextureInfo::FromPicaRegister(const TexturingRegs::TextureConfig& config,
                                           const TexturingRegs::TextureFormat& format) {
     TextureInfo info;
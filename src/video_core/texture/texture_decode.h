@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include "common/common_types.h"
 #include "common/vector_math.h"
 #include "video_core/regs_texturing.h"
@@ -56,5 +57,29 @@ Math::Vec4<u8> LookupTexture(const u8* source, unsigned int x, unsigned int y,
 Math::Vec4<u8> LookupTexelInTile(const u8* source, unsigned int x, unsigned int y,
                                  const TextureInfo& info, bool disable_alpha);
 
+/**
+ * Decodes all texels of a single 8x8 texture tile, giving the same results as LookupTexelInTile.
+ *
+ * @param source Pointer to the beginning of the tile.
+ * @param format Texture format of the tile.
+ * @param output Texel (x, y) of the tile is written to output[y * stride + x].
+ * @param stride Distance between output lines in texels, may be negative.
+ */
+void DecodeTile(const u8* source, TexturingRegs::TextureFormat format, Math::Vec4<u8>* output,
+                ptrdiff_t stride);
+
+/**
+ * Decodes a whole texture, giving the same results as calling LookupTexture for each texel.
+ *
+ * @param source Source pointer to read data from
+ * @param info TextureInfo object describing the texture setup
+ * @param output Buffer of info.width * info.height texels, texel (x, y) is written to
+ *               output[y * info.width + x]
+ * @param flip_vertically If true, texel (x, y) is written to line info.height - 1 - y instead,
+ *                        as expected by OpenGL
+ */
+void DecodeTexture(const u8* source, const TextureInfo& info, Math::Vec4<u8>* output,
+                   bool flip_vertically = false);
+
 } // namespace Texture
 } // namespace Pica
@@ -4,9 +4,12 @@
 
 #include <memory>
 #include "common/logging/log.h"
+#include "core/settings.h"
 #include "video_core/pica.h"
 #include "video_core/renderer_base.h"
+#include "video_core/renderer_headless/renderer_headless.h"
 #include "video_core/renderer_opengl/renderer_opengl.h"
+#include "video_core/shader/shader.h"
 #include "video_core/video_core.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -27,7 +30,11 @@ bool Init(EmuWindow* emu_window) {
     Pica::Init();
 
     g_emu_window = emu_window;
-    g_renderer = std::make_unique<RendererOpenGL>();
+    if (Settings::values.use_headless_renderer) {
+        g_renderer = std::make_unique<RendererHeadless>();
+    } else {
+        g_renderer = std::make_unique<RendererOpenGL>();
+    }
     g_renderer->SetWindow(g_emu_window);
     if (g_renderer->Init()) {
         LOG_DEBUG(Render, "initialized OK");
@@ -47,4 +54,12 @@ void Shutdown() {
     LOG_DEBUG(Render, "shutdown OK");
 }
 
+void LoadShaderCache(u64 program_id) {
+    if (!Settings::values.use_disk_shader_cache)
+        return;
+
+    Pica::Shader::LoadDiskCache(program_id);
+    g_renderer->LoadDiskResources(program_id);
+}
+
 } // namespace
@@ -6,6 +6,7 @@
 
 #include <atomic>
 #include <memory>
+#include "common/common_types.h"
 
 class EmuWindow;
 class RendererBase;
@@ -33,4 +34,7 @@ bool Init(EmuWindow* emu_window);
 /// Shutdown the video core
 void Shutdown();
 
+/// Loads the cached shaders of the title with the given program ID, used to avoid recompiling them
+void LoadShaderCache(u64 program_id);
+
 } // namespace